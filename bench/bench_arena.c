@@ -0,0 +1,191 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_arena.h"
+#include "ui_button.h"
+#include "ui_column.h"
+#include "ui_row.h"
+#include "ui_text.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define BENCH_HAVE_MALLINFO2 1
+#endif
+#endif
+
+#define BENCH_CHURN 20000
+
+typedef struct {
+    ui_column_t *root;
+    ui_text_t *texts[2];
+    ui_row_t **rows;
+    ui_button_t **buttons;
+    int row_count;
+    int columns;
+} bench_scene_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* A calculator-shaped scene: two texts over row_count rows of labelled buttons. */
+static bool bench_scene_build(bench_scene_t *scene, ui_arena_t *arena, int row_count, int columns)
+{
+    static const char *labels[] = {"C", "+/-", "%", "/", "7", "8", "9", "*", "Enter", "Cancel"};
+    scene->row_count = row_count;
+    scene->columns = columns;
+    scene->rows = calloc((size_t)row_count, sizeof(*scene->rows));
+    scene->buttons = calloc((size_t)row_count * (size_t)columns, sizeof(*scene->buttons));
+    scene->root = ui_column_create_in(arena);
+    if (!scene->rows || !scene->buttons || !scene->root) {
+        return false;
+    }
+    for (int i = 0; i < 2; ++i) {
+        scene->texts[i] = ui_text_create_in(arena);
+        if (!scene->texts[i]) {
+            return false;
+        }
+        ui_text_set_value(scene->texts[i], i == 0 ? "Classic Noir Calculator" : "0");
+        ui_column_add_control(scene->root, ui_text_widget_mutable(scene->texts[i]), false, NULL);
+    }
+    for (int r = 0; r < row_count; ++r) {
+        ui_row_t *row = ui_row_create_in(arena);
+        if (!row) {
+            return false;
+        }
+        scene->rows[r] = row;
+        ui_column_add_control(scene->root, ui_row_widget_mutable(row), false, NULL);
+        for (int c = 0; c < columns; ++c) {
+            ui_button_t *button = ui_button_create_in(arena);
+            if (!button) {
+                return false;
+            }
+            scene->buttons[r * columns + c] = button;
+            ui_button_set_text(button, labels[(r * columns + c) % 10]);
+            ui_row_add_control(row, ui_button_widget_mutable(button), false, NULL);
+        }
+    }
+    return true;
+}
+
+/* Heap scenes are torn down widget by widget, as the demos used to do. */
+static void bench_scene_destroy(bench_scene_t *scene, ui_arena_t *arena)
+{
+    if (!arena) {
+        for (int i = 0; scene->buttons && i < scene->row_count * scene->columns; ++i) {
+            ui_button_destroy(scene->buttons[i]);
+        }
+        for (int i = 0; scene->rows && i < scene->row_count; ++i) {
+            ui_row_destroy(scene->rows[i]);
+        }
+        ui_text_destroy(scene->texts[0]);
+        ui_text_destroy(scene->texts[1]);
+        ui_column_destroy(scene->root);
+    }
+    free(scene->rows);
+    free(scene->buttons);
+}
+
+/* Passes: heap, a fresh arena per build, one arena reset between builds. */
+static void bench_startup(const char *name, int row_count, int columns, int builds)
+{
+    double build[3] = {0.0, 0.0, 0.0};
+    double teardown[3] = {0.0, 0.0, 0.0};
+    ui_arena_t *kept = ui_arena_create(0);
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int i = 0; i < builds; ++i) {
+            bench_scene_t scene = {0};
+            double start = bench_now();
+            ui_arena_t *arena = pass == 1 ? ui_arena_create(0) : pass == 2 ? kept : NULL;
+            bench_scene_build(&scene, arena, row_count, columns);
+            double built = bench_now();
+            bench_scene_destroy(&scene, arena);
+            if (pass == 2) {
+                ui_arena_reset(arena);
+            } else {
+                ui_arena_destroy(arena);
+            }
+            build[pass] += built - start;
+            teardown[pass] += bench_now() - built;
+        }
+    }
+    ui_arena_destroy(kept);
+    printf("startup %-10s %5d widgets\n", name, 3 + row_count * (columns + 1));
+    static const char *labels[] = {"heap", "arena", "arena reset"};
+    for (int pass = 0; pass < 3; ++pass) {
+        printf("  %-12s build %8.1f us  teardown %6.1f us\n", labels[pass],
+               build[pass] * 1e6 / builds, teardown[pass] * 1e6 / builds);
+        bench_json("arena", build[pass] * 1e6 / builds, "us", "startup %s %s build", name,
+                   labels[pass]);
+        bench_json("arena", teardown[pass] * 1e6 / builds, "us", "startup %s %s teardown", name,
+                   labels[pass]);
+    }
+}
+
+/* Relabels random buttons with labels of random length, like a live display. */
+static void bench_churn(bench_scene_t *scene)
+{
+    unsigned seed = 12345u;
+    char label[48];
+    int count = scene->row_count * scene->columns;
+    for (int i = 0; i < BENCH_CHURN; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        int index = (int)((seed >> 8) % (unsigned)count);
+        seed = seed * 1103515245u + 12345u;
+        int len = 1 + (int)((seed >> 8) % (sizeof(label) - 1));
+        for (int k = 0; k < len; ++k) {
+            label[k] = (char)('a' + (k + i) % 26);
+        }
+        label[len] = '\0';
+        ui_button_set_text(scene->buttons[index], label);
+    }
+}
+
+static void bench_fragmentation(int row_count, int columns)
+{
+#if defined(BENCH_HAVE_MALLINFO2)
+    bench_scene_t heap_scene = {0};
+    bench_scene_build(&heap_scene, NULL, row_count, columns);
+    bench_churn(&heap_scene);
+    /* process-wide figures; the bench holds little else on the heap */
+    struct mallinfo2 info = mallinfo2();
+    printf("fragment heap   reserved %8zu B  in use %8zu B  free holes %8zu B (%.1f%%)\n",
+           info.arena, info.uordblks, info.fordblks,
+           info.arena ? 100.0 * (double)info.fordblks / (double)info.arena : 0.0);
+    bench_scene_destroy(&heap_scene, NULL);
+#endif
+
+    ui_arena_t *arena = ui_arena_create(0);
+    bench_scene_t arena_scene = {0};
+    bench_scene_build(&arena_scene, arena, row_count, columns);
+    bench_churn(&arena_scene);
+    ui_arena_stats_t stats;
+    ui_arena_stats(arena, &stats);
+    size_t reserved = stats.reserved + stats.large_bytes;
+    printf("fragment arena  reserved %8zu B  in use %8zu B  free lists %8zu B (%.1f%%), "
+           "%zu chunks\n",
+           reserved, stats.live + stats.large_bytes, stats.free,
+           reserved ? 100.0 * (double)(reserved - stats.live - stats.large_bytes) / (double)reserved
+                    : 0.0,
+           stats.chunks);
+    bench_json("arena", (double)reserved, "B", "fragment arena reserved");
+    bench_scene_destroy(&arena_scene, arena);
+    ui_arena_destroy(arena);
+}
+
+int main(void)
+{
+    /* first, while the process heap is still clean */
+    bench_fragmentation(5, 4);
+    bench_startup("calculator", 5, 4, 2000);
+    bench_startup("grid", 32, 32, 200);
+    return 0;
+}
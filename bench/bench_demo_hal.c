@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_hal_headless.h"
+#include "ui_hal_test.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Stands in for the test HAL when a demo is built as a benchmark (make
+ * bench): the demo runs headless on virtual time for BENCH_DEMO_FRAMES
+ * frames, every frame damaged in full, and the wall time per frame after a
+ * short warm-up is reported under BENCH_DEMO_NAME.
+ */
+
+#ifndef BENCH_DEMO_NAME
+#define BENCH_DEMO_NAME "demo"
+#endif
+
+#define BENCH_DEMO_FRAMES 600
+#define BENCH_DEMO_WARMUP 10
+
+static ui_hal_headless_t *bench_demo_headless;
+static ui_hal_ops_t bench_demo_ops;
+static const ui_hal_ops_t *bench_demo_inner;
+static uint32_t bench_demo_frame;
+static double bench_demo_start;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_demo_poll_input(ui_context_t *ctx)
+{
+    if (bench_demo_frame++ == BENCH_DEMO_WARMUP) {
+        bench_demo_start = bench_now();
+    }
+    ui_context_invalidate(ctx);
+    bench_demo_inner->poll_input(ctx);
+}
+
+static void bench_demo_deinit(ui_context_t *ctx)
+{
+    double elapsed = bench_now() - bench_demo_start;
+    bench_demo_inner->deinit(ctx);
+    if (bench_demo_frame > BENCH_DEMO_WARMUP) {
+        double us = elapsed * 1e6 / (bench_demo_frame - BENCH_DEMO_WARMUP);
+        printf("frames %-16s %9.1f us/frame\n", BENCH_DEMO_NAME, us);
+        bench_json("frames", us, "us/frame", "%s full repaint", BENCH_DEMO_NAME);
+    }
+    ui_hal_headless_destroy(bench_demo_headless);
+    bench_demo_headless = NULL;
+}
+
+const ui_hal_ops_t *ui_hal_test_ops(void)
+{
+    if (bench_demo_headless) {
+        return &bench_demo_ops;
+    }
+    bench_demo_headless = ui_hal_headless_create(NULL, BENCH_DEMO_FRAMES);
+    if (!bench_demo_headless) {
+        return NULL;
+    }
+    bench_demo_inner = ui_hal_headless_ops(bench_demo_headless);
+    bench_demo_ops = *bench_demo_inner;
+    bench_demo_ops.poll_input = bench_demo_poll_input;
+    bench_demo_ops.deinit = bench_demo_deinit;
+    return &bench_demo_ops;
+}
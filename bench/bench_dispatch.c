@@ -0,0 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_button.h"
+#include "ui_column.h"
+#include "ui_row.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_CELL_SIZE 16
+#define BENCH_EVENTS 20000
+
+typedef struct {
+    ui_column_t *root;
+    ui_row_t **rows;
+    ui_button_t **buttons;
+    int side;
+} bench_grid_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_grid_destroy(bench_grid_t *grid)
+{
+    if (grid->buttons) {
+        for (int i = 0; i < grid->side * grid->side; ++i) {
+            ui_button_destroy(grid->buttons[i]);
+        }
+    }
+    if (grid->rows) {
+        for (int i = 0; i < grid->side; ++i) {
+            ui_row_destroy(grid->rows[i]);
+        }
+    }
+    ui_column_destroy(grid->root);
+    free(grid->buttons);
+    free(grid->rows);
+}
+
+/* side x side buttons in rows of a column, laid out once like a scene frame */
+static bool bench_grid_build(bench_grid_t *grid, int side)
+{
+    grid->side = side;
+    grid->root = ui_column_create();
+    grid->rows = calloc((size_t)side, sizeof(*grid->rows));
+    grid->buttons = calloc((size_t)side * (size_t)side, sizeof(*grid->buttons));
+    if (!grid->root || !grid->rows || !grid->buttons) {
+        return false;
+    }
+    int extent = side * BENCH_CELL_SIZE;
+    ui_widget_set_bounds(ui_column_widget_mutable(grid->root), 0, 0, extent, extent);
+    ui_column_set_spacing(grid->root, 0);
+    for (int r = 0; r < side; ++r) {
+        ui_row_t *row = ui_row_create();
+        if (!row) {
+            return false;
+        }
+        grid->rows[r] = row;
+        ui_row_set_spacing(row, 0);
+        ui_widget_set_bounds(ui_row_widget_mutable(row), 0, 0, extent, BENCH_CELL_SIZE);
+        ui_column_add_control(grid->root, ui_row_widget_mutable(row), false, NULL);
+        for (int c = 0; c < side; ++c) {
+            ui_button_t *button = ui_button_create();
+            if (!button) {
+                return false;
+            }
+            grid->buttons[r * side + c] = button;
+            ui_widget_set_bounds(ui_button_widget_mutable(button), 0, 0, BENCH_CELL_SIZE,
+                                 BENCH_CELL_SIZE);
+            ui_row_add_control(row, ui_button_widget_mutable(button), false, NULL);
+        }
+    }
+    ui_widget_layout_tree(ui_column_widget_mutable(grid->root));
+    return true;
+}
+
+static void bench_points(ui_event_t *events, int extent)
+{
+    unsigned seed = 12345u;
+    for (int i = 0; i < BENCH_EVENTS; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        events[i].type = UI_EVENT_TOUCH_MOVE;
+        events[i].data.touch.x = (int)((seed >> 8) % (unsigned)extent);
+        seed = seed * 1103515245u + 12345u;
+        events[i].data.touch.y = (int)((seed >> 8) % (unsigned)extent);
+    }
+}
+
+static void bench_report(const char *name, int widgets, double elapsed)
+{
+    printf("%-10s %6d widgets %12.1f ns/event %12.0f events/s\n", name, widgets,
+           elapsed * 1e9 / BENCH_EVENTS, BENCH_EVENTS / elapsed);
+    bench_json("dispatch", elapsed * 1e9 / BENCH_EVENTS, "ns/event", "%s %d widgets", name,
+               widgets);
+}
+
+static void bench_run(int side)
+{
+    bench_grid_t grid = {0};
+    ui_event_t *events = calloc(BENCH_EVENTS, sizeof(*events));
+    if (!events || !bench_grid_build(&grid, side)) {
+        free(events);
+        bench_grid_destroy(&grid);
+        return;
+    }
+    ui_widget_t *root = ui_column_widget_mutable(grid.root);
+    int widgets = side * side;
+    bench_points(events, side * BENCH_CELL_SIZE);
+
+    double start = bench_now();
+    for (int i = 0; i < BENCH_EVENTS; ++i) {
+        ui_widget_dispatch_event(root, &events[i]);
+    }
+    bench_report("broadcast", widgets, bench_now() - start);
+
+    start = bench_now();
+    for (int i = 0; i < BENCH_EVENTS; ++i) {
+        ui_widget_dispatch_at(root, &events[i], events[i].data.touch.x, events[i].data.touch.y);
+    }
+    bench_report("hit-test", widgets, bench_now() - start);
+
+    /* a drag after TOUCH_DOWN: every MOVE goes to the captured button */
+    ui_widget_t *captured = ui_button_widget_mutable(grid.buttons[widgets / 2]);
+    start = bench_now();
+    for (int i = 0; i < BENCH_EVENTS; ++i) {
+        ui_widget_send_event(captured, &events[i]);
+    }
+    bench_report("captured", widgets, bench_now() - start);
+
+    free(events);
+    bench_grid_destroy(&grid);
+}
+
+int main(void)
+{
+    bench_run(32);
+    bench_run(100);
+    return 0;
+}
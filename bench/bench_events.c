@@ -0,0 +1,253 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_event_queue.h"
+#include "ui_primitives.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_EVENTS 4000000u
+#define BENCH_MAX_PRODUCERS 4
+
+/* The old context queue: a mutex around a 128-slot ring, kept as a baseline. */
+typedef struct {
+    pthread_mutex_t lock;
+    ui_event_t slots[UI_EVENT_QUEUE_SIZE];
+    size_t head;
+    size_t count;
+} bench_mutex_ring_t;
+
+typedef enum {
+    BENCH_QUEUE_MUTEX,
+    BENCH_QUEUE_SPSC,
+    BENCH_QUEUE_MPSC,
+    BENCH_QUEUE_CONTEXT
+} bench_queue_kind_t;
+
+typedef struct {
+    bench_queue_kind_t kind;
+    bench_mutex_ring_t mutex_ring;
+    ui_event_spsc_t spsc;
+    ui_event_mpsc_t mpsc;
+    ui_context_t *ctx;
+} bench_queue_t;
+
+typedef struct {
+    bench_queue_t *queue;
+    uint32_t producer;
+    uint32_t count;
+} bench_producer_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool bench_hal_init(ui_context_t *ctx)
+{
+    (void)ctx;
+    return true;
+}
+
+static void bench_hal_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    (void)ctx;
+    (void)framebuffer;
+}
+
+static const ui_hal_ops_t bench_hal = {
+    .user_data = NULL,
+    .init = bench_hal_init,
+    .deinit = NULL,
+    .commit_frame = bench_hal_commit
+};
+
+static bool bench_push(bench_queue_t *queue, const ui_event_t *event)
+{
+    switch (queue->kind) {
+    case BENCH_QUEUE_MUTEX: {
+        bench_mutex_ring_t *ring = &queue->mutex_ring;
+        pthread_mutex_lock(&ring->lock);
+        bool room = ring->count < UI_EVENT_QUEUE_SIZE;
+        if (room) {
+            ring->slots[(ring->head + ring->count) % UI_EVENT_QUEUE_SIZE] = *event;
+            ring->count++;
+        }
+        pthread_mutex_unlock(&ring->lock);
+        return room;
+    }
+    case BENCH_QUEUE_SPSC:
+        return ui_event_spsc_push(&queue->spsc, event);
+    case BENCH_QUEUE_MPSC:
+        return ui_event_mpsc_push(&queue->mpsc, event);
+    case BENCH_QUEUE_CONTEXT:
+        return ui_context_post_event(queue->ctx, event);
+    }
+    return false;
+}
+
+static bool bench_pop(bench_queue_t *queue, ui_event_t *event)
+{
+    switch (queue->kind) {
+    case BENCH_QUEUE_MUTEX: {
+        bench_mutex_ring_t *ring = &queue->mutex_ring;
+        pthread_mutex_lock(&ring->lock);
+        bool any = ring->count > 0;
+        if (any) {
+            *event = ring->slots[ring->head];
+            ring->head = (ring->head + 1) % UI_EVENT_QUEUE_SIZE;
+            ring->count--;
+        }
+        pthread_mutex_unlock(&ring->lock);
+        return any;
+    }
+    case BENCH_QUEUE_SPSC:
+        return ui_event_spsc_pop(&queue->spsc, event);
+    case BENCH_QUEUE_MPSC:
+        return ui_event_mpsc_pop(&queue->mpsc, event);
+    case BENCH_QUEUE_CONTEXT:
+        return ui_context_poll_event(queue->ctx, event);
+    }
+    return false;
+}
+
+/* Each producer numbers its moves in x/y so the consumer can check order. */
+static void *bench_produce(void *arg)
+{
+    bench_producer_t *producer = arg;
+    ui_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = UI_EVENT_TOUCH_MOVE;
+    for (uint32_t i = 0; i < producer->count; ++i) {
+        event.data.touch.x = (int16_t)producer->producer;
+        event.data.touch.y = (int16_t)(i & 0x7FFF);
+        while (!bench_push(producer->queue, &event)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void bench_run(const char *name, bench_queue_kind_t kind, uint32_t producers)
+{
+    static bench_queue_t queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.kind = kind;
+    pthread_mutex_init(&queue.mutex_ring.lock, NULL);
+    ui_event_spsc_init(&queue.spsc);
+    ui_event_mpsc_init(&queue.mpsc);
+    if (kind == BENCH_QUEUE_CONTEXT) {
+        queue.ctx = ui_context_create(&bench_hal);
+    }
+
+    bench_producer_t args[BENCH_MAX_PRODUCERS];
+    pthread_t threads[BENCH_MAX_PRODUCERS];
+    uint32_t next[BENCH_MAX_PRODUCERS] = {0};
+    uint32_t per_producer = BENCH_EVENTS / producers;
+    double start = bench_now();
+    for (uint32_t p = 0; p < producers; ++p) {
+        args[p].queue = &queue;
+        args[p].producer = p;
+        args[p].count = per_producer;
+        pthread_create(&threads[p], NULL, bench_produce, &args[p]);
+    }
+    uint32_t received = 0;
+    uint32_t out_of_order = 0;
+    ui_event_t event;
+    while (received < per_producer * producers) {
+        if (!bench_pop(&queue, &event)) {
+            /* hand the core over when producers share it */
+            sched_yield();
+            continue;
+        }
+        uint32_t p = (uint32_t)event.data.touch.x;
+        if (p >= producers || (uint32_t)event.data.touch.y != (next[p] & 0x7FFF)) {
+            out_of_order++;
+        }
+        if (p < producers) {
+            next[p]++;
+        }
+        received++;
+    }
+    for (uint32_t p = 0; p < producers; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+    double elapsed = bench_now() - start;
+    printf("events %-8s %u producer%s %7.1f M events/s  %5.1f ns/event  %u out of order\n",
+           name, producers, producers == 1 ? " " : "s", received / elapsed / 1e6,
+           elapsed * 1e9 / received, out_of_order);
+    bench_json("events", elapsed * 1e9 / received, "ns/event", "%s %u producers", name,
+               producers);
+    ui_context_destroy(queue.ctx);
+    pthread_mutex_destroy(&queue.mutex_ring.lock);
+}
+
+/* ui_scene_post's ring: producers post (fn, arg) calls, the consumer runs them. */
+static ui_task_mpsc_t bench_tasks;
+static uint32_t bench_task_runs;
+
+static void bench_task(void *arg)
+{
+    (void)arg;
+    bench_task_runs++;
+}
+
+static void *bench_produce_tasks(void *arg)
+{
+    uint32_t count = *(const uint32_t *)arg;
+    for (uint32_t i = 0; i < count; ++i) {
+        while (!ui_task_mpsc_push(&bench_tasks, bench_task, NULL)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void bench_run_tasks(uint32_t producers)
+{
+    ui_task_mpsc_init(&bench_tasks);
+    bench_task_runs = 0;
+    pthread_t threads[BENCH_MAX_PRODUCERS];
+    uint32_t per_producer = BENCH_EVENTS / producers;
+    double start = bench_now();
+    for (uint32_t p = 0; p < producers; ++p) {
+        pthread_create(&threads[p], NULL, bench_produce_tasks, &per_producer);
+    }
+    ui_task_fn fn;
+    void *arg;
+    while (bench_task_runs < per_producer * producers) {
+        if (!ui_task_mpsc_pop(&bench_tasks, &fn, &arg)) {
+            sched_yield();
+            continue;
+        }
+        fn(arg);
+    }
+    for (uint32_t p = 0; p < producers; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+    double elapsed = bench_now() - start;
+    printf("tasks  mpsc     %u producer%s %7.1f M tasks/s   %5.1f ns/task\n", producers,
+           producers == 1 ? " " : "s", bench_task_runs / elapsed / 1e6,
+           elapsed * 1e9 / bench_task_runs);
+    bench_json("events", elapsed * 1e9 / bench_task_runs, "ns/task", "tasks %u producers",
+               producers);
+}
+
+int main(void)
+{
+    bench_run("mutex", BENCH_QUEUE_MUTEX, 1);
+    bench_run("spsc", BENCH_QUEUE_SPSC, 1);
+    bench_run("mpsc", BENCH_QUEUE_MPSC, 1);
+    bench_run("mpsc", BENCH_QUEUE_MPSC, BENCH_MAX_PRODUCERS);
+    bench_run("context", BENCH_QUEUE_CONTEXT, 1);
+    bench_run("context", BENCH_QUEUE_CONTEXT, BENCH_MAX_PRODUCERS);
+    bench_run_tasks(1);
+    bench_run_tasks(BENCH_MAX_PRODUCERS);
+    return 0;
+}
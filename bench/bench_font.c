@@ -0,0 +1,197 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_font.h"
+#include "ui_font_aa.h"
+#include "ui_font_packed.h"
+#include "ui_primitives.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_FIRST_CODEPOINT 0x20
+#define BENCH_LAST_CODEPOINT 0x7E
+#define BENCH_GLYPH_COUNT (BENCH_LAST_CODEPOINT - BENCH_FIRST_CODEPOINT + 1)
+#define BENCH_PASSES 4000
+#define BENCH_CYRILLIC "\xD0\x9D\xD0\xB0\xD1\x81\xD1\x82\xD1\x80\xD0\xBE\xD0\xB9\xD0\xBA\xD0\xB8"
+
+static bool bench_hal_init(ui_context_t *ctx)
+{
+    (void)ctx;
+    return true;
+}
+
+static void bench_hal_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    (void)ctx;
+    (void)framebuffer;
+}
+
+static const ui_hal_ops_t bench_hal = {
+    .user_data = NULL,
+    .init = bench_hal_init,
+    .deinit = NULL,
+    .commit_frame = bench_hal_commit
+};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Derive a grayscale font from the 1bpp table: solid ink plus a soft halo
+ * on horizontal neighbours, so every path touches the same pixel count. */
+static bool bench_build_aa_font(bareui_font_aa_t *font, uint8_t bpp,
+                                bareui_font_aa_entry_t *entries, uint8_t **coverage_out)
+{
+    const bareui_font_t *base = bareui_font_default();
+    size_t stride = bareui_font_aa_stride(BAREUI_FONT_MAX_WIDTH, bpp);
+    uint8_t *coverage = calloc(BENCH_GLYPH_COUNT, stride * base->height);
+    if (!coverage) {
+        return false;
+    }
+    unsigned levels = (1u << bpp) - 1;
+    unsigned per_byte = 8 / bpp;
+    for (uint32_t cp = BENCH_FIRST_CODEPOINT; cp <= BENCH_LAST_CODEPOINT; ++cp) {
+        size_t index = cp - BENCH_FIRST_CODEPOINT;
+        bareui_font_glyph_t glyph;
+        bareui_font_aa_entry_t *entry = &entries[index];
+        entry->codepoint = cp;
+        entry->offset = (uint32_t)(index * stride * base->height);
+        if (!bareui_font_lookup(base, cp, &glyph)) {
+            entry->width = 0;
+            entry->advance = BAREUI_FONT_SPACING;
+            continue;
+        }
+        entry->width = glyph.width;
+        entry->advance = glyph.spacing;
+        for (uint8_t row = 0; row < glyph.height; ++row) {
+            uint8_t *dst = coverage + entry->offset + row * stride;
+            for (uint8_t col = 0; col < glyph.width; ++col) {
+                bool ink = glyph.columns[col] & (1u << row);
+                bool left = col > 0 && (glyph.columns[col - 1] & (1u << row));
+                bool right = col + 1 < glyph.width && (glyph.columns[col + 1] & (1u << row));
+                unsigned value = ink ? levels : ((left || right) ? levels / 2 : 0);
+                dst[col / per_byte] |= (uint8_t)(value << (8 - bpp - (col % per_byte) * bpp));
+            }
+        }
+    }
+    bareui_font_aa_init(font, base->height, bpp, entries, BENCH_GLYPH_COUNT, coverage);
+    *coverage_out = coverage;
+    return true;
+}
+
+static void bench_run(ui_context_t *ctx, const char *name, const bareui_font_t *font,
+                      bool solid_background, const char *text)
+{
+    ui_context_set_font(ctx, font);
+    if (solid_background) {
+        ui_context_set_text_background(ctx, ui_color_from_hex(0xEEE2DF));
+    } else {
+        ui_context_clear_text_background(ctx);
+    }
+    ui_color_t color = ui_color_from_hex(0x1A1A1A);
+    size_t glyphs = strlen(text);
+    double start = bench_now();
+    for (int pass = 0; pass < BENCH_PASSES; ++pass) {
+        int y = (pass * 9) % (UI_FRAMEBUFFER_HEIGHT - font->height);
+        ui_context_draw_text(ctx, 0, y, text, color);
+    }
+    double elapsed = bench_now() - start;
+    double total = (double)glyphs * BENCH_PASSES;
+    printf("%-16s %10.1f ns/glyph %12.0f glyphs/s\n", name, elapsed * 1e9 / total,
+           total / elapsed);
+    bench_json("font", elapsed * 1e9 / total, "ns/glyph", "%s", name);
+}
+
+/* the same label drawn from a ui_shaped_text_t: no decode or lookup per frame */
+static void bench_run_shaped(ui_context_t *ctx, const char *name, const bareui_font_t *font,
+                             const char *text)
+{
+    ui_shaped_text_t shaped;
+    ui_shaped_text_init(&shaped);
+    if (!ui_shaped_text_shape(&shaped, font, text)) {
+        return;
+    }
+    ui_context_clear_text_background(ctx);
+    ui_color_t color = ui_color_from_hex(0x1A1A1A);
+    double start = bench_now();
+    for (int pass = 0; pass < BENCH_PASSES; ++pass) {
+        int y = (pass * 9) % (UI_FRAMEBUFFER_HEIGHT - font->height);
+        ui_context_draw_shaped_text(ctx, 0, y, &shaped, color);
+    }
+    double elapsed = bench_now() - start;
+    double total = (double)shaped.count * BENCH_PASSES;
+    printf("%-16s %10.1f ns/glyph %12.0f glyphs/s\n", name, elapsed * 1e9 / total,
+           total / elapsed);
+    bench_json("font", elapsed * 1e9 / total, "ns/glyph", "%s", name);
+    ui_shaped_text_release(&shaped);
+}
+
+int main(void)
+{
+    ui_context_t *ctx = ui_context_create(&bench_hal);
+    if (!ctx) {
+        return 1;
+    }
+    char text[BENCH_GLYPH_COUNT + 1];
+    for (int i = 0; i < BENCH_GLYPH_COUNT; ++i) {
+        text[i] = (char)(BENCH_FIRST_CODEPOINT + i);
+    }
+    text[BENCH_GLYPH_COUNT] = '\0';
+
+    bareui_font_aa_entry_t entries4[BENCH_GLYPH_COUNT];
+    bareui_font_aa_entry_t entries2[BENCH_GLYPH_COUNT];
+    bareui_font_aa_t font4;
+    bareui_font_aa_t font2;
+    uint8_t *coverage4 = NULL;
+    uint8_t *coverage2 = NULL;
+    if (!bench_build_aa_font(&font4, 4, entries4, &coverage4) ||
+        !bench_build_aa_font(&font2, 2, entries2, &coverage2)) {
+        free(coverage4);
+        ui_context_destroy(ctx);
+        return 1;
+    }
+
+    uint32_t codepoints[BENCH_GLYPH_COUNT];
+    for (int i = 0; i < BENCH_GLYPH_COUNT; ++i) {
+        codepoints[i] = (uint32_t)(BENCH_FIRST_CODEPOINT + i);
+    }
+    bareui_font_packed_t *packed1 =
+        bareui_font_packed_create_scaled(bareui_font_default(), codepoints, BENCH_GLYPH_COUNT, 1);
+    bareui_font_packed_t *packed3 =
+        bareui_font_packed_create_scaled(bareui_font_default(), codepoints, BENCH_GLYPH_COUNT, 3);
+    if (!packed1 || !packed3) {
+        bareui_font_packed_destroy(packed1);
+        free(coverage4);
+        free(coverage2);
+        ui_context_destroy(ctx);
+        return 1;
+    }
+
+    ui_context_clear(ctx, ui_color_from_hex(0xEEE2DF));
+    bench_run(ctx, "1bpp", bareui_font_default(), false, text);
+    bench_run(ctx, "2bpp blend", &font2.base, false, text);
+    bench_run(ctx, "2bpp ramp", &font2.base, true, text);
+    bench_run(ctx, "4bpp blend", &font4.base, false, text);
+    bench_run(ctx, "4bpp ramp", &font4.base, true, text);
+    bench_run(ctx, "packed 1bpp", &packed1->base, false, text);
+    /* large readouts: digits only, so the 3x run stays on screen */
+    bench_run(ctx, "1bpp digits", bareui_font_default(), false, "0123456789");
+    bench_run(ctx, "packed digits 3x", &packed3->base, false, "0123456789");
+    /* Cyrillic misses the ASCII tables and hits the generated-table scan */
+    bench_run(ctx, "1bpp cyrillic", bareui_font_default(), false, BENCH_CYRILLIC);
+    bench_run_shaped(ctx, "shaped 1bpp", bareui_font_default(), text);
+    bench_run_shaped(ctx, "shaped cyrillic", bareui_font_default(), BENCH_CYRILLIC);
+
+    bareui_font_packed_destroy(packed3);
+    bareui_font_packed_destroy(packed1);
+    free(coverage4);
+    free(coverage2);
+    ui_context_destroy(ctx);
+    return 0;
+}
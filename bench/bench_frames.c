@@ -0,0 +1,124 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_arena.h"
+#include "ui_button.h"
+#include "ui_column.h"
+#include "ui_primitives.h"
+#include "ui_row.h"
+#include "ui_text.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_FRAMES 200
+
+static bool bench_hal_init(ui_context_t *ctx)
+{
+    (void)ctx;
+    return true;
+}
+
+static void bench_hal_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    (void)ctx;
+    (void)framebuffer;
+}
+
+static const ui_hal_ops_t bench_hal = {
+    .user_data = NULL,
+    .init = bench_hal_init,
+    .deinit = NULL,
+    .commit_frame = bench_hal_commit
+};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_report(const char *name, int widgets, double elapsed)
+{
+    double us = elapsed * 1e6 / BENCH_FRAMES;
+    printf("frames %-16s %5d widgets %9.1f us/frame\n", name, widgets, us);
+    bench_json("frames", us, "us/frame", "%s %d widgets", name, widgets);
+}
+
+/* A settings-style page: a scrolling column of rows, each a label and a
+ * button, about `widgets` nodes in all. Most rows sit below the fold, so
+ * layout scales with the tree while painting stays bounded by the screen. */
+static void bench_frames(ui_context_t *ctx, int widgets)
+{
+    ui_arena_t *arena = ui_arena_create(0);
+    ui_column_t *column = ui_column_create_in(arena);
+    ui_widget_t *root = ui_column_widget_mutable(column);
+    ui_widget_set_bounds(root, 0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT);
+    ui_column_set_scroll_mode(column, UI_SCROLL_MODE_ENABLED);
+    ui_column_set_spacing(column, 4);
+    ui_text_t *first = NULL;
+    int rows = (widgets - 1) / 3;
+    for (int i = 0; i < rows; ++i) {
+        char label[32];
+        snprintf(label, sizeof(label), "Setting %d", i);
+        ui_row_t *row = ui_row_create_in(arena);
+        ui_row_set_spacing(row, 8);
+        ui_text_t *text = ui_text_create_in(arena);
+        ui_text_set_value(text, label);
+        ui_button_t *button = ui_button_create_in(arena);
+        ui_button_set_text(button, "Edit");
+        ui_row_add_control(row, ui_text_widget_mutable(text), true, NULL);
+        ui_row_add_control(row, ui_button_widget_mutable(button), false, NULL);
+        ui_column_add_control(column, ui_row_widget_mutable(row), false, NULL);
+        first = first ? first : text;
+    }
+    widgets = 1 + rows * 3;
+    ui_widget_host_t host;
+    ui_widget_host_init(&host);
+    ui_widget_set_host(root, &host);
+    ui_widget_render_tree(root, ctx);
+
+    double start = bench_now();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        ui_widget_invalidate_all(root);
+        ui_widget_render_damage(root, ctx);
+        ui_context_render(ctx);
+    }
+    bench_report("full repaint", widgets, bench_now() - start);
+
+    start = bench_now();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        ui_widget_invalidate(ui_text_widget_mutable(first));
+        ui_widget_render_damage(root, ctx);
+        ui_context_render(ctx);
+    }
+    bench_report("one label damaged", widgets, bench_now() - start);
+
+    /* a text change re-measures up the spine and re-arranges every row */
+    start = bench_now();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        ui_text_set_value(first, frame % 2 ? "Setting 0" : "Setting zero");
+        ui_widget_render_damage(root, ctx);
+        ui_context_render(ctx);
+    }
+    bench_report("relayout", widgets, bench_now() - start);
+
+    ui_widget_set_host(root, NULL);
+    ui_widget_host_release(&host);
+    ui_widget_destroy_tree(root);
+    ui_arena_destroy(arena);
+}
+
+int main(void)
+{
+    ui_context_t *ctx = ui_context_create(&bench_hal);
+    if (!ctx) {
+        return 1;
+    }
+    bench_frames(ctx, 100);
+    bench_frames(ctx, 1000);
+    ui_context_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef BENCH_JSON_H
+#define BENCH_JSON_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Machine-readable results next to the human ones: when BAREUI_BENCH_JSON
+ * names a file, each result is appended to it as one JSON object per line,
+ * so runs diff line by line. make bench collects them in
+ * bench/results.jsonl; tools/bench_compare.py checks them against
+ * bench/baseline.jsonl. Units ending in "/s" are better when higher, all
+ * others when lower. Metric names are printf formats and must not need
+ * JSON escaping.
+ */
+static void bench_json(const char *bench, double value, const char *unit, const char *metric,
+                       ...)
+{
+    const char *path = getenv("BAREUI_BENCH_JSON");
+    if (!path || !*path) {
+        return;
+    }
+    FILE *file = fopen(path, "a");
+    if (!file) {
+        return;
+    }
+    char name[128];
+    va_list args;
+    va_start(args, metric);
+    vsnprintf(name, sizeof(name), metric, args);
+    va_end(args);
+    fprintf(file, "{\"bench\": \"%s\", \"metric\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}\n",
+            bench, name, value, unit);
+    fclose(file);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_arena.h"
+#include "ui_list_view.h"
+#include "ui_text.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_ROW_HEIGHT 20
+#define BENCH_VIEW_HEIGHT 240
+#define BENCH_FRAMES 20000
+#define BENCH_STEP 7
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t bench_item_count(void *user_data)
+{
+    return *(const size_t *)user_data;
+}
+
+static int bench_row_height(void *user_data)
+{
+    (void)user_data;
+    return BENCH_ROW_HEIGHT;
+}
+
+static ui_widget_t *bench_create_row(void *user_data, ui_arena_t *arena)
+{
+    (void)user_data;
+    return ui_text_widget_mutable(ui_text_create_in(arena));
+}
+
+static void bench_bind_row(void *user_data, ui_widget_t *row, size_t index)
+{
+    (void)user_data;
+    char label[32];
+    snprintf(label, sizeof(label), "Event %zu", index);
+    ui_text_set_value((ui_text_t *)row, label);
+}
+
+static void bench_destroy_row(void *user_data, ui_widget_t *row)
+{
+    (void)user_data;
+    ui_text_destroy((ui_text_t *)row);
+}
+
+static const ui_list_view_source_t bench_source = {
+    .item_count = bench_item_count,
+    .row_height = bench_row_height,
+    .create_row = bench_create_row,
+    .bind_row = bench_bind_row,
+    .destroy_row = bench_destroy_row,
+};
+
+/* Drags through the list one step per frame, bouncing at the ends, and lays
+ * out each frame the way the scene does before painting. */
+static void bench_scroll(size_t items)
+{
+    ui_arena_t *arena = ui_arena_create(0);
+    ui_list_view_t *list = ui_list_view_create_in(arena);
+    ui_widget_t *widget = ui_list_view_widget_mutable(list);
+    ui_widget_set_bounds(widget, 0, 0, 320, BENCH_VIEW_HEIGHT);
+    ui_list_view_set_source(list, &bench_source, &items);
+    ui_widget_layout_tree(widget);
+
+    int max_offset = (int)(items * BENCH_ROW_HEIGHT) - BENCH_VIEW_HEIGHT;
+    int offset = 0;
+    int step = BENCH_STEP;
+    double start = bench_now();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        offset += step;
+        if (offset < 0 || offset > max_offset) {
+            step = -step;
+            offset += 2 * step;
+        }
+        ui_list_view_set_scroll_offset(list, offset);
+        ui_widget_layout_tree(widget);
+    }
+    double elapsed = bench_now() - start;
+
+    ui_arena_stats_t stats;
+    ui_arena_stats(arena, &stats);
+    printf("list %7zu items  %6.1f ns/frame  %2zu rows alive  %6zu B live in arena\n", items,
+           elapsed * 1e9 / BENCH_FRAMES, ui_list_view_row_count(list),
+           stats.live + stats.large_bytes);
+    bench_json("list", elapsed * 1e9 / BENCH_FRAMES, "ns/frame", "list %zu items", items);
+    ui_list_view_destroy(list);
+    ui_arena_destroy(arena);
+}
+
+int main(void)
+{
+    bench_scroll(1000);
+    bench_scroll(100000);
+    return 0;
+}
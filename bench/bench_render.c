@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_font.h"
+#include "ui_primitives.h"
+#include "ui_progressring.h"
+#include "ui_widget.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_SPRITE 64
+#define BENCH_STAR_POINTS 10
+#define BENCH_CIRCLE_POINTS 48
+#define BENCH_CYRILLIC "\xD0\x9D\xD0\xB0\xD1\x81\xD1\x82\xD1\x80\xD0\xBE\xD0\xB9\xD0\xBA\xD0\xB8"
+
+static bool bench_hal_init(ui_context_t *ctx)
+{
+    (void)ctx;
+    return true;
+}
+
+static void bench_hal_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    (void)ctx;
+    (void)framebuffer;
+}
+
+static const ui_hal_ops_t bench_hal = {
+    .user_data = NULL,
+    .init = bench_hal_init,
+    .deinit = NULL,
+    .commit_frame = bench_hal_commit
+};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_report(const char *name, double elapsed, int iterations)
+{
+    double ns = elapsed * 1e9 / iterations;
+    printf("render %-20s %10.1f ns/op\n", name, ns);
+    bench_json("render", ns, "ns/op", "%s", name);
+}
+
+static void bench_fill(ui_context_t *ctx)
+{
+    ui_color_t color = ui_color_from_hex(0xC97C5D);
+    int iterations = 2000;
+    double start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_fill_rect(ctx, 0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT, color);
+    }
+    bench_report("fill_rect screen", bench_now() - start, iterations);
+
+    iterations = 200000;
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_fill_rect(ctx, (i * 7) % 288, (i * 5) % 208, 32, 32, color);
+    }
+    bench_report("fill_rect 32x32", bench_now() - start, iterations);
+
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_fill_rect(ctx, 0, i % UI_FRAMEBUFFER_HEIGHT, UI_FRAMEBUFFER_WIDTH, 1, color);
+    }
+    bench_report("fill_rect hline", bench_now() - start, iterations);
+}
+
+static void bench_blit(ui_context_t *ctx)
+{
+    static ui_color_t sprite[BENCH_SPRITE * BENCH_SPRITE];
+    for (int i = 0; i < BENCH_SPRITE * BENCH_SPRITE; ++i) {
+        sprite[i] = (ui_color_t)(i * 2654435761u >> 16);
+    }
+    int iterations = 50000;
+    double start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_blit(ctx, sprite, BENCH_SPRITE, BENCH_SPRITE, (i * 7) % 256, (i * 5) % 176);
+    }
+    bench_report("blit 64x64", bench_now() - start, iterations);
+
+    /* half the sprite hangs off the corner, so clipping is on the path */
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_blit(ctx, sprite, BENCH_SPRITE, BENCH_SPRITE, -BENCH_SPRITE / 2,
+                        -BENCH_SPRITE / 2);
+    }
+    bench_report("blit 64x64 clipped", bench_now() - start, iterations);
+}
+
+static void bench_text(ui_context_t *ctx)
+{
+    const bareui_font_t *font = bareui_font_default();
+    ui_context_set_font(ctx, font);
+    ui_context_clear_text_background(ctx);
+    ui_color_t color = ui_color_from_hex(0x1A1A1A);
+
+    int iterations = 500000;
+    volatile uint32_t sink = 0;
+    bareui_font_glyph_t glyph;
+    double start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        if (bareui_font_lookup(font, 0x20 + (uint32_t)(i % 95), &glyph)) {
+            sink += glyph.width;
+        }
+    }
+    bench_report("font_lookup ascii", bench_now() - start, iterations);
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        if (bareui_font_lookup(font, 0x410 + (uint32_t)(i % 64), &glyph)) {
+            sink += glyph.width;
+        }
+    }
+    bench_report("font_lookup cyrillic", bench_now() - start, iterations);
+    (void)sink;
+
+    iterations = 200000;
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_draw_codepoint(ctx, (i * 7) % 300, (i * 5) % 220, 'A' + (uint32_t)(i % 26),
+                                  color);
+    }
+    bench_report("draw_codepoint", bench_now() - start, iterations);
+
+    iterations = 20000;
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_draw_text(ctx, 0, (i * 9) % 220, "The quick brown fox jumps over", color);
+    }
+    bench_report("draw_text 30 ascii", bench_now() - start, iterations);
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_draw_text(ctx, 0, (i * 9) % 220, BENCH_CYRILLIC, color);
+    }
+    bench_report("draw_text 9 cyrillic", bench_now() - start, iterations);
+}
+
+static void bench_polygon(ui_context_t *ctx)
+{
+    ui_point_t star[BENCH_STAR_POINTS];
+    ui_point_t circle[BENCH_CIRCLE_POINTS];
+    const double pi = 3.14159265358979323846;
+    for (int i = 0; i < BENCH_STAR_POINTS; ++i) {
+        double radius = i % 2 ? 40.0 : 100.0;
+        double angle = 2.0 * pi * i / BENCH_STAR_POINTS;
+        star[i].x = (int16_t)(160 + radius * cos(angle));
+        star[i].y = (int16_t)(120 + radius * sin(angle));
+    }
+    for (int i = 0; i < BENCH_CIRCLE_POINTS; ++i) {
+        double angle = 2.0 * pi * i / BENCH_CIRCLE_POINTS;
+        circle[i].x = (int16_t)(160 + 32 * cos(angle));
+        circle[i].y = (int16_t)(120 + 32 * sin(angle));
+    }
+    ui_color_t color = ui_color_from_hex(0xB36A5E);
+    int iterations = 5000;
+    double start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_draw_polygon(ctx, star, BENCH_STAR_POINTS, color);
+    }
+    bench_report("polygon star r100", bench_now() - start, iterations);
+    start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_context_draw_polygon(ctx, circle, BENCH_CIRCLE_POINTS, color);
+    }
+    bench_report("polygon circle r32", bench_now() - start, iterations);
+}
+
+/* Arc rasterization as the widget does it: a 64 px ring at 62 %. */
+static void bench_ring(ui_context_t *ctx)
+{
+    ui_progressring_t *ring = ui_progressring_create();
+    if (!ring) {
+        return;
+    }
+    ui_widget_t *widget = ui_progressring_widget_mutable(ring);
+    ui_widget_set_bounds(widget, 128, 88, 64, 64);
+    ui_progressring_set_value(ring, 0.62);
+    int iterations = 5000;
+    double start = bench_now();
+    for (int i = 0; i < iterations; ++i) {
+        ui_widget_render_tree(widget, ctx);
+    }
+    bench_report("progressring 64px", bench_now() - start, iterations);
+    ui_progressring_destroy(ring);
+}
+
+int main(void)
+{
+    ui_context_t *ctx = ui_context_create(&bench_hal);
+    if (!ctx) {
+        return 1;
+    }
+    bench_fill(ctx);
+    bench_blit(ctx);
+    bench_text(ctx);
+    bench_polygon(ctx);
+    bench_ring(ctx);
+    ui_context_destroy(ctx);
+    return 0;
+}
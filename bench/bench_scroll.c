@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_arena.h"
+#include "ui_column.h"
+#include "ui_primitives.h"
+#include "ui_text.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_LINES 200
+#define BENCH_FRAMES 2000
+#define BENCH_STEP 3
+
+static bool bench_hal_init(ui_context_t *ctx)
+{
+    (void)ctx;
+    return true;
+}
+
+static void bench_hal_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    (void)ctx;
+    (void)framebuffer;
+}
+
+static const ui_hal_ops_t bench_hal = {
+    .user_data = NULL,
+    .init = bench_hal_init,
+    .deinit = NULL,
+    .commit_frame = bench_hal_commit
+};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Scrolls a full-screen column of text lines a few pixels per frame,
+ * bouncing at the ends, and paints each frame either from scratch or from
+ * the damage list (blit plus the uncovered strip). */
+static void bench_scroll(ui_context_t *ctx, bool damage_only)
+{
+    ui_arena_t *arena = ui_arena_create(0);
+    ui_column_t *column = ui_column_create_in(arena);
+    ui_widget_t *widget = ui_column_widget_mutable(column);
+    ui_widget_set_bounds(widget, 0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT);
+    ui_column_set_scroll_mode(column, UI_SCROLL_MODE_ENABLED);
+    ui_column_set_spacing(column, 2);
+    for (int i = 0; i < BENCH_LINES; ++i) {
+        char label[32];
+        snprintf(label, sizeof(label), "Line %d of the log", i);
+        ui_text_t *text = ui_text_create_in(arena);
+        ui_text_set_value(text, label);
+        ui_text_set_color(text, 0xFFFF);
+        ui_column_add_control(column, ui_text_widget_mutable(text), false, NULL);
+    }
+    ui_widget_host_t host;
+    ui_widget_host_init(&host);
+    ui_widget_set_host(widget, &host);
+    ui_widget_render_tree(widget, ctx);
+
+    int offset = 0;
+    int step = BENCH_STEP;
+    double start = bench_now();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        offset += step;
+        ui_column_set_scroll_offset(column, offset);
+        if (ui_column_scroll_offset(column) != offset) {
+            step = -step;
+            offset = ui_column_scroll_offset(column);
+        }
+        if (damage_only) {
+            ui_widget_render_damage(widget, ctx);
+        } else {
+            ui_widget_render_tree(widget, ctx);
+        }
+        ui_context_render(ctx);
+    }
+    double elapsed = bench_now() - start;
+    printf("scroll %-14s %8.1f us/frame\n", damage_only ? "blit + strip" : "full repaint",
+           elapsed * 1e6 / BENCH_FRAMES);
+    bench_json("scroll", elapsed * 1e6 / BENCH_FRAMES, "us/frame", "%s",
+               damage_only ? "blit + strip" : "full repaint");
+    ui_widget_set_host(widget, NULL);
+    ui_widget_host_release(&host);
+    ui_widget_destroy_tree(widget);
+    ui_arena_destroy(arena);
+}
+
+int main(void)
+{
+    ui_context_t *ctx = ui_context_create(&bench_hal);
+    if (!ctx) {
+        return 1;
+    }
+    bench_scroll(ctx, false);
+    bench_scroll(ctx, true);
+    ui_context_destroy(ctx);
+    return 0;
+}
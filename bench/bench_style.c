@@ -0,0 +1,100 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_json.h"
+#include "ui_button.h"
+#include "ui_style.h"
+#include "ui_system_styles.h"
+#include "ui_widget.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_BUTTONS 1024
+#define BENCH_LOOKUPS 1000000
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Themes BENCH_BUTTONS buttons with the system styles, then recolors every
+ * other one, the way a pressed/disabled state override would. */
+static void bench_theme(void)
+{
+    ui_button_t **buttons = calloc(BENCH_BUTTONS, sizeof(*buttons));
+    if (!buttons) {
+        return;
+    }
+    for (int i = 0; i < BENCH_BUTTONS; ++i) {
+        buttons[i] = ui_button_create();
+    }
+    ui_style_t themes[UI_SYSTEM_STYLE_COUNT];
+    for (int s = 0; s < UI_SYSTEM_STYLE_COUNT; ++s) {
+        ui_system_style_fill(&themes[s], (ui_system_style_t)s);
+    }
+    double start = bench_now();
+    for (int i = 0; i < BENCH_BUTTONS; ++i) {
+        ui_widget_set_style(ui_button_widget_mutable(buttons[i]),
+                            &themes[i % UI_SYSTEM_STYLE_COUNT]);
+    }
+    double themed = bench_now();
+    for (int i = 0; i < BENCH_BUTTONS; i += 2) {
+        ui_button_set_background_color(buttons[i], ui_color_from_hex(0x202020));
+    }
+    double overridden = bench_now();
+    printf("theme     %d buttons  set_style %6.1f ns  override %6.1f ns  %zu shared styles "
+           "(%zu B each, widget base %zu B)\n",
+           BENCH_BUTTONS, (themed - start) * 1e9 / BENCH_BUTTONS,
+           (overridden - themed) * 1e9 / (BENCH_BUTTONS / 2), ui_style_interned_count(),
+           sizeof(ui_style_t), sizeof(ui_widget_t));
+    bench_json("style", (themed - start) * 1e9 / BENCH_BUTTONS, "ns", "theme set_style");
+    bench_json("style", (overridden - themed) * 1e9 / (BENCH_BUTTONS / 2), "ns",
+               "theme override");
+    for (int i = 0; i < BENCH_BUTTONS; ++i) {
+        ui_button_destroy(buttons[i]);
+    }
+    free(buttons);
+}
+
+/* Last of UI_STYLE_MAX_CUSTOM_PROPS props, the worst case for a linear scan. */
+static void bench_lookup(void)
+{
+    char names[UI_STYLE_MAX_CUSTOM_PROPS][32];
+    ui_style_t style;
+    ui_style_init(&style);
+    for (int i = 0; i < UI_STYLE_MAX_CUSTOM_PROPS; ++i) {
+        snprintf(names[i], sizeof(names[i]), "theme-prop-%02d", i);
+        ui_style_set_custom_prop(&style, names[i], (uint32_t)i);
+    }
+    const char *name = names[UI_STYLE_MAX_CUSTOM_PROPS - 1];
+    ui_atom_t atom = ui_atom_find(name);
+    volatile uint32_t sink = 0;
+    uint32_t value = 0;
+
+    double start = bench_now();
+    for (int i = 0; i < BENCH_LOOKUPS; ++i) {
+        ui_style_get_custom_prop(&style, name, &value);
+        sink += value;
+    }
+    double by_name = bench_now();
+    for (int i = 0; i < BENCH_LOOKUPS; ++i) {
+        ui_style_get_prop(&style, atom, &value);
+        sink += value;
+    }
+    double by_atom = bench_now();
+    (void)sink;
+    printf("lookup    by name %6.1f ns  by atom %6.1f ns\n",
+           (by_name - start) * 1e9 / BENCH_LOOKUPS, (by_atom - by_name) * 1e9 / BENCH_LOOKUPS);
+    bench_json("style", (by_name - start) * 1e9 / BENCH_LOOKUPS, "ns", "lookup by name");
+    bench_json("style", (by_atom - by_name) * 1e9 / BENCH_LOOKUPS, "ns", "lookup by atom");
+}
+
+int main(void)
+{
+    bench_theme();
+    bench_lookup();
+    return 0;
+}
@@ -15,9 +15,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define TAB_DEMO_TEXT_MAX 16
-#define TAB_DEMO_BUTTON_MAX 3
-
 typedef struct {
     ui_color_t seashell;
     ui_color_t champagne;
@@ -38,24 +35,6 @@ typedef struct {
     ui_text_t *value_label;
 } slider_value_ctx_t;
 
-static bool track_text(ui_text_t **storage, size_t *count, ui_text_t *text)
-{
-    if (!storage || !count || !text || *count >= TAB_DEMO_TEXT_MAX) {
-        return false;
-    }
-    storage[(*count)++] = text;
-    return true;
-}
-
-static bool track_button(ui_button_t **storage, size_t *count, ui_button_t *button)
-{
-    if (!storage || !count || !button || *count >= TAB_DEMO_BUTTON_MAX) {
-        return false;
-    }
-    storage[(*count)++] = button;
-    return true;
-}
-
 static void update_slider_value(ui_slider_t *slider, double value, void *user_data)
 {
     (void)slider;
@@ -90,7 +69,7 @@ static void style_tab_column(ui_column_t *column, ui_color_t background, ui_colo
 
 int main(void)
 {
-    const ui_hal_ops_t *hal = ui_hal_test_sdl_ops();
+    const ui_hal_ops_t *hal = ui_hal_test_ops();
     if (!hal) {
         return 1;
     }
@@ -109,7 +88,8 @@ int main(void)
         .dark_text = ui_color_from_hex(CLASSIC_NOIR_DARK),
     };
 
-    ui_column_t *root = ui_column_create();
+    ui_arena_t *arena = ui_scene_arena(scene);
+    ui_column_t *root = ui_column_create_in(arena);
     if (!root) {
         ui_scene_destroy(scene);
         return 1;
@@ -136,10 +116,6 @@ int main(void)
     const int subtitle_height = font->height + 4;
     const int content_width = UI_FRAMEBUFFER_WIDTH - root_style.padding_left - root_style.padding_right;
 
-    ui_text_t *text_widgets[TAB_DEMO_TEXT_MAX] = {0};
-    size_t text_count = 0;
-    ui_button_t *buttons[TAB_DEMO_BUTTON_MAX] = {0};
-    size_t button_count = 0;
     ui_switch_t *night_switch = NULL;
     ui_progressring_t *ambient_ring = NULL;
     ui_slider_t *tone_slider = NULL;
@@ -147,7 +123,7 @@ int main(void)
     ui_tabs_t *tabs = NULL;
     int exit_code = 1;
 
-    ui_text_t *title = ui_text_create();
+    ui_text_t *title = ui_text_create_in(arena);
     if (!title) {
         goto cleanup;
     }
@@ -157,14 +133,11 @@ int main(void)
     ui_text_set_no_wrap(title, true);
     ui_text_set_background_color(title, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(title), 0, 0, content_width, title_height);
-    if (!track_text(text_widgets, &text_count, title)) {
-        goto cleanup;
-    }
     if (!ui_column_add_control(root, ui_text_widget_mutable(title), false, "headline")) {
         goto cleanup;
     }
 
-    ui_text_t *subtitle = ui_text_create();
+    ui_text_t *subtitle = ui_text_create_in(arena);
     if (!subtitle) {
         goto cleanup;
     }
@@ -174,14 +147,11 @@ int main(void)
     ui_text_set_no_wrap(subtitle, false);
     ui_text_set_background_color(subtitle, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(subtitle), 0, 0, content_width, subtitle_height);
-    if (!track_text(text_widgets, &text_count, subtitle)) {
-        goto cleanup;
-    }
     if (!ui_column_add_control(root, ui_text_widget_mutable(subtitle), false, "subtitle")) {
         goto cleanup;
     }
 
-    tabs = ui_tabs_create();
+    tabs = ui_tabs_create_in(arena);
     if (!tabs) {
         goto cleanup;
     }
@@ -226,7 +196,7 @@ int main(void)
 
     ui_column_t *tab_columns[3] = {0};
     for (size_t i = 0; i < 3; ++i) {
-        tab_columns[i] = ui_column_create();
+        tab_columns[i] = ui_column_create_in(arena);
         if (!tab_columns[i]) {
             goto cleanup;
         }
@@ -247,7 +217,7 @@ int main(void)
     const int line_height = font->height + 2;
     const int button_height = 32;
 
-    ui_text_t *tab1_header = ui_text_create();
+    ui_text_t *tab1_header = ui_text_create_in(arena);
     if (!tab1_header) {
         goto cleanup;
     }
@@ -256,12 +226,9 @@ int main(void)
     ui_text_set_align(tab1_header, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(tab1_header, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(tab1_header), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, tab1_header)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[0], ui_text_widget_mutable(tab1_header), false, "tab1-label");
 
-    ui_button_t *highlight = ui_button_create();
+    ui_button_t *highlight = ui_button_create_in(arena);
     if (!highlight) {
         goto cleanup;
     }
@@ -269,12 +236,9 @@ int main(void)
     ui_button_set_filled_style(highlight, palette.burnt_sienna, palette.champagne, palette.redwood);
     ui_button_set_text_color(highlight, palette.seashell);
     ui_widget_set_bounds(ui_button_widget_mutable(highlight), 0, 0, tab_content_width, button_height);
-    if (!track_button(buttons, &button_count, highlight)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[0], ui_button_widget_mutable(highlight), false, "tab1-primary");
 
-    ui_button_t *tonal = ui_button_create();
+    ui_button_t *tonal = ui_button_create_in(arena);
     if (!tonal) {
         goto cleanup;
     }
@@ -284,12 +248,9 @@ int main(void)
     ui_button_set_pressed_color(tonal, palette.burnt_sienna);
     ui_button_set_text_color(tonal, palette.dark_text);
     ui_widget_set_bounds(ui_button_widget_mutable(tonal), 0, 0, tab_content_width, button_height);
-    if (!track_button(buttons, &button_count, tonal)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[0], ui_button_widget_mutable(tonal), false, "tab1-secondary");
 
-    ui_button_t *ghost = ui_button_create();
+    ui_button_t *ghost = ui_button_create_in(arena);
     if (!ghost) {
         goto cleanup;
     }
@@ -299,12 +260,9 @@ int main(void)
     ui_button_set_pressed_color(ghost, palette.redwood);
     ui_button_set_text_color(ghost, palette.redwood);
     ui_widget_set_bounds(ui_button_widget_mutable(ghost), 0, 0, tab_content_width, button_height);
-    if (!track_button(buttons, &button_count, ghost)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[0], ui_button_widget_mutable(ghost), false, "tab1-ghost");
 
-    ui_text_t *tab2_header = ui_text_create();
+    ui_text_t *tab2_header = ui_text_create_in(arena);
     if (!tab2_header) {
         goto cleanup;
     }
@@ -313,12 +271,9 @@ int main(void)
     ui_text_set_align(tab2_header, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(tab2_header, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(tab2_header), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, tab2_header)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[1], ui_text_widget_mutable(tab2_header), false, "tab2-label");
 
-    night_switch = ui_switch_create();
+    night_switch = ui_switch_create_in(arena);
     if (!night_switch) {
         goto cleanup;
     }
@@ -332,7 +287,7 @@ int main(void)
     ui_widget_set_bounds(ui_switch_widget_mutable(night_switch), 0, 0, tab_content_width, 32);
     ui_column_add_control(tab_columns[1], ui_switch_widget_mutable(night_switch), false, "night-switch");
 
-    ui_text_t *ring_label = ui_text_create();
+    ui_text_t *ring_label = ui_text_create_in(arena);
     if (!ring_label) {
         goto cleanup;
     }
@@ -341,12 +296,9 @@ int main(void)
     ui_text_set_align(ring_label, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(ring_label, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(ring_label), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, ring_label)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[1], ui_text_widget_mutable(ring_label), false, "ring-label");
 
-    ambient_ring = ui_progressring_create();
+    ambient_ring = ui_progressring_create_in(arena);
     if (!ambient_ring) {
         goto cleanup;
     }
@@ -358,7 +310,7 @@ int main(void)
     ui_widget_set_bounds(ui_progressring_widget_mutable(ambient_ring), 0, 0, tab_content_width, 110);
     ui_column_add_control(tab_columns[1], ui_progressring_widget_mutable(ambient_ring), false, "ambient-ring");
 
-    ui_text_t *tab3_header = ui_text_create();
+    ui_text_t *tab3_header = ui_text_create_in(arena);
     if (!tab3_header) {
         goto cleanup;
     }
@@ -367,12 +319,9 @@ int main(void)
     ui_text_set_align(tab3_header, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(tab3_header, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(tab3_header), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, tab3_header)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[2], ui_text_widget_mutable(tab3_header), false, "tab3-label");
 
-    ui_text_t *slider_label = ui_text_create();
+    ui_text_t *slider_label = ui_text_create_in(arena);
     if (!slider_label) {
         goto cleanup;
     }
@@ -381,12 +330,9 @@ int main(void)
     ui_text_set_align(slider_label, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(slider_label, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(slider_label), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, slider_label)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[2], ui_text_widget_mutable(slider_label), false, "slider-label");
 
-    tone_slider = ui_slider_create();
+    tone_slider = ui_slider_create_in(arena);
     if (!tone_slider) {
         goto cleanup;
     }
@@ -399,7 +345,7 @@ int main(void)
     ui_widget_set_bounds(ui_slider_widget_mutable(tone_slider), 0, 0, tab_content_width, 28);
     ui_column_add_control(tab_columns[2], ui_slider_widget_mutable(tone_slider), false, "tone-slider");
 
-    ui_text_t *slider_value_text = ui_text_create();
+    ui_text_t *slider_value_text = ui_text_create_in(arena);
     if (!slider_value_text) {
         goto cleanup;
     }
@@ -408,16 +354,13 @@ int main(void)
     ui_text_set_align(slider_value_text, UI_TEXT_ALIGN_RIGHT);
     ui_text_set_background_color(slider_value_text, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(slider_value_text), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, slider_value_text)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[2], ui_text_widget_mutable(slider_value_text), false, "slider-value");
 
     slider_value_ctx_t slider_ctx = {.value_label = slider_value_text};
     ui_slider_set_on_change(tone_slider, update_slider_value, &slider_ctx);
     update_slider_value(tone_slider, ui_slider_value(tone_slider), &slider_ctx);
 
-    ui_text_t *progress_label = ui_text_create();
+    ui_text_t *progress_label = ui_text_create_in(arena);
     if (!progress_label) {
         goto cleanup;
     }
@@ -426,12 +369,9 @@ int main(void)
     ui_text_set_align(progress_label, UI_TEXT_ALIGN_LEFT);
     ui_text_set_background_color(progress_label, palette.seashell);
     ui_widget_set_bounds(ui_text_widget_mutable(progress_label), 0, 0, tab_content_width, line_height);
-    if (!track_text(text_widgets, &text_count, progress_label)) {
-        goto cleanup;
-    }
     ui_column_add_control(tab_columns[2], ui_text_widget_mutable(progress_label), false, "progress-label");
 
-    progress_bar = ui_progressbar_create();
+    progress_bar = ui_progressbar_create_in(arena);
     if (!progress_bar) {
         goto cleanup;
     }
@@ -455,7 +395,7 @@ int main(void)
 
     const char *tab_titles[3] = {"Controls", "Indicators", "Sliders"};
     for (size_t i = 0; i < 3; ++i) {
-        ui_tab_t *tab = ui_tab_create();
+        ui_tab_t *tab = ui_tab_create_in(arena);
         if (!tab) {
             goto cleanup;
         }
@@ -472,41 +412,7 @@ int main(void)
     ui_scene_run(scene);
 
 cleanup:
-    for (size_t i = 0; i < button_count; ++i) {
-        if (buttons[i]) {
-            ui_button_destroy(buttons[i]);
-        }
-    }
-    for (size_t i = 0; i < text_count; ++i) {
-        if (text_widgets[i]) {
-            ui_text_destroy(text_widgets[i]);
-        }
-    }
-    if (tone_slider) {
-        ui_slider_destroy(tone_slider);
-    }
-    if (progress_bar) {
-        ui_progressbar_destroy(progress_bar);
-    }
-    if (ambient_ring) {
-        ui_progressring_destroy(ambient_ring);
-    }
-    if (night_switch) {
-        ui_switch_destroy(night_switch);
-    }
-    if (tabs) {
-        ui_tabs_destroy(tabs);
-    }
-    for (size_t i = 0; i < 3; ++i) {
-        if (tab_columns[i]) {
-            ui_column_destroy(tab_columns[i]);
-        }
-    }
-    if (root) {
-        ui_column_destroy(root);
-    }
-    if (scene) {
-        ui_scene_destroy(scene);
-    }
+    /* every widget above lives in the scene arena */
+    ui_scene_destroy(scene);
     return exit_code;
 }
@@ -0,0 +1,66 @@
+#ifndef UI_ANIMATION_H
+#define UI_ANIMATION_H
+
+#include "ui_primitives.h"
+#include "ui_widget.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Tweens of int, double and color properties. Active tweens sit in a compact
+ * array in the ui_widget_host_t of their target's tree, which
+ * ui_animation_tick walks once per frame (the scene calls it with its own
+ * host); each step writes the property and invalidates only the tween's
+ * target widget. Tweens of a target that leaves its tree are cancelled.
+ * Starting a tween on a value that is already animating replaces the old one.
+ */
+
+typedef enum {
+    UI_EASE_LINEAR,
+    UI_EASE_IN_QUAD,
+    UI_EASE_OUT_QUAD,
+    UI_EASE_IN_OUT_QUAD,
+    UI_EASE_OUT_CUBIC,
+    UI_EASE_IN_OUT_CUBIC
+} ui_easing_t;
+
+/* 0 never names a tween */
+typedef uint32_t ui_animation_id_t;
+
+/* Runs from ui_animation_tick once the tween reached its end value; may
+ * start or cancel tweens. Cancelled tweens do not call it. */
+typedef void (*ui_animation_done_fn)(void *user_data);
+
+typedef struct {
+    ui_widget_t *target; /* required; repainted on every step, picks the host */
+    int duration_ms;
+    ui_easing_t easing;
+    ui_animation_done_fn on_done;
+    void *user_data;
+} ui_animation_params_t;
+
+double ui_easing_apply(ui_easing_t easing, double t);
+
+/* Tweens from the value's current contents; a non-positive duration lands on
+ * the end value on the next tick. Returns 0 when out of memory or when the
+ * target is not in a hosted tree. */
+ui_animation_id_t ui_animate_int(int *value, int to, const ui_animation_params_t *params);
+ui_animation_id_t ui_animate_double(double *value, double to, const ui_animation_params_t *params);
+ui_animation_id_t ui_animate_color(ui_color_t *value, ui_color_t to,
+                                   const ui_animation_params_t *params);
+
+/* id as returned for target; ids are only unique within one host. */
+bool ui_animation_running(const ui_widget_t *target, ui_animation_id_t id);
+void ui_animation_cancel(const ui_widget_t *target, ui_animation_id_t id);
+void ui_animation_cancel_target(const ui_widget_t *target);
+/* Drops every tween of host and the array behind them. */
+void ui_animation_cancel_all(ui_widget_host_t *host);
+size_t ui_animation_count(const ui_widget_host_t *host);
+
+/* Advances every tween of host by delta_seconds; returns whether any is still
+ * running. */
+bool ui_animation_tick(ui_widget_host_t *host, double delta_seconds);
+
+#endif
@@ -19,6 +19,8 @@ typedef enum {
 typedef struct ui_appbar ui_appbar_t;
 
 ui_appbar_t *ui_appbar_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_appbar_t *ui_appbar_create_in(ui_arena_t *arena);
 void ui_appbar_destroy(ui_appbar_t *appbar);
 void ui_appbar_init(ui_appbar_t *appbar);
 
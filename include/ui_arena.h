@@ -0,0 +1,63 @@
+#ifndef UI_ARENA_H
+#define UI_ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Region allocator for one scene's widgets and the strings and glyph arrays
+ * they own. Blocks are bump-allocated from large chunks and rounded up to a
+ * size class; ui_arena_free puts a block on its class free list so setters
+ * that replace labels reuse memory instead of growing the heap. Blocks
+ * larger than the biggest class fall back to malloc but are still tracked,
+ * so ui_arena_destroy releases everything at once.
+ *
+ * A NULL arena means the plain heap: ui_arena_alloc(NULL, n) is calloc and
+ * ui_arena_free(NULL, p) is free, which lets widgets call the same functions
+ * whether or not they were created in an arena.
+ */
+
+typedef struct ui_arena ui_arena_t;
+
+/* Intrusive link for blocks that must be cleaned up before the arena drops
+ * them; ui_arena_destroy and ui_arena_reset unlink each one still registered
+ * and call fn on it, newest first. Widgets created in an arena embed one. */
+typedef struct ui_arena_finalizer {
+    struct ui_arena_finalizer *prev;
+    struct ui_arena_finalizer *next;
+    void (*fn)(struct ui_arena_finalizer *node);
+} ui_arena_finalizer_t;
+
+typedef struct {
+    size_t chunks;
+    size_t reserved;  /* bytes obtained from the heap for chunks */
+    size_t consumed;  /* chunk bytes handed out so far, headers included */
+    size_t live;      /* class-rounded bytes of blocks in use */
+    size_t free;      /* class-rounded bytes waiting on free lists */
+    size_t large_blocks;
+    size_t large_bytes;
+} ui_arena_stats_t;
+
+/* chunk_size 0 picks UI_ARENA_DEFAULT_CHUNK. */
+#define UI_ARENA_DEFAULT_CHUNK 16384u
+
+ui_arena_t *ui_arena_create(size_t chunk_size);
+void ui_arena_destroy(ui_arena_t *arena);
+/* Drops every block but keeps the chunks, so rebuilding a screen of the
+ * same size touches no new memory. */
+void ui_arena_reset(ui_arena_t *arena);
+
+/* Returns zeroed memory aligned for any widget type, or NULL. */
+void *ui_arena_alloc(ui_arena_t *arena, size_t size);
+/* Grows or shrinks a block; stays in place when the size class still fits. */
+void *ui_arena_realloc(ui_arena_t *arena, void *ptr, size_t size);
+void ui_arena_free(ui_arena_t *arena, void *ptr);
+char *ui_arena_strdup(ui_arena_t *arena, const char *value);
+
+void ui_arena_add_finalizer(ui_arena_t *arena, ui_arena_finalizer_t *node,
+                            void (*fn)(ui_arena_finalizer_t *node));
+/* No-op for a node that is not registered. */
+void ui_arena_remove_finalizer(ui_arena_t *arena, ui_arena_finalizer_t *node);
+
+void ui_arena_stats(const ui_arena_t *arena, ui_arena_stats_t *stats);
+
+#endif
@@ -12,6 +12,8 @@ typedef void (*ui_button_event_fn)(ui_button_t *button, void *user_data);
 typedef void (*ui_button_hover_fn)(ui_button_t *button, bool hovering, void *user_data);
 
 ui_button_t *ui_button_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_button_t *ui_button_create_in(ui_arena_t *arena);
 void ui_button_destroy(ui_button_t *button);
 
 void ui_button_init(ui_button_t *button);
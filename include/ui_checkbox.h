@@ -28,6 +28,8 @@ typedef void (*ui_checkbox_change_fn)(ui_checkbox_t *checkbox, ui_checkbox_state
 typedef void (*ui_checkbox_event_fn)(ui_checkbox_t *checkbox, void *user_data);
 
 ui_checkbox_t *ui_checkbox_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_checkbox_t *ui_checkbox_create_in(ui_arena_t *arena);
 void ui_checkbox_destroy(ui_checkbox_t *checkbox);
 
 void ui_checkbox_init(ui_checkbox_t *checkbox);
@@ -15,6 +15,8 @@ typedef enum {
 typedef struct ui_column ui_column_t;
 
 ui_column_t *ui_column_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_column_t *ui_column_create_in(ui_arena_t *arena);
 void ui_column_destroy(ui_column_t *column);
 
 void ui_column_init(ui_column_t *column);
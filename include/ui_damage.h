@@ -0,0 +1,45 @@
+#ifndef UI_DAMAGE_H
+#define UI_DAMAGE_H
+
+#include "ui_primitives.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Framebuffer regions to repaint on the next frame, plus pending region
+ * scrolls. A scroll moves pixels that are still valid, so only the strip it
+ * exposes is added as damage; damage already recorded inside the scrolled
+ * rect moves along with the pixels. Rects are clipped to the framebuffer and
+ * merged once UI_DAMAGE_MAX_RECTS are in use.
+ */
+
+#define UI_DAMAGE_MAX_RECTS 8
+#define UI_DAMAGE_MAX_SCROLLS 4
+
+typedef struct {
+    ui_rect_t rect;
+    int dx;
+    int dy;
+} ui_damage_scroll_t;
+
+typedef struct {
+    ui_rect_t rects[UI_DAMAGE_MAX_RECTS];
+    size_t count;
+    ui_damage_scroll_t scrolls[UI_DAMAGE_MAX_SCROLLS];
+    size_t scroll_count;
+    bool full;
+} ui_damage_t;
+
+void ui_damage_reset(ui_damage_t *damage);
+void ui_damage_add(ui_damage_t *damage, const ui_rect_t *rect);
+void ui_damage_add_all(ui_damage_t *damage);
+/* Records a shift of the pixels in rect by (dx, dy); returns false when the
+ * whole rect had to be damaged instead (shift too large or too many scrolls). */
+bool ui_damage_scroll(ui_damage_t *damage, const ui_rect_t *rect, int dx, int dy);
+bool ui_damage_is_empty(const ui_damage_t *damage);
+
+/* Intersection of a and b; false (and an empty out) if they do not overlap. */
+bool ui_rect_intersect(const ui_rect_t *a, const ui_rect_t *b, ui_rect_t *out);
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef UI_EVENT_QUEUE_H
+#define UI_EVENT_QUEUE_H
+
+#include "ui_primitives.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Bounded lock-free event rings; neither takes a lock or allocates, so push
+ * is safe from interrupt handlers and from threads that must not block.
+ *
+ * ui_event_spsc_t: one producer, one consumer. Two indices, each written by
+ * one side only.
+ * ui_event_mpsc_t: any number of producers, one consumer. Producers claim a
+ * slot with a CAS and publish it through the slot's sequence number, so a
+ * producer preempted mid-push only delays the events queued after it.
+ *
+ * The context uses the MPSC ring (HAL threads and poll_input both post); a
+ * HAL can keep an SPSC ring between its ISR and poll_input.
+ * ui_task_mpsc_t is the same MPSC ring carrying (fn, arg) calls; the scene
+ * runs them on the UI thread (ui_scene_post).
+ */
+
+#define UI_EVENT_QUEUE_SIZE 128 /* power of two */
+#define UI_EVENT_QUEUE_CACHE_LINE 64
+
+/* the indices sit on separate cache lines so the two sides do not share one */
+typedef struct {
+    atomic_size_t head; /* consumer */
+    char head_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail; /* producer */
+    char tail_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+    ui_event_t slots[UI_EVENT_QUEUE_SIZE];
+} ui_event_spsc_t;
+
+typedef struct {
+    atomic_size_t sequence;
+    ui_event_t event;
+} ui_event_slot_t;
+
+typedef struct {
+    atomic_size_t tail; /* producers */
+    char tail_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+    size_t head; /* consumer only */
+    char head_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(size_t)];
+    ui_event_slot_t slots[UI_EVENT_QUEUE_SIZE];
+} ui_event_mpsc_t;
+
+typedef void (*ui_task_fn)(void *arg);
+
+#define UI_TASK_QUEUE_SIZE 256 /* power of two */
+
+typedef struct {
+    atomic_size_t sequence;
+    ui_task_fn fn;
+    void *arg;
+} ui_task_slot_t;
+
+typedef struct {
+    atomic_size_t tail; /* producers */
+    char tail_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(atomic_size_t)];
+    size_t head; /* consumer only */
+    char head_pad[UI_EVENT_QUEUE_CACHE_LINE - sizeof(size_t)];
+    ui_task_slot_t slots[UI_TASK_QUEUE_SIZE];
+} ui_task_mpsc_t;
+
+void ui_event_spsc_init(ui_event_spsc_t *queue);
+/* Producer side; false when full. */
+bool ui_event_spsc_push(ui_event_spsc_t *queue, const ui_event_t *event);
+/* Consumer side; false when empty. */
+bool ui_event_spsc_pop(ui_event_spsc_t *queue, ui_event_t *event);
+bool ui_event_spsc_empty(ui_event_spsc_t *queue);
+
+void ui_event_mpsc_init(ui_event_mpsc_t *queue);
+bool ui_event_mpsc_push(ui_event_mpsc_t *queue, const ui_event_t *event);
+/* Fails while fewer than keep_free slots would stay free after the push, so
+ * lossy events (TOUCH_MOVE) cannot take the room left for the rest. */
+bool ui_event_mpsc_push_keep(ui_event_mpsc_t *queue, const ui_event_t *event, size_t keep_free);
+bool ui_event_mpsc_pop(ui_event_mpsc_t *queue, ui_event_t *event);
+/* Consumer side: nothing published at the head yet. */
+bool ui_event_mpsc_empty(ui_event_mpsc_t *queue);
+/* Pushes that claimed a slot so far, read from the producers' ticket counter. */
+size_t ui_event_mpsc_pushed(ui_event_mpsc_t *queue);
+
+void ui_task_mpsc_init(ui_task_mpsc_t *queue);
+bool ui_task_mpsc_push(ui_task_mpsc_t *queue, ui_task_fn fn, void *arg);
+bool ui_task_mpsc_pop(ui_task_mpsc_t *queue, ui_task_fn *fn, void **arg);
+
+#endif
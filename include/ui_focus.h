@@ -0,0 +1,46 @@
+#ifndef UI_FOCUS_H
+#define UI_FOCUS_H
+
+#include "ui_widget.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Keyboard focus for one widget tree. The traversal order (visible,
+ * focusable widgets in tree order) is cached and rebuilt only when
+ * ui_widget_tree_epoch() moves, so routing a key to the focused widget and
+ * stepping to its neighbours are constant time. Keys the focused widget and
+ * its ancestors leave unhandled drive navigation: Tab, arrows and
+ * UI_KEY_NEXT/UI_KEY_PREV from a rotary encoder or D-pad.
+ */
+
+typedef struct {
+    ui_widget_t **order;
+    size_t count;
+    size_t capacity;
+    size_t index; /* position of focused in order */
+    ui_widget_t *focused;
+    uint32_t epoch;
+    bool built;
+} ui_focus_manager_t;
+
+void ui_focus_manager_init(ui_focus_manager_t *focus);
+void ui_focus_manager_release(ui_focus_manager_t *focus);
+
+/* Rebuilds the order if the tree changed; drops focus from detached widgets
+ * and applies autofocus when nothing is focused. */
+void ui_focus_manager_sync(ui_focus_manager_t *focus, ui_widget_t *root);
+/* Focuses widget (NULL or unfocusable: clears focus); returns true if focus changed. */
+bool ui_focus_manager_set(ui_focus_manager_t *focus, ui_widget_t *root, ui_widget_t *widget);
+/* Steps focus by direction (+1 next, -1 previous), wrapping around. */
+bool ui_focus_manager_move(ui_focus_manager_t *focus, ui_widget_t *root, int direction);
+ui_widget_t *ui_focus_manager_focused(const ui_focus_manager_t *focus);
+
+/* Sends a key event to the focused widget, then its interested ancestors,
+ * then uses it for navigation; returns true if anything consumed it. */
+bool ui_focus_manager_route_key(ui_focus_manager_t *focus, ui_widget_t *root,
+                                const ui_event_t *event);
+
+#endif
@@ -19,11 +19,7 @@ typedef struct {
     uint8_t columns[BAREUI_FONT_MAX_WIDTH];
 } bareui_font_entry_t;
 
-typedef struct {
-    const bareui_font_entry_t *entries;
-    size_t count;
-    uint8_t height;
-} bareui_font_t;
+typedef struct bareui_font bareui_font_t;
 
 typedef struct {
     uint32_t codepoint;
@@ -31,8 +27,32 @@ typedef struct {
     uint8_t height;
     const uint8_t *columns;
     uint8_t spacing;
+    /* anti-aliased glyphs: row-major coverage, MSB first, bpp bits per pixel */
+    const uint8_t *coverage;
+    uint8_t bpp;
+    /* packed 1bpp glyphs: row-major, MSB = leftmost pixel, rows padded to a byte */
+    const uint8_t *rows;
+    /* bitmap placement relative to the pen position and line top */
+    int8_t offset_x;
+    int8_t offset_y;
 } bareui_font_glyph_t;
 
+/* optional glyph source consulted before the entry table (e.g. paged fonts) */
+typedef bool (*bareui_font_lookup_fn)(const bareui_font_t *font, uint32_t codepoint,
+                                      bareui_font_glyph_t *glyph_out);
+
+/* glyph bitmaps may be freed after lookup (paged cache); do not keep pointers */
+#define BAREUI_FONT_FLAG_VOLATILE_GLYPHS 0x01u
+
+struct bareui_font {
+    const bareui_font_entry_t *entries;
+    size_t count;
+    uint8_t height;
+    bareui_font_lookup_fn lookup;
+    void *user_data;
+    uint8_t flags;
+};
+
 const bareui_font_t *bareui_font_default(void);
 bool bareui_font_lookup(const bareui_font_t *font, uint32_t codepoint,
                         bareui_font_glyph_t *glyph_out);
@@ -0,0 +1,46 @@
+#ifndef UI_FONT_AA_H
+#define UI_FONT_AA_H
+
+#include "ui_font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Anti-aliased grayscale font: each glyph is a row-major coverage bitmap
+ * with 2 or 4 bits per pixel (MSB first, rows padded to a byte). The font
+ * plugs into the regular bareui_font_t lookup, so ui_context_set_font and
+ * the widget font setters accept &font->base directly.
+ */
+
+typedef struct {
+    uint32_t codepoint;
+    uint8_t width;
+    uint8_t advance;
+    uint32_t offset; /* byte offset of the first row in coverage */
+} bareui_font_aa_entry_t;
+
+typedef struct {
+    bareui_font_t base;
+    const bareui_font_aa_entry_t *glyphs; /* sorted by codepoint */
+    size_t glyph_count;
+    const uint8_t *coverage;
+    uint8_t bpp;
+} bareui_font_aa_t;
+
+void bareui_font_aa_init(bareui_font_aa_t *font, uint8_t height, uint8_t bpp,
+                         const bareui_font_aa_entry_t *glyphs, size_t glyph_count,
+                         const uint8_t *coverage);
+/* Drops the metrics cached for font; call before freeing or reusing its
+ * memory, since caches are keyed by the font's address. */
+void bareui_font_aa_deinit(bareui_font_aa_t *font);
+bool bareui_font_aa_lookup(const bareui_font_t *font, uint32_t codepoint,
+                           bareui_font_glyph_t *glyph_out);
+
+static inline size_t bareui_font_aa_stride(uint8_t width, uint8_t bpp)
+{
+    return ((size_t)width * bpp + 7) / 8;
+}
+
+#endif
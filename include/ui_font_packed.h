@@ -0,0 +1,54 @@
+#ifndef UI_FONT_PACKED_H
+#define UI_FONT_PACKED_H
+
+#include "ui_font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Variable-height 1bpp font: glyphs are stored row-major as packed bits
+ * (MSB = leftmost pixel, rows padded to a byte) with per-glyph bearings
+ * relative to the font baseline. Heights are not limited to 8 px, and the
+ * blitter expands four pixels per nibble instead of testing every bit.
+ */
+
+typedef struct {
+    uint32_t codepoint;
+    uint8_t width;
+    uint8_t height;
+    int8_t bearing_x; /* pen position to left edge */
+    int8_t bearing_y; /* baseline to top edge, positive up */
+    uint8_t advance;
+    uint32_t offset;  /* byte offset of the first row in bitmap */
+} bareui_font_packed_entry_t;
+
+typedef struct {
+    bareui_font_t base;
+    const bareui_font_packed_entry_t *glyphs; /* sorted by codepoint */
+    size_t glyph_count;
+    const uint8_t *bitmap;
+    uint8_t baseline; /* line top to baseline */
+    void *owned;
+} bareui_font_packed_t;
+
+void bareui_font_packed_init(bareui_font_packed_t *font, uint8_t height, uint8_t baseline,
+                             const bareui_font_packed_entry_t *glyphs, size_t glyph_count,
+                             const uint8_t *bitmap);
+bool bareui_font_packed_lookup(const bareui_font_t *font, uint32_t codepoint,
+                               bareui_font_glyph_t *glyph_out);
+
+/* Builds an integer-scaled copy of a column font, e.g. large digit readouts.
+ * NULL when a scaled height exceeds 127 px or a width or advance 255 px. */
+bareui_font_packed_t *bareui_font_packed_create_scaled(const bareui_font_t *source,
+                                                       const uint32_t *codepoints,
+                                                       size_t count, uint8_t scale);
+void bareui_font_packed_destroy(bareui_font_packed_t *font);
+
+static inline size_t bareui_font_packed_stride(uint8_t width)
+{
+    return ((size_t)width + 7) / 8;
+}
+
+#endif
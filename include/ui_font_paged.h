@@ -0,0 +1,51 @@
+#ifndef UI_FONT_PAGED_H
+#define UI_FONT_PAGED_H
+
+#include "ui_font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Paged font container produced by tools/build_paged_font.py.
+ *
+ * Layout (little-endian):
+ *   header     "BUPF", u16 version, u8 height, u8 max_width,
+ *              u32 page_count, u32 directory_offset, u32 glyph_count
+ *   directory  page_count x {u32 page (codepoint >> 8), u32 offset,
+ *              u16 packed_size, u16 glyph_count}, sorted by page;
+ *              pages stop at U+10FFFF, so at most 0x1100 entries
+ *   pages      PackBits-compressed: 32-byte presence bitmap, then
+ *              {u8 width, width column bytes} per present glyph
+ *
+ * Only the directory is kept in RAM; pages are decoded on demand into a
+ * small LRU. Glyph column pointers stay valid until their page is evicted,
+ * which is enough for the draw-as-you-look-up text path; the font carries
+ * BAREUI_FONT_FLAG_VOLATILE_GLYPHS so shaped text re-resolves them.
+ */
+
+#define BAREUI_PAGED_FONT_MAGIC "BUPF"
+#define BAREUI_PAGED_FONT_VERSION 1
+#define BAREUI_PAGED_FONT_PAGE_SIZE 256
+#define BAREUI_PAGED_FONT_DEFAULT_CACHE 4
+
+typedef struct bareui_paged_font bareui_paged_font_t;
+
+/* reads size bytes at offset from the font image (file, flash, ...) */
+typedef bool (*bareui_paged_font_read_fn)(void *user_data, uint32_t offset, void *dst,
+                                          size_t size);
+
+bareui_paged_font_t *bareui_paged_font_open(const char *path, size_t cache_pages);
+bareui_paged_font_t *bareui_paged_font_open_memory(const void *data, size_t size,
+                                                   size_t cache_pages);
+bareui_paged_font_t *bareui_paged_font_open_reader(bareui_paged_font_read_fn read,
+                                                   void *user_data, size_t cache_pages);
+void bareui_paged_font_close(bareui_paged_font_t *font);
+
+const bareui_font_t *bareui_paged_font_font(const bareui_paged_font_t *font);
+size_t bareui_paged_font_page_count(const bareui_paged_font_t *font);
+size_t bareui_paged_font_glyph_count(const bareui_paged_font_t *font);
+size_t bareui_paged_font_resident_bytes(const bareui_paged_font_t *font);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef UI_HAL_HEADLESS_H
+#define UI_HAL_HEADLESS_H
+
+#include "ui_primitives.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Offscreen HAL: frames land in memory, input comes from a script keyed by
+ * frame number and the scene runs on virtual time (frame_step_seconds), so a
+ * run renders the same pixels on any machine. Frame n is the n-th pass of
+ * ui_scene_run, counted from 0; a snapshot of frame n is the screen after
+ * that frame rendered.
+ */
+
+typedef struct ui_hal_headless ui_hal_headless_t;
+
+typedef enum {
+    UI_HAL_HEADLESS_EVENT,
+    UI_HAL_HEADLESS_SNAPSHOT,
+    UI_HAL_HEADLESS_OVERLAY
+} ui_hal_headless_action_t;
+
+typedef struct {
+    uint32_t frame;
+    ui_hal_headless_action_t action;
+    ui_event_t event;  /* UI_HAL_HEADLESS_EVENT */
+    uint32_t overlays; /* UI_HAL_HEADLESS_OVERLAY: ui_debug_overlay_t flags */
+} ui_hal_headless_step_t;
+
+/* snapshot_prefix: snapshots go to "<prefix>-<frame>.ppm" (NULL: none are
+ * written). max_frames: a QUIT is posted at that frame (0: never). */
+ui_hal_headless_t *ui_hal_headless_create(const char *snapshot_prefix, uint32_t max_frames);
+void ui_hal_headless_destroy(ui_hal_headless_t *hal);
+const ui_hal_ops_t *ui_hal_headless_ops(ui_hal_headless_t *hal);
+
+/* Steps may be added in any order; same-frame steps keep theirs. */
+bool ui_hal_headless_add(ui_hal_headless_t *hal, const ui_hal_headless_step_t *step);
+bool ui_hal_headless_inject(ui_hal_headless_t *hal, uint32_t frame, const ui_event_t *event);
+bool ui_hal_headless_snapshot_at(ui_hal_headless_t *hal, uint32_t frame);
+/* Switches debug overlays from frame on; that frame commits with them. */
+bool ui_hal_headless_overlay_at(ui_hal_headless_t *hal, uint32_t frame, uint32_t overlays);
+/* One step per line, '#' starts a comment:
+ *   <frame> down|up|move <x> <y>
+ *   <frame> key_down|key_up <keycode>   (decimal, 0x hex or 'c')
+ *   <frame> overlay <names>             (as for ui_debug_overlay_parse)
+ *   <frame> snapshot | quit
+ * Returns false, naming the line on stderr, at the first malformed one. */
+bool ui_hal_headless_load_script(ui_hal_headless_t *hal, const char *path);
+
+/* Frames the scene has started; the last committed framebuffer. */
+uint32_t ui_hal_headless_frame(const ui_hal_headless_t *hal);
+const ui_color_t *ui_hal_headless_framebuffer(const ui_hal_headless_t *hal);
+
+/* Binary PPM (P6) of a full framebuffer, expanded to 8 bits per channel.
+ * read_ppm accepts only what write_ppm produces: the framebuffer size and
+ * maxval 255; channels are narrowed back to RGB565. */
+bool ui_hal_headless_write_ppm(const char *path, const ui_color_t *framebuffer);
+bool ui_hal_headless_read_ppm(const char *path, ui_color_t *framebuffer);
+
+#endif
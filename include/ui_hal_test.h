@@ -4,5 +4,8 @@
 #include "ui_core.h"
 
 const ui_hal_ops_t *ui_hal_test_sdl_ops(void);
+/* The HAL the demos run on: SDL when src/hal/hal_test_sdl.c is linked, the
+ * scripted offscreen HAL (ui_hal_headless.h) with src/hal/hal_test_headless.c. */
+const ui_hal_ops_t *ui_hal_test_ops(void);
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef UI_LIST_VIEW_H
+#define UI_LIST_VIEW_H
+
+#include "ui_column.h"
+#include "ui_widget.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Scrolling list whose rows exist only while they are on screen. The data
+ * source reports the item count and a fixed row height; the list creates
+ * just enough row widgets to cover the viewport plus an overscan margin and
+ * rebinds them to new items as they scroll in, so a 100k-item list costs
+ * the same memory and per-frame work as a 20-item one. Rows are children
+ * of the list: they render, receive events and take focus like any widget.
+ */
+
+typedef struct ui_list_view ui_list_view_t;
+
+typedef struct {
+    size_t (*item_count)(void *user_data);
+    /* height of every row; read again on ui_list_view_reload */
+    int (*row_height)(void *user_data);
+    /* a new, unbound row widget allocated from arena (NULL: heap) */
+    ui_widget_t *(*create_row)(void *user_data, ui_arena_t *arena);
+    /* shows item index in row; called whenever a row is recycled */
+    void (*bind_row)(void *user_data, ui_widget_t *row, size_t index);
+    /* frees a row made by create_row, e.g. with the widget's destroy function */
+    void (*destroy_row)(void *user_data, ui_widget_t *row);
+} ui_list_view_source_t;
+
+#define UI_LIST_VIEW_DEFAULT_OVERSCAN 2
+
+ui_list_view_t *ui_list_view_create(void);
+/* Allocates from arena (NULL: heap); rows are created in the same arena. */
+ui_list_view_t *ui_list_view_create_in(ui_arena_t *arena);
+/* Destroys the rows through the source, then the list. */
+void ui_list_view_destroy(ui_list_view_t *list);
+
+/* The source must outlive the list; setting one drops the current rows. */
+void ui_list_view_set_source(ui_list_view_t *list, const ui_list_view_source_t *source,
+                             void *user_data);
+/* Re-reads count and row height and rebinds every visible row. */
+void ui_list_view_reload(ui_list_view_t *list);
+/* Rebinds the row showing index, if it is materialized. */
+void ui_list_view_reload_item(ui_list_view_t *list, size_t index);
+size_t ui_list_view_item_count(const ui_list_view_t *list);
+
+/* Rows kept beyond each edge of the viewport. */
+void ui_list_view_set_overscan(ui_list_view_t *list, int rows);
+int ui_list_view_overscan(const ui_list_view_t *list);
+/* Row widgets currently alive. */
+size_t ui_list_view_row_count(const ui_list_view_t *list);
+
+/* UI_SCROLL_MODE_NONE disables touch dragging, as for ui_column. */
+void ui_list_view_set_scroll_mode(ui_list_view_t *list, ui_scroll_mode_t mode);
+ui_scroll_mode_t ui_list_view_scroll_mode(const ui_list_view_t *list);
+void ui_list_view_set_scroll_offset(ui_list_view_t *list, int offset);
+int ui_list_view_scroll_offset(const ui_list_view_t *list);
+/* Scrolls so item index is the first visible row (or as close as possible). */
+void ui_list_view_scroll_to_index(ui_list_view_t *list, size_t index);
+/* First item whose row intersects the viewport. */
+size_t ui_list_view_first_visible(const ui_list_view_t *list);
+
+const ui_widget_t *ui_list_view_widget(const ui_list_view_t *list);
+ui_widget_t *ui_list_view_widget_mutable(ui_list_view_t *list);
+
+#endif
@@ -2,6 +2,7 @@
 #define UI_PRIMITIVES_H
 
 #include "ui_font.h"
+#include "ui_shaped_text.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -43,8 +44,37 @@ typedef struct {
             uint32_t keycode;
         } key;
     } data;
+    /* CLOCK_MONOTONIC microseconds when the input happened; HALs that know
+     * fill it in, poll_event stamps events that arrive with 0 */
+    uint64_t timestamp_us;
 } ui_event_t;
 
+/* Current time on the event clock (CLOCK_MONOTONIC, microseconds). */
+uint64_t ui_event_time_now(void);
+/* event's timestamp in seconds; events built by hand and delivered without
+ * the context queue carry 0 and count as happening now. */
+double ui_event_seconds(const ui_event_t *event);
+
+typedef struct {
+    uint32_t posted;
+    uint32_t dropped;       /* post_event found the queue full */
+    uint32_t dropped_moves; /* the TOUCH_MOVE share of dropped */
+    uint32_t coalesced;     /* moves folded into a later one before dispatch (scene) */
+} ui_event_stats_t;
+
+/* Keycodes with a meaning to the focus manager. Arrows use the SDL keycode
+ * values so the SDL HAL passes them through; encoder and D-pad HALs post
+ * UI_KEY_NEXT/UI_KEY_PREV per detent and UI_KEY_ENTER for the push button. */
+#define UI_KEY_TAB '\t'
+#define UI_KEY_ENTER '\r'
+#define UI_KEY_SPACE ' '
+#define UI_KEY_RIGHT 0x4000004Fu
+#define UI_KEY_LEFT 0x40000050u
+#define UI_KEY_DOWN 0x40000051u
+#define UI_KEY_UP 0x40000052u
+#define UI_KEY_NEXT 0x40010001u
+#define UI_KEY_PREV 0x40010002u
+
 typedef struct {
     int16_t x;
     int16_t y;
@@ -64,6 +94,12 @@ typedef struct {
     bool (*init)(ui_context_t *ctx);
     void (*deinit)(ui_context_t *ctx);
     void (*commit_frame)(ui_context_t *ctx, const ui_color_t *framebuffer);
+    /* optional: posts pending input with ui_context_post_event; called from the
+     * scene thread at the input rate, whether or not a frame is drawn */
+    void (*poll_input)(ui_context_t *ctx);
+    /* > 0: offscreen HAL on virtual time; every scene frame advances clocks
+     * by exactly this many seconds, without pacing or idling */
+    double frame_step_seconds;
 } ui_hal_ops_t;
 
 ui_context_t *ui_context_create(const ui_hal_ops_t *hal);
@@ -77,16 +113,76 @@ void ui_context_draw_codepoint(ui_context_t *ctx, int x, int y, uint32_t codepoi
                                ui_color_t color);
 void ui_context_draw_text(ui_context_t *ctx, int x, int y, const char *text,
                           ui_color_t color);
+/* The first len bytes of text, which need no terminator. */
+void ui_context_draw_text_len(ui_context_t *ctx, int x, int y, const char *text, size_t len,
+                              ui_color_t color);
+void ui_context_draw_shaped_text(ui_context_t *ctx, int x, int y,
+                                 const ui_shaped_text_t *shaped, ui_color_t color);
 void ui_context_draw_polygon(ui_context_t *ctx, const ui_point_t *points,
                              size_t point_count, ui_color_t color);
 bool ui_context_blit(ui_context_t *ctx, const ui_color_t *src, int src_width,
                      int src_height, int dst_x, int dst_y);
 bool ui_context_scroll(ui_context_t *ctx, int dx, int dy, ui_color_t fill);
-
+/* Moves the pixels inside rect by (dx, dy) with one memmove per row, ignoring
+ * the clip stack; the strip the shift uncovers keeps stale pixels for the
+ * caller to repaint. */
+bool ui_context_scroll_rect(ui_context_t *ctx, const ui_rect_t *rect, int dx, int dy);
+
+/* UI thread only, like wait_event. Events posted with timestamp_us 0 get
+ * the time of the first pop since the queue last ran dry, so a HAL that wants
+ * per-event times should stamp them itself. */
 bool ui_context_poll_event(ui_context_t *ctx, ui_event_t *event);
+/* Runs the HAL's poll_input op, if it has one. */
+void ui_context_poll_input(ui_context_t *ctx);
+/* Lock-free from any thread; false when the queue is full. TOUCH_MOVE is
+ * refused while only the last 16 slots are free, so a burst of moves is
+ * dropped before any other event is. Takes the wait mutex only to wake a
+ * blocked ui_context_wait_event, so interrupt handlers should feed a ring of
+ * their own (ui_event_queue.h) and post from poll_input. */
 bool ui_context_post_event(ui_context_t *ctx, const ui_event_t *event);
+/* Counters since the context was created; coalesced stays 0 here, see
+ * ui_scene_event_stats. */
+void ui_context_event_stats(const ui_context_t *ctx, ui_event_stats_t *stats);
+/* Blocks until an event is queued, ui_context_wake is called or
+ * timeout_seconds pass (< 0: no timeout); returns false on timeout. */
+bool ui_context_wait_event(ui_context_t *ctx, double timeout_seconds);
+/* Ends the current (or next) wait_event without posting an event. */
+void ui_context_wake(ui_context_t *ctx);
 
 void ui_context_render(ui_context_t *ctx);
+/* The framebuffer no longer shows what the widgets drew (display reset,
+ * benchmarks): the next ui_widget_render_damage of any tree on ctx repaints
+ * in full. UI thread only. */
+void ui_context_invalidate(ui_context_t *ctx);
+uint32_t ui_context_repaint_epoch(const ui_context_t *ctx);
+
+/* Debug overlays, composed into a copy of the framebuffer at commit so the
+ * pixels widgets reuse between frames stay untouched. */
+typedef enum {
+    UI_DEBUG_OVERLAY_NONE = 0,
+    /* writes per pixel since the last commit (glyphs count only the pixels
+     * they set): unwritten pixels dimmed, one write as is, then blue, green,
+     * pink and red for 2, 3, 4 and 5+ */
+    UI_DEBUG_OVERLAY_OVERDRAW = 1u << 0,
+    /* repainted rects in pink, scroll blits in cyan and the committed region
+     * outlined in yellow, fading over UI_DEBUG_FLASH_FRAMES commits */
+    UI_DEBUG_OVERLAY_DAMAGE = 1u << 1
+} ui_debug_overlay_t;
+
+#define UI_DEBUG_FLASH_FRAMES 12
+
+/* Any combination of ui_debug_overlay_t; false when the buffers cannot be
+ * allocated. UI thread only. */
+bool ui_context_set_debug_overlay(ui_context_t *ctx, uint32_t overlays);
+uint32_t ui_context_debug_overlay(const ui_context_t *ctx);
+/* Flashes rect under UI_DEBUG_OVERLAY_DAMAGE; render_damage reports what it
+ * repaints (scroll: a blit rather than a repaint). No-op otherwise. */
+void ui_context_debug_damage(ui_context_t *ctx, const ui_rect_t *rect, bool scroll);
+/* Flashes are still fading: keep committing frames while this holds. */
+bool ui_context_debug_overlay_pending(const ui_context_t *ctx);
+/* "overdraw", "damage" or "none", joined by '+' or ','; false on an unknown
+ * name. For HALs that take overlays from scripts or the environment. */
+bool ui_debug_overlay_parse(const char *names, uint32_t *overlays);
 
 void ui_context_push_clip(ui_context_t *ctx, const ui_rect_t *bounds);
 void ui_context_pop_clip(ui_context_t *ctx);
@@ -99,4 +195,9 @@ const ui_hal_ops_t *ui_context_hal(const ui_context_t *ctx);
 const bareui_font_t *ui_context_font(const ui_context_t *ctx);
 void ui_context_set_font(ui_context_t *ctx, const bareui_font_t *font);
 
+/* Known solid color behind text: anti-aliased glyphs use a precomputed
+ * 16-step ramp instead of blending against the framebuffer. */
+void ui_context_set_text_background(ui_context_t *ctx, ui_color_t color);
+void ui_context_clear_text_background(ui_context_t *ctx);
+
 #endif
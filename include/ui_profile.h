@@ -0,0 +1,117 @@
+#ifndef UI_PROFILE_H
+#define UI_PROFILE_H
+
+#include "ui_widget.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Render profiler, compiled in only with -DBAREUI_PROFILE (make PROFILE=1)
+ * and recording only while enabled. It times every widget's render and
+ * arrange ops, counts the pixels and draw operations (rect fills, glyphs,
+ * blits, polygon spans) each render op writes, times the phases of every
+ * scene frame, sums all of it per widget type (ops->name) and keeps a
+ * Chrome trace_event log for chrome://tracing or Perfetto. Without
+ * BAREUI_PROFILE the hooks below expand to nothing and the functions do
+ * nothing, so callers need no #ifdefs. Single-threaded, like rendering.
+ */
+
+/* trace events kept between resets; later ones only reach the totals */
+#ifndef BAREUI_PROFILE_EVENTS
+#define BAREUI_PROFILE_EVENTS 65536
+#endif
+
+typedef enum {
+    UI_PROFILE_PHASE_EVENTS, /* posted tasks, hit-test layout, input dispatch */
+    UI_PROFILE_PHASE_TICK,   /* scene tick, tweens, widget ticks */
+    UI_PROFILE_PHASE_LAYOUT,
+    UI_PROFILE_PHASE_PAINT,
+    UI_PROFILE_PHASE_COMMIT, /* hand-off to the HAL */
+    UI_PROFILE_PHASE_COUNT
+} ui_profile_phase_t;
+
+typedef struct {
+    const char *name; /* ops->name; "widget" when unset */
+    uint32_t renders;
+    uint32_t layouts;
+    uint64_t render_ns; /* render ops alone, children excluded */
+    uint64_t layout_ns; /* arrange ops, with the child measures they ask for */
+    uint64_t pixels;
+    uint64_t primitives;
+} ui_profile_type_stats_t;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t phase_ns[UI_PROFILE_PHASE_COUNT];
+    uint32_t events_dropped; /* past BAREUI_PROFILE_EVENTS */
+} ui_profile_frame_stats_t;
+
+/* Starts or stops recording; false when compiled without BAREUI_PROFILE. */
+bool ui_profile_set_enabled(bool enabled);
+bool ui_profile_enabled(void);
+/* Drops totals and trace events; trace timestamps restart at 0. */
+void ui_profile_reset(void);
+/* Copies up to capacity per-type totals, slowest render first; returns how
+ * many types were seen. */
+size_t ui_profile_type_stats(ui_profile_type_stats_t *stats, size_t capacity);
+void ui_profile_frame_stats(ui_profile_frame_stats_t *stats);
+/* Per-type and per-phase table, averaged over the frames recorded. */
+void ui_profile_print_summary(FILE *file);
+/* Writes the trace as Chrome trace_event JSON. */
+bool ui_profile_write_trace(const char *path);
+/* Enables recording now and, at exit, writes the trace to path and the
+ * summary to stderr; later calls are ignored. For test HALs. */
+bool ui_profile_trace_at_exit(const char *path);
+
+/* Hooks for the render path and the scene loop; a span lives on the stack of
+ * the function it measures. */
+#ifdef BAREUI_PROFILE
+
+typedef struct {
+    bool active;
+    uint64_t origin_ns; /* span_begin; phases move start_ns on */
+    uint64_t start_ns;
+    uint64_t self_ns;
+    uint64_t pixels;
+    uint64_t primitives;
+} ui_profile_span_t;
+
+/* Bumped by every framebuffer write while compiled in. */
+extern uint64_t ui_profile_pixels_written;
+extern uint64_t ui_profile_primitives_drawn;
+
+void ui_profile_span_begin(ui_profile_span_t *span);
+void ui_profile_render_self(ui_profile_span_t *span, const ui_widget_t *widget);
+void ui_profile_render_end(ui_profile_span_t *span, const ui_widget_t *widget);
+void ui_profile_layout_end(ui_profile_span_t *span, const ui_widget_t *widget);
+void ui_profile_phase_end(ui_profile_span_t *span, ui_profile_phase_t phase);
+void ui_profile_frame_end(ui_profile_span_t *span);
+
+#define UI_PROFILE_SPAN(span) ui_profile_span_t span
+#define UI_PROFILE_BEGIN(span) ui_profile_span_begin(&(span))
+#define UI_PROFILE_RENDER_SELF(span, widget) ui_profile_render_self(&(span), (widget))
+#define UI_PROFILE_RENDER_END(span, widget) ui_profile_render_end(&(span), (widget))
+#define UI_PROFILE_LAYOUT_END(span, widget) ui_profile_layout_end(&(span), (widget))
+/* closes the running phase and starts the next one on the same span */
+#define UI_PROFILE_PHASE(span, phase) ui_profile_phase_end(&(span), (phase))
+#define UI_PROFILE_FRAME_END(span) ui_profile_frame_end(&(span))
+#define UI_PROFILE_DRAW(pixel_count)                                                         \
+    (ui_profile_pixels_written += (uint64_t)(pixel_count), ++ui_profile_primitives_drawn)
+
+#else
+
+#define UI_PROFILE_SPAN(span) ((void)0)
+#define UI_PROFILE_BEGIN(span) ((void)0)
+#define UI_PROFILE_RENDER_SELF(span, widget) ((void)0)
+#define UI_PROFILE_RENDER_END(span, widget) ((void)0)
+#define UI_PROFILE_LAYOUT_END(span, widget) ((void)0)
+#define UI_PROFILE_PHASE(span, phase) ((void)0)
+#define UI_PROFILE_FRAME_END(span) ((void)0)
+#define UI_PROFILE_DRAW(pixel_count) ((void)0)
+
+#endif
+
+#endif
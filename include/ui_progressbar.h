@@ -9,6 +9,8 @@
 typedef struct ui_progressbar ui_progressbar_t;
 
 ui_progressbar_t *ui_progressbar_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_progressbar_t *ui_progressbar_create_in(ui_arena_t *arena);
 void ui_progressbar_destroy(ui_progressbar_t *progressbar);
 void ui_progressbar_init(ui_progressbar_t *progressbar);
 
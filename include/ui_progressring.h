@@ -15,6 +15,8 @@ typedef enum {
 typedef struct ui_progressring ui_progressring_t;
 
 ui_progressring_t *ui_progressring_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_progressring_t *ui_progressring_create_in(ui_arena_t *arena);
 void ui_progressring_destroy(ui_progressring_t *ring);
 void ui_progressring_init(ui_progressring_t *ring);
 
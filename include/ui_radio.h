@@ -34,6 +34,8 @@ typedef void (*ui_radio_group_change_fn)(ui_radio_group_t *group, int32_t value,
                                           void *user_data);
 
 ui_radio_t *ui_radio_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_radio_t *ui_radio_create_in(ui_arena_t *arena);
 void ui_radio_destroy(ui_radio_t *radio);
 
 void ui_radio_init(ui_radio_t *radio);
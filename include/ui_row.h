@@ -15,6 +15,8 @@ typedef enum {
 typedef struct ui_row ui_row_t;
 
 ui_row_t *ui_row_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_row_t *ui_row_create_in(ui_arena_t *arena);
 void ui_row_destroy(ui_row_t *row);
 
 void ui_row_init(ui_row_t *row);
@@ -1,6 +1,7 @@
 #ifndef UI_SCENE_H
 #define UI_SCENE_H
 
+#include "ui_event_queue.h"
 #include "ui_primitives.h"
 #include "ui_widget.h"
 
@@ -13,15 +14,59 @@ typedef bool (*ui_scene_tick_fn)(ui_scene_t *scene, double delta_seconds);
 ui_scene_t *ui_scene_create(const ui_hal_ops_t *hal);
 void ui_scene_destroy(ui_scene_t *scene);
 
+/* The previous root is detached, not destroyed. */
 bool ui_scene_set_root(ui_scene_t *scene, ui_widget_t *root);
 ui_widget_t *ui_scene_root(const ui_scene_t *scene);
 
+/* Arena released by ui_scene_destroy after the root tree's destroy hooks have
+ * run; widgets built with ui_*_create_in(ui_scene_arena(scene)) need no
+ * individual destroy calls, and the arena runs the hooks of those outside the
+ * root tree (replaced roots, detached or never attached widgets) itself.
+ * Created on first use; NULL if that fails. */
+ui_arena_t *ui_scene_arena(ui_scene_t *scene);
+
+/* Runs once per frame after input; tweens (ui_animation.h) and widget ticks
+ * advance right after it. While a tick is set the loop never idles. */
 void ui_scene_set_tick(ui_scene_t *scene, ui_scene_tick_fn tick);
 ui_scene_tick_fn ui_scene_tick(const ui_scene_t *scene);
+/* Upper bound on frames per second (default 60), measured between frame
+ * starts. With no tick callback, nothing animating and no damage left, the
+ * loop blocks in ui_context_wait_event until input arrives. */
+void ui_scene_set_frame_rate(ui_scene_t *scene, int frames_per_second);
+int ui_scene_frame_rate(const ui_scene_t *scene);
+/* Tweens or widget ticks of this scene's tree are pending, so the next frame
+ * changes even without input. */
+bool ui_scene_is_animating(const ui_scene_t *scene);
+
+/* Context counters plus the TOUCH_MOVEs the loop coalesced: each frame,
+ * consecutive queued moves are dispatched once, as the latest, with the
+ * earlier ones in ui_widget_pointer_history. */
+void ui_scene_event_stats(const ui_scene_t *scene, ui_event_stats_t *stats);
+
+/* Debug overlays (ui_debug_overlay_t) on the frames the scene commits; may be
+ * switched between frames, e.g. from a key handler or a tick. */
+bool ui_scene_set_debug_overlay(ui_scene_t *scene, uint32_t overlays);
+uint32_t ui_scene_debug_overlay(const ui_scene_t *scene);
 
 void ui_scene_set_user_data(ui_scene_t *scene, void *user_data);
 void *ui_scene_user_data(const ui_scene_t *scene);
 
+/* Keys go to the focused widget; a touch focuses the focusable widget that
+ * takes TOUCH_DOWN and clears focus otherwise. */
+bool ui_scene_focus(ui_scene_t *scene, ui_widget_t *widget);
+ui_widget_t *ui_scene_focused(ui_scene_t *scene);
+bool ui_scene_focus_next(ui_scene_t *scene);
+bool ui_scene_focus_previous(ui_scene_t *scene);
+
+/* The way other threads touch widgets: queues fn(arg) to run on the UI
+ * thread at the start of the next frame, before layout and render, and wakes
+ * an idle loop. Lock-free and allocation-free; tasks run in posting order
+ * per producer, and a frame's batch shares one layout and one repaint.
+ * Returns false when UI_TASK_QUEUE_SIZE tasks are already pending. Tasks
+ * still queued at ui_scene_destroy are dropped without running. */
+bool ui_scene_post(ui_scene_t *scene, ui_task_fn fn, void *arg);
+
+/* Safe from other threads; wakes an idle loop. */
 void ui_scene_request_exit(ui_scene_t *scene);
 bool ui_scene_is_running(const ui_scene_t *scene);
 
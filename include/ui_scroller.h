@@ -0,0 +1,63 @@
+#ifndef UI_SCROLLER_H
+#define UI_SCROLLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Scroll motion shared by the scrolling containers: a velocity tracker fed
+ * from drag moves, a fling that decays under friction, and timed scroll-to
+ * animations. It only produces offsets; the widget applies them (so content
+ * moves by blit) and keeps itself scheduled with ui_widget_schedule_tick
+ * while ui_scroller_step reports motion.
+ */
+
+#define UI_SCROLLER_SAMPLES 8
+
+typedef enum {
+    UI_SCROLLER_IDLE,
+    UI_SCROLLER_FLING,
+    UI_SCROLLER_ANIMATE
+} ui_scroller_mode_t;
+
+typedef struct {
+    double time;
+    int offset;
+} ui_scroller_sample_t;
+
+typedef struct {
+    ui_scroller_mode_t mode;
+    double position;
+    double velocity; /* px/s along the scroll axis, fling only */
+    double from;
+    double to;
+    double elapsed;
+    double duration;
+    double curve;
+    ui_scroller_sample_t samples[UI_SCROLLER_SAMPLES];
+    size_t sample_count;
+    size_t sample_next;
+} ui_scroller_t;
+
+void ui_scroller_reset(ui_scroller_t *scroller);
+/* Stops any motion; the drag that follows starts a fresh velocity estimate. */
+void ui_scroller_stop(ui_scroller_t *scroller);
+bool ui_scroller_active(const ui_scroller_t *scroller);
+/* Records the offset a drag moved the content to at time (seconds on the
+ * event clock, ui_event_seconds). */
+void ui_scroller_track(ui_scroller_t *scroller, int offset, double time);
+/* Drag released at offset and time: flings with the velocity of the last
+ * moves. Returns false when the pointer was too slow or had stopped. */
+bool ui_scroller_fling(ui_scroller_t *scroller, int offset, double time);
+/* Eases from one offset to another over duration_ms. curve is the ease-out
+ * power: 1 is linear, larger decelerates harder, <= 0 picks a cubic ease-out.
+ * Returns false (and stays idle) for non-positive durations. */
+bool ui_scroller_animate(ui_scroller_t *scroller, int from, int to, int duration_ms,
+                         double curve);
+/* Advances by delta_seconds and stores the new offset, clamped to
+ * [0, max_offset]; a fling stops at the edge it runs into. Returns whether
+ * the motion goes on after this step. */
+bool ui_scroller_step(ui_scroller_t *scroller, double delta_seconds, int max_offset,
+                      int *offset);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef UI_SHAPED_TEXT_H
+#define UI_SHAPED_TEXT_H
+
+#include "ui_arena.h"
+#include "ui_font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A label decoded once into resolved glyphs with their advances and total
+ * width, so drawing and measuring walk a flat array instead of decoding
+ * UTF-8 and looking up every codepoint each frame. Widgets shape when the
+ * text or font changes; ui_shaped_text_ensure also notices fonts that were
+ * freed (ui_text_engine_forget_font). For fonts flagged
+ * BAREUI_FONT_FLAG_VOLATILE_GLYPHS only codepoints and advances are trusted
+ * and bitmaps are looked up again at draw time.
+ *
+ * Static labels can be shaped at build time (tools/build_packed_font.py
+ * --label) and declared with UI_SHAPED_TEXT_STATIC.
+ */
+
+typedef struct {
+    const bareui_font_t *font; /* NULL for static text */
+    const bareui_font_glyph_t *glyphs;
+    size_t count;
+    int width;
+    uint8_t height; /* font line height, used for embedded newlines */
+    uint32_t epoch;
+    bool dirty;
+    bool is_static;
+    ui_arena_t *arena; /* glyph storage; NULL is the heap, kept across release */
+} ui_shaped_text_t;
+
+#define UI_SHAPED_TEXT_STATIC(glyph_array, glyph_count, total_width, line_height) \
+    {NULL, (glyph_array), (glyph_count), (total_width), (line_height), 0, false, true}
+
+void ui_shaped_text_init(ui_shaped_text_t *shaped);
+void ui_shaped_text_release(ui_shaped_text_t *shaped);
+
+/* Decodes text with font (NULL: default font); returns false on allocation failure. */
+bool ui_shaped_text_shape(ui_shaped_text_t *shaped, const bareui_font_t *font, const char *text);
+/* Marks the text as changed so the next ensure reshapes it. */
+void ui_shaped_text_invalidate(ui_shaped_text_t *shaped);
+/* Reshapes only when invalidated, the font differs or fonts were freed; returns the width. */
+int ui_shaped_text_ensure(ui_shaped_text_t *shaped, const bareui_font_t *font, const char *text);
+
+int ui_shaped_text_width(const ui_shaped_text_t *shaped);
+bool ui_shaped_text_is_empty(const ui_shaped_text_t *shaped);
+
+#endif
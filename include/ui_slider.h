@@ -18,6 +18,8 @@ typedef void (*ui_slider_event_fn)(ui_slider_t *slider, void *user_data);
 typedef void (*ui_slider_value_event_fn)(ui_slider_t *slider, double value, void *user_data);
 
 ui_slider_t *ui_slider_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_slider_t *ui_slider_create_in(ui_arena_t *arena);
 void ui_slider_destroy(ui_slider_t *slider);
 
 void ui_slider_init(ui_slider_t *slider);
@@ -0,0 +1,92 @@
+#ifndef UI_STYLE_H
+#define UI_STYLE_H
+
+#include "ui_primitives.h"
+#include "ui_shadow.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Styles are built as plain ui_style_t values and then interned: equal
+ * styles share one refcounted, immutable copy, so a widget carries only a
+ * pointer and a theme applied to a thousand buttons costs one style.
+ * Overriding a field is copy-on-write: copy the shared style, change it and
+ * set it again, which interns the result.
+ *
+ * Custom property keys are atoms, integers interned from names once, so
+ * theme lookups compare integers instead of strings.
+ */
+
+typedef enum {
+    UI_BORDER_LEFT = 1 << 0,
+    UI_BORDER_TOP = 1 << 1,
+    UI_BORDER_RIGHT = 1 << 2,
+    UI_BORDER_BOTTOM = 1 << 3
+} ui_border_side_t;
+
+/* 0 is never a valid atom. */
+typedef uint32_t ui_atom_t;
+
+typedef struct {
+    ui_atom_t key;
+    uint32_t value;
+} ui_style_prop_t;
+
+#define UI_STYLE_MAX_CUSTOM_PROPS 16
+
+typedef struct {
+    ui_color_t background_color;
+    ui_color_t foreground_color;
+    ui_color_t accent_color;
+    int padding_left;
+    int padding_right;
+    int padding_top;
+    int padding_bottom;
+    int margin_left;
+    int margin_right;
+    int margin_top;
+    int margin_bottom;
+    ui_border_side_t border_sides;
+    int border_width;
+    ui_color_t border_color;
+    ui_box_shadow_t box_shadow;
+    ui_style_prop_t custom_props[UI_STYLE_MAX_CUSTOM_PROPS];
+    size_t custom_count;
+    uint32_t flags;
+} ui_style_t;
+
+#define UI_STYLE_FLAG_BACKGROUND_COLOR (1u << 0)
+#define UI_STYLE_FLAG_FOREGROUND_COLOR (1u << 1)
+#define UI_STYLE_FLAG_ACCENT_COLOR     (1u << 2)
+#define UI_STYLE_FLAG_BORDER_COLOR     (1u << 3)
+#define UI_STYLE_FLAG_BORDER_WIDTH     (1u << 4)
+#define UI_STYLE_FLAG_BORDER_SIDES     (1u << 5)
+#define UI_STYLE_FLAG_BOX_SHADOW       (1u << 6)
+
+/* Atoms live for the whole process; the same name always yields the same atom. */
+ui_atom_t ui_atom_intern(const char *name);
+/* 0 if name was never interned. */
+ui_atom_t ui_atom_find(const char *name);
+const char *ui_atom_name(ui_atom_t atom);
+
+void ui_style_init(ui_style_t *style);
+void ui_style_copy(ui_style_t *dst, const ui_style_t *src);
+bool ui_style_set_prop(ui_style_t *style, ui_atom_t key, uint32_t value);
+bool ui_style_get_prop(const ui_style_t *style, ui_atom_t key, uint32_t *out);
+/* Name-keyed wrappers over the atom functions. */
+bool ui_style_set_custom_prop(ui_style_t *style, const char *key, uint32_t value);
+bool ui_style_get_custom_prop(const ui_style_t *style, const char *key, uint32_t *out);
+
+/* Returns the shared copy equal to style (NULL: the default style) with one
+ * more reference, or NULL if out of memory. */
+const ui_style_t *ui_style_intern(const ui_style_t *style);
+const ui_style_t *ui_style_retain(const ui_style_t *shared);
+void ui_style_release(const ui_style_t *shared);
+/* The shared default style; it is never freed and needs no release. */
+const ui_style_t *ui_style_default(void);
+/* Distinct shared styles currently alive, the default included. */
+size_t ui_style_interned_count(void);
+
+#endif
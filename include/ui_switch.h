@@ -17,6 +17,8 @@ typedef void (*ui_switch_change_fn)(ui_switch_t *sw, bool value, void *user_data
 typedef void (*ui_switch_event_fn)(ui_switch_t *sw, void *user_data);
 
 ui_switch_t *ui_switch_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_switch_t *ui_switch_create_in(ui_arena_t *arena);
 void ui_switch_destroy(ui_switch_t *sw);
 
 void ui_switch_init(ui_switch_t *sw);
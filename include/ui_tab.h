@@ -36,6 +36,8 @@ typedef void (*ui_tabs_change_fn)(ui_tabs_t *tabs, size_t selected_index, void *
 typedef void (*ui_tabs_click_fn)(ui_tabs_t *tabs, size_t index, void *user_data);
 
 ui_tab_t *ui_tab_create(void);
+/* Allocates the tab and its label from arena (NULL: heap). */
+ui_tab_t *ui_tab_create_in(ui_arena_t *arena);
 void ui_tab_destroy(ui_tab_t *tab);
 
 void ui_tab_set_text(ui_tab_t *tab, const char *text);
@@ -51,6 +53,8 @@ void ui_tab_set_content(ui_tab_t *tab, ui_widget_t *content);
 ui_widget_t *ui_tab_content(const ui_tab_t *tab);
 
 ui_tabs_t *ui_tabs_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_tabs_t *ui_tabs_create_in(ui_arena_t *arena);
 void ui_tabs_destroy(ui_tabs_t *tabs);
 void ui_tabs_init(ui_tabs_t *tabs);
 
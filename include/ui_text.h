@@ -14,12 +14,15 @@ typedef enum {
 
 typedef enum {
     UI_TEXT_OVERFLOW_CLIP,
-    UI_TEXT_OVERFLOW_FADE
+    UI_TEXT_OVERFLOW_FADE,
+    UI_TEXT_OVERFLOW_ELLIPSIS
 } ui_text_overflow_t;
 
 typedef struct ui_text ui_text_t;
 
 ui_text_t *ui_text_create(void);
+/* Allocates from arena (NULL: heap); strings the widget copies live there too. */
+ui_text_t *ui_text_create_in(ui_arena_t *arena);
 void ui_text_destroy(ui_text_t *text);
 
 void ui_text_init(ui_text_t *text);
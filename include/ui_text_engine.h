@@ -0,0 +1,50 @@
+#ifndef UI_TEXT_ENGINE_H
+#define UI_TEXT_ENGINE_H
+
+#include "ui_font.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Shared UTF-8 decoding, measurement, line breaking and ellipsizing for all
+ * widgets. A NULL font means bareui_font_default(). Missing glyphs measure
+ * as '?', matching what ui_context_draw_text renders.
+ */
+
+/* Decodes one codepoint; returns the bytes consumed, or 0 at end/malformed input. */
+size_t ui_utf8_decode(const char *text, size_t len, uint32_t *out);
+/* NUL-terminated variant that advances *text. */
+bool ui_utf8_next(const char **text, uint32_t *out);
+
+bool ui_text_engine_glyph(const bareui_font_t *font, uint32_t codepoint,
+                          bareui_font_glyph_t *glyph_out);
+int ui_text_engine_advance(const bareui_font_t *font, uint32_t codepoint);
+
+int ui_text_engine_measure(const bareui_font_t *font, const char *text, size_t len);
+/* Memoized by (content hash, font); use for labels measured every frame. */
+int ui_text_engine_measure_cached(const bareui_font_t *font, const char *text);
+
+/* Returns the end of the first line that fits max_width (<= 0: unlimited);
+ * *next receives where the following line starts (separators skipped). */
+size_t ui_text_engine_line_break(const bareui_font_t *font, const char *text, size_t len,
+                                 int max_width, size_t *next);
+#define UI_TEXT_ENGINE_ELLIPSIS "..."
+
+/* Bytes of text that ellipsize keeps ahead of the ellipsis; len when the
+ * whole text fits max_width. */
+size_t ui_text_engine_ellipsis_keep(const bareui_font_t *font, const char *text, size_t len,
+                                    int max_width);
+/* Writes text, or its longest prefix plus "...", that fits max_width into
+ * out (always NUL-terminated); returns the bytes written. */
+size_t ui_text_engine_ellipsize(const bareui_font_t *font, const char *text, size_t len,
+                                int max_width, char *out, size_t out_size);
+
+/* Drops cached metrics for a font that is about to be freed. */
+void ui_text_engine_forget_font(const bareui_font_t *font);
+void ui_text_engine_reset(void);
+/* Bumped whenever a font is forgotten; shaped text compares it to reshape. */
+uint32_t ui_text_engine_font_epoch(void);
+
+#endif
@@ -1,97 +1,222 @@
 #ifndef UI_WIDGET_H
 #define UI_WIDGET_H
 
+#include "ui_arena.h"
+#include "ui_damage.h"
 #include "ui_primitives.h"
+#include "ui_style.h"
 
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
-#include "ui_shadow.h"
+typedef struct ui_widget ui_widget_t;
 
-typedef enum {
-    UI_BORDER_LEFT = 1 << 0,
-    UI_BORDER_TOP = 1 << 1,
-    UI_BORDER_RIGHT = 1 << 2,
-    UI_BORDER_BOTTOM = 1 << 3
-} ui_border_side_t;
+#define UI_EVENT_MASK(type) (1u << (type))
+#define UI_EVENT_MASK_POINTER                                                                \
+    (UI_EVENT_MASK(UI_EVENT_TOUCH_DOWN) | UI_EVENT_MASK(UI_EVENT_TOUCH_UP) |                  \
+     UI_EVENT_MASK(UI_EVENT_TOUCH_MOVE))
+#define UI_EVENT_MASK_KEY (UI_EVENT_MASK(UI_EVENT_KEY_DOWN) | UI_EVENT_MASK(UI_EVENT_KEY_UP))
 
 typedef struct {
+    /* widget type, e.g. "button"; groups widgets in profiles and debug output */
     const char *name;
-    uint32_t value;
-} ui_style_prop_t;
-
-#define UI_STYLE_MAX_CUSTOM_PROPS 16
-
-typedef struct {
-    ui_color_t background_color;
-    ui_color_t foreground_color;
-    ui_color_t accent_color;
-    int padding_left;
-    int padding_right;
-    int padding_top;
-    int padding_bottom;
-    int margin_left;
-    int margin_right;
-    int margin_top;
-    int margin_bottom;
-    ui_border_side_t border_sides;
-    int border_width;
-    ui_color_t border_color;
-    ui_box_shadow_t box_shadow;
-    ui_style_prop_t custom_props[UI_STYLE_MAX_CUSTOM_PROPS];
-    size_t custom_count;
-    uint32_t flags;
-} ui_style_t;
-
-#define UI_STYLE_FLAG_BACKGROUND_COLOR (1u << 0)
-#define UI_STYLE_FLAG_FOREGROUND_COLOR (1u << 1)
-#define UI_STYLE_FLAG_ACCENT_COLOR     (1u << 2)
-#define UI_STYLE_FLAG_BORDER_COLOR     (1u << 3)
-#define UI_STYLE_FLAG_BORDER_WIDTH     (1u << 4)
-#define UI_STYLE_FLAG_BORDER_SIDES     (1u << 5)
-#define UI_STYLE_FLAG_BOX_SHADOW       (1u << 6)
-
-typedef struct ui_widget ui_widget_t;
-
-typedef struct {
     bool (*render)(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_t *bounds);
     bool (*handle_event)(ui_widget_t *widget, const ui_event_t *event);
     void (*destroy)(ui_widget_t *widget);
     void (*style_changed)(ui_widget_t *widget, const ui_style_t *style);
+    /* intrinsic size within the given limits (<= 0: unconstrained); results are cached
+     * per widget until ui_widget_invalidate_measure and reused for any tighter limit
+     * the result still fits, so the size must not change between the two */
+    void (*measure)(ui_widget_t *widget, int max_width, int max_height, int *width,
+                    int *height);
+    /* positions children inside bounds; runs in the layout pass, never from render */
+    void (*arrange)(ui_widget_t *widget, const ui_rect_t *bounds);
+    /* events handle_event wants; 0 accepts everything */
+    uint32_t event_mask;
+    /* the scene focus manager moved focus onto or away from widget */
+    void (*focus_changed)(ui_widget_t *widget, bool focused);
+    /* handle_event reports its own damage (e.g. by scrolling content); otherwise
+     * the widget is repainted after every event it is offered */
+    bool manages_damage;
+    /* advances an animation once per frame while the widget is scheduled with
+     * ui_widget_schedule_tick; returning false unschedules it */
+    bool (*tick)(ui_widget_t *widget, double delta_seconds);
 } ui_widget_ops_t;
 
-void ui_style_init(ui_style_t *style);
-void ui_style_copy(ui_style_t *dst, const ui_style_t *src);
-bool ui_style_set_custom_prop(ui_style_t *style, const char *key, uint32_t value);
-bool ui_style_get_custom_prop(const ui_style_t *style, const char *key, uint32_t *out);
+#define UI_WIDGET_MEASURE_CACHE_SIZE 2
+
+struct ui_tween;
+
+/* Per-tree frame state, owned by whoever runs the tree (the scene) and
+ * attached to its root with ui_widget_set_host. Widgets reach it through
+ * their root, so trees in different scenes or contexts never share damage,
+ * ticks, tweens or pointer history; widgets outside a hosted tree have none. */
+typedef struct {
+    ui_damage_t damage; /* what render_damage repaints next */
+    uint32_t font_epoch;
+    uint32_t repaint_epoch; /* ui_context_repaint_epoch at the last render */
+    /* widgets waiting for the next tick, and those not yet ticked this frame */
+    ui_widget_t *tick_list;
+    ui_widget_t *tick_running;
+    const ui_event_t *history;
+    size_t history_count;
+    struct ui_tween *tweens; /* ui_animation.h */
+    size_t tween_count;
+    size_t tween_capacity;
+    uint32_t next_tween_id;
+} ui_widget_host_t;
+
+typedef struct {
+    int max_width;
+    int max_height;
+    uint32_t generation; /* 0: empty slot */
+    uint32_t font_epoch;
+    int width;
+    int height;
+} ui_measure_entry_t;
 
 struct ui_widget {
     ui_widget_t *parent;
     ui_widget_t *first_child;
+    ui_widget_t *last_child;
     ui_widget_t *next_sibling;
+    ui_widget_t *prev_sibling;
+    size_t child_count;
     const ui_widget_ops_t *ops;
     ui_rect_t bounds;
     void *user_data;
+    ui_arena_t *arena; /* where the widget and its strings live; NULL is the heap */
+    ui_arena_finalizer_t arena_link; /* see ui_widget_set_arena */
     bool visible;
-    ui_style_t style;
+    bool needs_layout;
+    bool focusable;
+    bool autofocus;
+    /* read by the parent's layout: column/row expand and scroll-to keys */
+    bool expand;
+    const char *key;
+    int preferred_width; /* from ui_widget_set_bounds; 0 lets the layout measure */
+    int preferred_height;
+    uint32_t measure_generation;
+    uint8_t measure_next;
+    ui_measure_entry_t measure_cache[UI_WIDGET_MEASURE_CACHE_SIZE];
+    const ui_style_t *style; /* interned and shared, never NULL */
+    ui_widget_t *tick_next; /* ui_widget_schedule_tick list */
+    bool tick_scheduled;
+    ui_widget_host_t *host; /* roots only, see ui_widget_set_host */
 };
 
 void ui_widget_init(ui_widget_t *widget, const ui_widget_ops_t *ops);
+/* Drops the style reference init and set_style took; for widget destroy functions.
+ * Safe to call twice. */
+void ui_widget_deinit(ui_widget_t *widget);
+/* For ui_*_create_in: records the arena and registers the widget with it, so
+ * destroying or resetting the arena runs ops->destroy and ui_widget_deinit
+ * on every widget nobody destroyed, in the tree or not. deinit unregisters. */
+void ui_widget_set_arena(ui_widget_t *widget, ui_arena_t *arena);
 void ui_widget_set_bounds(ui_widget_t *widget, int x, int y, int width, int height);
 void ui_widget_set_visible(ui_widget_t *widget, bool visible);
 void ui_widget_set_user_data(ui_widget_t *widget, void *user_data);
 void *ui_widget_user_data(const ui_widget_t *widget);
 
 bool ui_widget_add_child(ui_widget_t *parent, ui_widget_t *child);
+/* Like add_child but keeps insertion order (add_child prepends); both are O(1). */
+bool ui_widget_append_child(ui_widget_t *parent, ui_widget_t *child);
 void ui_widget_remove_child(ui_widget_t *child);
 
+/* Focusable widgets join the scene's traversal order; the first autofocus
+ * widget takes focus when nothing else holds it. */
+void ui_widget_set_focusable(ui_widget_t *widget, bool focusable);
+void ui_widget_set_autofocus(ui_widget_t *widget, bool autofocus);
+bool ui_widget_accepts_event(const ui_widget_t *widget, ui_event_type_t type);
+
+/* Flags widget and its ancestors; the next layout pass re-arranges that path. */
+void ui_widget_mark_needs_layout(ui_widget_t *widget);
+bool ui_widget_needs_layout(const ui_widget_t *widget);
+/* Content or size hints changed: drops cached measurements of widget and its
+ * ancestors and schedules a layout. */
+void ui_widget_invalidate_measure(ui_widget_t *widget);
+/* Size a parent should give widget: the non-zero preferred axes from
+ * set_bounds, the rest from the (cached) measure op. */
+void ui_widget_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                       int *height);
+/* For arrange ops: moves a child without dirtying the parent being laid out. */
+void ui_widget_place(ui_widget_t *child, int x, int y, int width, int height);
+/* Runs arrange for dirty subtrees only; render_tree calls it before painting. */
+void ui_widget_layout_tree(ui_widget_t *root);
+
+/* Schedules widget's bounds for repaint by ui_widget_render_damage; for
+ * setters that change appearance but not size. Layout changes (set_bounds,
+ * place, invalidate_measure, visibility, attach/detach, style) damage on their own. */
+void ui_widget_invalidate(ui_widget_t *widget);
+/* Damages the whole screen for widget's tree. */
+void ui_widget_invalidate_all(ui_widget_t *widget);
+/* Damage widget's tree collected since its last render; NULL when unhosted. */
+const ui_damage_t *ui_widget_damage(const ui_widget_t *widget);
+
+/* Empty host whose first render_damage repaints everything. */
+void ui_widget_host_init(ui_widget_host_t *host);
+/* Frees the tween array; the tree it hosted must be detached or destroyed. */
+void ui_widget_host_release(ui_widget_host_t *host);
+/* Attaches host to root (NULL detaches) and damages the whole screen. The
+ * tree's ticks and tweens in the previous host are cancelled, as are those of
+ * any subtree removed from a hosted tree, and a hosted root that becomes a
+ * child leaves its host. */
+void ui_widget_set_host(ui_widget_t *root, ui_widget_host_t *host);
+/* The host of widget's root, NULL when there is none. */
+ui_widget_host_t *ui_widget_host(const ui_widget_t *widget);
+/* Moves widget's descendants by (dx, dy) after a scroll-offset change and
+ * schedules a blit of the pixels already inside widget's visible bounds, so
+ * the next render_damage repaints only the uncovered strip. The widget must
+ * paint an opaque, uniform background under its content. Returns false when
+ * the viewport is repainted instead (hidden, too large a shift, or too many
+ * scrolls pending). */
+bool ui_widget_scroll_content(ui_widget_t *widget, int dx, int dy);
+
+/* Runs ops->tick on widget every frame until it returns false, the widget
+ * leaves its tree or is deinitialized; scheduling twice is a no-op. Returns
+ * false when nothing will tick it: no tick op or no hosted tree. */
+bool ui_widget_schedule_tick(ui_widget_t *widget);
+void ui_widget_cancel_tick(ui_widget_t *widget);
+/* Ticks every widget scheduled in host once (the scene calls this after its
+ * own tick); returns whether any stays scheduled. */
+bool ui_widget_tick_all(ui_widget_host_t *host, double delta_seconds);
+bool ui_widget_tick_pending(const ui_widget_host_t *host);
+
+/* Full repaint; clears pending damage. */
 void ui_widget_render_tree(ui_widget_t *root, ui_context_t *ctx);
+/* Lays out, applies pending scroll blits and repaints only damaged rects
+ * through the clip stack; an unhosted root is repainted in full. */
+void ui_widget_render_damage(ui_widget_t *root, ui_context_t *ctx);
+/* Offers event to every visible widget, children first; used for keys and quit. */
 bool ui_widget_dispatch_event(ui_widget_t *root, const ui_event_t *event);
+/* Deepest visible widget under (x, y), in dispatch order. Subtrees whose bounds
+ * miss the point are skipped; widgets with empty bounds never prune. */
+ui_widget_t *ui_widget_hit_test(ui_widget_t *root, int x, int y);
+/* dispatch_event restricted to the subtrees under (x, y); returns the handler. */
+ui_widget_t *ui_widget_dispatch_at(ui_widget_t *root, const ui_event_t *event, int x, int y);
+/* Delivers event to one widget only, e.g. the one holding pointer capture. */
+bool ui_widget_send_event(ui_widget_t *widget, const ui_event_t *event);
+/* While a coalesced TOUCH_MOVE is being dispatched: the moves folded into it,
+ * oldest first and not including it; empty otherwise. Drag handlers feed
+ * these to velocity trackers. */
+const ui_event_t *ui_widget_pointer_history(const ui_widget_t *widget, size_t *count);
+/* Set by the dispatcher around one event; events must outlive the dispatch. */
+void ui_widget_set_pointer_history(ui_widget_host_t *host, const ui_event_t *events,
+                                   size_t count);
+bool ui_widget_tree_contains(const ui_widget_t *root, const ui_widget_t *widget);
+/* Bumped whenever widgets are attached, detached, shown, hidden or change
+ * focusability; lets holders of widget pointers and cached traversal orders
+ * revalidate only after the tree actually changed. */
+uint32_t ui_widget_tree_epoch(void);
 void ui_widget_destroy_tree(ui_widget_t *root);
 
+/* Interns style (NULL: the default) and shares it; to override a field, copy
+ * ui_widget_style(), change the copy and set it. */
 void ui_widget_set_style(ui_widget_t *widget, const ui_style_t *style);
+/* Shares an already interned style without hashing it again. */
+void ui_widget_set_shared_style(ui_widget_t *widget, const ui_style_t *shared);
 const ui_style_t *ui_widget_style(const ui_widget_t *widget);
 
 #endif
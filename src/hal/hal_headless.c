@@ -0,0 +1,369 @@
+#include "ui_hal_headless.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HAL_HEADLESS_FRAME_STEP (1.0 / 60.0)
+#define HAL_HEADLESS_PIXELS (UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT)
+
+struct ui_hal_headless {
+    ui_hal_ops_t ops;
+    ui_hal_headless_step_t *steps; /* sorted by hal_headless_due */
+    size_t step_count;
+    size_t step_capacity;
+    size_t step_next;
+    uint32_t frame;
+    uint32_t max_frames;
+    char *snapshot_prefix;
+    ui_color_t framebuffer[HAL_HEADLESS_PIXELS];
+};
+
+static bool hal_headless_init(ui_context_t *ctx)
+{
+    return ui_context_user_data(ctx) != NULL;
+}
+
+static void hal_headless_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
+{
+    ui_hal_headless_t *hal = ui_context_user_data(ctx);
+    if (hal) {
+        memcpy(hal->framebuffer, framebuffer, sizeof(hal->framebuffer));
+    }
+}
+
+static void hal_headless_snapshot(ui_hal_headless_t *hal, uint32_t frame)
+{
+    if (!hal->snapshot_prefix) {
+        return;
+    }
+    size_t length = strlen(hal->snapshot_prefix) + 16;
+    char *path = malloc(length);
+    if (!path) {
+        return;
+    }
+    snprintf(path, length, "%s-%u.ppm", hal->snapshot_prefix, (unsigned)frame);
+    if (!ui_hal_headless_write_ppm(path, hal->framebuffer)) {
+        fprintf(stderr, "headless: cannot write %s\n", path);
+    }
+    free(path);
+}
+
+/* A snapshot of frame n can only be taken once n has rendered, at the start
+ * of n + 1; steps are kept sorted by this. */
+static uint32_t hal_headless_due(const ui_hal_headless_step_t *step)
+{
+    return step->action == UI_HAL_HEADLESS_SNAPSHOT ? step->frame + 1 : step->frame;
+}
+
+static void hal_headless_poll_input(ui_context_t *ctx)
+{
+    ui_hal_headless_t *hal = ui_context_user_data(ctx);
+    if (!hal) {
+        return;
+    }
+    uint32_t frame = hal->frame++;
+    uint64_t now_us = (uint64_t)(frame * HAL_HEADLESS_FRAME_STEP * 1e6) + 1;
+    while (hal->step_next < hal->step_count &&
+           hal_headless_due(&hal->steps[hal->step_next]) <= frame) {
+        const ui_hal_headless_step_t *step = &hal->steps[hal->step_next++];
+        if (step->action == UI_HAL_HEADLESS_SNAPSHOT) {
+            hal_headless_snapshot(hal, step->frame);
+            continue;
+        }
+        if (step->action == UI_HAL_HEADLESS_OVERLAY) {
+            ui_context_set_debug_overlay(ctx, step->overlays);
+            continue;
+        }
+        ui_event_t event = step->event;
+        event.timestamp_us = now_us;
+        ui_context_post_event(ctx, &event);
+    }
+    if (hal->max_frames && frame == hal->max_frames) {
+        ui_event_t quit;
+        memset(&quit, 0, sizeof(quit));
+        quit.type = UI_EVENT_QUIT;
+        quit.timestamp_us = now_us;
+        ui_context_post_event(ctx, &quit);
+    }
+}
+
+/* The frame that handled QUIT never reaches another poll; its snapshots are
+ * taken when the context goes away. */
+static void hal_headless_deinit(ui_context_t *ctx)
+{
+    ui_hal_headless_t *hal = ui_context_user_data(ctx);
+    if (!hal) {
+        return;
+    }
+    while (hal->step_next < hal->step_count) {
+        const ui_hal_headless_step_t *step = &hal->steps[hal->step_next++];
+        if (step->action == UI_HAL_HEADLESS_SNAPSHOT && step->frame < hal->frame) {
+            hal_headless_snapshot(hal, step->frame);
+        }
+    }
+}
+
+ui_hal_headless_t *ui_hal_headless_create(const char *snapshot_prefix, uint32_t max_frames)
+{
+    ui_hal_headless_t *hal = calloc(1, sizeof(*hal));
+    if (!hal) {
+        return NULL;
+    }
+    if (snapshot_prefix) {
+        hal->snapshot_prefix = malloc(strlen(snapshot_prefix) + 1);
+        if (!hal->snapshot_prefix) {
+            free(hal);
+            return NULL;
+        }
+        strcpy(hal->snapshot_prefix, snapshot_prefix);
+    }
+    hal->max_frames = max_frames;
+    hal->ops.user_data = hal;
+    hal->ops.init = hal_headless_init;
+    hal->ops.deinit = hal_headless_deinit;
+    hal->ops.commit_frame = hal_headless_commit;
+    hal->ops.poll_input = hal_headless_poll_input;
+    hal->ops.frame_step_seconds = HAL_HEADLESS_FRAME_STEP;
+    return hal;
+}
+
+void ui_hal_headless_destroy(ui_hal_headless_t *hal)
+{
+    if (!hal) {
+        return;
+    }
+    free(hal->steps);
+    free(hal->snapshot_prefix);
+    free(hal);
+}
+
+const ui_hal_ops_t *ui_hal_headless_ops(ui_hal_headless_t *hal)
+{
+    return hal ? &hal->ops : NULL;
+}
+
+bool ui_hal_headless_add(ui_hal_headless_t *hal, const ui_hal_headless_step_t *step)
+{
+    if (!hal || !step) {
+        return false;
+    }
+    if (hal->step_count == hal->step_capacity) {
+        size_t capacity = hal->step_capacity ? hal->step_capacity * 2 : 16;
+        ui_hal_headless_step_t *steps = realloc(hal->steps, capacity * sizeof(*steps));
+        if (!steps) {
+            return false;
+        }
+        hal->steps = steps;
+        hal->step_capacity = capacity;
+    }
+    size_t index = hal->step_count;
+    while (index > hal->step_next &&
+           hal_headless_due(&hal->steps[index - 1]) > hal_headless_due(step)) {
+        hal->steps[index] = hal->steps[index - 1];
+        --index;
+    }
+    hal->steps[index] = *step;
+    hal->step_count++;
+    return true;
+}
+
+bool ui_hal_headless_inject(ui_hal_headless_t *hal, uint32_t frame, const ui_event_t *event)
+{
+    if (!event) {
+        return false;
+    }
+    ui_hal_headless_step_t step;
+    memset(&step, 0, sizeof(step));
+    step.frame = frame;
+    step.action = UI_HAL_HEADLESS_EVENT;
+    step.event = *event;
+    return ui_hal_headless_add(hal, &step);
+}
+
+bool ui_hal_headless_snapshot_at(ui_hal_headless_t *hal, uint32_t frame)
+{
+    ui_hal_headless_step_t step;
+    memset(&step, 0, sizeof(step));
+    step.frame = frame;
+    step.action = UI_HAL_HEADLESS_SNAPSHOT;
+    return ui_hal_headless_add(hal, &step);
+}
+
+bool ui_hal_headless_overlay_at(ui_hal_headless_t *hal, uint32_t frame, uint32_t overlays)
+{
+    ui_hal_headless_step_t step;
+    memset(&step, 0, sizeof(step));
+    step.frame = frame;
+    step.action = UI_HAL_HEADLESS_OVERLAY;
+    step.overlays = overlays;
+    return ui_hal_headless_add(hal, &step);
+}
+
+static bool hal_headless_parse_key(const char *text, uint32_t *keycode)
+{
+    if (text[0] == '\'' && text[1] && text[2] == '\'') {
+        *keycode = (unsigned char)text[1];
+        return true;
+    }
+    char *end = NULL;
+    unsigned long value = strtoul(text, &end, 0);
+    if (end == text || *end) {
+        return false;
+    }
+    *keycode = (uint32_t)value;
+    return true;
+}
+
+static bool hal_headless_parse_line(const char *line, ui_hal_headless_step_t *step)
+{
+    char action[16];
+    char first[32];
+    char second[32];
+    unsigned long frame = 0;
+    int fields = sscanf(line, "%lu %15s %31s %31s", &frame, action, first, second);
+    if (fields < 2) {
+        return false;
+    }
+    memset(step, 0, sizeof(*step));
+    step->frame = (uint32_t)frame;
+    step->action = UI_HAL_HEADLESS_EVENT;
+    ui_event_t *event = &step->event;
+    if (strcmp(action, "down") == 0 || strcmp(action, "up") == 0 ||
+        strcmp(action, "move") == 0) {
+        if (fields != 4) {
+            return false;
+        }
+        event->type = action[0] == 'd' ? UI_EVENT_TOUCH_DOWN
+                      : action[0] == 'u' ? UI_EVENT_TOUCH_UP
+                                         : UI_EVENT_TOUCH_MOVE;
+        event->data.touch.x = (int16_t)atoi(first);
+        event->data.touch.y = (int16_t)atoi(second);
+        return true;
+    }
+    if (strcmp(action, "key_down") == 0 || strcmp(action, "key_up") == 0) {
+        event->type = action[4] == 'd' ? UI_EVENT_KEY_DOWN : UI_EVENT_KEY_UP;
+        return fields == 3 && hal_headless_parse_key(first, &event->data.key.keycode);
+    }
+    if (strcmp(action, "overlay") == 0) {
+        step->action = UI_HAL_HEADLESS_OVERLAY;
+        return fields == 3 && ui_debug_overlay_parse(first, &step->overlays);
+    }
+    if (strcmp(action, "snapshot") == 0) {
+        step->action = UI_HAL_HEADLESS_SNAPSHOT;
+        return fields == 2;
+    }
+    if (strcmp(action, "quit") == 0) {
+        event->type = UI_EVENT_QUIT;
+        return fields == 2;
+    }
+    return false;
+}
+
+bool ui_hal_headless_load_script(ui_hal_headless_t *hal, const char *path)
+{
+    if (!hal || !path) {
+        return false;
+    }
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "headless: cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    unsigned line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        ++line_number;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char *text = line;
+        while (isspace((unsigned char)*text)) {
+            ++text;
+        }
+        if (!*text) {
+            continue;
+        }
+        ui_hal_headless_step_t step;
+        if (!hal_headless_parse_line(text, &step)) {
+            fprintf(stderr, "headless: %s:%u: cannot parse step\n", path, line_number);
+            ok = false;
+            break;
+        }
+        ok = ui_hal_headless_add(hal, &step);
+    }
+    fclose(file);
+    return ok;
+}
+
+uint32_t ui_hal_headless_frame(const ui_hal_headless_t *hal)
+{
+    return hal ? hal->frame : 0;
+}
+
+const ui_color_t *ui_hal_headless_framebuffer(const ui_hal_headless_t *hal)
+{
+    return hal ? hal->framebuffer : NULL;
+}
+
+bool ui_hal_headless_write_ppm(const char *path, const ui_color_t *framebuffer)
+{
+    if (!path || !framebuffer) {
+        return false;
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT);
+    unsigned char row[UI_FRAMEBUFFER_WIDTH * 3];
+    bool ok = true;
+    for (int y = 0; y < UI_FRAMEBUFFER_HEIGHT && ok; ++y) {
+        for (int x = 0; x < UI_FRAMEBUFFER_WIDTH; ++x) {
+            ui_color_t pixel = framebuffer[y * UI_FRAMEBUFFER_WIDTH + x];
+            unsigned r = (pixel >> 11) & 0x1F;
+            unsigned g = (pixel >> 5) & 0x3F;
+            unsigned b = pixel & 0x1F;
+            row[x * 3] = (unsigned char)((r << 3) | (r >> 2));
+            row[x * 3 + 1] = (unsigned char)((g << 2) | (g >> 4));
+            row[x * 3 + 2] = (unsigned char)((b << 3) | (b >> 2));
+        }
+        ok = fwrite(row, sizeof(row), 1, file) == 1;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+bool ui_hal_headless_read_ppm(const char *path, ui_color_t *framebuffer)
+{
+    if (!path || !framebuffer) {
+        return false;
+    }
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    int width = 0;
+    int height = 0;
+    int maxval = 0;
+    /* the single whitespace byte after maxval ends the header */
+    if (fscanf(file, "P6 %d %d %d", &width, &height, &maxval) != 3 ||
+        width != UI_FRAMEBUFFER_WIDTH || height != UI_FRAMEBUFFER_HEIGHT || maxval != 255 ||
+        !isspace(fgetc(file))) {
+        fclose(file);
+        return false;
+    }
+    unsigned char row[UI_FRAMEBUFFER_WIDTH * 3];
+    bool ok = true;
+    for (int y = 0; y < UI_FRAMEBUFFER_HEIGHT && ok; ++y) {
+        ok = fread(row, sizeof(row), 1, file) == 1;
+        for (int x = 0; x < UI_FRAMEBUFFER_WIDTH && ok; ++x) {
+            framebuffer[y * UI_FRAMEBUFFER_WIDTH + x] =
+                ui_color_rgb(row[x * 3], row[x * 3 + 1], row[x * 3 + 2]);
+        }
+    }
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,55 @@
+#include "ui_hal_headless.h"
+#include "ui_hal_test.h"
+#include "ui_profile.h"
+
+#include <stdlib.h>
+
+/* Bounds a run whose script never quits. */
+#define HAL_TEST_HEADLESS_MAX_FRAMES 600
+
+/*
+ * Runs the demos offscreen, configured from the environment:
+ *   BAREUI_SCRIPT           input/snapshot script (ui_hal_headless_load_script)
+ *   BAREUI_SNAPSHOT_PREFIX  snapshots go to <prefix>-<frame>.ppm
+ *   BAREUI_MAX_FRAMES       QUIT is posted at this frame (default 600)
+ *   BAREUI_PROFILE_TRACE    profile trace written here at exit (PROFILE=1 builds)
+ *   BAREUI_DEBUG_OVERLAY    debug overlays from the first frame, e.g. overdraw+damage
+ */
+
+static ui_hal_headless_t *hal_test_headless;
+
+static void hal_test_headless_release(void)
+{
+    ui_hal_headless_destroy(hal_test_headless);
+    hal_test_headless = NULL;
+}
+
+const ui_hal_ops_t *ui_hal_test_ops(void)
+{
+    if (hal_test_headless) {
+        return ui_hal_headless_ops(hal_test_headless);
+    }
+    const char *trace = getenv("BAREUI_PROFILE_TRACE");
+    if (trace) {
+        ui_profile_trace_at_exit(trace);
+    }
+    const char *frames = getenv("BAREUI_MAX_FRAMES");
+    uint32_t max_frames = frames ? (uint32_t)strtoul(frames, NULL, 10)
+                                 : HAL_TEST_HEADLESS_MAX_FRAMES;
+    hal_test_headless = ui_hal_headless_create(getenv("BAREUI_SNAPSHOT_PREFIX"), max_frames);
+    if (!hal_test_headless) {
+        return NULL;
+    }
+    atexit(hal_test_headless_release);
+    const char *overlay = getenv("BAREUI_DEBUG_OVERLAY");
+    uint32_t overlays = UI_DEBUG_OVERLAY_NONE;
+    if (overlay && (!ui_debug_overlay_parse(overlay, &overlays) ||
+                    !ui_hal_headless_overlay_at(hal_test_headless, 0, overlays))) {
+        return NULL;
+    }
+    const char *script = getenv("BAREUI_SCRIPT");
+    if (script && !ui_hal_headless_load_script(hal_test_headless, script)) {
+        return NULL;
+    }
+    return ui_hal_headless_ops(hal_test_headless);
+}
@@ -1,4 +1,5 @@
 #include "ui_hal_test.h"
+#include "ui_profile.h"
 
 #include <SDL2/SDL.h>
 #include <stdint.h>
@@ -28,12 +29,24 @@ static inline uint32_t hal_color_to_argb(ui_color_t pixel)
     return (0xFFu << 24) | (r << 16) | (g << 8) | b;
 }
 
-static void hal_process_events(ui_context_t *ctx, hal_sdl_state_t *state)
+static void hal_sdl_poll_input(ui_context_t *ctx)
 {
+    hal_sdl_state_t *state = ui_context_user_data(ctx);
+    if (!state || !state->running) {
+        return;
+    }
+    /* SDL stamps events in milliseconds since SDL_Init; map them onto the
+     * event clock through the current time on both */
+    uint64_t now = ui_event_time_now();
+    uint32_t ticks = SDL_GetTicks();
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         ui_event_t ui_evt = {0};
         bool valid = true;
+        uint32_t age_ms = ticks - event.common.timestamp;
+        if (age_ms <= ticks && (uint64_t)age_ms * 1000u < now) {
+            ui_evt.timestamp_us = now - (uint64_t)age_ms * 1000u;
+        }
         switch (event.type) {
         case SDL_QUIT:
             ui_evt.type = UI_EVENT_QUIT;
@@ -55,6 +68,14 @@ static void hal_process_events(ui_context_t *ctx, hal_sdl_state_t *state)
             ui_evt.data.touch.y = event.motion.y / UI_TEST_SCALE;
             break;
         case SDL_KEYDOWN:
+            /* F1/F2 toggle the overdraw and damage overlays */
+            if (event.key.keysym.sym == SDLK_F1 || event.key.keysym.sym == SDLK_F2) {
+                uint32_t overlay = event.key.keysym.sym == SDLK_F1 ? UI_DEBUG_OVERLAY_OVERDRAW
+                                                                   : UI_DEBUG_OVERLAY_DAMAGE;
+                ui_context_set_debug_overlay(ctx, ui_context_debug_overlay(ctx) ^ overlay);
+                valid = false;
+                break;
+            }
             ui_evt.type = UI_EVENT_KEY_DOWN;
             ui_evt.data.key.keycode = (uint32_t)event.key.keysym.sym;
             break;
@@ -127,6 +148,11 @@ static bool hal_sdl_init(ui_context_t *ctx)
 
     state->running = true;
     ui_context_set_user_data(ctx, state);
+    const char *overlay = getenv("BAREUI_DEBUG_OVERLAY");
+    uint32_t overlays = UI_DEBUG_OVERLAY_NONE;
+    if (overlay && ui_debug_overlay_parse(overlay, &overlays)) {
+        ui_context_set_debug_overlay(ctx, overlays);
+    }
     return true;
 }
 
@@ -163,8 +189,6 @@ static void hal_sdl_commit(ui_context_t *ctx, const ui_color_t *framebuffer)
         return;
     }
 
-    hal_process_events(ctx, state);
-
     uint32_t *dest = state->scaled_buffer;
     for (int y = 0; y < UI_FRAMEBUFFER_HEIGHT; ++y) {
         for (int x = 0; x < UI_FRAMEBUFFER_WIDTH; ++x) {
@@ -188,10 +212,20 @@ static const ui_hal_ops_t test_ops = {
     .user_data = NULL,
     .init = hal_sdl_init,
     .deinit = hal_sdl_deinit,
-    .commit_frame = hal_sdl_commit
+    .commit_frame = hal_sdl_commit,
+    .poll_input = hal_sdl_poll_input
 };
 
 const ui_hal_ops_t *ui_hal_test_sdl_ops(void)
 {
     return &test_ops;
 }
+
+const ui_hal_ops_t *ui_hal_test_ops(void)
+{
+    const char *trace = getenv("BAREUI_PROFILE_TRACE");
+    if (trace) {
+        ui_profile_trace_at_exit(trace);
+    }
+    return &test_ops;
+}
@@ -0,0 +1,245 @@
+#include "ui_animation.h"
+
+#include <stdlib.h>
+
+typedef enum {
+    UI_TWEEN_INT,
+    UI_TWEEN_DOUBLE,
+    UI_TWEEN_COLOR
+} ui_tween_kind_t;
+
+typedef struct ui_tween {
+    ui_animation_id_t id;
+    ui_tween_kind_t kind;
+    void *value;
+    double from;
+    double to;
+    double elapsed;
+    double duration;
+    ui_easing_t easing;
+    bool finished;
+    ui_widget_t *target;
+    ui_animation_done_fn on_done;
+    void *user_data;
+} ui_tween_t;
+
+double ui_easing_apply(ui_easing_t easing, double t)
+{
+    if (t <= 0.0) {
+        return 0.0;
+    }
+    if (t >= 1.0) {
+        return 1.0;
+    }
+    double u = 1.0 - t;
+    switch (easing) {
+    case UI_EASE_IN_QUAD:
+        return t * t;
+    case UI_EASE_OUT_QUAD:
+        return 1.0 - u * u;
+    case UI_EASE_IN_OUT_QUAD:
+        return t < 0.5 ? 2.0 * t * t : 1.0 - 2.0 * u * u;
+    case UI_EASE_OUT_CUBIC:
+        return 1.0 - u * u * u;
+    case UI_EASE_IN_OUT_CUBIC:
+        return t < 0.5 ? 4.0 * t * t * t : 1.0 - 4.0 * u * u * u;
+    case UI_EASE_LINEAR:
+    default:
+        return t;
+    }
+}
+
+static void ui_animation_remove_at(ui_widget_host_t *host, size_t index)
+{
+    host->tweens[index] = host->tweens[--host->tween_count];
+}
+
+static ui_animation_id_t ui_animation_start(ui_tween_kind_t kind, void *value, double from,
+                                            double to, const ui_animation_params_t *params)
+{
+    ui_widget_host_t *host = params ? ui_widget_host(params->target) : NULL;
+    if (!value || !host) {
+        return 0;
+    }
+    for (size_t i = 0; i < host->tween_count; ++i) {
+        if (host->tweens[i].value == value) {
+            ui_animation_remove_at(host, i);
+            break;
+        }
+    }
+    if (host->tween_count == host->tween_capacity) {
+        size_t capacity = host->tween_capacity ? host->tween_capacity * 2 : 8;
+        ui_tween_t *tweens = realloc(host->tweens, capacity * sizeof(*tweens));
+        if (!tweens) {
+            return 0;
+        }
+        host->tweens = tweens;
+        host->tween_capacity = capacity;
+    }
+    ui_tween_t *tween = &host->tweens[host->tween_count++];
+    tween->id = ++host->next_tween_id;
+    if (tween->id == 0) {
+        tween->id = ++host->next_tween_id;
+    }
+    tween->kind = kind;
+    tween->value = value;
+    tween->from = from;
+    tween->to = to;
+    tween->elapsed = 0.0;
+    tween->duration = params->duration_ms > 0 ? params->duration_ms / 1000.0 : 0.0;
+    tween->easing = params->easing;
+    tween->finished = false;
+    tween->target = params->target;
+    tween->on_done = params->on_done;
+    tween->user_data = params->user_data;
+    return tween->id;
+}
+
+ui_animation_id_t ui_animate_int(int *value, int to, const ui_animation_params_t *params)
+{
+    return value ? ui_animation_start(UI_TWEEN_INT, value, *value, to, params) : 0;
+}
+
+ui_animation_id_t ui_animate_double(double *value, double to, const ui_animation_params_t *params)
+{
+    return value ? ui_animation_start(UI_TWEEN_DOUBLE, value, *value, to, params) : 0;
+}
+
+ui_animation_id_t ui_animate_color(ui_color_t *value, ui_color_t to,
+                                   const ui_animation_params_t *params)
+{
+    /* colors keep both ends packed; channels are split per step */
+    return value ? ui_animation_start(UI_TWEEN_COLOR, value, *value, to, params) : 0;
+}
+
+static int ui_animation_lerp_channel(int from, int to, double eased)
+{
+    return from + (int)((to - from) * eased + (to >= from ? 0.5 : -0.5));
+}
+
+static ui_color_t ui_animation_lerp_color(ui_color_t from, ui_color_t to, double eased)
+{
+    int r = ui_animation_lerp_channel((from >> 11) & 0x1F, (to >> 11) & 0x1F, eased);
+    int g = ui_animation_lerp_channel((from >> 5) & 0x3F, (to >> 5) & 0x3F, eased);
+    int b = ui_animation_lerp_channel(from & 0x1F, to & 0x1F, eased);
+    return (ui_color_t)((r << 11) | (g << 5) | b);
+}
+
+static void ui_animation_step(ui_tween_t *tween, double delta_seconds)
+{
+    tween->elapsed += delta_seconds;
+    double t = tween->duration > 0.0 ? tween->elapsed / tween->duration : 1.0;
+    if (t >= 1.0) {
+        t = 1.0;
+        tween->finished = true;
+    }
+    double eased = ui_easing_apply(tween->easing, t);
+    switch (tween->kind) {
+    case UI_TWEEN_INT: {
+        double value = tween->from + (tween->to - tween->from) * eased;
+        *(int *)tween->value = (int)(value >= 0.0 ? value + 0.5 : value - 0.5);
+        break;
+    }
+    case UI_TWEEN_DOUBLE:
+        *(double *)tween->value =
+            tween->finished ? tween->to : tween->from + (tween->to - tween->from) * eased;
+        break;
+    case UI_TWEEN_COLOR:
+        *(ui_color_t *)tween->value = ui_animation_lerp_color(
+            (ui_color_t)tween->from, (ui_color_t)tween->to, eased);
+        break;
+    }
+    ui_widget_invalidate(tween->target);
+}
+
+bool ui_animation_tick(ui_widget_host_t *host, double delta_seconds)
+{
+    if (!host) {
+        return false;
+    }
+    if (delta_seconds < 0.0) {
+        delta_seconds = 0.0;
+    }
+    /* step first, then retire: completion callbacks may add or cancel tweens */
+    for (size_t i = 0; i < host->tween_count; ++i) {
+        ui_animation_step(&host->tweens[i], delta_seconds);
+    }
+    size_t i = 0;
+    while (i < host->tween_count) {
+        if (!host->tweens[i].finished) {
+            ++i;
+            continue;
+        }
+        ui_tween_t done = host->tweens[i];
+        ui_animation_remove_at(host, i);
+        if (done.on_done) {
+            done.on_done(done.user_data);
+        }
+    }
+    return host->tween_count > 0;
+}
+
+/* ids are per host, so a tween is named by its target and id together */
+static size_t ui_animation_find(const ui_widget_host_t *host, const ui_widget_t *target,
+                                ui_animation_id_t id)
+{
+    for (size_t i = 0; i < host->tween_count; ++i) {
+        if (host->tweens[i].id == id && host->tweens[i].target == target) {
+            return i;
+        }
+    }
+    return host->tween_count;
+}
+
+bool ui_animation_running(const ui_widget_t *target, ui_animation_id_t id)
+{
+    ui_widget_host_t *host = ui_widget_host(target);
+    if (!host || id == 0) {
+        return false;
+    }
+    return ui_animation_find(host, target, id) < host->tween_count;
+}
+
+void ui_animation_cancel(const ui_widget_t *target, ui_animation_id_t id)
+{
+    ui_widget_host_t *host = ui_widget_host(target);
+    if (!host || id == 0) {
+        return;
+    }
+    size_t index = ui_animation_find(host, target, id);
+    if (index < host->tween_count) {
+        ui_animation_remove_at(host, index);
+    }
+}
+
+void ui_animation_cancel_target(const ui_widget_t *target)
+{
+    ui_widget_host_t *host = ui_widget_host(target);
+    if (!host) {
+        return;
+    }
+    size_t i = 0;
+    while (i < host->tween_count) {
+        if (host->tweens[i].target == target) {
+            ui_animation_remove_at(host, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ui_animation_cancel_all(ui_widget_host_t *host)
+{
+    if (!host) {
+        return;
+    }
+    free(host->tweens);
+    host->tweens = NULL;
+    host->tween_count = 0;
+    host->tween_capacity = 0;
+}
+
+size_t ui_animation_count(const ui_widget_host_t *host)
+{
+    return host ? host->tween_count : 0;
+}
@@ -74,7 +74,8 @@ static bool ui_appbar_ensure_capacity(ui_appbar_t *appbar, size_t target)
     if (next < target) {
         next = target;
     }
-    ui_appbar_action_t *realloced = realloc(appbar->actions, next * sizeof(*appbar->actions));
+    ui_appbar_action_t *realloced =
+        ui_arena_realloc(appbar->base.arena, appbar->actions, next * sizeof(*appbar->actions));
     if (!realloced) {
         return false;
     }
@@ -93,7 +94,7 @@ static int ui_appbar_resolve_height(const ui_widget_t *widget, int content_heigh
     if (available < 0) {
         available = 0;
     }
-    int height = widget->bounds.height > 0 ? widget->bounds.height : available;
+    int height = widget->preferred_height > 0 ? widget->preferred_height : available;
     if (height > available) {
         height = available;
     }
@@ -110,9 +111,10 @@ static int ui_appbar_resolve_action_width(ui_widget_t *widget, int content_heigh
     if (fallback < 0) {
         fallback = 0;
     }
-    int width = widget->bounds.width > 0 ? widget->bounds.width : fallback;
-    if (width < 0) {
-        width = 0;
+    int width = 0;
+    ui_widget_measure(widget, 0, fallback, &width, NULL);
+    if (width <= 0) {
+        width = fallback;
     }
     return width;
 }
@@ -178,7 +180,7 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
         if (slot < 0) {
             slot = 0;
         }
-        int width = appbar->leading->bounds.width > 0 ? appbar->leading->bounds.width : slot;
+        int width = appbar->leading->preferred_width > 0 ? appbar->leading->preferred_width : slot;
         if (width > slot) {
             width = slot;
         }
@@ -192,10 +194,7 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
         if (slot > width) {
             x += (slot - width) / 2;
         }
-        appbar->leading->bounds.x = x;
-        appbar->leading->bounds.y = y;
-        appbar->leading->bounds.width = width;
-        appbar->leading->bounds.height = height;
+        ui_widget_place(appbar->leading, x, y, width, height);
     }
 
     int actions_spacing = appbar->action_count > 0 ? spacing : 0;
@@ -217,16 +216,13 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
         if (action_x < content_x) {
             action_x = content_x;
         }
-        action->bounds.x = action_x;
-        action->bounds.width = width;
         int height = ui_appbar_resolve_height(action, content_height);
         int y = content_y + action_style->margin_top;
         int extra = content_height - action_style->margin_top - action_style->margin_bottom - height;
         if (extra > 0) {
             y += extra / 2;
         }
-        action->bounds.y = y;
-        action->bounds.height = height;
+        ui_widget_place(action, action_x, y, width, height);
         layout_cursor = action_x - action_style->margin_left;
         if (layout_cursor < content_x) {
             layout_cursor = content_x;
@@ -251,11 +247,11 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
         if (available < 0) {
             available = 0;
         }
-        int width = appbar->title->bounds.width > 0 ? appbar->title->bounds.width : available;
+        int width = appbar->title->preferred_width > 0 ? appbar->title->preferred_width : available;
         if (width > available) {
             width = available;
         }
-        int x_base = title_start + title_style->margin_left;
+        int x = title_start + title_style->margin_left;
         if (appbar->center_title && width > 0) {
             int center = content_x + (content_width - width) / 2;
             int left_limit = title_start + title_style->margin_left;
@@ -269,15 +265,13 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
             if (center > right_limit) {
                 center = right_limit;
             }
-            appbar->title->bounds.x = center;
-        } else {
-            appbar->title->bounds.x = x_base;
+            x = center;
         }
         int available_height = content_height - title_style->margin_top - title_style->margin_bottom;
         if (available_height < 0) {
             available_height = 0;
         }
-        int height = appbar->title->bounds.height > 0 ? appbar->title->bounds.height : available_height;
+        int height = appbar->title->preferred_height > 0 ? appbar->title->preferred_height : available_height;
         if (height > available_height) {
             height = available_height;
         }
@@ -286,9 +280,7 @@ static void ui_appbar_layout(ui_appbar_t *appbar, const ui_rect_t *bounds)
         if (extra > 0) {
             y += extra / 2;
         }
-        appbar->title->bounds.y = y;
-        appbar->title->bounds.height = height;
-        appbar->title->bounds.width = width;
+        ui_widget_place(appbar->title, x, y, width, height);
     }
 }
 
@@ -302,23 +294,35 @@ static bool ui_appbar_render(ui_context_t *ctx, ui_widget_t *widget, const ui_re
         ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
                              appbar->bgcolor);
     }
-    ui_appbar_layout(appbar, bounds);
     return true;
 }
 
+static void ui_appbar_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    ui_appbar_layout((ui_appbar_t *)widget, bounds);
+}
+
 static const ui_widget_ops_t ui_appbar_ops = {
+    .name = "appbar",
     .render = ui_appbar_render,
     .handle_event = NULL,
-    .destroy = NULL
+    .destroy = NULL,
+    .arrange = ui_appbar_arrange
 };
 
 ui_appbar_t *ui_appbar_create(void)
 {
-    ui_appbar_t *appbar = calloc(1, sizeof(*appbar));
+    return ui_appbar_create_in(NULL);
+}
+
+ui_appbar_t *ui_appbar_create_in(ui_arena_t *arena)
+{
+    ui_appbar_t *appbar = ui_arena_alloc(arena, sizeof(*appbar));
     if (!appbar) {
         return NULL;
     }
     ui_appbar_init(appbar);
+    ui_widget_set_arena(&appbar->base, arena);
     return appbar;
 }
 
@@ -327,10 +331,9 @@ void ui_appbar_destroy(ui_appbar_t *appbar)
     if (!appbar) {
         return;
     }
-    if (appbar->actions) {
-        free(appbar->actions);
-    }
-    free(appbar);
+    ui_arena_free(appbar->base.arena, appbar->actions);
+    ui_widget_deinit(&appbar->base);
+    ui_arena_free(appbar->base.arena, appbar);
 }
 
 void ui_appbar_init(ui_appbar_t *appbar)
@@ -501,6 +504,7 @@ void ui_appbar_set_center_title(ui_appbar_t *appbar, bool center)
 {
     if (appbar) {
         appbar->center_title = center;
+        ui_widget_mark_needs_layout(&appbar->base);
     }
 }
 
@@ -513,6 +517,7 @@ void ui_appbar_set_title_spacing(ui_appbar_t *appbar, int spacing)
 {
     if (appbar) {
         appbar->title_spacing = spacing >= 0 ? spacing : UI_APPBAR_DEFAULT_TITLE_SPACING;
+        ui_widget_mark_needs_layout(&appbar->base);
     }
 }
 
@@ -525,6 +530,7 @@ void ui_appbar_set_leading_width(ui_appbar_t *appbar, int width)
 {
     if (appbar) {
         appbar->leading_width = width >= 0 ? width : UI_APPBAR_DEFAULT_LEADING_WIDTH;
+        ui_widget_mark_needs_layout(&appbar->base);
     }
 }
 
@@ -537,6 +543,7 @@ void ui_appbar_set_toolbar_height(ui_appbar_t *appbar, int height)
 {
     if (appbar) {
         appbar->toolbar_height = height >= 0 ? height : UI_APPBAR_DEFAULT_TOOLBAR_HEIGHT;
+        ui_widget_mark_needs_layout(&appbar->base);
     }
 }
 
@@ -554,6 +561,7 @@ void ui_appbar_set_toolbar_opacity(ui_appbar_t *appbar, double opacity)
             opacity = 1.0;
         }
         appbar->toolbar_opacity = opacity;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -566,6 +574,7 @@ void ui_appbar_set_background_color(ui_appbar_t *appbar, ui_color_t color)
 {
     if (appbar) {
         appbar->bgcolor = color;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -578,6 +587,7 @@ void ui_appbar_set_content_color(ui_appbar_t *appbar, ui_color_t color)
 {
     if (appbar) {
         appbar->content_color = color;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -590,6 +600,7 @@ void ui_appbar_set_force_material_transparency(ui_appbar_t *appbar, bool force)
 {
     if (appbar) {
         appbar->force_material_transparency = force;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -602,6 +613,7 @@ void ui_appbar_set_elevation(ui_appbar_t *appbar, double elevation)
 {
     if (appbar) {
         appbar->elevation = elevation;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -614,6 +626,7 @@ void ui_appbar_set_elevation_on_scroll(ui_appbar_t *appbar, double elevation)
 {
     if (appbar) {
         appbar->elevation_on_scroll = elevation;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -626,6 +639,7 @@ void ui_appbar_set_shadow_color(ui_appbar_t *appbar, ui_color_t color)
 {
     if (appbar) {
         appbar->shadow_color = color;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -638,6 +652,7 @@ void ui_appbar_set_surface_tint_color(ui_appbar_t *appbar, ui_color_t color)
 {
     if (appbar) {
         appbar->surface_tint_color = color;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
@@ -650,6 +665,7 @@ void ui_appbar_set_clip_behavior(ui_appbar_t *appbar, ui_appbar_clip_behavior_t
 {
     if (appbar) {
         appbar->clip_behavior = behavior;
+        ui_widget_invalidate(&appbar->base);
     }
 }
 
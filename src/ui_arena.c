@@ -0,0 +1,343 @@
+#include "ui_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Roughly 1.5x steps keep rounding waste under a third of a block. */
+static const size_t ui_arena_classes[] = {16,  32,  48,  64,   96,   128,  192, 256,
+                                          384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+#define UI_ARENA_CLASS_COUNT (sizeof(ui_arena_classes) / sizeof(ui_arena_classes[0]))
+#define UI_ARENA_LARGE UINT32_MAX
+
+typedef union {
+    struct {
+        uint32_t size_class;
+        size_t size;
+    } info;
+    long double align_ld;
+    long long align_ll;
+    void *align_ptr;
+} ui_arena_header_t;
+
+typedef struct ui_arena_free_block {
+    struct ui_arena_free_block *next;
+} ui_arena_free_block_t;
+
+typedef struct ui_arena_chunk {
+    struct ui_arena_chunk *next;
+    unsigned char *cursor;
+    unsigned char *end;
+} ui_arena_chunk_t;
+
+typedef union ui_arena_large {
+    struct {
+        union ui_arena_large *prev;
+        union ui_arena_large *next;
+    } link;
+    ui_arena_header_t align;
+} ui_arena_large_t;
+
+struct ui_arena {
+    size_t chunk_size;
+    ui_arena_chunk_t *chunks; /* oldest first */
+    ui_arena_chunk_t *tail;
+    ui_arena_chunk_t *current;
+    ui_arena_large_t *large;
+    ui_arena_free_block_t *free_lists[UI_ARENA_CLASS_COUNT];
+    ui_arena_finalizer_t *finalizers; /* newest first */
+    ui_arena_stats_t stats;
+};
+
+#define UI_ARENA_ALIGN sizeof(ui_arena_header_t)
+
+static size_t ui_arena_align_up(size_t value)
+{
+    return (value + UI_ARENA_ALIGN - 1) / UI_ARENA_ALIGN * UI_ARENA_ALIGN;
+}
+
+static uint32_t ui_arena_class_of(size_t size)
+{
+    for (uint32_t i = 0; i < UI_ARENA_CLASS_COUNT; ++i) {
+        if (size <= ui_arena_classes[i]) {
+            return i;
+        }
+    }
+    return UI_ARENA_LARGE;
+}
+
+static unsigned char *ui_arena_chunk_start(ui_arena_chunk_t *chunk)
+{
+    return (unsigned char *)chunk + ui_arena_align_up(sizeof(ui_arena_chunk_t));
+}
+
+static ui_arena_header_t *ui_arena_header(void *ptr)
+{
+    return (ui_arena_header_t *)ptr - 1;
+}
+
+ui_arena_t *ui_arena_create(size_t chunk_size)
+{
+    ui_arena_t *arena = calloc(1, sizeof(*arena));
+    if (!arena) {
+        return NULL;
+    }
+    size_t minimum = sizeof(ui_arena_header_t) + ui_arena_classes[UI_ARENA_CLASS_COUNT - 1];
+    arena->chunk_size = chunk_size ? chunk_size : UI_ARENA_DEFAULT_CHUNK;
+    if (arena->chunk_size < minimum) {
+        arena->chunk_size = minimum;
+    }
+    return arena;
+}
+
+static void ui_arena_free_large_blocks(ui_arena_t *arena)
+{
+    ui_arena_large_t *large = arena->large;
+    while (large) {
+        ui_arena_large_t *next = large->link.next;
+        free(large);
+        large = next;
+    }
+    arena->large = NULL;
+}
+
+/* A finalizer may free blocks or unregister other nodes, so the head is
+ * unlinked before its fn runs and the list is re-read each time. */
+static void ui_arena_run_finalizers(ui_arena_t *arena)
+{
+    while (arena->finalizers) {
+        ui_arena_finalizer_t *node = arena->finalizers;
+        ui_arena_remove_finalizer(arena, node);
+        node->fn(node);
+    }
+}
+
+void ui_arena_destroy(ui_arena_t *arena)
+{
+    if (!arena) {
+        return;
+    }
+    ui_arena_run_finalizers(arena);
+    ui_arena_chunk_t *chunk = arena->chunks;
+    while (chunk) {
+        ui_arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    ui_arena_free_large_blocks(arena);
+    free(arena);
+}
+
+void ui_arena_reset(ui_arena_t *arena)
+{
+    if (!arena) {
+        return;
+    }
+    ui_arena_run_finalizers(arena);
+    for (ui_arena_chunk_t *chunk = arena->chunks; chunk; chunk = chunk->next) {
+        chunk->cursor = ui_arena_chunk_start(chunk);
+    }
+    arena->current = arena->chunks;
+    ui_arena_free_large_blocks(arena);
+    memset(arena->free_lists, 0, sizeof(arena->free_lists));
+    arena->stats.consumed = 0;
+    arena->stats.live = 0;
+    arena->stats.free = 0;
+    arena->stats.large_blocks = 0;
+    arena->stats.large_bytes = 0;
+}
+
+static void *ui_arena_bump(ui_arena_t *arena, size_t bytes)
+{
+    ui_arena_chunk_t *chunk = arena->current;
+    /* the rest of a full chunk is abandoned; blocks never span chunks */
+    while (chunk && (size_t)(chunk->end - chunk->cursor) < bytes) {
+        chunk = chunk->next;
+    }
+    if (!chunk) {
+        size_t head = ui_arena_align_up(sizeof(ui_arena_chunk_t));
+        chunk = malloc(head + arena->chunk_size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->cursor = ui_arena_chunk_start(chunk);
+        chunk->end = chunk->cursor + arena->chunk_size;
+        chunk->next = NULL;
+        if (arena->tail) {
+            arena->tail->next = chunk;
+        } else {
+            arena->chunks = chunk;
+        }
+        arena->tail = chunk;
+        arena->stats.chunks++;
+        arena->stats.reserved += head + arena->chunk_size;
+    }
+    arena->current = chunk;
+    void *block = chunk->cursor;
+    chunk->cursor += bytes;
+    arena->stats.consumed += bytes;
+    return block;
+}
+
+static void *ui_arena_alloc_large(ui_arena_t *arena, size_t size)
+{
+    ui_arena_large_t *large = malloc(sizeof(*large) + sizeof(ui_arena_header_t) + size);
+    if (!large) {
+        return NULL;
+    }
+    large->link.prev = NULL;
+    large->link.next = arena->large;
+    if (arena->large) {
+        arena->large->link.prev = large;
+    }
+    arena->large = large;
+    arena->stats.large_blocks++;
+    arena->stats.large_bytes += size;
+
+    ui_arena_header_t *header = (ui_arena_header_t *)(large + 1);
+    header->info.size_class = UI_ARENA_LARGE;
+    header->info.size = size;
+    memset(header + 1, 0, size);
+    return header + 1;
+}
+
+void *ui_arena_alloc(ui_arena_t *arena, size_t size)
+{
+    if (!arena) {
+        return calloc(1, size ? size : 1);
+    }
+    uint32_t size_class = ui_arena_class_of(size);
+    if (size_class == UI_ARENA_LARGE) {
+        return ui_arena_alloc_large(arena, size);
+    }
+    size_t class_size = ui_arena_classes[size_class];
+    ui_arena_header_t *header;
+    ui_arena_free_block_t *reused = arena->free_lists[size_class];
+    if (reused) {
+        arena->free_lists[size_class] = reused->next;
+        arena->stats.free -= class_size;
+        header = ui_arena_header(reused);
+    } else {
+        header = ui_arena_bump(arena, sizeof(ui_arena_header_t) + class_size);
+        if (!header) {
+            return NULL;
+        }
+        header->info.size_class = size_class;
+    }
+    header->info.size = class_size;
+    arena->stats.live += class_size;
+    memset(header + 1, 0, class_size);
+    return header + 1;
+}
+
+void ui_arena_free(ui_arena_t *arena, void *ptr)
+{
+    if (!arena) {
+        free(ptr);
+        return;
+    }
+    if (!ptr) {
+        return;
+    }
+    ui_arena_header_t *header = ui_arena_header(ptr);
+    if (header->info.size_class == UI_ARENA_LARGE) {
+        ui_arena_large_t *large = (ui_arena_large_t *)header - 1;
+        if (large->link.prev) {
+            large->link.prev->link.next = large->link.next;
+        } else {
+            arena->large = large->link.next;
+        }
+        if (large->link.next) {
+            large->link.next->link.prev = large->link.prev;
+        }
+        arena->stats.large_blocks--;
+        arena->stats.large_bytes -= header->info.size;
+        free(large);
+        return;
+    }
+    size_t class_size = ui_arena_classes[header->info.size_class];
+    ui_arena_free_block_t *block = ptr;
+    block->next = arena->free_lists[header->info.size_class];
+    arena->free_lists[header->info.size_class] = block;
+    arena->stats.live -= class_size;
+    arena->stats.free += class_size;
+}
+
+void *ui_arena_realloc(ui_arena_t *arena, void *ptr, size_t size)
+{
+    if (!arena) {
+        return realloc(ptr, size);
+    }
+    if (!ptr) {
+        return ui_arena_alloc(arena, size);
+    }
+    size_t current = ui_arena_header(ptr)->info.size;
+    if (size <= current) {
+        return ptr;
+    }
+    void *moved = ui_arena_alloc(arena, size);
+    if (!moved) {
+        return NULL;
+    }
+    memcpy(moved, ptr, current < size ? current : size);
+    ui_arena_free(arena, ptr);
+    return moved;
+}
+
+char *ui_arena_strdup(ui_arena_t *arena, const char *value)
+{
+    if (!value) {
+        return NULL;
+    }
+    size_t len = strlen(value) + 1;
+    char *copy = arena ? ui_arena_alloc(arena, len) : malloc(len);
+    if (copy) {
+        memcpy(copy, value, len);
+    }
+    return copy;
+}
+
+void ui_arena_add_finalizer(ui_arena_t *arena, ui_arena_finalizer_t *node,
+                            void (*fn)(ui_arena_finalizer_t *node))
+{
+    if (!arena || !node || !fn) {
+        return;
+    }
+    ui_arena_remove_finalizer(arena, node);
+    node->fn = fn;
+    node->prev = NULL;
+    node->next = arena->finalizers;
+    if (arena->finalizers) {
+        arena->finalizers->prev = node;
+    }
+    arena->finalizers = node;
+}
+
+void ui_arena_remove_finalizer(ui_arena_t *arena, ui_arena_finalizer_t *node)
+{
+    if (!arena || !node || (!node->prev && arena->finalizers != node)) {
+        return;
+    }
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        arena->finalizers = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    node->prev = NULL;
+    node->next = NULL;
+}
+
+void ui_arena_stats(const ui_arena_t *arena, ui_arena_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (!arena) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = arena->stats;
+}
@@ -1,5 +1,3 @@
-#define _POSIX_C_SOURCE 200809L
-
 #include "ui_button.h"
 
 #include <stdbool.h>
@@ -7,10 +5,10 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "ui_primitives.h"
 #include "ui_font.h"
+#include "ui_shaped_text.h"
 #include "ui_shadow.h"
 
 #define UI_BUTTON_LONG_PRESS_MS 500
@@ -18,6 +16,7 @@
 struct ui_button {
     ui_widget_t base;
     char *text;
+    ui_shaped_text_t shaped_text;
     const bareui_font_t *font;
     ui_color_t background_color;
     ui_color_t text_color;
@@ -28,10 +27,9 @@ struct ui_button {
     bool hovered;
     bool pressed;
     bool focused;
-    bool autofocus;
     bool enabled;
     bool rtl;
-    struct timespec pressed_at;
+    double pressed_at; /* event clock, seconds */
     bool long_press_fired;
     ui_button_event_fn on_click;
     void *on_click_data;
@@ -57,59 +55,12 @@ static inline bool ui_button_contains(const ui_button_t *button, int x, int y)
            x < bounds->x + bounds->width && y < bounds->y + bounds->height;
 }
 
-static bool ui_button_next_codepoint(const unsigned char **ptr, uint32_t *out)
+static int ui_button_measure_text(ui_button_t *button)
 {
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t codepoint = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-        // ASCII
-    } else if ((first & 0xE0) == 0xC0) {
-        codepoint &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        codepoint &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        codepoint &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        codepoint = (codepoint << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = codepoint;
-    }
-    return true;
-}
-
-static int ui_button_measure_text(const ui_button_t *button)
-{
-    const char *text = button && button->text ? button->text : "";
-    const bareui_font_t *font = button && button->font ? button->font : bareui_font_default();
-    const unsigned char *ptr = (const unsigned char *)text;
-    int width = 0;
-    while (*ptr) {
-        uint32_t cp;
-        if (!ui_button_next_codepoint(&ptr, &cp)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
-        }
+    if (!button) {
+        return 0;
     }
-    return width;
+    return ui_shaped_text_ensure(&button->shaped_text, button->font, button->text);
 }
 
 static void ui_button_draw_text(ui_context_t *ctx, const ui_button_t *button, int x, int y,
@@ -118,11 +69,7 @@ static void ui_button_draw_text(ui_context_t *ctx, const ui_button_t *button, in
     if (!button || !button->text) {
         return;
     }
-    const bareui_font_t *font = button->font ? button->font : bareui_font_default();
-    const bareui_font_t *prev = ui_context_font(ctx);
-    ui_context_set_font(ctx, font);
-    ui_context_draw_text(ctx, x, y, button->text, color);
-    ui_context_set_font(ctx, prev);
+    ui_context_draw_shaped_text(ctx, x, y, &button->shaped_text, color);
 }
 
 static void ui_button_apply_style(ui_widget_t *widget, const ui_style_t *style)
@@ -179,16 +126,14 @@ static void ui_button_notify_focus(ui_button_t *button, bool focus_state)
     }
 }
 
-static void ui_button_try_long_press(ui_button_t *button)
+/* Measured on event timestamps, so scripted input replays the same way. */
+static void ui_button_try_long_press(ui_button_t *button, const ui_event_t *event)
 {
     if (!button || button->long_press_fired || !button->pressed) {
         return;
     }
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    long delta_ms = (now.tv_sec - button->pressed_at.tv_sec) * 1000 +
-                    (now.tv_nsec - button->pressed_at.tv_nsec) / 1000000;
-    if (delta_ms >= UI_BUTTON_LONG_PRESS_MS) {
+    double held_ms = (ui_event_seconds(event) - button->pressed_at) * 1000.0;
+    if (held_ms >= UI_BUTTON_LONG_PRESS_MS) {
         button->long_press_fired = true;
         if (button->on_long_press) {
             button->on_long_press(button, button->on_long_press_data);
@@ -222,7 +167,7 @@ static bool ui_button_handle_event(ui_widget_t *widget, const ui_event_t *event)
             return false;
         }
         button->pressed = true;
-        clock_gettime(CLOCK_MONOTONIC, &button->pressed_at);
+        button->pressed_at = ui_event_seconds(event);
         button->long_press_fired = false;
         ui_button_notify_focus(button, true);
         ui_button_notify_hover(button, true);
@@ -234,7 +179,7 @@ static bool ui_button_handle_event(ui_widget_t *widget, const ui_event_t *event)
         if (!inside && button->pressed) {
             button->pressed = false;
         }
-        ui_button_try_long_press(button);
+        ui_button_try_long_press(button, event);
         return inside;
     }
     case UI_EVENT_TOUCH_UP: {
@@ -254,7 +199,7 @@ static bool ui_button_handle_event(ui_widget_t *widget, const ui_event_t *event)
         uint32_t key = event->data.key.keycode;
         if (key == ' ' || key == '\n' || key == '\r') {
             button->pressed = true;
-            clock_gettime(CLOCK_MONOTONIC, &button->pressed_at);
+            button->pressed_at = ui_event_seconds(event);
             button->long_press_fired = false;
             ui_button_notify_focus(button, true);
             return true;
@@ -284,7 +229,7 @@ static bool ui_button_render(ui_context_t *ctx, ui_widget_t *widget, const ui_re
     if (!button || !bounds) {
         return false;
     }
-    const ui_style_t *style = &button->base.style;
+    const ui_style_t *style = button->base.style;
     const ui_box_shadow_t *shadow = &button->box_shadow;
     if (style->flags & UI_STYLE_FLAG_BOX_SHADOW) {
         shadow = &style->box_shadow;
@@ -346,33 +291,49 @@ static bool ui_button_render(ui_context_t *ctx, ui_widget_t *widget, const ui_re
     return true;
 }
 
+static void ui_button_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                              int *height)
+{
+    (void)max_width;
+    (void)max_height;
+    ui_button_t *button = (ui_button_t *)widget;
+    const ui_style_t *style = widget->style;
+    int border = button->border_width > 0 ? button->border_width * 2 : 0;
+    const bareui_font_t *font = button->font ? button->font : bareui_font_default();
+    *width = ui_button_measure_text(button) + style->padding_left + style->padding_right + border;
+    *height = font->height + style->padding_top + style->padding_bottom + border;
+}
+
+static void ui_button_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_button_notify_focus((ui_button_t *)widget, focused);
+}
+
 static const ui_widget_ops_t ui_button_ops = {
+    .name = "button",
     .render = ui_button_render,
     .handle_event = ui_button_handle_event,
     .destroy = NULL,
-    .style_changed = ui_button_apply_style
+    .style_changed = ui_button_apply_style,
+    .measure = ui_button_measure,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_button_focus_changed
 };
 
-static char *ui_button_copy_text(const char *text)
+ui_button_t *ui_button_create(void)
 {
-    if (!text) {
-        return NULL;
-    }
-    size_t len = strlen(text) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, text, len);
-    }
-    return copy;
+    return ui_button_create_in(NULL);
 }
 
-ui_button_t *ui_button_create(void)
+ui_button_t *ui_button_create_in(ui_arena_t *arena)
 {
-    ui_button_t *button = calloc(1, sizeof(*button));
+    ui_button_t *button = ui_arena_alloc(arena, sizeof(*button));
     if (!button) {
         return NULL;
     }
     ui_button_init(button);
+    ui_widget_set_arena(&button->base, arena);
+    button->shaped_text.arena = arena;
     return button;
 }
 
@@ -381,8 +342,10 @@ void ui_button_destroy(ui_button_t *button)
     if (!button) {
         return;
     }
-    free(button->text);
-    free(button);
+    ui_arena_free(button->base.arena, button->text);
+    ui_shaped_text_release(&button->shaped_text);
+    ui_widget_deinit(&button->base);
+    ui_arena_free(button->base.arena, button);
 }
 
 void ui_button_init(ui_button_t *button)
@@ -392,6 +355,7 @@ void ui_button_init(ui_button_t *button)
     }
     ui_widget_init(&button->base, &ui_button_ops);
     button->text = NULL;
+    ui_shaped_text_init(&button->shaped_text);
     button->font = bareui_font_default();
     button->background_color = ui_color_from_hex(0x202020);
     button->text_color = ui_color_from_hex(0xFFFFFF);
@@ -402,7 +366,7 @@ void ui_button_init(ui_button_t *button)
     button->hovered = false;
     button->pressed = false;
     button->focused = false;
-    button->autofocus = false;
+    ui_widget_set_focusable(&button->base, true);
     button->enabled = true;
     button->rtl = false;
     button->long_press_fired = false;
@@ -435,8 +399,10 @@ void ui_button_set_text(ui_button_t *button, const char *text)
     if (!button) {
         return;
     }
-    free(button->text);
-    button->text = ui_button_copy_text(text);
+    ui_arena_free(button->base.arena, button->text);
+    button->text = ui_arena_strdup(button->base.arena, text);
+    ui_shaped_text_shape(&button->shaped_text, button->font, button->text);
+    ui_widget_invalidate_measure(&button->base);
 }
 
 const char *ui_button_text(const ui_button_t *button)
@@ -448,6 +414,8 @@ void ui_button_set_font(ui_button_t *button, const bareui_font_t *font)
 {
     if (button) {
         button->font = font ? font : bareui_font_default();
+        ui_shaped_text_invalidate(&button->shaped_text);
+        ui_widget_invalidate_measure(&button->base);
     }
 }
 
@@ -462,12 +430,10 @@ void ui_button_set_background_color(ui_button_t *button, ui_color_t color)
         return;
     }
     button->background_color = color;
-    ui_style_t *style = &button->base.style;
-    style->background_color = color;
-    style->flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
-    if (button->base.ops && button->base.ops->style_changed) {
-        button->base.ops->style_changed(&button->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&button->base);
+    style.background_color = color;
+    style.flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
+    ui_widget_set_style(&button->base, &style);
 }
 
 ui_color_t ui_button_background_color(const ui_button_t *button)
@@ -481,12 +447,10 @@ void ui_button_set_text_color(ui_button_t *button, ui_color_t color)
         return;
     }
     button->text_color = color;
-    ui_style_t *style = &button->base.style;
-    style->foreground_color = color;
-    style->flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
-    if (button->base.ops && button->base.ops->style_changed) {
-        button->base.ops->style_changed(&button->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&button->base);
+    style.foreground_color = color;
+    style.flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
+    ui_widget_set_style(&button->base, &style);
 }
 
 ui_color_t ui_button_text_color(const ui_button_t *button)
@@ -500,12 +464,10 @@ void ui_button_set_hover_color(ui_button_t *button, ui_color_t color)
         return;
     }
     button->hover_color = color;
-    ui_style_t *style = &button->base.style;
-    style->accent_color = color;
-    style->flags |= UI_STYLE_FLAG_ACCENT_COLOR;
-    if (button->base.ops && button->base.ops->style_changed) {
-        button->base.ops->style_changed(&button->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&button->base);
+    style.accent_color = color;
+    style.flags |= UI_STYLE_FLAG_ACCENT_COLOR;
+    ui_widget_set_style(&button->base, &style);
 }
 
 ui_color_t ui_button_hover_color(const ui_button_t *button)
@@ -519,12 +481,10 @@ void ui_button_set_pressed_color(ui_button_t *button, ui_color_t color)
         return;
     }
     button->pressed_color = color;
-    ui_style_t *style = &button->base.style;
-    style->border_color = color;
-    style->flags |= UI_STYLE_FLAG_BORDER_COLOR;
-    if (button->base.ops && button->base.ops->style_changed) {
-        button->base.ops->style_changed(&button->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&button->base);
+    style.border_color = color;
+    style.flags |= UI_STYLE_FLAG_BORDER_COLOR;
+    ui_widget_set_style(&button->base, &style);
 }
 
 ui_color_t ui_button_pressed_color(const ui_button_t *button)
@@ -565,19 +525,20 @@ void ui_button_set_filled_style(ui_button_t *button, ui_color_t background,
 void ui_button_set_autofocus(ui_button_t *button, bool autofocus)
 {
     if (button) {
-        button->autofocus = autofocus;
+        ui_widget_set_autofocus(&button->base, autofocus);
     }
 }
 
 bool ui_button_autofocus(const ui_button_t *button)
 {
-    return button ? button->autofocus : false;
+    return button ? button->base.autofocus : false;
 }
 
 void ui_button_set_rtl(ui_button_t *button, bool rtl)
 {
     if (button) {
         button->rtl = rtl;
+        ui_widget_invalidate(&button->base);
     }
 }
 
@@ -590,6 +551,8 @@ void ui_button_set_enabled(ui_button_t *button, bool enabled)
 {
     if (button) {
         button->enabled = enabled;
+        ui_widget_set_focusable(&button->base, enabled);
+        ui_widget_invalidate(&button->base);
     }
 }
 
@@ -7,17 +7,19 @@
 #include <stddef.h>
 
 #include "ui_primitives.h"
+#include "ui_shaped_text.h"
+#include "ui_text_engine.h"
 
 struct ui_checkbox {
     ui_widget_t base;
     char *label;
+    ui_shaped_text_t shaped_label;
     const bareui_font_t *font;
     ui_checkbox_state_t state;
     bool tristate;
     bool hovered;
     bool pressed;
     bool focused;
-    bool autofocus;
     bool enabled;
     bool is_error;
     ui_color_t active_color;
@@ -34,60 +36,12 @@ struct ui_checkbox {
     void *on_blur_data;
 };
 
-static bool ui_checkbox_next_codepoint(const unsigned char **ptr, uint32_t *out)
+static int ui_checkbox_measure_label(ui_checkbox_t *checkbox)
 {
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t codepoint = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-    } else if ((first & 0xE0) == 0xC0) {
-        codepoint &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        codepoint &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        codepoint &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        codepoint = (codepoint << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = codepoint;
-    }
-    return true;
-}
-
-static int ui_checkbox_measure_text(const ui_checkbox_t *checkbox, const char *text)
-{
-    if (!checkbox || !text) {
+    if (!checkbox || !checkbox->label) {
         return 0;
     }
-    const bareui_font_t *font = checkbox->font ? checkbox->font : bareui_font_default();
-    const unsigned char *ptr = (const unsigned char *)text;
-    int width = 0;
-    while (*ptr) {
-        uint32_t codepoint;
-        if (!ui_checkbox_next_codepoint(&ptr, &codepoint)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, codepoint, &glyph)) {
-            width += glyph.spacing;
-        }
-    }
-    return width;
+    return ui_shaped_text_ensure(&checkbox->shaped_label, checkbox->font, checkbox->label);
 }
 
 static bool ui_checkbox_contains(const ui_checkbox_t *checkbox, int x, int y)
@@ -171,6 +125,7 @@ static void ui_checkbox_set_state_internal(ui_checkbox_t *checkbox, ui_checkbox_
         return;
     }
     checkbox->state = state;
+    ui_widget_invalidate(&checkbox->base);
     if (notify && checkbox->on_change) {
         checkbox->on_change(checkbox, state, checkbox->on_change_data);
     }
@@ -263,7 +218,7 @@ static bool ui_checkbox_render(ui_context_t *ctx, ui_widget_t *widget, const ui_
         box_size = bounds->width;
     }
 
-    int label_width = checkbox->label ? ui_checkbox_measure_text(checkbox, checkbox->label) : 0;
+    int label_width = ui_checkbox_measure_label(checkbox);
     int label_gap = 6;
     int box_x = bounds->x + 2;
     int box_y = bounds->y + (bounds->height - box_size) / 2;
@@ -324,11 +279,7 @@ static bool ui_checkbox_render(ui_context_t *ctx, ui_widget_t *widget, const ui_
     }
     if (icon) {
         const bareui_font_t *font = checkbox->font ? checkbox->font : bareui_font_default();
-        bareui_font_glyph_t glyph;
-        int icon_width = 0;
-        if (bareui_font_lookup(font, (uint32_t)icon[0], &glyph)) {
-            icon_width = glyph.spacing;
-        }
+        int icon_width = ui_text_engine_advance(font, (uint32_t)icon[0]);
         if (icon_width <= 0) {
             icon_width = font ? font->height : BAREUI_FONT_HEIGHT;
         }
@@ -358,8 +309,6 @@ static bool ui_checkbox_render(ui_context_t *ctx, ui_widget_t *widget, const ui_
 
     if (checkbox->label && *checkbox->label) {
         const bareui_font_t *font = checkbox->font ? checkbox->font : bareui_font_default();
-        const bareui_font_t *prev_font = ui_context_font(ctx);
-        ui_context_set_font(ctx, font);
         ui_color_t label_color = ui_color_from_hex(0xF5F5F5);
         if (style && (style->flags & UI_STYLE_FLAG_FOREGROUND_COLOR)) {
             label_color = style->foreground_color;
@@ -368,40 +317,41 @@ static bool ui_checkbox_render(ui_context_t *ctx, ui_widget_t *widget, const ui_
         if (label_y < bounds->y) {
             label_y = bounds->y;
         }
-        ui_context_draw_text(ctx, label_x, label_y, checkbox->label, label_color);
-        ui_context_set_font(ctx, prev_font);
+        ui_context_draw_shaped_text(ctx, label_x, label_y, &checkbox->shaped_label, label_color);
     }
 
     return true;
 }
 
+static void ui_checkbox_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_checkbox_notify_focus((ui_checkbox_t *)widget, focused);
+}
+
 static const ui_widget_ops_t ui_checkbox_ops = {
+    .name = "checkbox",
     .render = ui_checkbox_render,
     .handle_event = ui_checkbox_handle_event,
     .destroy = NULL,
-    .style_changed = ui_checkbox_apply_style
+    .style_changed = ui_checkbox_apply_style,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_checkbox_focus_changed
 };
 
-static char *ui_checkbox_copy_label(const char *label)
+ui_checkbox_t *ui_checkbox_create(void)
 {
-    if (!label) {
-        return NULL;
-    }
-    size_t len = strlen(label) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, label, len);
-    }
-    return copy;
+    return ui_checkbox_create_in(NULL);
 }
 
-ui_checkbox_t *ui_checkbox_create(void)
+ui_checkbox_t *ui_checkbox_create_in(ui_arena_t *arena)
 {
-    ui_checkbox_t *checkbox = calloc(1, sizeof(*checkbox));
+    ui_checkbox_t *checkbox = ui_arena_alloc(arena, sizeof(*checkbox));
     if (!checkbox) {
         return NULL;
     }
     ui_checkbox_init(checkbox);
+    ui_widget_set_arena(&checkbox->base, arena);
+    checkbox->shaped_label.arena = arena;
     return checkbox;
 }
 
@@ -410,8 +360,10 @@ void ui_checkbox_destroy(ui_checkbox_t *checkbox)
     if (!checkbox) {
         return;
     }
-    free(checkbox->label);
-    free(checkbox);
+    ui_arena_free(checkbox->base.arena, checkbox->label);
+    ui_shaped_text_release(&checkbox->shaped_label);
+    ui_widget_deinit(&checkbox->base);
+    ui_arena_free(checkbox->base.arena, checkbox);
 }
 
 void ui_checkbox_init(ui_checkbox_t *checkbox)
@@ -421,13 +373,14 @@ void ui_checkbox_init(ui_checkbox_t *checkbox)
     }
     ui_widget_init(&checkbox->base, &ui_checkbox_ops);
     checkbox->label = NULL;
+    ui_shaped_text_init(&checkbox->shaped_label);
     checkbox->font = bareui_font_default();
     checkbox->state = UI_CHECKBOX_STATE_UNCHECKED;
     checkbox->tristate = false;
     checkbox->hovered = false;
     checkbox->pressed = false;
     checkbox->focused = false;
-    checkbox->autofocus = false;
+    ui_widget_set_focusable(&checkbox->base, true);
     checkbox->enabled = true;
     checkbox->is_error = false;
     checkbox->active_color = ui_color_from_hex(0x5992FF);
@@ -475,6 +428,7 @@ void ui_checkbox_set_tristate(ui_checkbox_t *checkbox, bool tristate)
     if (!tristate && checkbox->state == UI_CHECKBOX_STATE_INDETERMINATE) {
         checkbox->state = UI_CHECKBOX_STATE_UNCHECKED;
     }
+    ui_widget_invalidate(&checkbox->base);
 }
 
 bool ui_checkbox_tristate(const ui_checkbox_t *checkbox)
@@ -488,12 +442,10 @@ void ui_checkbox_set_active_color(ui_checkbox_t *checkbox, ui_color_t color)
         return;
     }
     checkbox->active_color = color;
-    ui_style_t *style = &checkbox->base.style;
-    style->accent_color = color;
-    style->flags |= UI_STYLE_FLAG_ACCENT_COLOR;
-    if (checkbox->base.ops && checkbox->base.ops->style_changed) {
-        checkbox->base.ops->style_changed(&checkbox->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&checkbox->base);
+    style.accent_color = color;
+    style.flags |= UI_STYLE_FLAG_ACCENT_COLOR;
+    ui_widget_set_style(&checkbox->base, &style);
 }
 
 ui_color_t ui_checkbox_active_color(const ui_checkbox_t *checkbox)
@@ -507,12 +459,10 @@ void ui_checkbox_set_fill_color(ui_checkbox_t *checkbox, ui_color_t color)
         return;
     }
     checkbox->fill_color = color;
-    ui_style_t *style = &checkbox->base.style;
-    style->background_color = color;
-    style->flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
-    if (checkbox->base.ops && checkbox->base.ops->style_changed) {
-        checkbox->base.ops->style_changed(&checkbox->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&checkbox->base);
+    style.background_color = color;
+    style.flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
+    ui_widget_set_style(&checkbox->base, &style);
 }
 
 ui_color_t ui_checkbox_fill_color(const ui_checkbox_t *checkbox)
@@ -526,12 +476,10 @@ void ui_checkbox_set_border_color(ui_checkbox_t *checkbox, ui_color_t color)
         return;
     }
     checkbox->border_color = color;
-    ui_style_t *style = &checkbox->base.style;
-    style->border_color = color;
-    style->flags |= UI_STYLE_FLAG_BORDER_COLOR;
-    if (checkbox->base.ops && checkbox->base.ops->style_changed) {
-        checkbox->base.ops->style_changed(&checkbox->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&checkbox->base);
+    style.border_color = color;
+    style.flags |= UI_STYLE_FLAG_BORDER_COLOR;
+    ui_widget_set_style(&checkbox->base, &style);
 }
 
 ui_color_t ui_checkbox_border_color(const ui_checkbox_t *checkbox)
@@ -545,12 +493,10 @@ void ui_checkbox_set_check_color(ui_checkbox_t *checkbox, ui_color_t color)
         return;
     }
     checkbox->check_color = color;
-    ui_style_t *style = &checkbox->base.style;
-    style->foreground_color = color;
-    style->flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
-    if (checkbox->base.ops && checkbox->base.ops->style_changed) {
-        checkbox->base.ops->style_changed(&checkbox->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&checkbox->base);
+    style.foreground_color = color;
+    style.flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
+    ui_widget_set_style(&checkbox->base, &style);
 }
 
 ui_color_t ui_checkbox_check_color(const ui_checkbox_t *checkbox)
@@ -562,6 +508,7 @@ void ui_checkbox_set_hover_color(ui_checkbox_t *checkbox, ui_color_t color)
 {
     if (checkbox) {
         checkbox->hover_color = color;
+        ui_widget_invalidate(&checkbox->base);
     }
 }
 
@@ -575,8 +522,10 @@ void ui_checkbox_set_label(ui_checkbox_t *checkbox, const char *label)
     if (!checkbox) {
         return;
     }
-    free(checkbox->label);
-    checkbox->label = ui_checkbox_copy_label(label);
+    ui_arena_free(checkbox->base.arena, checkbox->label);
+    checkbox->label = ui_arena_strdup(checkbox->base.arena, label);
+    ui_shaped_text_shape(&checkbox->shaped_label, checkbox->font, checkbox->label);
+    ui_widget_invalidate(&checkbox->base);
 }
 
 const char *ui_checkbox_label(const ui_checkbox_t *checkbox)
@@ -589,6 +538,7 @@ void ui_checkbox_set_label_position(ui_checkbox_t *checkbox,
 {
     if (checkbox) {
         checkbox->label_position = position;
+        ui_widget_invalidate(&checkbox->base);
     }
 }
 
@@ -601,6 +551,8 @@ void ui_checkbox_set_font(ui_checkbox_t *checkbox, const bareui_font_t *font)
 {
     if (checkbox) {
         checkbox->font = font ? font : bareui_font_default();
+        ui_shaped_text_invalidate(&checkbox->shaped_label);
+        ui_widget_invalidate(&checkbox->base);
     }
 }
 
@@ -613,6 +565,8 @@ void ui_checkbox_set_enabled(ui_checkbox_t *checkbox, bool enabled)
 {
     if (checkbox) {
         checkbox->enabled = enabled;
+        ui_widget_set_focusable(&checkbox->base, enabled);
+        ui_widget_invalidate(&checkbox->base);
     }
 }
 
@@ -624,19 +578,20 @@ bool ui_checkbox_enabled(const ui_checkbox_t *checkbox)
 void ui_checkbox_set_autofocus(ui_checkbox_t *checkbox, bool autofocus)
 {
     if (checkbox) {
-        checkbox->autofocus = autofocus;
+        ui_widget_set_autofocus(&checkbox->base, autofocus);
     }
 }
 
 bool ui_checkbox_autofocus(const ui_checkbox_t *checkbox)
 {
-    return checkbox ? checkbox->autofocus : false;
+    return checkbox ? checkbox->base.autofocus : false;
 }
 
 void ui_checkbox_set_is_error(ui_checkbox_t *checkbox, bool is_error)
 {
     if (checkbox) {
         checkbox->is_error = is_error;
+        ui_widget_invalidate(&checkbox->base);
     }
 }
 
@@ -1,15 +1,11 @@
 #include "ui_column.h"
 
+#include "ui_scroller.h"
+
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct {
-    ui_widget_t *widget;
-    bool expand;
-    const char *key;
-} ui_column_child_t;
-
 struct ui_column {
     ui_widget_t base;
     ui_main_axis_alignment_t alignment;
@@ -27,9 +23,7 @@ struct ui_column {
     int on_scroll_interval;
     int scroll_offset;
     int max_scroll_offset;
-    ui_column_child_t *children;
-    size_t child_count;
-    size_t child_capacity;
+    ui_scroller_t scroller;
 };
 
 static const int SCROLL_INTERVAL_DEFAULT = 10;
@@ -42,44 +36,6 @@ static bool ui_rect_contains_point(const ui_rect_t *rect, int x, int y)
     return x >= rect->x && x < rect->x + rect->width && y >= rect->y && y < rect->y + rect->height;
 }
 
-static bool ui_widget_add_child_last(ui_widget_t *parent, ui_widget_t *child)
-{
-    if (!parent || !child || parent == child) {
-        return false;
-    }
-    ui_widget_remove_child(child);
-    child->parent = parent;
-    child->next_sibling = NULL;
-    if (!parent->first_child) {
-        parent->first_child = child;
-        return true;
-    }
-    ui_widget_t *tail = parent->first_child;
-    while (tail->next_sibling) {
-        tail = tail->next_sibling;
-    }
-    tail->next_sibling = child;
-    return true;
-}
-
-static bool ui_column_ensure_capacity(ui_column_t *column, size_t target)
-{
-    if (column->child_capacity >= target) {
-        return true;
-    }
-    size_t next = column->child_capacity ? column->child_capacity * 2 : 4;
-    if (next < target) {
-        next = target;
-    }
-    ui_column_child_t *realloced = realloc(column->children, next * sizeof(*column->children));
-    if (!realloced) {
-        return false;
-    }
-    column->children = realloced;
-    column->child_capacity = next;
-    return true;
-}
-
 static const ui_style_t *ui_widget_style_safe(const ui_widget_t *widget)
 {
     const ui_style_t *style = ui_widget_style(widget);
@@ -111,6 +67,16 @@ static int ui_column_clamp_scroll(ui_column_t *column, int value)
     return value;
 }
 
+/* Moves the content by the clamped change and blits what is already on screen. */
+static void ui_column_apply_scroll(ui_column_t *column, int offset)
+{
+    int previous = column->scroll_offset;
+    column->scroll_offset = ui_column_clamp_scroll(column, offset);
+    if (!ui_widget_scroll_content(&column->base, 0, previous - column->scroll_offset)) {
+        ui_widget_mark_needs_layout(&column->base);
+    }
+}
+
 static void ui_column_update_scroll_limits(ui_column_t *column, int content_height, int available)
 {
     if (!column) {
@@ -129,6 +95,33 @@ static void ui_column_update_scroll_limits(ui_column_t *column, int content_heig
     }
 }
 
+static int ui_column_child_limit(ui_widget_t *child, int content_width)
+{
+    if (content_width <= 0) {
+        return 0;
+    }
+    const ui_style_t *child_style = ui_widget_style_safe(child);
+    int limit = content_width - child_style->margin_left - child_style->margin_right;
+    return limit > 0 ? limit : 1;
+}
+
+static int ui_column_child_height(ui_widget_t *child, int content_width)
+{
+    int height = 0;
+    ui_widget_measure(child, ui_column_child_limit(child, content_width), 0, NULL, &height);
+    return height > 0 ? height : 0;
+}
+
+static int ui_column_child_width(const ui_column_t *column, ui_widget_t *child, int content_width)
+{
+    const ui_style_t *child_style = ui_widget_style_safe(child);
+    int width = child->preferred_width;
+    if (width <= 0 || column->horizontal_alignment == UI_CROSS_AXIS_STRETCH) {
+        width = content_width - child_style->margin_left - child_style->margin_right;
+    }
+    return width > 0 ? width : 0;
+}
+
 static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
 {
     if (!column || !bounds) {
@@ -148,14 +141,11 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
 
     int total_child_height = 0;
     size_t expand_count = 0;
-    for (size_t i = 0; i < column->child_count; ++i) {
-        ui_widget_t *child = column->children[i].widget;
+    size_t child_count = column->base.child_count;
+    for (ui_widget_t *child = column->base.first_child; child; child = child->next_sibling) {
         const ui_style_t *child_style = ui_widget_style_safe(child);
-        int child_height = child->bounds.height;
-        if (child_height <= 0) {
-            child_height = 0;
-        }
-        if (column->children[i].expand) {
+        int child_height = ui_column_child_height(child, content_width);
+        if (child->expand) {
             expand_count++;
         }
         total_child_height += child_height + child_style->margin_top + child_style->margin_bottom;
@@ -164,8 +154,8 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
     int spacing_total = 0;
     if (column->alignment == UI_MAIN_AXIS_START || column->alignment == UI_MAIN_AXIS_END ||
         column->alignment == UI_MAIN_AXIS_CENTER) {
-        if (column->child_count > 1) {
-            spacing_total = column->spacing * ((int)column->child_count - 1);
+        if (child_count > 1) {
+            spacing_total = column->spacing * ((int)child_count - 1);
         }
     }
 
@@ -183,7 +173,7 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
 
     int start_y = content_y;
     int gap = 0;
-    if (column->child_count > 0) {
+    if (child_count > 0) {
         switch (column->alignment) {
         case UI_MAIN_AXIS_START:
             gap = column->spacing;
@@ -197,7 +187,7 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
             gap = column->spacing;
             break;
         case UI_MAIN_AXIS_SPACE_BETWEEN: {
-            int gaps = column->child_count > 1 ? (int)column->child_count - 1 : 0;
+            int gaps = child_count > 1 ? (int)child_count - 1 : 0;
             if (gaps > 0) {
                 int available = content_height - total_child_height - expand_extra * (int)expand_count;
                 gap = available > 0 ? available / gaps : 0;
@@ -206,13 +196,13 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
         }
         case UI_MAIN_AXIS_SPACE_AROUND: {
             int available = content_height - total_child_height - expand_extra * (int)expand_count;
-            gap = column->child_count > 0 ? (available > 0 ? available / (int)column->child_count : 0) : 0;
+            gap = child_count > 0 ? (available > 0 ? available / (int)child_count : 0) : 0;
             start_y += gap / 2;
             break;
         }
         case UI_MAIN_AXIS_SPACE_EVENLY: {
             int available = content_height - total_child_height - expand_extra * (int)expand_count;
-            gap = column->child_count > 0 ? (available > 0 ? available / ((int)column->child_count + 1) : 0) : 0;
+            gap = child_count > 0 ? (available > 0 ? available / ((int)child_count + 1) : 0) : 0;
             start_y += gap;
             break;
         }
@@ -222,22 +212,14 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
     start_y -= column->scroll_offset;
 
     int cursor_y = start_y;
-    for (size_t i = 0; i < column->child_count; ++i) {
-        ui_widget_t *child = column->children[i].widget;
+    for (ui_widget_t *child = column->base.first_child; child; child = child->next_sibling) {
         const ui_style_t *child_style = ui_widget_style_safe(child);
-        child->bounds.height = child->bounds.height > 0 ? child->bounds.height : 0;
-        if (column->children[i].expand) {
-            child->bounds.height += expand_extra;
+        int child_height = ui_column_child_height(child, content_width);
+        if (child->expand) {
+            child_height += expand_extra;
         }
 
-        int child_width = child->bounds.width;
-        if (child_width <= 0 || column->horizontal_alignment == UI_CROSS_AXIS_STRETCH) {
-            child_width = content_width - child_style->margin_left - child_style->margin_right;
-            if (child_width < 0) {
-                child_width = 0;
-            }
-        }
-        child->bounds.width = child_width;
+        int child_width = ui_column_child_width(column, child, content_width);
 
         int x = content_x + child_style->margin_left;
         if (column->horizontal_alignment == UI_CROSS_AXIS_CENTER) {
@@ -250,9 +232,8 @@ static void ui_column_layout(ui_column_t *column, const ui_rect_t *bounds)
         }
 
         cursor_y += child_style->margin_top;
-        child->bounds.x = x;
-        child->bounds.y = cursor_y;
-        cursor_y += child->bounds.height + child_style->margin_bottom;
+        ui_widget_place(child, x, cursor_y, child_width, child_height);
+        cursor_y += child_height + child_style->margin_bottom;
         if (column->alignment == UI_MAIN_AXIS_SPACE_AROUND || column->alignment == UI_MAIN_AXIS_SPACE_EVENLY) {
             cursor_y += gap;
         } else if (column->alignment == UI_MAIN_AXIS_START ||
@@ -280,6 +261,8 @@ static bool ui_column_handle_event(ui_widget_t *widget, const ui_event_t *event)
         if (ui_rect_contains_point(bounds, event->data.touch.x, event->data.touch.y)) {
             column->dragging = true;
             column->last_touch_y = event->data.touch.y;
+            ui_scroller_stop(&column->scroller);
+            ui_scroller_track(&column->scroller, column->scroll_offset, ui_event_seconds(event));
             return true;
         }
         break;
@@ -292,16 +275,31 @@ static bool ui_column_handle_event(ui_widget_t *widget, const ui_event_t *event)
             return true;
         }
         {
-            int delta = column->last_touch_y - event->data.touch.y;
+            /* moves coalesced into this one only feed the velocity estimate */
+            size_t count = 0;
+            const ui_event_t *history = ui_widget_pointer_history(widget, &count);
+            int offset = column->scroll_offset;
+            for (size_t i = 0; i < count; ++i) {
+                offset = ui_column_clamp_scroll(
+                    column, offset + column->last_touch_y - history[i].data.touch.y);
+                column->last_touch_y = history[i].data.touch.y;
+                ui_scroller_track(&column->scroller, offset, ui_event_seconds(&history[i]));
+            }
+            offset += column->last_touch_y - event->data.touch.y;
             column->last_touch_y = event->data.touch.y;
-            if (delta != 0) {
-                column->scroll_offset = ui_column_clamp_scroll(column, column->scroll_offset + delta);
+            if (offset != column->scroll_offset) {
+                ui_column_apply_scroll(column, offset);
             }
+            ui_scroller_track(&column->scroller, column->scroll_offset, ui_event_seconds(event));
         }
         return true;
     case UI_EVENT_TOUCH_UP:
         if (column->dragging) {
             column->dragging = false;
+            if (ui_scroller_fling(&column->scroller, column->scroll_offset,
+                                  ui_event_seconds(event))) {
+                ui_widget_schedule_tick(widget);
+            }
             return true;
         }
         break;
@@ -311,6 +309,18 @@ static bool ui_column_handle_event(ui_widget_t *widget, const ui_event_t *event)
     return false;
 }
 
+static bool ui_column_tick(ui_widget_t *widget, double delta_seconds)
+{
+    ui_column_t *column = (ui_column_t *)widget;
+    int offset = column->scroll_offset;
+    bool moving = ui_scroller_step(&column->scroller, delta_seconds, column->max_scroll_offset,
+                                   &offset);
+    if (offset != column->scroll_offset) {
+        ui_column_apply_scroll(column, offset);
+    }
+    return moving;
+}
+
 static bool ui_column_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_t *bounds)
 {
     ui_column_t *column = (ui_column_t *)widget;
@@ -320,23 +330,73 @@ static bool ui_column_render(ui_context_t *ctx, ui_widget_t *widget, const ui_re
     const ui_style_t *style = ui_widget_style_safe(widget);
     ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
                          style->background_color);
-    ui_column_layout(column, bounds);
     return true;
 }
 
+static void ui_column_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    ui_column_layout((ui_column_t *)widget, bounds);
+}
+
+static void ui_column_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                              int *height)
+{
+    (void)max_height;
+    ui_column_t *column = (ui_column_t *)widget;
+    const ui_style_t *style = ui_widget_style_safe(widget);
+    int content_width = 0;
+    if (max_width > 0) {
+        content_width = max_width - style->padding_left - style->padding_right;
+        if (content_width <= 0) {
+            content_width = 1;
+        }
+    }
+    int widest = 0;
+    int total = 0;
+    for (ui_widget_t *child = column->base.first_child; child; child = child->next_sibling) {
+        const ui_style_t *child_style = ui_widget_style_safe(child);
+        int child_width = 0;
+        int child_height = 0;
+        ui_widget_measure(child, ui_column_child_limit(child, content_width), 0, &child_width,
+                          &child_height);
+        child_width += child_style->margin_left + child_style->margin_right;
+        if (child_width > widest) {
+            widest = child_width;
+        }
+        total += child_height + child_style->margin_top + child_style->margin_bottom;
+    }
+    if (column->base.child_count > 1) {
+        total += column->spacing * ((int)column->base.child_count - 1);
+    }
+    *width = widest + style->padding_left + style->padding_right;
+    *height = total + style->padding_top + style->padding_bottom;
+}
+
 static const ui_widget_ops_t ui_column_ops = {
+    .name = "column",
     .render = ui_column_render,
     .handle_event = ui_column_handle_event,
-    .destroy = NULL
+    .destroy = NULL,
+    .measure = ui_column_measure,
+    .arrange = ui_column_arrange,
+    .event_mask = UI_EVENT_MASK_POINTER,
+    .manages_damage = true,
+    .tick = ui_column_tick
 };
 
 ui_column_t *ui_column_create(void)
 {
-    ui_column_t *column = calloc(1, sizeof(*column));
+    return ui_column_create_in(NULL);
+}
+
+ui_column_t *ui_column_create_in(ui_arena_t *arena)
+{
+    ui_column_t *column = ui_arena_alloc(arena, sizeof(*column));
     if (!column) {
         return NULL;
     }
     ui_column_init(column);
+    ui_widget_set_arena(&column->base, arena);
     return column;
 }
 
@@ -345,10 +405,8 @@ void ui_column_destroy(ui_column_t *column)
     if (!column) {
         return;
     }
-    if (column->children) {
-        free(column->children);
-    }
-    free(column);
+    ui_widget_deinit(&column->base);
+    ui_arena_free(column->base.arena, column);
 }
 
 void ui_column_init(ui_column_t *column)
@@ -376,18 +434,15 @@ bool ui_column_add_control(ui_column_t *column, ui_widget_t *control, bool expan
     if (!column || !control) {
         return false;
     }
-    if (!ui_column_ensure_capacity(column, column->child_count + 1)) {
+    if (!ui_widget_append_child(&column->base, control)) {
         return false;
     }
-    column->children[column->child_count++] = (ui_column_child_t){
-        .widget = control,
-        .expand = expand,
-        .key = key
-    };
-    ui_widget_add_child_last(&column->base, control);
+    control->expand = expand;
+    control->key = key;
     if (column->auto_scroll) {
         column->scroll_offset = column->max_scroll_offset;
     }
+    ui_widget_invalidate_measure(control);
     return true;
 }
 
@@ -396,27 +451,23 @@ bool ui_column_remove_control(ui_column_t *column, ui_widget_t *control)
     if (!column || !control) {
         return false;
     }
-    for (size_t i = 0; i < column->child_count; ++i) {
-        if (column->children[i].widget == control) {
-            ui_widget_remove_child(control);
-            memmove(&column->children[i], &column->children[i + 1],
-                    (column->child_count - i - 1) * sizeof(ui_column_child_t));
-            --column->child_count;
-            return true;
-        }
+    if (control->parent != &column->base) {
+        return false;
     }
-    return false;
+    ui_widget_remove_child(control);
+    return true;
 }
 
 size_t ui_column_control_count(const ui_column_t *column)
 {
-    return column ? column->child_count : 0;
+    return column ? column->base.child_count : 0;
 }
 
 void ui_column_set_alignment(ui_column_t *column, ui_main_axis_alignment_t alignment)
 {
     if (column) {
         column->alignment = alignment;
+        ui_widget_mark_needs_layout(&column->base);
     }
 }
 
@@ -430,6 +481,7 @@ void ui_column_set_horizontal_alignment(ui_column_t *column,
 {
     if (column) {
         column->horizontal_alignment = alignment;
+        ui_widget_mark_needs_layout(&column->base);
     }
 }
 
@@ -442,6 +494,7 @@ void ui_column_set_spacing(ui_column_t *column, int spacing)
 {
     if (column && spacing >= 0) {
         column->spacing = spacing;
+        ui_widget_invalidate_measure(&column->base);
     }
 }
 
@@ -457,6 +510,7 @@ void ui_column_set_auto_scroll(ui_column_t *column, bool auto_scroll)
         if (auto_scroll) {
             column->scroll_offset = column->max_scroll_offset;
         }
+        ui_widget_mark_needs_layout(&column->base);
     }
 }
 
@@ -472,9 +526,11 @@ void ui_column_set_scroll_mode(ui_column_t *column, ui_scroll_mode_t mode)
         if (mode == UI_SCROLL_MODE_NONE) {
             column->scroll_offset = 0;
             column->dragging = false;
+            ui_scroller_stop(&column->scroller);
         } else {
             column->scroll_offset = ui_column_clamp_scroll(column, column->scroll_offset);
         }
+        ui_widget_mark_needs_layout(&column->base);
     }
 }
 
@@ -486,7 +542,8 @@ ui_scroll_mode_t ui_column_scroll_mode(const ui_column_t *column)
 void ui_column_set_scroll_offset(ui_column_t *column, int offset)
 {
     if (column) {
-        column->scroll_offset = ui_column_clamp_scroll(column, offset);
+        ui_scroller_stop(&column->scroller);
+        ui_column_apply_scroll(column, offset);
     }
 }
 
@@ -554,6 +611,7 @@ void ui_column_set_rtl(ui_column_t *column, bool rtl)
 {
     if (column) {
         column->rtl = rtl;
+        ui_widget_mark_needs_layout(&column->base);
     }
 }
 
@@ -574,32 +632,30 @@ int ui_column_on_scroll_interval(const ui_column_t *column)
     return column ? column->on_scroll_interval : SCROLL_INTERVAL_DEFAULT;
 }
 
-static int ui_column_find_child_index_with_key(const ui_column_t *column, const char *key)
+static ui_widget_t *ui_column_find_child_with_key(const ui_column_t *column, const char *key)
 {
     if (!column || !key) {
-        return -1;
+        return NULL;
     }
-    for (size_t i = 0; i < column->child_count; ++i) {
-        if (column->children[i].key && strcmp(column->children[i].key, key) == 0) {
-            return (int)i;
+    for (ui_widget_t *child = column->base.first_child; child; child = child->next_sibling) {
+        if (child->key && strcmp(child->key, key) == 0) {
+            return child;
         }
     }
-    return -1;
+    return NULL;
 }
 
 void ui_column_scroll_to(ui_column_t *column, int offset, int delta, const char *key,
                          int duration_ms, double curve)
 {
-    (void)duration_ms;
-    (void)curve;
     if (!column) {
         return;
     }
     int target = column->scroll_offset;
     if (key) {
-        int index = ui_column_find_child_index_with_key(column, key);
-        if (index >= 0) {
-            target = column->children[index].widget->bounds.y - column->base.bounds.y;
+        ui_widget_t *child = ui_column_find_child_with_key(column, key);
+        if (child) {
+            target = child->bounds.y - column->base.bounds.y + column->scroll_offset;
         }
     }
     if (offset != INT_MIN) {
@@ -609,8 +665,15 @@ void ui_column_scroll_to(ui_column_t *column, int offset, int delta, const char
             target = offset;
         }
     }
-    target += delta;
-    column->scroll_offset = ui_column_clamp_scroll(column, target);
+    target = ui_column_clamp_scroll(column, target + delta);
+    if (ui_scroller_animate(&column->scroller, column->scroll_offset, target, duration_ms,
+                            curve) &&
+        ui_widget_schedule_tick(&column->base)) {
+        return;
+    }
+    /* no duration, or no scene to tick the animation yet */
+    ui_scroller_stop(&column->scroller);
+    ui_column_apply_scroll(column, target);
 }
 
 const ui_widget_t *ui_column_widget(const ui_column_t *column)
@@ -54,37 +54,31 @@ void ui_container_layout_children(ui_container_t *container)
         int margin_top = child_style->margin_top;
         int margin_bottom = child_style->margin_bottom;
 
-        int child_width = child->bounds.width > 0 ? child->bounds.width
-                                                  : content_width - margin_left - margin_right;
+        int child_width = child->preferred_width > 0 ? child->preferred_width
+                                                     : content_width - margin_left - margin_right;
         if (child_width < 0) {
             child_width = 0;
         }
-        int child_height = child->bounds.height > 0 ? child->bounds.height
-                                                    : content_height - margin_top - margin_bottom;
+        int child_height = child->preferred_height > 0 ? child->preferred_height
+                                                       : content_height - margin_top - margin_bottom;
         if (child_height < 0) {
             child_height = 0;
         }
 
         switch (container->layout) {
         case UI_CONTAINER_LAYOUT_HORIZONTAL:
-            child->bounds.x = cursor_x + margin_left;
-            child->bounds.y = content_y + margin_top;
-            child->bounds.width = child_width;
-            child->bounds.height = child_height;
+            ui_widget_place(child, cursor_x + margin_left, content_y + margin_top, child_width,
+                            child_height);
             cursor_x += margin_left + child_width + margin_right + container->spacing;
             break;
         case UI_CONTAINER_LAYOUT_VERTICAL:
-            child->bounds.x = content_x + margin_left;
-            child->bounds.y = cursor_y + margin_top;
-            child->bounds.width = child_width;
-            child->bounds.height = child_height;
+            ui_widget_place(child, content_x + margin_left, cursor_y + margin_top, child_width,
+                            child_height);
             cursor_y += margin_top + child_height + margin_bottom + container->spacing;
             break;
         case UI_CONTAINER_LAYOUT_OVERLAY:
-            child->bounds.x = content_x + margin_left;
-            child->bounds.y = content_y + margin_top;
-            child->bounds.width = child_width;
-            child->bounds.height = child_height;
+            ui_widget_place(child, content_x + margin_left, content_y + margin_top, child_width,
+                            child_height);
             break;
         }
     }
@@ -99,10 +93,15 @@ static bool ui_container_render(ui_context_t *ctx, ui_widget_t *widget, const ui
     const ui_style_t *style = ui_widget_style_safe(widget);
     ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
                          style->background_color);
-    ui_container_layout_children(container);
     return true;
 }
 
+static void ui_container_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    (void)bounds;
+    ui_container_layout_children(ui_container_from_widget(widget));
+}
+
 void ui_container_init(ui_container_t *container, ui_container_layout_t layout)
 {
     if (!container) {
@@ -117,6 +116,7 @@ void ui_container_set_layout(ui_container_t *container, ui_container_layout_t la
 {
     if (container) {
         container->layout = layout;
+        ui_widget_mark_needs_layout(&container->base);
     }
 }
 
@@ -129,6 +129,7 @@ void ui_container_set_spacing(ui_container_t *container, int spacing)
 {
     if (container) {
         container->spacing = spacing;
+        ui_widget_mark_needs_layout(&container->base);
     }
 }
 
@@ -138,7 +139,9 @@ int ui_container_spacing(const ui_container_t *container)
 }
 
 static const ui_widget_ops_t ui_container_ops = {
+    .name = "container",
     .render = ui_container_render,
     .handle_event = NULL,
-    .destroy = NULL
+    .destroy = NULL,
+    .arrange = ui_container_arrange
 };
@@ -0,0 +1,145 @@
+#include "ui_damage.h"
+
+#include <string.h>
+
+static const ui_rect_t ui_damage_screen = {0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT};
+
+bool ui_rect_intersect(const ui_rect_t *a, const ui_rect_t *b, ui_rect_t *out)
+{
+    int x0 = a->x > b->x ? a->x : b->x;
+    int y0 = a->y > b->y ? a->y : b->y;
+    int x1 = a->x + a->width < b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height < b->y + b->height ? a->y + a->height : b->y + b->height;
+    if (x1 <= x0 || y1 <= y0) {
+        memset(out, 0, sizeof(*out));
+        return false;
+    }
+    out->x = x0;
+    out->y = y0;
+    out->width = x1 - x0;
+    out->height = y1 - y0;
+    return true;
+}
+
+static ui_rect_t ui_damage_union(const ui_rect_t *a, const ui_rect_t *b)
+{
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    ui_rect_t out = {x0, y0, x1 - x0, y1 - y0};
+    return out;
+}
+
+static bool ui_damage_contains(const ui_rect_t *outer, const ui_rect_t *inner)
+{
+    return inner->x >= outer->x && inner->y >= outer->y &&
+           inner->x + inner->width <= outer->x + outer->width &&
+           inner->y + inner->height <= outer->y + outer->height;
+}
+
+void ui_damage_reset(ui_damage_t *damage)
+{
+    if (damage) {
+        memset(damage, 0, sizeof(*damage));
+    }
+}
+
+void ui_damage_add_all(ui_damage_t *damage)
+{
+    if (damage) {
+        damage->full = true;
+        damage->count = 0;
+        damage->scroll_count = 0;
+    }
+}
+
+void ui_damage_add(ui_damage_t *damage, const ui_rect_t *rect)
+{
+    ui_rect_t clipped;
+    if (!damage || !rect || damage->full || !ui_rect_intersect(rect, &ui_damage_screen, &clipped)) {
+        return;
+    }
+    for (size_t i = 0; i < damage->count;) {
+        if (ui_damage_contains(&damage->rects[i], &clipped)) {
+            return;
+        }
+        if (ui_damage_contains(&clipped, &damage->rects[i])) {
+            damage->rects[i] = damage->rects[--damage->count];
+            continue;
+        }
+        ++i;
+    }
+    if (damage->count < UI_DAMAGE_MAX_RECTS) {
+        damage->rects[damage->count++] = clipped;
+        return;
+    }
+    /* full: grow whichever rect absorbs this one with the least added area */
+    size_t best = 0;
+    long best_growth = -1;
+    for (size_t i = 0; i < damage->count; ++i) {
+        ui_rect_t merged = ui_damage_union(&damage->rects[i], &clipped);
+        long growth = (long)merged.width * merged.height -
+                      (long)damage->rects[i].width * damage->rects[i].height;
+        if (best_growth < 0 || growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    damage->rects[best] = ui_damage_union(&damage->rects[best], &clipped);
+}
+
+bool ui_damage_scroll(ui_damage_t *damage, const ui_rect_t *rect, int dx, int dy)
+{
+    ui_rect_t area;
+    if (!damage || !rect || !ui_rect_intersect(rect, &ui_damage_screen, &area)) {
+        return true;
+    }
+    if (damage->full || (dx == 0 && dy == 0)) {
+        return true;
+    }
+    if (dx >= area.width || -dx >= area.width || dy >= area.height || -dy >= area.height ||
+        damage->scroll_count == UI_DAMAGE_MAX_SCROLLS) {
+        ui_damage_add(damage, &area);
+        return false;
+    }
+
+    /* pixels already due for repaint move with the scroll */
+    ui_rect_t moved[UI_DAMAGE_MAX_RECTS];
+    size_t moved_count = 0;
+    for (size_t i = 0; i < damage->count; ++i) {
+        ui_rect_t part;
+        if (ui_rect_intersect(&damage->rects[i], &area, &part)) {
+            part.x += dx;
+            part.y += dy;
+            if (ui_rect_intersect(&part, &area, &part)) {
+                moved[moved_count++] = part;
+            }
+        }
+    }
+    for (size_t i = 0; i < moved_count; ++i) {
+        ui_damage_add(damage, &moved[i]);
+    }
+
+    ui_damage_scroll_t *scroll = &damage->scrolls[damage->scroll_count++];
+    scroll->rect = area;
+    scroll->dx = dx;
+    scroll->dy = dy;
+
+    if (dy != 0) {
+        ui_rect_t strip = {area.x, dy > 0 ? area.y : area.y + area.height + dy, area.width,
+                           dy > 0 ? dy : -dy};
+        ui_damage_add(damage, &strip);
+    }
+    if (dx != 0) {
+        ui_rect_t strip = {dx > 0 ? area.x : area.x + area.width + dx, area.y, dx > 0 ? dx : -dx,
+                           area.height};
+        ui_damage_add(damage, &strip);
+    }
+    return true;
+}
+
+bool ui_damage_is_empty(const ui_damage_t *damage)
+{
+    return !damage || (!damage->full && damage->count == 0 && damage->scroll_count == 0);
+}
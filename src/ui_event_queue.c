@@ -0,0 +1,214 @@
+#include "ui_event_queue.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define UI_EVENT_QUEUE_MASK (UI_EVENT_QUEUE_SIZE - 1)
+#define UI_TASK_QUEUE_MASK (UI_TASK_QUEUE_SIZE - 1)
+
+void ui_event_spsc_init(ui_event_spsc_t *queue)
+{
+    if (!queue) {
+        return;
+    }
+    memset(queue, 0, sizeof(*queue));
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+bool ui_event_spsc_push(ui_event_spsc_t *queue, const ui_event_t *event)
+{
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail - head == UI_EVENT_QUEUE_SIZE) {
+        return false;
+    }
+    queue->slots[tail & UI_EVENT_QUEUE_MASK] = *event;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool ui_event_spsc_pop(ui_event_spsc_t *queue, ui_event_t *event)
+{
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *event = queue->slots[head & UI_EVENT_QUEUE_MASK];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool ui_event_spsc_empty(ui_event_spsc_t *queue)
+{
+    return atomic_load_explicit(&queue->head, memory_order_relaxed) ==
+           atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
+
+/* Slot i holds sequence i while free for the producer that claims ticket i,
+ * i + 1 once that entry is published, and i + size after the consumer took it.
+ * Both MPSC rings share this through their slots' leading sequence. */
+static void ui_mpsc_init(atomic_size_t *tail, unsigned char *slots, size_t stride, size_t size)
+{
+    atomic_init(tail, 0);
+    for (size_t i = 0; i < size; ++i) {
+        atomic_init((atomic_size_t *)(slots + i * stride), i);
+    }
+}
+
+/* Claims a slot for the caller to fill and publish; NULL when full or when
+ * fewer than keep_free slots would be left after it. */
+static void *ui_mpsc_claim(atomic_size_t *tail_index, unsigned char *slots, size_t stride,
+                           size_t mask, size_t keep_free, size_t *ticket)
+{
+    size_t tail = atomic_load_explicit(tail_index, memory_order_relaxed);
+    for (;;) {
+        unsigned char *slot = slots + (tail & mask) * stride;
+        size_t sequence =
+            atomic_load_explicit((atomic_size_t *)slot, memory_order_acquire);
+        /* signed distance, so 32-bit counters survive wrapping */
+        ptrdiff_t lag = (ptrdiff_t)(sequence - tail);
+        if (lag == 0 && keep_free > 0) {
+            /* the slot keep_free tickets ahead is still unread from the last
+             * lap; producers racing past this check can dip into the reserve
+             * by at most one slot each */
+            size_t ahead = tail + keep_free;
+            size_t ahead_sequence = atomic_load_explicit(
+                (atomic_size_t *)(slots + (ahead & mask) * stride), memory_order_acquire);
+            if ((ptrdiff_t)(ahead_sequence - ahead) < 0) {
+                return NULL;
+            }
+        }
+        if (lag == 0) {
+            /* on failure tail is reloaded and the loop retries that ticket */
+            if (atomic_compare_exchange_weak_explicit(tail_index, &tail, tail + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *ticket = tail;
+                return slot;
+            }
+        } else if (lag < 0) {
+            /* the consumer has not freed this slot since the last lap: full */
+            return NULL;
+        } else {
+            tail = atomic_load_explicit(tail_index, memory_order_relaxed);
+        }
+    }
+}
+
+static void ui_mpsc_publish(void *slot, size_t ticket)
+{
+    atomic_store_explicit((atomic_size_t *)slot, ticket + 1, memory_order_release);
+}
+
+/* The slot at head once its entry is published, NULL before. */
+static void *ui_mpsc_front(size_t head, unsigned char *slots, size_t stride, size_t mask)
+{
+    unsigned char *slot = slots + (head & mask) * stride;
+    if (atomic_load_explicit((atomic_size_t *)slot, memory_order_acquire) != head + 1) {
+        return NULL;
+    }
+    return slot;
+}
+
+static void ui_mpsc_release(void *slot, size_t head, size_t size)
+{
+    atomic_store_explicit((atomic_size_t *)slot, head + size, memory_order_release);
+}
+
+void ui_event_mpsc_init(ui_event_mpsc_t *queue)
+{
+    if (!queue) {
+        return;
+    }
+    memset(queue, 0, sizeof(*queue));
+    queue->head = 0;
+    ui_mpsc_init(&queue->tail, (unsigned char *)queue->slots, sizeof(ui_event_slot_t),
+                 UI_EVENT_QUEUE_SIZE);
+}
+
+bool ui_event_mpsc_push(ui_event_mpsc_t *queue, const ui_event_t *event)
+{
+    return ui_event_mpsc_push_keep(queue, event, 0);
+}
+
+bool ui_event_mpsc_push_keep(ui_event_mpsc_t *queue, const ui_event_t *event, size_t keep_free)
+{
+    if (keep_free >= UI_EVENT_QUEUE_SIZE) {
+        return false;
+    }
+    size_t ticket;
+    ui_event_slot_t *slot =
+        ui_mpsc_claim(&queue->tail, (unsigned char *)queue->slots, sizeof(ui_event_slot_t),
+                      UI_EVENT_QUEUE_MASK, keep_free, &ticket);
+    if (!slot) {
+        return false;
+    }
+    slot->event = *event;
+    ui_mpsc_publish(slot, ticket);
+    return true;
+}
+
+bool ui_event_mpsc_pop(ui_event_mpsc_t *queue, ui_event_t *event)
+{
+    ui_event_slot_t *slot = ui_mpsc_front(queue->head, (unsigned char *)queue->slots,
+                                          sizeof(ui_event_slot_t), UI_EVENT_QUEUE_MASK);
+    if (!slot) {
+        return false;
+    }
+    *event = slot->event;
+    ui_mpsc_release(slot, queue->head, UI_EVENT_QUEUE_SIZE);
+    queue->head++;
+    return true;
+}
+
+bool ui_event_mpsc_empty(ui_event_mpsc_t *queue)
+{
+    return !ui_mpsc_front(queue->head, (unsigned char *)queue->slots, sizeof(ui_event_slot_t),
+                          UI_EVENT_QUEUE_MASK);
+}
+
+size_t ui_event_mpsc_pushed(ui_event_mpsc_t *queue)
+{
+    return atomic_load_explicit(&queue->tail, memory_order_relaxed);
+}
+
+void ui_task_mpsc_init(ui_task_mpsc_t *queue)
+{
+    if (!queue) {
+        return;
+    }
+    memset(queue, 0, sizeof(*queue));
+    queue->head = 0;
+    ui_mpsc_init(&queue->tail, (unsigned char *)queue->slots, sizeof(ui_task_slot_t),
+                 UI_TASK_QUEUE_SIZE);
+}
+
+bool ui_task_mpsc_push(ui_task_mpsc_t *queue, ui_task_fn fn, void *arg)
+{
+    size_t ticket;
+    ui_task_slot_t *slot = ui_mpsc_claim(&queue->tail, (unsigned char *)queue->slots,
+                                         sizeof(ui_task_slot_t), UI_TASK_QUEUE_MASK, 0, &ticket);
+    if (!slot) {
+        return false;
+    }
+    slot->fn = fn;
+    slot->arg = arg;
+    ui_mpsc_publish(slot, ticket);
+    return true;
+}
+
+bool ui_task_mpsc_pop(ui_task_mpsc_t *queue, ui_task_fn *fn, void **arg)
+{
+    ui_task_slot_t *slot = ui_mpsc_front(queue->head, (unsigned char *)queue->slots,
+                                         sizeof(ui_task_slot_t), UI_TASK_QUEUE_MASK);
+    if (!slot) {
+        return false;
+    }
+    *fn = slot->fn;
+    *arg = slot->arg;
+    ui_mpsc_release(slot, queue->head, UI_TASK_QUEUE_SIZE);
+    queue->head++;
+    return true;
+}
@@ -0,0 +1,200 @@
+#include "ui_focus.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void ui_focus_manager_init(ui_focus_manager_t *focus)
+{
+    if (!focus) {
+        return;
+    }
+    memset(focus, 0, sizeof(*focus));
+}
+
+void ui_focus_manager_release(ui_focus_manager_t *focus)
+{
+    if (!focus) {
+        return;
+    }
+    free(focus->order);
+    ui_focus_manager_init(focus);
+}
+
+static bool ui_focus_push(ui_focus_manager_t *focus, ui_widget_t *widget)
+{
+    if (focus->count == focus->capacity) {
+        size_t next = focus->capacity ? focus->capacity * 2 : 16;
+        ui_widget_t **order = realloc(focus->order, next * sizeof(*order));
+        if (!order) {
+            return false;
+        }
+        focus->order = order;
+        focus->capacity = next;
+    }
+    focus->order[focus->count++] = widget;
+    return true;
+}
+
+static void ui_focus_collect(ui_focus_manager_t *focus, ui_widget_t *widget)
+{
+    if (!widget || !widget->visible) {
+        return;
+    }
+    if (widget->focusable) {
+        ui_focus_push(focus, widget);
+    }
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_focus_collect(focus, child);
+    }
+}
+
+static void ui_focus_notify(ui_widget_t *widget, bool focused)
+{
+    if (widget && widget->ops && widget->ops->focus_changed) {
+        widget->ops->focus_changed(widget, focused);
+    }
+    /* focus rings and colors change without a setter */
+    ui_widget_invalidate(widget);
+}
+
+static bool ui_focus_index_of(const ui_focus_manager_t *focus, const ui_widget_t *widget,
+                              size_t *out)
+{
+    for (size_t i = 0; i < focus->count; ++i) {
+        if (focus->order[i] == widget) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ui_focus_assign(ui_focus_manager_t *focus, size_t index)
+{
+    ui_widget_t *previous = focus->focused;
+    focus->focused = focus->order[index];
+    focus->index = index;
+    if (previous != focus->focused) {
+        ui_focus_notify(previous, false);
+        ui_focus_notify(focus->focused, true);
+    }
+}
+
+void ui_focus_manager_sync(ui_focus_manager_t *focus, ui_widget_t *root)
+{
+    if (!focus) {
+        return;
+    }
+    uint32_t epoch = ui_widget_tree_epoch();
+    if (focus->built && focus->epoch == epoch) {
+        return;
+    }
+    focus->count = 0;
+    ui_focus_collect(focus, root);
+    focus->epoch = epoch;
+    focus->built = true;
+
+    if (focus->focused && !ui_focus_index_of(focus, focus->focused, &focus->index)) {
+        /* only widgets still in the tree are known to be alive */
+        if (ui_widget_tree_contains(root, focus->focused)) {
+            ui_focus_notify(focus->focused, false);
+        }
+        focus->focused = NULL;
+    }
+    if (!focus->focused) {
+        for (size_t i = 0; i < focus->count; ++i) {
+            if (focus->order[i]->autofocus) {
+                ui_focus_assign(focus, i);
+                break;
+            }
+        }
+    }
+}
+
+bool ui_focus_manager_set(ui_focus_manager_t *focus, ui_widget_t *root, ui_widget_t *widget)
+{
+    if (!focus) {
+        return false;
+    }
+    ui_focus_manager_sync(focus, root);
+    if (widget == focus->focused) {
+        return false;
+    }
+    size_t index;
+    if (widget && ui_focus_index_of(focus, widget, &index)) {
+        ui_focus_assign(focus, index);
+        return true;
+    }
+    if (!focus->focused) {
+        return false;
+    }
+    ui_widget_t *previous = focus->focused;
+    focus->focused = NULL;
+    ui_focus_notify(previous, false);
+    return true;
+}
+
+bool ui_focus_manager_move(ui_focus_manager_t *focus, ui_widget_t *root, int direction)
+{
+    if (!focus) {
+        return false;
+    }
+    ui_focus_manager_sync(focus, root);
+    if (focus->count == 0) {
+        return false;
+    }
+    size_t index;
+    if (!focus->focused) {
+        index = direction >= 0 ? 0 : focus->count - 1;
+    } else if (direction >= 0) {
+        index = focus->index + 1 < focus->count ? focus->index + 1 : 0;
+    } else {
+        index = focus->index > 0 ? focus->index - 1 : focus->count - 1;
+    }
+    ui_focus_assign(focus, index);
+    return true;
+}
+
+ui_widget_t *ui_focus_manager_focused(const ui_focus_manager_t *focus)
+{
+    return focus ? focus->focused : NULL;
+}
+
+static int ui_focus_direction(uint32_t keycode)
+{
+    switch (keycode) {
+    case UI_KEY_TAB:
+    case UI_KEY_NEXT:
+    case UI_KEY_RIGHT:
+    case UI_KEY_DOWN:
+        return 1;
+    case UI_KEY_PREV:
+    case UI_KEY_LEFT:
+    case UI_KEY_UP:
+        return -1;
+    default:
+        return 0;
+    }
+}
+
+bool ui_focus_manager_route_key(ui_focus_manager_t *focus, ui_widget_t *root,
+                                const ui_event_t *event)
+{
+    if (!focus || !event) {
+        return false;
+    }
+    ui_focus_manager_sync(focus, root);
+    for (ui_widget_t *widget = focus->focused; widget; widget = widget->parent) {
+        if (ui_widget_send_event(widget, event)) {
+            return true;
+        }
+    }
+    int direction = ui_focus_direction(event->data.key.keycode);
+    if (direction == 0) {
+        return false;
+    }
+    if (event->type == UI_EVENT_KEY_DOWN) {
+        ui_focus_manager_move(focus, root, direction);
+    }
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "ui_font.h"
 #include "font/bareui_font_data.h"
+
+#include <string.h>
 /* lo-res 5x7 table exists, but is disabled by default for now. */
 
 /* By default, prefer the crisp low-res ASCII; fall back to generated table. */
@@ -22,7 +24,11 @@ bool bareui_font_lookup(const bareui_font_t *font, uint32_t codepoint,
         return false;
     }
 
+    memset(glyph_out, 0, sizeof(*glyph_out));
     /* No special-case ASCII; rely on generated coverage for correctness. */
+    if (font->lookup && font->lookup(font, codepoint, glyph_out)) {
+        return true;
+    }
 
     for (size_t i = 0; i < font->count; ++i) {
         const bareui_font_entry_t *entry = &font->entries[i];
@@ -32,6 +38,7 @@ bool bareui_font_lookup(const bareui_font_t *font, uint32_t codepoint,
             glyph_out->height = font->height;
             glyph_out->columns = entry->columns;
             glyph_out->spacing = (uint8_t)(entry->width + BAREUI_FONT_SPACING);
+            glyph_out->bpp = 1;
             return true;
         }
     }
@@ -43,6 +50,7 @@ bool bareui_font_lookup(const bareui_font_t *font, uint32_t codepoint,
             glyph_out->height = font->height;
             glyph_out->columns = bareui_font_data[i].columns;
             glyph_out->spacing = (uint8_t)(bareui_font_data[i].width + BAREUI_FONT_SPACING);
+            glyph_out->bpp = 1;
             return true;
         }
     }
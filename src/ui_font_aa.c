@@ -0,0 +1,72 @@
+#include "ui_font_aa.h"
+
+#include <string.h>
+
+#include "ui_text_engine.h"
+
+void bareui_font_aa_init(bareui_font_aa_t *font, uint8_t height, uint8_t bpp,
+                         const bareui_font_aa_entry_t *glyphs, size_t glyph_count,
+                         const uint8_t *coverage)
+{
+    if (!font) {
+        return;
+    }
+    /* the address may have held another font whose metrics are still cached */
+    ui_text_engine_forget_font(&font->base);
+    memset(font, 0, sizeof(*font));
+    font->base.height = height;
+    font->base.lookup = bareui_font_aa_lookup;
+    font->base.user_data = font;
+    font->glyphs = glyphs;
+    font->glyph_count = glyph_count;
+    font->coverage = coverage;
+    font->bpp = (bpp == 2) ? 2 : 4;
+}
+
+void bareui_font_aa_deinit(bareui_font_aa_t *font)
+{
+    if (!font) {
+        return;
+    }
+    ui_text_engine_forget_font(&font->base);
+    font->glyphs = NULL;
+    font->glyph_count = 0;
+    font->coverage = NULL;
+}
+
+bool bareui_font_aa_lookup(const bareui_font_t *font, uint32_t codepoint,
+                           bareui_font_glyph_t *glyph_out)
+{
+    if (!font || !font->user_data || !glyph_out) {
+        return false;
+    }
+    const bareui_font_aa_t *aa = font->user_data;
+    if (!aa->glyphs || !aa->coverage) {
+        return false;
+    }
+    size_t lo = 0;
+    size_t hi = aa->glyph_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const bareui_font_aa_entry_t *entry = &aa->glyphs[mid];
+        if (entry->codepoint == codepoint) {
+            glyph_out->codepoint = codepoint;
+            glyph_out->width = entry->width;
+            glyph_out->height = aa->base.height;
+            glyph_out->columns = NULL;
+            glyph_out->spacing = entry->advance;
+            glyph_out->coverage = aa->coverage + entry->offset;
+            glyph_out->bpp = aa->bpp;
+            glyph_out->rows = NULL;
+            glyph_out->offset_x = 0;
+            glyph_out->offset_y = 0;
+            return true;
+        }
+        if (entry->codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,154 @@
+#include "ui_font_packed.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_text_engine.h"
+
+#define BAREUI_FONT_PACKED_MAX_SCALE 16
+
+void bareui_font_packed_init(bareui_font_packed_t *font, uint8_t height, uint8_t baseline,
+                             const bareui_font_packed_entry_t *glyphs, size_t glyph_count,
+                             const uint8_t *bitmap)
+{
+    if (!font) {
+        return;
+    }
+    /* the address may have held another font whose metrics are still cached */
+    ui_text_engine_forget_font(&font->base);
+    memset(font, 0, sizeof(*font));
+    font->base.height = height;
+    font->base.lookup = bareui_font_packed_lookup;
+    font->base.user_data = font;
+    font->glyphs = glyphs;
+    font->glyph_count = glyph_count;
+    font->bitmap = bitmap;
+    font->baseline = baseline;
+}
+
+bool bareui_font_packed_lookup(const bareui_font_t *font, uint32_t codepoint,
+                               bareui_font_glyph_t *glyph_out)
+{
+    if (!font || !font->user_data || !glyph_out) {
+        return false;
+    }
+    const bareui_font_packed_t *packed = font->user_data;
+    if (!packed->glyphs || !packed->bitmap) {
+        return false;
+    }
+    size_t lo = 0;
+    size_t hi = packed->glyph_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const bareui_font_packed_entry_t *entry = &packed->glyphs[mid];
+        if (entry->codepoint == codepoint) {
+            glyph_out->codepoint = codepoint;
+            glyph_out->width = entry->width;
+            glyph_out->height = entry->height;
+            glyph_out->columns = NULL;
+            glyph_out->spacing = entry->advance;
+            glyph_out->coverage = NULL;
+            glyph_out->bpp = 1;
+            glyph_out->rows = packed->bitmap + entry->offset;
+            glyph_out->offset_x = entry->bearing_x;
+            glyph_out->offset_y = (int8_t)(packed->baseline - entry->bearing_y);
+            return true;
+        }
+        if (entry->codepoint < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+static int bareui_font_packed_compare(const void *a, const void *b)
+{
+    uint32_t lhs = ((const bareui_font_packed_entry_t *)a)->codepoint;
+    uint32_t rhs = ((const bareui_font_packed_entry_t *)b)->codepoint;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+bareui_font_packed_t *bareui_font_packed_create_scaled(const bareui_font_t *source,
+                                                       const uint32_t *codepoints,
+                                                       size_t count, uint8_t scale)
+{
+    if (!source || !codepoints || count == 0 || scale == 0 ||
+        scale > BAREUI_FONT_PACKED_MAX_SCALE) {
+        return NULL;
+    }
+    /* bearing_y is an int8_t, width and advance are uint8_t */
+    if ((unsigned)source->height * scale > INT8_MAX ||
+        (unsigned)BAREUI_FONT_MAX_WIDTH * scale > UINT8_MAX) {
+        return NULL;
+    }
+    uint8_t height = (uint8_t)(source->height * scale);
+    size_t stride = bareui_font_packed_stride((uint8_t)(BAREUI_FONT_MAX_WIDTH * scale));
+    size_t glyph_bytes = stride * height;
+
+    bareui_font_packed_t *font = calloc(1, sizeof(*font));
+    bareui_font_packed_entry_t *glyphs = calloc(count, sizeof(*glyphs));
+    uint8_t *bitmap = calloc(count, glyph_bytes);
+    if (!font || !glyphs || !bitmap) {
+        free(font);
+        free(glyphs);
+        free(bitmap);
+        return NULL;
+    }
+
+    size_t used = 0;
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bareui_font_glyph_t glyph;
+        if (!bareui_font_lookup(source, codepoints[i], &glyph) || !glyph.columns) {
+            continue;
+        }
+        if ((unsigned)glyph.spacing * scale > UINT8_MAX) {
+            free(font);
+            free(glyphs);
+            free(bitmap);
+            return NULL;
+        }
+        bareui_font_packed_entry_t *entry = &glyphs[used++];
+        entry->codepoint = codepoints[i];
+        entry->width = (uint8_t)(glyph.width * scale);
+        entry->height = height;
+        entry->bearing_x = 0;
+        entry->bearing_y = (int8_t)height;
+        entry->advance = (uint8_t)(glyph.spacing * scale);
+        entry->offset = (uint32_t)offset;
+        size_t entry_stride = bareui_font_packed_stride(entry->width);
+        for (uint8_t row = 0; row < glyph.height; ++row) {
+            for (uint8_t col = 0; col < glyph.width; ++col) {
+                if (!(glyph.columns[col] & (1u << row))) {
+                    continue;
+                }
+                for (uint8_t sy = 0; sy < scale; ++sy) {
+                    uint8_t *dst = bitmap + offset + (size_t)(row * scale + sy) * entry_stride;
+                    for (uint8_t sx = 0; sx < scale; ++sx) {
+                        unsigned px = (unsigned)col * scale + sx;
+                        dst[px >> 3] |= (uint8_t)(0x80u >> (px & 7));
+                    }
+                }
+            }
+        }
+        offset += entry_stride * height;
+    }
+    qsort(glyphs, used, sizeof(*glyphs), bareui_font_packed_compare);
+
+    bareui_font_packed_init(font, height, height, glyphs, used, bitmap);
+    font->owned = bitmap;
+    return font;
+}
+
+void bareui_font_packed_destroy(bareui_font_packed_t *font)
+{
+    if (!font || !font->owned) {
+        return;
+    }
+    ui_text_engine_forget_font(&font->base);
+    free((void *)font->glyphs);
+    free(font->owned);
+    free(font);
+}
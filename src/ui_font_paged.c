@@ -0,0 +1,465 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ui_font_paged.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_text_engine.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BAREUI_PAGED_FONT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BAREUI_PAGED_FONT_HEADER_SIZE 20
+#define BAREUI_PAGED_FONT_DIR_ENTRY_SIZE 12
+/* pages of 256 codepoints up to U+10FFFF */
+#define BAREUI_PAGED_FONT_MAX_PAGES 0x1100u
+#define BAREUI_PAGED_FONT_BITMAP_SIZE (BAREUI_PAGED_FONT_PAGE_SIZE / 8)
+#define BAREUI_PAGED_FONT_RAW_MAX \
+    (BAREUI_PAGED_FONT_BITMAP_SIZE + BAREUI_PAGED_FONT_PAGE_SIZE * (1 + BAREUI_FONT_MAX_WIDTH))
+#define BAREUI_PAGED_FONT_NO_PAGE UINT32_MAX
+
+typedef struct {
+    uint32_t page;
+    uint32_t offset;
+    uint16_t packed_size;
+    uint16_t glyph_count;
+} bareui_paged_font_dir_t;
+
+typedef struct {
+    uint32_t page;
+    uint32_t stamp;
+    uint8_t present[BAREUI_PAGED_FONT_BITMAP_SIZE];
+    uint8_t widths[BAREUI_PAGED_FONT_PAGE_SIZE];
+    uint8_t columns[BAREUI_PAGED_FONT_PAGE_SIZE][BAREUI_FONT_MAX_WIDTH];
+} bareui_paged_font_slot_t;
+
+struct bareui_paged_font {
+    bareui_font_t base;
+    bareui_paged_font_read_fn read;
+    void *read_user_data;
+    const uint8_t *memory;
+    size_t memory_size;
+    void *map;
+    size_t map_size;
+    FILE *file;
+    uint8_t max_width;
+    bareui_paged_font_dir_t *directory;
+    size_t page_count;
+    size_t glyph_count;
+    bareui_paged_font_slot_t *slots;
+    size_t slot_count;
+    size_t last_slot;
+    uint32_t clock;
+    uint8_t *packed;
+    size_t packed_size;
+    uint8_t raw[BAREUI_PAGED_FONT_RAW_MAX];
+};
+
+static uint16_t bareui_paged_font_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t bareui_paged_font_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static bool bareui_paged_font_read_memory(void *user_data, uint32_t offset, void *dst,
+                                          size_t size)
+{
+    bareui_paged_font_t *font = user_data;
+    if (!font || !font->memory || offset > font->memory_size ||
+        size > font->memory_size - offset) {
+        return false;
+    }
+    memcpy(dst, font->memory + offset, size);
+    return true;
+}
+
+static bool bareui_paged_font_read_file(void *user_data, uint32_t offset, void *dst,
+                                        size_t size)
+{
+    bareui_paged_font_t *font = user_data;
+    if (!font || !font->file) {
+        return false;
+    }
+    if (fseek(font->file, (long)offset, SEEK_SET) != 0) {
+        return false;
+    }
+    return fread(dst, 1, size, font->file) == size;
+}
+
+/* PackBits: n < 128 copies n + 1 literals, n > 128 repeats the next byte 257 - n times */
+static size_t bareui_paged_font_unpack(const uint8_t *src, size_t src_len, uint8_t *dst,
+                                       size_t dst_cap)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in < src_len) {
+        uint8_t n = src[in++];
+        if (n < 128) {
+            size_t run = (size_t)n + 1;
+            if (in + run > src_len || out + run > dst_cap) {
+                return 0;
+            }
+            memcpy(dst + out, src + in, run);
+            in += run;
+            out += run;
+        } else if (n > 128) {
+            size_t run = 257 - (size_t)n;
+            if (in >= src_len || out + run > dst_cap) {
+                return 0;
+            }
+            memset(dst + out, src[in++], run);
+            out += run;
+        }
+    }
+    return out;
+}
+
+static const bareui_paged_font_dir_t *bareui_paged_font_find_page(const bareui_paged_font_t *font,
+                                                                  uint32_t page)
+{
+    size_t lo = 0;
+    size_t hi = font->page_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const bareui_paged_font_dir_t *entry = &font->directory[mid];
+        if (entry->page == page) {
+            return entry;
+        }
+        if (entry->page < page) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+static bool bareui_paged_font_decode(bareui_paged_font_t *font, const bareui_paged_font_dir_t *entry,
+                                     bareui_paged_font_slot_t *slot)
+{
+    const uint8_t *packed = NULL;
+    if (font->memory) {
+        if (entry->offset > font->memory_size ||
+            entry->packed_size > font->memory_size - entry->offset) {
+            return false;
+        }
+        packed = font->memory + entry->offset;
+    } else {
+        if (!font->read(font->read_user_data, entry->offset, font->packed, entry->packed_size)) {
+            return false;
+        }
+        packed = font->packed;
+    }
+
+    size_t raw_len = bareui_paged_font_unpack(packed, entry->packed_size, font->raw,
+                                              sizeof(font->raw));
+    if (raw_len < BAREUI_PAGED_FONT_BITMAP_SIZE) {
+        return false;
+    }
+    memcpy(slot->present, font->raw, BAREUI_PAGED_FONT_BITMAP_SIZE);
+    memset(slot->widths, 0, sizeof(slot->widths));
+    memset(slot->columns, 0, sizeof(slot->columns));
+
+    size_t pos = BAREUI_PAGED_FONT_BITMAP_SIZE;
+    for (size_t i = 0; i < BAREUI_PAGED_FONT_PAGE_SIZE; ++i) {
+        if (!(slot->present[i >> 3] & (1u << (i & 7)))) {
+            continue;
+        }
+        if (pos >= raw_len) {
+            return false;
+        }
+        uint8_t width = font->raw[pos++];
+        if (width > font->max_width || pos + width > raw_len) {
+            return false;
+        }
+        slot->widths[i] = width;
+        memcpy(slot->columns[i], font->raw + pos, width);
+        pos += width;
+    }
+    return true;
+}
+
+static bareui_paged_font_slot_t *bareui_paged_font_page(bareui_paged_font_t *font, uint32_t page)
+{
+    bareui_paged_font_slot_t *slot = &font->slots[font->last_slot];
+    if (slot->page == page) {
+        slot->stamp = ++font->clock;
+        return slot;
+    }
+
+    size_t victim = 0;
+    for (size_t i = 0; i < font->slot_count; ++i) {
+        slot = &font->slots[i];
+        if (slot->page == page) {
+            slot->stamp = ++font->clock;
+            font->last_slot = i;
+            return slot;
+        }
+        if (slot->stamp < font->slots[victim].stamp) {
+            victim = i;
+        }
+    }
+
+    const bareui_paged_font_dir_t *entry = bareui_paged_font_find_page(font, page);
+    if (!entry) {
+        return NULL;
+    }
+    slot = &font->slots[victim];
+    if (!bareui_paged_font_decode(font, entry, slot)) {
+        slot->page = BAREUI_PAGED_FONT_NO_PAGE;
+        slot->stamp = 0;
+        return NULL;
+    }
+    slot->page = page;
+    slot->stamp = ++font->clock;
+    font->last_slot = victim;
+    return slot;
+}
+
+static bool bareui_paged_font_lookup(const bareui_font_t *base, uint32_t codepoint,
+                                     bareui_font_glyph_t *glyph_out)
+{
+    if (!base || !base->user_data || !glyph_out) {
+        return false;
+    }
+    bareui_paged_font_t *font = base->user_data;
+    bareui_paged_font_slot_t *slot = bareui_paged_font_page(font, codepoint >> 8);
+    if (!slot) {
+        return false;
+    }
+    uint8_t index = (uint8_t)(codepoint & 0xFF);
+    if (!(slot->present[index >> 3] & (1u << (index & 7)))) {
+        return false;
+    }
+    glyph_out->codepoint = codepoint;
+    glyph_out->width = slot->widths[index];
+    glyph_out->height = font->base.height;
+    glyph_out->columns = slot->columns[index];
+    glyph_out->spacing = (uint8_t)(slot->widths[index] + BAREUI_FONT_SPACING);
+    glyph_out->coverage = NULL;
+    glyph_out->bpp = 1;
+    glyph_out->rows = NULL;
+    glyph_out->offset_x = 0;
+    glyph_out->offset_y = 0;
+    return true;
+}
+
+static bool bareui_paged_font_load(bareui_paged_font_t *font, size_t cache_pages)
+{
+    uint8_t header[BAREUI_PAGED_FONT_HEADER_SIZE];
+    if (!font->read(font->read_user_data, 0, header, sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header, BAREUI_PAGED_FONT_MAGIC, 4) != 0 ||
+        bareui_paged_font_u16(header + 4) != BAREUI_PAGED_FONT_VERSION) {
+        return false;
+    }
+    uint8_t height = header[6];
+    uint8_t max_width = header[7];
+    if (height == 0 || height > 8 || max_width > BAREUI_FONT_MAX_WIDTH) {
+        return false;
+    }
+    uint32_t page_count = bareui_paged_font_u32(header + 8);
+    uint32_t dir_offset = bareui_paged_font_u32(header + 12);
+    if (page_count > BAREUI_PAGED_FONT_MAX_PAGES ||
+        dir_offset > UINT32_MAX - page_count * BAREUI_PAGED_FONT_DIR_ENTRY_SIZE) {
+        return false;
+    }
+
+    font->directory = calloc(page_count ? page_count : 1, sizeof(*font->directory));
+    if (!font->directory) {
+        return false;
+    }
+    uint8_t raw_entry[BAREUI_PAGED_FONT_DIR_ENTRY_SIZE];
+    for (uint32_t i = 0; i < page_count; ++i) {
+        if (!font->read(font->read_user_data, dir_offset + i * BAREUI_PAGED_FONT_DIR_ENTRY_SIZE,
+                        raw_entry, sizeof(raw_entry))) {
+            return false;
+        }
+        bareui_paged_font_dir_t *entry = &font->directory[i];
+        entry->page = bareui_paged_font_u32(raw_entry);
+        entry->offset = bareui_paged_font_u32(raw_entry + 4);
+        entry->packed_size = bareui_paged_font_u16(raw_entry + 8);
+        entry->glyph_count = bareui_paged_font_u16(raw_entry + 10);
+        if (entry->page >= BAREUI_PAGED_FONT_MAX_PAGES ||
+            (i > 0 && entry->page <= font->directory[i - 1].page)) {
+            return false;
+        }
+    }
+
+    if (cache_pages == 0) {
+        cache_pages = BAREUI_PAGED_FONT_DEFAULT_CACHE;
+    }
+    if (!font->memory) {
+        for (uint32_t i = 0; i < page_count; ++i) {
+            if (font->directory[i].packed_size > font->packed_size) {
+                font->packed_size = font->directory[i].packed_size;
+            }
+        }
+        font->packed = malloc(font->packed_size ? font->packed_size : 1);
+        if (!font->packed) {
+            return false;
+        }
+    }
+    font->slots = calloc(cache_pages, sizeof(*font->slots));
+    if (!font->slots) {
+        return false;
+    }
+    for (size_t i = 0; i < cache_pages; ++i) {
+        font->slots[i].page = BAREUI_PAGED_FONT_NO_PAGE;
+    }
+    font->slot_count = cache_pages;
+    font->page_count = page_count;
+    font->glyph_count = bareui_paged_font_u32(header + 16);
+    font->max_width = max_width;
+    font->base.entries = NULL;
+    font->base.count = 0;
+    font->base.height = height;
+    font->base.lookup = bareui_paged_font_lookup;
+    font->base.user_data = font;
+    font->base.flags = BAREUI_FONT_FLAG_VOLATILE_GLYPHS;
+    return true;
+}
+
+static bareui_paged_font_t *bareui_paged_font_alloc(void)
+{
+    return calloc(1, sizeof(bareui_paged_font_t));
+}
+
+bareui_paged_font_t *bareui_paged_font_open_reader(bareui_paged_font_read_fn read,
+                                                   void *user_data, size_t cache_pages)
+{
+    if (!read) {
+        return NULL;
+    }
+    bareui_paged_font_t *font = bareui_paged_font_alloc();
+    if (!font) {
+        return NULL;
+    }
+    font->read = read;
+    font->read_user_data = user_data;
+    if (!bareui_paged_font_load(font, cache_pages)) {
+        bareui_paged_font_close(font);
+        return NULL;
+    }
+    return font;
+}
+
+bareui_paged_font_t *bareui_paged_font_open_memory(const void *data, size_t size,
+                                                   size_t cache_pages)
+{
+    if (!data || size < BAREUI_PAGED_FONT_HEADER_SIZE) {
+        return NULL;
+    }
+    bareui_paged_font_t *font = bareui_paged_font_alloc();
+    if (!font) {
+        return NULL;
+    }
+    font->memory = data;
+    font->memory_size = size;
+    font->read = bareui_paged_font_read_memory;
+    font->read_user_data = font;
+    if (!bareui_paged_font_load(font, cache_pages)) {
+        bareui_paged_font_close(font);
+        return NULL;
+    }
+    return font;
+}
+
+bareui_paged_font_t *bareui_paged_font_open(const char *path, size_t cache_pages)
+{
+    if (!path) {
+        return NULL;
+    }
+    bareui_paged_font_t *font = bareui_paged_font_alloc();
+    if (!font) {
+        return NULL;
+    }
+#ifdef BAREUI_PAGED_FONT_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= BAREUI_PAGED_FONT_HEADER_SIZE) {
+            void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                font->map = map;
+                font->map_size = (size_t)st.st_size;
+                font->memory = map;
+                font->memory_size = font->map_size;
+                font->read = bareui_paged_font_read_memory;
+            }
+        }
+        close(fd);
+    }
+#endif
+    if (!font->read) {
+        font->file = fopen(path, "rb");
+        if (!font->file) {
+            free(font);
+            return NULL;
+        }
+        font->read = bareui_paged_font_read_file;
+    }
+    font->read_user_data = font;
+    if (!bareui_paged_font_load(font, cache_pages)) {
+        bareui_paged_font_close(font);
+        return NULL;
+    }
+    return font;
+}
+
+void bareui_paged_font_close(bareui_paged_font_t *font)
+{
+    if (!font) {
+        return;
+    }
+    ui_text_engine_forget_font(&font->base);
+#ifdef BAREUI_PAGED_FONT_HAVE_MMAP
+    if (font->map) {
+        munmap(font->map, font->map_size);
+    }
+#endif
+    if (font->file) {
+        fclose(font->file);
+    }
+    free(font->directory);
+    free(font->slots);
+    free(font->packed);
+    free(font);
+}
+
+const bareui_font_t *bareui_paged_font_font(const bareui_paged_font_t *font)
+{
+    return font ? &font->base : NULL;
+}
+
+size_t bareui_paged_font_page_count(const bareui_paged_font_t *font)
+{
+    return font ? font->page_count : 0;
+}
+
+size_t bareui_paged_font_glyph_count(const bareui_paged_font_t *font)
+{
+    return font ? font->glyph_count : 0;
+}
+
+size_t bareui_paged_font_resident_bytes(const bareui_paged_font_t *font)
+{
+    if (!font) {
+        return 0;
+    }
+    return sizeof(*font) + font->page_count * sizeof(*font->directory) +
+           font->slot_count * sizeof(*font->slots) + font->packed_size;
+}
@@ -0,0 +1,446 @@
+#include "ui_list_view.h"
+
+#include "ui_scroller.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#define UI_LIST_VIEW_UNBOUND SIZE_MAX
+
+struct ui_list_view {
+    ui_widget_t base;
+    const ui_list_view_source_t *source;
+    void *user_data;
+    /* rows[slot] shows item bound[slot]; item i always lives in slot i % row_count */
+    ui_widget_t **rows;
+    size_t *bound;
+    size_t row_count;
+    size_t item_count;
+    int row_height;
+    int overscan;
+    ui_scroll_mode_t scroll_mode;
+    bool dragging;
+    int last_touch_y;
+    int scroll_offset;
+    ui_scroller_t scroller;
+};
+
+static ui_rect_t ui_list_view_content(const ui_list_view_t *list)
+{
+    const ui_style_t *style = ui_widget_style(&list->base);
+    ui_rect_t content = list->base.bounds;
+    content.x += style->padding_left;
+    content.y += style->padding_top;
+    content.width -= style->padding_left + style->padding_right;
+    content.height -= style->padding_top + style->padding_bottom;
+    if (content.width < 0) {
+        content.width = 0;
+    }
+    if (content.height < 0) {
+        content.height = 0;
+    }
+    return content;
+}
+
+static int ui_list_view_total_height(const ui_list_view_t *list)
+{
+    long long total = (long long)list->item_count * list->row_height;
+    return total > INT_MAX ? INT_MAX : (int)total;
+}
+
+static int ui_list_view_max_offset(const ui_list_view_t *list)
+{
+    int max_offset = ui_list_view_total_height(list) - ui_list_view_content(list).height;
+    return max_offset > 0 ? max_offset : 0;
+}
+
+static int ui_list_view_clamp_scroll(const ui_list_view_t *list, int value)
+{
+    if (list->scroll_mode == UI_SCROLL_MODE_NONE || value < 0) {
+        return 0;
+    }
+    int max_offset = ui_list_view_max_offset(list);
+    return value > max_offset ? max_offset : value;
+}
+
+/* Rows still in the window keep their pixels and move by blit; recycled rows
+ * repaint through their bind. Without a background of its own the list cannot
+ * blit over whatever shows through it. */
+static void ui_list_view_apply_scroll(ui_list_view_t *list, int offset)
+{
+    int previous = list->scroll_offset;
+    list->scroll_offset = ui_list_view_clamp_scroll(list, offset);
+    if (list->scroll_offset == previous) {
+        return;
+    }
+    if (!(ui_widget_style(&list->base)->flags & UI_STYLE_FLAG_BACKGROUND_COLOR) ||
+        !ui_widget_scroll_content(&list->base, 0, previous - list->scroll_offset)) {
+        ui_widget_invalidate(&list->base);
+        ui_widget_mark_needs_layout(&list->base);
+    }
+}
+
+static void ui_list_view_unbind_all(ui_list_view_t *list)
+{
+    for (size_t i = 0; i < list->row_count; ++i) {
+        list->bound[i] = UI_LIST_VIEW_UNBOUND;
+    }
+}
+
+static void ui_list_view_drop_rows(ui_list_view_t *list)
+{
+    for (size_t i = 0; i < list->row_count; ++i) {
+        ui_widget_remove_child(list->rows[i]);
+        if (list->source && list->source->destroy_row) {
+            list->source->destroy_row(list->user_data, list->rows[i]);
+        }
+    }
+    ui_arena_free(list->base.arena, list->rows);
+    ui_arena_free(list->base.arena, list->bound);
+    list->rows = NULL;
+    list->bound = NULL;
+    list->row_count = 0;
+}
+
+/* Grows the pool to needed rows; growing changes slot mapping, so all rows rebind. */
+static bool ui_list_view_ensure_rows(ui_list_view_t *list, size_t needed)
+{
+    if (needed <= list->row_count) {
+        return true;
+    }
+    if (!list->source || !list->source->create_row) {
+        return false;
+    }
+    ui_widget_t **rows = ui_arena_realloc(list->base.arena, list->rows, needed * sizeof(*rows));
+    if (!rows) {
+        return false;
+    }
+    list->rows = rows;
+    size_t *bound = ui_arena_realloc(list->base.arena, list->bound, needed * sizeof(*bound));
+    if (!bound) {
+        return false;
+    }
+    list->bound = bound;
+    while (list->row_count < needed) {
+        ui_widget_t *row = list->source->create_row(list->user_data, list->base.arena);
+        if (!row) {
+            break;
+        }
+        ui_widget_append_child(&list->base, row);
+        list->rows[list->row_count++] = row;
+    }
+    ui_list_view_unbind_all(list);
+    return list->row_count > 0;
+}
+
+static void ui_list_view_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    (void)bounds;
+    ui_list_view_t *list = (ui_list_view_t *)widget;
+    if (list->row_height <= 0) {
+        return;
+    }
+    ui_rect_t content = ui_list_view_content(list);
+    list->scroll_offset = ui_list_view_clamp_scroll(list, list->scroll_offset);
+
+    size_t overscan = (size_t)list->overscan;
+    size_t first = (size_t)(list->scroll_offset / list->row_height);
+    first = first > overscan ? first - overscan : 0;
+    size_t end = (size_t)((list->scroll_offset + content.height + list->row_height - 1) /
+                          list->row_height) +
+                 overscan;
+    if (end > list->item_count) {
+        end = list->item_count;
+    }
+    /* pool size depends on the viewport only, so scrolling never reallocates */
+    size_t needed = (size_t)(content.height / list->row_height) + 2 + 2 * overscan;
+    if (needed > list->item_count) {
+        needed = list->item_count;
+    }
+    if (needed == 0 || !ui_list_view_ensure_rows(list, needed)) {
+        for (size_t slot = 0; slot < list->row_count; ++slot) {
+            ui_widget_set_visible(list->rows[slot], false);
+        }
+        return;
+    }
+
+    size_t count = list->row_count;
+    for (size_t slot = 0; slot < count; ++slot) {
+        ui_widget_t *row = list->rows[slot];
+        size_t index = first + (slot + count - first % count) % count;
+        if (index >= end) {
+            ui_widget_set_visible(row, false);
+            continue;
+        }
+        if (list->bound[slot] != index) {
+            list->bound[slot] = index;
+            if (list->source->bind_row) {
+                list->source->bind_row(list->user_data, row, index);
+            }
+        }
+        ui_widget_set_visible(row, true);
+        long long y = (long long)content.y + (long long)index * list->row_height -
+                      list->scroll_offset;
+        ui_widget_place(row, content.x, (int)y, content.width, list->row_height);
+    }
+}
+
+static void ui_list_view_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                                 int *height)
+{
+    (void)max_width;
+    ui_list_view_t *list = (ui_list_view_t *)widget;
+    const ui_style_t *style = ui_widget_style(widget);
+    int padding_y = style->padding_top + style->padding_bottom;
+    int content = ui_list_view_total_height(list);
+    if (max_height > 0 && content > max_height - padding_y) {
+        content = max_height - padding_y > 0 ? max_height - padding_y : 0;
+    }
+    *width = style->padding_left + style->padding_right;
+    *height = content + padding_y;
+}
+
+static bool ui_list_view_handle_event(ui_widget_t *widget, const ui_event_t *event)
+{
+    if (!widget || !event) {
+        return false;
+    }
+    ui_list_view_t *list = (ui_list_view_t *)widget;
+    if (list->scroll_mode != UI_SCROLL_MODE_ENABLED) {
+        return false;
+    }
+    const ui_rect_t *bounds = &widget->bounds;
+    switch (event->type) {
+    case UI_EVENT_TOUCH_DOWN:
+        if (event->data.touch.x >= bounds->x && event->data.touch.x < bounds->x + bounds->width &&
+            event->data.touch.y >= bounds->y && event->data.touch.y < bounds->y + bounds->height) {
+            list->dragging = true;
+            list->last_touch_y = event->data.touch.y;
+            ui_scroller_stop(&list->scroller);
+            ui_scroller_track(&list->scroller, list->scroll_offset, ui_event_seconds(event));
+            return true;
+        }
+        break;
+    case UI_EVENT_TOUCH_MOVE:
+        if (!list->dragging) {
+            return false;
+        }
+        {
+            /* moves coalesced into this one only feed the velocity estimate */
+            size_t count = 0;
+            const ui_event_t *history = ui_widget_pointer_history(widget, &count);
+            int offset = list->scroll_offset;
+            for (size_t i = 0; i < count; ++i) {
+                offset = ui_list_view_clamp_scroll(
+                    list, offset + list->last_touch_y - history[i].data.touch.y);
+                list->last_touch_y = history[i].data.touch.y;
+                ui_scroller_track(&list->scroller, offset, ui_event_seconds(&history[i]));
+            }
+            offset += list->last_touch_y - event->data.touch.y;
+            list->last_touch_y = event->data.touch.y;
+            ui_list_view_apply_scroll(list, offset);
+            ui_scroller_track(&list->scroller, list->scroll_offset, ui_event_seconds(event));
+        }
+        return true;
+    case UI_EVENT_TOUCH_UP:
+        if (list->dragging) {
+            list->dragging = false;
+            if (ui_scroller_fling(&list->scroller, list->scroll_offset,
+                                  ui_event_seconds(event))) {
+                ui_widget_schedule_tick(widget);
+            }
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+static bool ui_list_view_tick(ui_widget_t *widget, double delta_seconds)
+{
+    ui_list_view_t *list = (ui_list_view_t *)widget;
+    int offset = list->scroll_offset;
+    bool moving = ui_scroller_step(&list->scroller, delta_seconds,
+                                   ui_list_view_max_offset(list), &offset);
+    ui_list_view_apply_scroll(list, offset);
+    return moving;
+}
+
+static bool ui_list_view_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    const ui_style_t *style = ui_widget_style(widget);
+    if (style->flags & UI_STYLE_FLAG_BACKGROUND_COLOR) {
+        ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
+                             style->background_color);
+    }
+    return true;
+}
+
+static void ui_list_view_destroy_internal(ui_widget_t *widget)
+{
+    if (!widget) {
+        return;
+    }
+    ui_list_view_drop_rows((ui_list_view_t *)widget);
+}
+
+static const ui_widget_ops_t ui_list_view_ops = {
+    .name = "list_view",
+    .render = ui_list_view_render,
+    .handle_event = ui_list_view_handle_event,
+    .destroy = ui_list_view_destroy_internal,
+    .measure = ui_list_view_measure,
+    .arrange = ui_list_view_arrange,
+    .event_mask = UI_EVENT_MASK_POINTER,
+    .manages_damage = true,
+    .tick = ui_list_view_tick
+};
+
+ui_list_view_t *ui_list_view_create(void)
+{
+    return ui_list_view_create_in(NULL);
+}
+
+ui_list_view_t *ui_list_view_create_in(ui_arena_t *arena)
+{
+    ui_list_view_t *list = ui_arena_alloc(arena, sizeof(*list));
+    if (!list) {
+        return NULL;
+    }
+    memset(list, 0, sizeof(*list));
+    ui_widget_init(&list->base, &ui_list_view_ops);
+    ui_widget_set_arena(&list->base, arena);
+    list->overscan = UI_LIST_VIEW_DEFAULT_OVERSCAN;
+    list->scroll_mode = UI_SCROLL_MODE_ENABLED;
+    return list;
+}
+
+void ui_list_view_destroy(ui_list_view_t *list)
+{
+    if (!list) {
+        return;
+    }
+    ui_list_view_destroy_internal(&list->base);
+    ui_widget_deinit(&list->base);
+    ui_arena_free(list->base.arena, list);
+}
+
+void ui_list_view_set_source(ui_list_view_t *list, const ui_list_view_source_t *source,
+                             void *user_data)
+{
+    if (!list) {
+        return;
+    }
+    ui_list_view_drop_rows(list);
+    list->source = source;
+    list->user_data = user_data;
+    ui_list_view_reload(list);
+}
+
+void ui_list_view_reload(ui_list_view_t *list)
+{
+    if (!list) {
+        return;
+    }
+    const ui_list_view_source_t *source = list->source;
+    list->item_count = source && source->item_count ? source->item_count(list->user_data) : 0;
+    list->row_height = source && source->row_height ? source->row_height(list->user_data) : 0;
+    if (list->row_height < 0) {
+        list->row_height = 0;
+    }
+    ui_list_view_unbind_all(list);
+    ui_widget_invalidate_measure(&list->base);
+}
+
+void ui_list_view_reload_item(ui_list_view_t *list, size_t index)
+{
+    if (!list || list->row_count == 0 || !list->source || !list->source->bind_row) {
+        return;
+    }
+    size_t slot = index % list->row_count;
+    if (list->bound[slot] == index) {
+        list->source->bind_row(list->user_data, list->rows[slot], index);
+    }
+}
+
+size_t ui_list_view_item_count(const ui_list_view_t *list)
+{
+    return list ? list->item_count : 0;
+}
+
+void ui_list_view_set_overscan(ui_list_view_t *list, int rows)
+{
+    if (list && rows >= 0) {
+        list->overscan = rows;
+        ui_widget_mark_needs_layout(&list->base);
+    }
+}
+
+int ui_list_view_overscan(const ui_list_view_t *list)
+{
+    return list ? list->overscan : 0;
+}
+
+size_t ui_list_view_row_count(const ui_list_view_t *list)
+{
+    return list ? list->row_count : 0;
+}
+
+void ui_list_view_set_scroll_mode(ui_list_view_t *list, ui_scroll_mode_t mode)
+{
+    if (list) {
+        list->scroll_mode = mode;
+        list->dragging = false;
+        ui_scroller_stop(&list->scroller);
+        list->scroll_offset = ui_list_view_clamp_scroll(list, list->scroll_offset);
+        ui_widget_mark_needs_layout(&list->base);
+    }
+}
+
+ui_scroll_mode_t ui_list_view_scroll_mode(const ui_list_view_t *list)
+{
+    return list ? list->scroll_mode : UI_SCROLL_MODE_NONE;
+}
+
+void ui_list_view_set_scroll_offset(ui_list_view_t *list, int offset)
+{
+    if (list) {
+        ui_scroller_stop(&list->scroller);
+        ui_list_view_apply_scroll(list, offset);
+    }
+}
+
+int ui_list_view_scroll_offset(const ui_list_view_t *list)
+{
+    return list ? list->scroll_offset : 0;
+}
+
+void ui_list_view_scroll_to_index(ui_list_view_t *list, size_t index)
+{
+    if (!list) {
+        return;
+    }
+    long long offset = (long long)index * list->row_height;
+    ui_list_view_set_scroll_offset(list, offset > INT_MAX ? INT_MAX : (int)offset);
+}
+
+size_t ui_list_view_first_visible(const ui_list_view_t *list)
+{
+    if (!list || list->row_height <= 0) {
+        return 0;
+    }
+    return (size_t)(list->scroll_offset / list->row_height);
+}
+
+const ui_widget_t *ui_list_view_widget(const ui_list_view_t *list)
+{
+    return list ? &list->base : NULL;
+}
+
+ui_widget_t *ui_list_view_widget_mutable(ui_list_view_t *list)
+{
+    return list ? &list->base : NULL;
+}
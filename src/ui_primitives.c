@@ -1,12 +1,18 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "ui_primitives.h"
 
 #include <math.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
-/* ASCII 5x7 fast path disabled for now; rely on font lookup */
+#include <time.h>
 
-#define UI_EVENT_QUEUE_SIZE 128
+#include "ui_event_queue.h"
+#include "ui_profile.h"
+#include "ui_text_engine.h"
+/* ASCII 5x7 fast path disabled for now; rely on font lookup */
 
 typedef struct {
     ui_rect_t rect;
@@ -14,14 +20,33 @@ typedef struct {
 } ui_clip_entry_t;
 
 #define UI_CLIP_STACK_DEPTH 32
+#define UI_FRAMEBUFFER_PIXELS (UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT)
+/* oldest flashes give way first */
+#define UI_DEBUG_MAX_FLASHES 64
+/* queue slots TOUCH_MOVE may not take, so a burst of moves cannot crowd out
+ * the TOUCH_UP or key release behind it */
+#define UI_CONTEXT_MOVE_RESERVE 16
+
+typedef struct {
+    ui_rect_t rect;
+    ui_color_t color;
+    bool outline_only;
+    uint8_t age; /* commits shown so far */
+} ui_debug_flash_t;
 
 struct ui_context {
     ui_color_t framebuffer[UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT];
     pthread_mutex_t fb_lock;
+    ui_event_mpsc_t events;
+    /* only for sleeping in wait_event; posting takes it just to wake a waiter */
     pthread_mutex_t ev_lock;
-    ui_event_t ev_queue[UI_EVENT_QUEUE_SIZE];
-    size_t ev_head;
-    size_t ev_count;
+    pthread_cond_t ev_ready;
+    atomic_bool ev_waiting;
+    atomic_bool ev_wake;
+    atomic_uint ev_dropped;
+    atomic_uint ev_dropped_moves;
+    /* UI thread: one clock read stamps every unstamped event of a drain */
+    uint64_t ev_drain_us;
     const ui_hal_ops_t *hal;
     void *user_data;
     const bareui_font_t *font;
@@ -32,6 +57,18 @@ struct ui_context {
     int dirty_max_y;
     ui_clip_entry_t clip_stack[UI_CLIP_STACK_DEPTH];
     size_t clip_stack_top;
+    bool text_background_set;
+    ui_color_t text_background;
+    bool ramp_valid;
+    ui_color_t ramp_fg;
+    ui_color_t ramp_bg;
+    ui_color_t ramp[16];
+    uint32_t repaint_epoch; /* bumped by ui_context_invalidate */
+    uint32_t debug_overlays;
+    uint8_t *overdraw;         /* UI_DEBUG_OVERLAY_OVERDRAW: writes since the last commit */
+    ui_color_t *overlay_frame; /* what the HAL gets while an overlay is on */
+    ui_debug_flash_t flashes[UI_DEBUG_MAX_FLASHES];
+    size_t flash_count;
 };
 
 static inline const ui_clip_entry_t *ui_context_clip_top(const ui_context_t *ctx)
@@ -60,6 +97,11 @@ static inline bool ui_point_in_rect(const ui_rect_t *rect, int x, int y)
     return x >= rect->x && x < rect->x + rect->width && y >= rect->y && y < rect->y + rect->height;
 }
 
+static inline void ui_count_overdraw(uint8_t *count)
+{
+    *count += *count < UINT8_MAX;
+}
+
 static inline void ui_set_pixel_locked(ui_context_t *ctx, int x, int y, ui_color_t color)
 {
     if ((unsigned)x >= UI_FRAMEBUFFER_WIDTH || (unsigned)y >= UI_FRAMEBUFFER_HEIGHT) {
@@ -69,6 +111,9 @@ static inline void ui_set_pixel_locked(ui_context_t *ctx, int x, int y, ui_color
         return;
     }
     ctx->framebuffer[y * UI_FRAMEBUFFER_WIDTH + x] = color;
+    if (ctx->overdraw) {
+        ui_count_overdraw(&ctx->overdraw[y * UI_FRAMEBUFFER_WIDTH + x]);
+    }
 }
 
 static void ui_reset_dirty(ui_context_t *ctx)
@@ -80,7 +125,10 @@ static void ui_reset_dirty(ui_context_t *ctx)
     ctx->dirty_max_y = 0;
 }
 
-static void ui_mark_dirty_locked(ui_context_t *ctx, int x, int y, int width, int height)
+/* Writers that cover their whole box count it as overdraw here; glyphs and
+ * single pixels count only the pixels they set and pass false. */
+static void ui_mark_written_locked(ui_context_t *ctx, int x, int y, int width, int height,
+                                   bool count_overdraw)
 {
     if (!ctx || width <= 0 || height <= 0) {
         return;
@@ -98,6 +146,15 @@ static void ui_mark_dirty_locked(ui_context_t *ctx, int x, int y, int width, int
     if (x0 >= x1 || y0 >= y1) {
         return;
     }
+    UI_PROFILE_DRAW((x1 - x0) * (y1 - y0));
+    if (count_overdraw && ctx->overdraw) {
+        for (int row = y0; row < y1; ++row) {
+            uint8_t *count = &ctx->overdraw[row * UI_FRAMEBUFFER_WIDTH];
+            for (int col = x0; col < x1; ++col) {
+                ui_count_overdraw(&count[col]);
+            }
+        }
+    }
     if (!ctx->dirty) {
         ctx->dirty = true;
         ctx->dirty_min_x = x0;
@@ -120,43 +177,156 @@ static void ui_mark_dirty_locked(ui_context_t *ctx, int x, int y, int width, int
     }
 }
 
-static bool ui_next_codepoint(const char **text, uint32_t *out)
+static void ui_mark_dirty_locked(ui_context_t *ctx, int x, int y, int width, int height)
 {
-    if (!text || !*text || !out) {
-        return false;
-    }
-    const unsigned char *ptr = (const unsigned char *)*text;
-    uint32_t cp = *ptr++;
-    if (cp < 0x80) {
-        *out = cp;
-        *text = (const char *)ptr;
-        return true;
+    ui_mark_written_locked(ctx, x, y, width, height, true);
+}
+
+static bool ui_context_clip_rect(ui_context_t *ctx, int *x0, int *y0, int *x1, int *y1);
+
+/* alpha in 0..32 */
+static inline ui_color_t ui_color_blend(ui_color_t fg, ui_color_t bg, uint32_t alpha)
+{
+    uint32_t f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81Fu;
+    uint32_t b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81Fu;
+    uint32_t mixed = ((f * alpha + b * (32 - alpha)) >> 5) & 0x07E0F81Fu;
+    return (ui_color_t)(mixed | (mixed >> 16));
+}
+
+static const ui_color_t *ui_context_text_ramp(ui_context_t *ctx, ui_color_t color)
+{
+    if (!ctx->ramp_valid || ctx->ramp_fg != color || ctx->ramp_bg != ctx->text_background) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            ctx->ramp[i] = ui_color_blend(color, ctx->text_background, (i * 32 + 7) / 15);
+        }
+        ctx->ramp_fg = color;
+        ctx->ramp_bg = ctx->text_background;
+        ctx->ramp_valid = true;
     }
+    return ctx->ramp;
+}
 
-    int extra = 0;
-    if ((cp & 0xE0) == 0xC0) {
-        cp &= 0x1F;
-        extra = 1;
-    } else if ((cp & 0xF0) == 0xE0) {
-        cp &= 0x0F;
-        extra = 2;
-    } else if ((cp & 0xF8) == 0xF0) {
-        cp &= 0x07;
-        extra = 3;
-    } else {
-        return false;
+static void ui_draw_glyph_aa_locked(ui_context_t *ctx, int x, int y,
+                                    const bareui_font_glyph_t *glyph, ui_color_t color)
+{
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + glyph->width;
+    int y1 = y + glyph->height;
+    if (x1 > UI_FRAMEBUFFER_WIDTH) {
+        x1 = UI_FRAMEBUFFER_WIDTH;
+    }
+    if (y1 > UI_FRAMEBUFFER_HEIGHT) {
+        y1 = UI_FRAMEBUFFER_HEIGHT;
+    }
+    if (x0 >= x1 || y0 >= y1 || !ui_context_clip_rect(ctx, &x0, &y0, &x1, &y1)) {
+        return;
     }
 
-    for (int i = 0; i < extra; ++i) {
-        if ((ptr[i] & 0xC0) != 0x80) {
-            return false;
+    const unsigned bpp = glyph->bpp == 2 ? 2 : 4;
+    const unsigned levels = (1u << bpp) - 1;
+    const unsigned per_byte = 8 / bpp;
+    const size_t stride = ((size_t)glyph->width * bpp + 7) / 8;
+    /* 2bpp levels land on every fifth ramp entry */
+    const unsigned ramp_step = 15 / levels;
+    const ui_color_t *ramp = ctx->text_background_set ? ui_context_text_ramp(ctx, color) : NULL;
+
+    for (int row = y0; row < y1; ++row) {
+        const uint8_t *src = glyph->coverage + (size_t)(row - y) * stride;
+        ui_color_t *dst = &ctx->framebuffer[row * UI_FRAMEBUFFER_WIDTH];
+        uint8_t *overdraw = ctx->overdraw ? &ctx->overdraw[row * UI_FRAMEBUFFER_WIDTH] : NULL;
+        for (int col = x0; col < x1; ++col) {
+            unsigned index = (unsigned)(col - x);
+            unsigned shift = 8 - bpp - (index % per_byte) * bpp;
+            unsigned value = (src[index / per_byte] >> shift) & levels;
+            if (value == 0) {
+                continue;
+            }
+            if (overdraw) {
+                ui_count_overdraw(&overdraw[col]);
+            }
+            if (value == levels) {
+                dst[col] = color;
+            } else if (ramp) {
+                dst[col] = ramp[value * ramp_step];
+            } else {
+                dst[col] = ui_color_blend(color, dst[col], (value * 32 + levels / 2) / levels);
+            }
         }
-        cp = (cp << 6) | (ptr[i] & 0x3F);
     }
+    ui_mark_written_locked(ctx, x0, y0, x1 - x0, y1 - y0, false);
+}
 
-    *text = (const char *)(ptr + extra);
-    *out = cp;
-    return true;
+/* 0xFFFF lanes for each set bit of a nibble, leftmost pixel first in memory */
+static const uint16_t ui_nibble_lanes[16][4] = {
+    {0, 0, 0, 0},                    {0, 0, 0, 0xFFFF},
+    {0, 0, 0xFFFF, 0},               {0, 0, 0xFFFF, 0xFFFF},
+    {0, 0xFFFF, 0, 0},               {0, 0xFFFF, 0, 0xFFFF},
+    {0, 0xFFFF, 0xFFFF, 0},          {0, 0xFFFF, 0xFFFF, 0xFFFF},
+    {0xFFFF, 0, 0, 0},               {0xFFFF, 0, 0, 0xFFFF},
+    {0xFFFF, 0, 0xFFFF, 0},          {0xFFFF, 0, 0xFFFF, 0xFFFF},
+    {0xFFFF, 0xFFFF, 0, 0},          {0xFFFF, 0xFFFF, 0, 0xFFFF},
+    {0xFFFF, 0xFFFF, 0xFFFF, 0},     {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF}
+};
+
+static void ui_draw_glyph_rows_locked(ui_context_t *ctx, int x, int y,
+                                      const bareui_font_glyph_t *glyph, ui_color_t color)
+{
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + glyph->width;
+    int y1 = y + glyph->height;
+    if (x1 > UI_FRAMEBUFFER_WIDTH) {
+        x1 = UI_FRAMEBUFFER_WIDTH;
+    }
+    if (y1 > UI_FRAMEBUFFER_HEIGHT) {
+        y1 = UI_FRAMEBUFFER_HEIGHT;
+    }
+    if (x0 >= x1 || y0 >= y1 || !ui_context_clip_rect(ctx, &x0, &y0, &x1, &y1)) {
+        return;
+    }
+
+    const size_t stride = ((size_t)glyph->width + 7) / 8;
+    const ui_color_t fill[4] = {color, color, color, color};
+    uint64_t color4;
+    memcpy(&color4, fill, sizeof(color4));
+
+    for (int row = y0; row < y1; ++row) {
+        const uint8_t *src = glyph->rows + (size_t)(row - y) * stride;
+        ui_color_t *dst = &ctx->framebuffer[row * UI_FRAMEBUFFER_WIDTH];
+        uint8_t *overdraw = ctx->overdraw ? &ctx->overdraw[row * UI_FRAMEBUFFER_WIDTH] : NULL;
+        for (int gx = 0; gx < glyph->width; gx += 4) {
+            unsigned nibble = (src[gx >> 3] >> (4 - (gx & 4))) & 0x0F;
+            if (nibble == 0) {
+                continue;
+            }
+            int px = x + gx;
+            if (px >= x0 && px + 4 <= x1) {
+                uint64_t mask;
+                uint64_t pixels;
+                memcpy(&mask, ui_nibble_lanes[nibble], sizeof(mask));
+                memcpy(&pixels, dst + px, sizeof(pixels));
+                pixels = (pixels & ~mask) | (color4 & mask);
+                memcpy(dst + px, &pixels, sizeof(pixels));
+                for (int i = 0; overdraw && i < 4; ++i) {
+                    if (nibble & (8u >> i)) {
+                        ui_count_overdraw(&overdraw[px + i]);
+                    }
+                }
+                continue;
+            }
+            for (int i = 0; i < 4; ++i) {
+                int cx = px + i;
+                if ((nibble & (8u >> i)) && cx >= x0 && cx < x1) {
+                    dst[cx] = color;
+                    if (overdraw) {
+                        ui_count_overdraw(&overdraw[cx]);
+                    }
+                }
+            }
+        }
+    }
+    ui_mark_written_locked(ctx, x0, y0, x1 - x0, y1 - y0, false);
 }
 
 static bool ui_context_get_glyph(ui_context_t *ctx, uint32_t codepoint,
@@ -165,19 +335,26 @@ static bool ui_context_get_glyph(ui_context_t *ctx, uint32_t codepoint,
     if (!ctx || !glyph || !ctx->font) {
         return false;
     }
-    if (bareui_font_lookup(ctx->font, codepoint, glyph)) {
-        return true;
-    }
-    if (codepoint != '?') {
-        return bareui_font_lookup(ctx->font, '?', glyph);
-    }
-    return false;
+    return ui_text_engine_glyph(ctx->font, codepoint, glyph);
 }
 
 static void ui_draw_glyph_locked(ui_context_t *ctx, int x, int y,
                                  const bareui_font_glyph_t *glyph, ui_color_t color)
 {
-    if (!ctx || !glyph || !glyph->columns) {
+    if (!ctx || !glyph) {
+        return;
+    }
+    x += glyph->offset_x;
+    y += glyph->offset_y;
+    if (glyph->coverage) {
+        ui_draw_glyph_aa_locked(ctx, x, y, glyph, color);
+        return;
+    }
+    if (glyph->rows) {
+        ui_draw_glyph_rows_locked(ctx, x, y, glyph, color);
+        return;
+    }
+    if (!glyph->columns) {
         return;
     }
 
@@ -189,7 +366,7 @@ static void ui_draw_glyph_locked(ui_context_t *ctx, int x, int y,
             }
         }
     }
-    ui_mark_dirty_locked(ctx, x, y, glyph->width, glyph->height);
+    ui_mark_written_locked(ctx, x, y, glyph->width, glyph->height, false);
 }
 
 /* removed */
@@ -208,15 +385,34 @@ ui_context_t *ui_context_create(const ui_hal_ops_t *hal)
     memset(ctx->framebuffer, 0, sizeof(ctx->framebuffer));
     pthread_mutex_init(&ctx->fb_lock, NULL);
     pthread_mutex_init(&ctx->ev_lock, NULL);
-    ctx->ev_head = 0;
-    ctx->ev_count = 0;
+    /* wait_event deadlines must not jump with the wall clock */
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&ctx->ev_ready, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    ui_event_mpsc_init(&ctx->events);
+    atomic_init(&ctx->ev_waiting, false);
+    atomic_init(&ctx->ev_wake, false);
+    atomic_init(&ctx->ev_dropped, 0);
+    atomic_init(&ctx->ev_dropped_moves, 0);
+    ctx->ev_drain_us = 0;
     ctx->hal = hal;
     ctx->user_data = hal->user_data;
     ctx->font = bareui_font_default();
     ui_reset_dirty(ctx);
     ctx->clip_stack_top = 0;
+    ctx->text_background_set = false;
+    ctx->text_background = 0;
+    ctx->ramp_valid = false;
+    ctx->repaint_epoch = 0;
+    ctx->debug_overlays = UI_DEBUG_OVERLAY_NONE;
+    ctx->overdraw = NULL;
+    ctx->overlay_frame = NULL;
+    ctx->flash_count = 0;
 
     if (!hal->init(ctx)) {
+        pthread_cond_destroy(&ctx->ev_ready);
         pthread_mutex_destroy(&ctx->ev_lock);
         pthread_mutex_destroy(&ctx->fb_lock);
         free(ctx);
@@ -234,8 +430,11 @@ void ui_context_destroy(ui_context_t *ctx)
     if (ctx->hal && ctx->hal->deinit) {
         ctx->hal->deinit(ctx);
     }
+    pthread_cond_destroy(&ctx->ev_ready);
     pthread_mutex_destroy(&ctx->ev_lock);
     pthread_mutex_destroy(&ctx->fb_lock);
+    free(ctx->overdraw);
+    free(ctx->overlay_frame);
     free(ctx);
 }
 
@@ -261,7 +460,8 @@ static bool ui_context_clip_rect(ui_context_t *ctx, int *x0, int *y0, int *x1, i
     if (!clip || !clip->enabled) {
         return true;
     }
-    if (*x1 <= clip->rect.x || *y1 <= clip->rect.y ||
+    if (clip->rect.width <= 0 || clip->rect.height <= 0 || *x1 <= clip->rect.x ||
+        *y1 <= clip->rect.y ||
         *x0 >= clip->rect.x + clip->rect.width ||
         *y0 >= clip->rect.y + clip->rect.height) {
         return false;
@@ -290,59 +490,46 @@ void ui_context_push_clip(ui_context_t *ctx, const ui_rect_t *bounds)
         return;
     }
     ui_clip_entry_t entry = {{0}, false};
+    const ui_clip_entry_t *parent = ui_context_clip_top(ctx);
     ui_rect_t clip = *bounds;
     if (clip.width <= 0 || clip.height <= 0) {
-        entry.enabled = false;
+        /* unsized groups clip like their parent */
+        if (parent) {
+            entry = *parent;
+        }
     } else {
-        int x0 = clip.x;
-        int y0 = clip.y;
+        int x0 = clip.x < 0 ? 0 : clip.x;
+        int y0 = clip.y < 0 ? 0 : clip.y;
         int x1 = clip.x + clip.width;
         int y1 = clip.y + clip.height;
-        if (x0 < 0) {
-            x0 = 0;
-        }
-        if (y0 < 0) {
-            y0 = 0;
-        }
         if (x1 > UI_FRAMEBUFFER_WIDTH) {
             x1 = UI_FRAMEBUFFER_WIDTH;
         }
         if (y1 > UI_FRAMEBUFFER_HEIGHT) {
             y1 = UI_FRAMEBUFFER_HEIGHT;
         }
-        if (x1 > x0 && y1 > y0) {
-            clip.x = x0;
-            clip.y = y0;
-            clip.width = x1 - x0;
-            clip.height = y1 - y0;
-            const ui_clip_entry_t *parent = ui_context_clip_top(ctx);
-            if (parent && parent->enabled) {
-                int px0 = parent->rect.x;
-                int py0 = parent->rect.y;
-                int px1 = parent->rect.x + parent->rect.width;
-                int py1 = parent->rect.y + parent->rect.height;
-                if (clip.x < px0) {
-                    clip.x = px0;
-                }
-                if (clip.y < py0) {
-                    clip.y = py0;
-                }
-                if (clip.x + clip.width > px1) {
-                    clip.width = px1 - clip.x;
-                }
-                if (clip.y + clip.height > py1) {
-                    clip.height = py1 - clip.y;
-                }
+        if (parent && parent->enabled) {
+            if (x0 < parent->rect.x) {
+                x0 = parent->rect.x;
+            }
+            if (y0 < parent->rect.y) {
+                y0 = parent->rect.y;
+            }
+            if (x1 > parent->rect.x + parent->rect.width) {
+                x1 = parent->rect.x + parent->rect.width;
             }
-            if (clip.width > 0 && clip.height > 0) {
-                entry.rect = clip;
-                entry.enabled = true;
+            if (y1 > parent->rect.y + parent->rect.height) {
+                y1 = parent->rect.y + parent->rect.height;
             }
         }
-    }
-    if (!entry.enabled) {
-        entry.rect = *bounds;
-        entry.enabled = false;
+        /* a widget entirely outside its parent's clip draws nothing */
+        entry.enabled = true;
+        if (x1 > x0 && y1 > y0) {
+            entry.rect.x = x0;
+            entry.rect.y = y0;
+            entry.rect.width = x1 - x0;
+            entry.rect.height = y1 - y0;
+        }
     }
     ctx->clip_stack[ctx->clip_stack_top++] = entry;
 }
@@ -355,6 +542,16 @@ void ui_context_pop_clip(ui_context_t *ctx)
     ctx->clip_stack_top--;
 }
 
+static void ui_fill_locked(ui_context_t *ctx, int x0, int y0, int x1, int y1, ui_color_t color)
+{
+    for (int row = y0; row < y1; ++row) {
+        ui_color_t *base = &ctx->framebuffer[row * UI_FRAMEBUFFER_WIDTH + x0];
+        for (int col = x0; col < x1; ++col) {
+            *base++ = color;
+        }
+    }
+}
+
 void ui_context_fill_rect(ui_context_t *ctx, int x, int y, int width, int height,
                           ui_color_t color)
 {
@@ -376,12 +573,7 @@ void ui_context_fill_rect(ui_context_t *ctx, int x, int y, int width, int height
     }
 
     pthread_mutex_lock(&ctx->fb_lock);
-    for (int row = y0; row < y1; ++row) {
-        ui_color_t *base = &ctx->framebuffer[row * UI_FRAMEBUFFER_WIDTH + x0];
-        for (int col = x0; col < x1; ++col) {
-            *base++ = color;
-        }
-    }
+    ui_fill_locked(ctx, x0, y0, x1, y1, color);
     ui_mark_dirty_locked(ctx, x0, y0, x1 - x0, y1 - y0);
     pthread_mutex_unlock(&ctx->fb_lock);
 }
@@ -394,7 +586,7 @@ void ui_context_set_pixel(ui_context_t *ctx, int x, int y, ui_color_t color)
     pthread_mutex_lock(&ctx->fb_lock);
     if (ui_context_point_visible(ctx, x, y)) {
         ui_set_pixel_locked(ctx, x, y, color);
-        ui_mark_dirty_locked(ctx, x, y, 1, 1);
+        ui_mark_written_locked(ctx, x, y, 1, 1, false);
     }
     pthread_mutex_unlock(&ctx->fb_lock);
 }
@@ -433,39 +625,83 @@ bool ui_context_blit(ui_context_t *ctx, const ui_color_t *src, int src_width,
     return true;
 }
 
-bool ui_context_scroll(ui_context_t *ctx, int dx, int dy, ui_color_t fill)
+/* Shifts the pixels of an on-screen rect; the vacated strip keeps its old
+ * contents. Caller holds fb_lock. */
+static void ui_scroll_rect_locked(ui_context_t *ctx, int x0, int y0, int x1, int y1, int dx,
+                                  int dy)
 {
-    if (!ctx) {
+    int width = x1 - x0;
+    int height = y1 - y0;
+    int adx = dx < 0 ? -dx : dx;
+    int ady = dy < 0 ? -dy : dy;
+    if (adx >= width || ady >= height) {
+        return;
+    }
+    size_t row_bytes = (size_t)(width - adx) * sizeof(ui_color_t);
+    int src_x = dx > 0 ? x0 : x0 + adx;
+    int dst_x = dx > 0 ? x0 + adx : x0;
+    int rows = height - ady;
+    for (int i = 0; i < rows; ++i) {
+        /* walk against the shift so no source row is overwritten before use */
+        int dst_y = dy > 0 ? y1 - 1 - i : y0 + i;
+        int src_y = dst_y - dy;
+        memmove(&ctx->framebuffer[dst_y * UI_FRAMEBUFFER_WIDTH + dst_x],
+                &ctx->framebuffer[src_y * UI_FRAMEBUFFER_WIDTH + src_x], row_bytes);
+    }
+}
+
+bool ui_context_scroll_rect(ui_context_t *ctx, const ui_rect_t *rect, int dx, int dy)
+{
+    if (!ctx || !rect) {
+        return false;
+    }
+    int x0 = rect->x < 0 ? 0 : rect->x;
+    int y0 = rect->y < 0 ? 0 : rect->y;
+    int x1 = rect->x + rect->width;
+    int y1 = rect->y + rect->height;
+    if (x1 > UI_FRAMEBUFFER_WIDTH) {
+        x1 = UI_FRAMEBUFFER_WIDTH;
+    }
+    if (y1 > UI_FRAMEBUFFER_HEIGHT) {
+        y1 = UI_FRAMEBUFFER_HEIGHT;
+    }
+    if (x0 >= x1 || y0 >= y1) {
         return false;
     }
     if (dx == 0 && dy == 0) {
         return true;
     }
-    size_t total = (size_t)UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT;
-    ui_color_t *temp = malloc(total * sizeof(ui_color_t));
-    if (!temp) {
+    pthread_mutex_lock(&ctx->fb_lock);
+    ui_scroll_rect_locked(ctx, x0, y0, x1, y1, dx, dy);
+    ui_mark_dirty_locked(ctx, x0, y0, x1 - x0, y1 - y0);
+    pthread_mutex_unlock(&ctx->fb_lock);
+    return true;
+}
+
+bool ui_context_scroll(ui_context_t *ctx, int dx, int dy, ui_color_t fill)
+{
+    if (!ctx) {
         return false;
     }
+    if (dx == 0 && dy == 0) {
+        return true;
+    }
+    int w = UI_FRAMEBUFFER_WIDTH;
+    int h = UI_FRAMEBUFFER_HEIGHT;
+    /* exposed bands, clamped to the screen */
+    int top = dy > 0 ? (dy < h ? dy : h) : 0;
+    int bottom = dy < 0 ? (-dy < h ? -dy : h) : 0;
+    int left = dx > 0 ? (dx < w ? dx : w) : 0;
+    int right = dx < 0 ? (-dx < w ? -dx : w) : 0;
 
     pthread_mutex_lock(&ctx->fb_lock);
-    memcpy(temp, ctx->framebuffer, total * sizeof(ui_color_t));
-    for (int y = 0; y < UI_FRAMEBUFFER_HEIGHT; ++y) {
-        for (int x = 0; x < UI_FRAMEBUFFER_WIDTH; ++x) {
-            int src_x = x - dx;
-            int src_y = y - dy;
-            if (src_x >= 0 && src_x < UI_FRAMEBUFFER_WIDTH &&
-                src_y >= 0 && src_y < UI_FRAMEBUFFER_HEIGHT) {
-                ctx->framebuffer[y * UI_FRAMEBUFFER_WIDTH + x] =
-                    temp[src_y * UI_FRAMEBUFFER_WIDTH + src_x];
-            } else {
-                ctx->framebuffer[y * UI_FRAMEBUFFER_WIDTH + x] = fill;
-            }
-        }
-    }
-    ui_mark_dirty_locked(ctx, 0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT);
+    ui_scroll_rect_locked(ctx, 0, 0, w, h, dx, dy);
+    ui_fill_locked(ctx, 0, 0, w, top, fill);
+    ui_fill_locked(ctx, 0, h - bottom, w, h, fill);
+    ui_fill_locked(ctx, 0, 0, left, h, fill);
+    ui_fill_locked(ctx, w - right, 0, w, h, fill);
+    ui_mark_dirty_locked(ctx, 0, 0, w, h);
     pthread_mutex_unlock(&ctx->fb_lock);
-
-    free(temp);
     return true;
 }
 
@@ -488,6 +724,14 @@ void ui_context_draw_codepoint(ui_context_t *ctx, int x, int y, uint32_t codepoi
 
 void ui_context_draw_text(ui_context_t *ctx, int x, int y, const char *text,
                           ui_color_t color)
+{
+    if (text) {
+        ui_context_draw_text_len(ctx, x, y, text, strlen(text), color);
+    }
+}
+
+void ui_context_draw_text_len(ui_context_t *ctx, int x, int y, const char *text, size_t len,
+                              ui_color_t color)
 {
     if (!ctx || !text) {
         return;
@@ -495,14 +739,17 @@ void ui_context_draw_text(ui_context_t *ctx, int x, int y, const char *text,
 
     int cursor = x;
     int baseline = y;
-    const char *ptr = text;
+    size_t pos = 0;
     int line_height = (ctx->font ? ctx->font->height : BAREUI_FONT_HEIGHT) + 1;
 
-    while (*ptr) {
+    pthread_mutex_lock(&ctx->fb_lock);
+    while (pos < len) {
         uint32_t codepoint;
-        if (!ui_next_codepoint(&ptr, &codepoint)) {
+        size_t adv = ui_utf8_decode(text + pos, len - pos, &codepoint);
+        if (adv == 0 || codepoint == '\0') {
             break;
         }
+        pos += adv;
         if (codepoint == '\n') {
             cursor = x;
             baseline += line_height;
@@ -513,11 +760,44 @@ void ui_context_draw_text(ui_context_t *ctx, int x, int y, const char *text,
         if (!ui_context_get_glyph(ctx, codepoint, &glyph)) {
             continue;
         }
-        pthread_mutex_lock(&ctx->fb_lock);
         ui_draw_glyph_locked(ctx, cursor, baseline, &glyph, color);
-        pthread_mutex_unlock(&ctx->fb_lock);
         cursor += glyph.spacing;
     }
+    pthread_mutex_unlock(&ctx->fb_lock);
+}
+
+void ui_context_draw_shaped_text(ui_context_t *ctx, int x, int y,
+                                 const ui_shaped_text_t *shaped, ui_color_t color)
+{
+    if (!ctx || !shaped || !shaped->glyphs) {
+        return;
+    }
+
+    const bareui_font_t *font = shaped->font;
+    bool volatile_glyphs = font && (font->flags & BAREUI_FONT_FLAG_VOLATILE_GLYPHS);
+    int line_height = shaped->height + 1;
+    int cursor = x;
+    int baseline = y;
+
+    pthread_mutex_lock(&ctx->fb_lock);
+    for (size_t i = 0; i < shaped->count; ++i) {
+        const bareui_font_glyph_t *glyph = &shaped->glyphs[i];
+        if (glyph->codepoint == '\n') {
+            cursor = x;
+            baseline += line_height;
+            continue;
+        }
+        if (volatile_glyphs) {
+            bareui_font_glyph_t fresh;
+            if (ui_text_engine_glyph(font, glyph->codepoint, &fresh)) {
+                ui_draw_glyph_locked(ctx, cursor, baseline, &fresh, color);
+            }
+        } else {
+            ui_draw_glyph_locked(ctx, cursor, baseline, glyph, color);
+        }
+        cursor += glyph->spacing;
+    }
+    pthread_mutex_unlock(&ctx->fb_lock);
 }
 
 void ui_context_draw_polygon(ui_context_t *ctx, const ui_point_t *points,
@@ -598,53 +878,356 @@ void ui_context_draw_polygon(ui_context_t *ctx, const ui_point_t *points,
     free(intersections);
 }
 
+uint64_t ui_event_time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+double ui_event_seconds(const ui_event_t *event)
+{
+    uint64_t timestamp = event && event->timestamp_us ? event->timestamp_us : ui_event_time_now();
+    return (double)timestamp * 1e-6;
+}
+
 bool ui_context_poll_event(ui_context_t *ctx, ui_event_t *event)
 {
     if (!ctx || !event) {
         return false;
     }
-    pthread_mutex_lock(&ctx->ev_lock);
-    if (ctx->ev_count == 0) {
-        pthread_mutex_unlock(&ctx->ev_lock);
+    if (!ui_event_mpsc_pop(&ctx->events, event)) {
+        ctx->ev_drain_us = 0;
         return false;
     }
-    *event = ctx->ev_queue[ctx->ev_head];
-    ctx->ev_head = (ctx->ev_head + 1) % UI_EVENT_QUEUE_SIZE;
-    ctx->ev_count--;
-    pthread_mutex_unlock(&ctx->ev_lock);
+    /* stamped here rather than in post_event, so producers never read the
+     * clock; events popped before the queue next runs dry share the stamp */
+    if (event->timestamp_us == 0) {
+        if (ctx->ev_drain_us == 0) {
+            ctx->ev_drain_us = ui_event_time_now();
+        }
+        event->timestamp_us = ctx->ev_drain_us;
+    }
     return true;
 }
 
+/* Pairs with the fence in wait_event: either the waiter sees what was just
+ * published or this sees the waiter and signals under the lock. */
+static void ui_context_signal(ui_context_t *ctx)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ctx->ev_waiting, memory_order_relaxed)) {
+        pthread_mutex_lock(&ctx->ev_lock);
+        pthread_cond_signal(&ctx->ev_ready);
+        pthread_mutex_unlock(&ctx->ev_lock);
+    }
+}
+
 bool ui_context_post_event(ui_context_t *ctx, const ui_event_t *event)
 {
     if (!ctx || !event) {
         return false;
     }
-    pthread_mutex_lock(&ctx->ev_lock);
-    if (ctx->ev_count == UI_EVENT_QUEUE_SIZE) {
-        pthread_mutex_unlock(&ctx->ev_lock);
+    size_t keep_free = event->type == UI_EVENT_TOUCH_MOVE ? UI_CONTEXT_MOVE_RESERVE : 0;
+    if (!ui_event_mpsc_push_keep(&ctx->events, event, keep_free)) {
+        atomic_fetch_add_explicit(&ctx->ev_dropped, 1, memory_order_relaxed);
+        if (event->type == UI_EVENT_TOUCH_MOVE) {
+            atomic_fetch_add_explicit(&ctx->ev_dropped_moves, 1, memory_order_relaxed);
+        }
         return false;
     }
-    size_t insert = (ctx->ev_head + ctx->ev_count) % UI_EVENT_QUEUE_SIZE;
-    ctx->ev_queue[insert] = *event;
-    ctx->ev_count++;
-    pthread_mutex_unlock(&ctx->ev_lock);
+    ui_context_signal(ctx);
     return true;
 }
 
+void ui_context_event_stats(const ui_context_t *ctx, ui_event_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!ctx) {
+        return;
+    }
+    /* atomic_load takes a non-const pointer in older C11 headers */
+    ui_context_t *counters = (ui_context_t *)ctx;
+    /* every ticket the ring hands out is a successful post */
+    stats->posted = (uint32_t)ui_event_mpsc_pushed(&counters->events);
+    stats->dropped = atomic_load_explicit(&counters->ev_dropped, memory_order_relaxed);
+    stats->dropped_moves =
+        atomic_load_explicit(&counters->ev_dropped_moves, memory_order_relaxed);
+}
+
+void ui_context_poll_input(ui_context_t *ctx)
+{
+    if (ctx && ctx->hal && ctx->hal->poll_input) {
+        ctx->hal->poll_input(ctx);
+    }
+}
+
+bool ui_context_wait_event(ui_context_t *ctx, double timeout_seconds)
+{
+    if (!ctx) {
+        return false;
+    }
+    struct timespec deadline;
+    if (timeout_seconds >= 0.0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        double whole = floor(timeout_seconds);
+        deadline.tv_sec += (time_t)whole;
+        deadline.tv_nsec += (long)((timeout_seconds - whole) * 1e9);
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+    pthread_mutex_lock(&ctx->ev_lock);
+    atomic_store_explicit(&ctx->ev_waiting, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (ui_event_mpsc_empty(&ctx->events) &&
+           !atomic_load_explicit(&ctx->ev_wake, memory_order_relaxed)) {
+        int rc = timeout_seconds >= 0.0
+                     ? pthread_cond_timedwait(&ctx->ev_ready, &ctx->ev_lock, &deadline)
+                     : pthread_cond_wait(&ctx->ev_ready, &ctx->ev_lock);
+        if (rc != 0) {
+            break;
+        }
+    }
+    atomic_store_explicit(&ctx->ev_waiting, false, memory_order_relaxed);
+    bool woken = atomic_exchange_explicit(&ctx->ev_wake, false, memory_order_relaxed);
+    bool signalled = woken || !ui_event_mpsc_empty(&ctx->events);
+    pthread_mutex_unlock(&ctx->ev_lock);
+    return signalled;
+}
+
+void ui_context_wake(ui_context_t *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+    atomic_store_explicit(&ctx->ev_wake, true, memory_order_relaxed);
+    ui_context_signal(ctx);
+}
+
+static void ui_debug_flash_add(ui_context_t *ctx, const ui_rect_t *rect, ui_color_t color,
+                               bool outline_only)
+{
+    int x0 = rect->x < 0 ? 0 : rect->x;
+    int y0 = rect->y < 0 ? 0 : rect->y;
+    int x1 = rect->x + rect->width > UI_FRAMEBUFFER_WIDTH ? UI_FRAMEBUFFER_WIDTH
+                                                          : rect->x + rect->width;
+    int y1 = rect->y + rect->height > UI_FRAMEBUFFER_HEIGHT ? UI_FRAMEBUFFER_HEIGHT
+                                                            : rect->y + rect->height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    if (ctx->flash_count == UI_DEBUG_MAX_FLASHES) {
+        memmove(ctx->flashes, ctx->flashes + 1,
+                (UI_DEBUG_MAX_FLASHES - 1) * sizeof(ctx->flashes[0]));
+        --ctx->flash_count;
+    }
+    ui_debug_flash_t *flash = &ctx->flashes[ctx->flash_count++];
+    flash->rect.x = x0;
+    flash->rect.y = y0;
+    flash->rect.width = x1 - x0;
+    flash->rect.height = y1 - y0;
+    flash->color = color;
+    flash->outline_only = outline_only;
+    flash->age = 0;
+}
+
+static void ui_debug_blend_span(ui_color_t *row, int x0, int x1, ui_color_t color,
+                                uint32_t alpha)
+{
+    for (int x = x0; x < x1; ++x) {
+        row[x] = ui_color_blend(color, row[x], alpha);
+    }
+}
+
+static void ui_debug_draw_flash(ui_color_t *frame, const ui_debug_flash_t *flash)
+{
+    uint32_t remaining = UI_DEBUG_FLASH_FRAMES - flash->age;
+    uint32_t fill_alpha = flash->outline_only ? 0 : 12 * remaining / UI_DEBUG_FLASH_FRAMES;
+    uint32_t line_alpha = 32 * remaining / UI_DEBUG_FLASH_FRAMES;
+    int x0 = flash->rect.x;
+    int y0 = flash->rect.y;
+    int x1 = x0 + flash->rect.width;
+    int y1 = y0 + flash->rect.height;
+    for (int y = y0; y < y1; ++y) {
+        ui_color_t *row = &frame[y * UI_FRAMEBUFFER_WIDTH];
+        if (y == y0 || y == y1 - 1) {
+            ui_debug_blend_span(row, x0, x1, flash->color, line_alpha);
+            continue;
+        }
+        row[x0] = ui_color_blend(flash->color, row[x0], line_alpha);
+        row[x1 - 1] = ui_color_blend(flash->color, row[x1 - 1], line_alpha);
+        if (fill_alpha > 0) {
+            ui_debug_blend_span(row, x0 + 1, x1 - 1, flash->color, fill_alpha);
+        }
+    }
+}
+
+static ui_color_t ui_debug_heat(ui_color_t pixel, uint8_t writes)
+{
+    /* 2, 3, 4 and 5+ writes */
+    static const ui_color_t heat[] = {0x001F, 0x07E0, 0xF81F, 0xF800};
+    if (writes == 0) {
+        return (ui_color_t)((pixel >> 1) & 0x7BEF);
+    }
+    if (writes == 1) {
+        return pixel;
+    }
+    return ui_color_blend(heat[writes >= 5 ? 3 : writes - 2], pixel, 20);
+}
+
+/* Copies the framebuffer into overlay_frame and paints the overlays on the
+ * copy; caller holds fb_lock. */
+static void ui_debug_compose_locked(ui_context_t *ctx)
+{
+    ui_color_t *frame = ctx->overlay_frame;
+    memcpy(frame, ctx->framebuffer, sizeof(ctx->framebuffer));
+    if (ctx->overdraw) {
+        for (size_t i = 0; i < UI_FRAMEBUFFER_PIXELS; ++i) {
+            frame[i] = ui_debug_heat(frame[i], ctx->overdraw[i]);
+        }
+        memset(ctx->overdraw, 0, UI_FRAMEBUFFER_PIXELS);
+    }
+    if (!(ctx->debug_overlays & UI_DEBUG_OVERLAY_DAMAGE)) {
+        return;
+    }
+    if (ctx->dirty) {
+        ui_rect_t committed = {ctx->dirty_min_x, ctx->dirty_min_y,
+                               ctx->dirty_max_x - ctx->dirty_min_x,
+                               ctx->dirty_max_y - ctx->dirty_min_y};
+        ui_debug_flash_add(ctx, &committed, 0xFFE0, true);
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < ctx->flash_count; ++i) {
+        ui_debug_flash_t *flash = &ctx->flashes[i];
+        ui_debug_draw_flash(frame, flash);
+        if (++flash->age < UI_DEBUG_FLASH_FRAMES) {
+            ctx->flashes[kept++] = *flash;
+        }
+    }
+    ctx->flash_count = kept;
+}
+
 void ui_context_render(ui_context_t *ctx)
 {
     if (!ctx || !ctx->hal || !ctx->hal->commit_frame) {
         return;
     }
     pthread_mutex_lock(&ctx->fb_lock);
-    if (ctx->dirty) {
-        ctx->hal->commit_frame(ctx, ctx->framebuffer);
+    /* fading flashes keep frames coming after the screen settles */
+    if (ctx->dirty || ctx->flash_count > 0) {
+        const ui_color_t *frame = ctx->framebuffer;
+        if (ctx->overlay_frame) {
+            ui_debug_compose_locked(ctx);
+            frame = ctx->overlay_frame;
+        }
+        ctx->hal->commit_frame(ctx, frame);
         ui_reset_dirty(ctx);
     }
     pthread_mutex_unlock(&ctx->fb_lock);
 }
 
+bool ui_context_set_debug_overlay(ui_context_t *ctx, uint32_t overlays)
+{
+    if (!ctx) {
+        return false;
+    }
+    pthread_mutex_lock(&ctx->fb_lock);
+    if (overlays != UI_DEBUG_OVERLAY_NONE && !ctx->overlay_frame) {
+        ctx->overlay_frame = malloc(sizeof(ctx->framebuffer));
+    }
+    if ((overlays & UI_DEBUG_OVERLAY_OVERDRAW) && !ctx->overdraw) {
+        ctx->overdraw = calloc(UI_FRAMEBUFFER_PIXELS, 1);
+    }
+    bool ok = (overlays == UI_DEBUG_OVERLAY_NONE || ctx->overlay_frame) &&
+              (!(overlays & UI_DEBUG_OVERLAY_OVERDRAW) || ctx->overdraw);
+    if (!ok) {
+        overlays = UI_DEBUG_OVERLAY_NONE;
+    }
+    if (!(overlays & UI_DEBUG_OVERLAY_OVERDRAW)) {
+        free(ctx->overdraw);
+        ctx->overdraw = NULL;
+    }
+    if (overlays == UI_DEBUG_OVERLAY_NONE) {
+        free(ctx->overlay_frame);
+        ctx->overlay_frame = NULL;
+    }
+    if (!(overlays & UI_DEBUG_OVERLAY_DAMAGE)) {
+        ctx->flash_count = 0;
+    }
+    if (overlays != ctx->debug_overlays) {
+        /* the next commit replaces whatever the HAL shows now */
+        ctx->dirty = true;
+        ctx->dirty_min_x = 0;
+        ctx->dirty_min_y = 0;
+        ctx->dirty_max_x = UI_FRAMEBUFFER_WIDTH;
+        ctx->dirty_max_y = UI_FRAMEBUFFER_HEIGHT;
+    }
+    ctx->debug_overlays = overlays;
+    pthread_mutex_unlock(&ctx->fb_lock);
+    return ok;
+}
+
+uint32_t ui_context_debug_overlay(const ui_context_t *ctx)
+{
+    return ctx ? ctx->debug_overlays : UI_DEBUG_OVERLAY_NONE;
+}
+
+void ui_context_debug_damage(ui_context_t *ctx, const ui_rect_t *rect, bool scroll)
+{
+    if (!ctx || !rect || !(ctx->debug_overlays & UI_DEBUG_OVERLAY_DAMAGE)) {
+        return;
+    }
+    pthread_mutex_lock(&ctx->fb_lock);
+    ui_debug_flash_add(ctx, rect, scroll ? 0x07FF : 0xF81F, false);
+    pthread_mutex_unlock(&ctx->fb_lock);
+}
+
+bool ui_context_debug_overlay_pending(const ui_context_t *ctx)
+{
+    return ctx && ctx->flash_count > 0;
+}
+
+bool ui_debug_overlay_parse(const char *names, uint32_t *overlays)
+{
+    if (!names || !overlays) {
+        return false;
+    }
+    uint32_t parsed = UI_DEBUG_OVERLAY_NONE;
+    while (*names) {
+        size_t length = strcspn(names, "+,");
+        if (length == 8 && strncmp(names, "overdraw", length) == 0) {
+            parsed |= UI_DEBUG_OVERLAY_OVERDRAW;
+        } else if (length == 6 && strncmp(names, "damage", length) == 0) {
+            parsed |= UI_DEBUG_OVERLAY_DAMAGE;
+        } else if (!(length == 4 && strncmp(names, "none", length) == 0)) {
+            return false;
+        }
+        names += length;
+        if (*names) {
+            ++names;
+        }
+    }
+    *overlays = parsed;
+    return true;
+}
+
+void ui_context_invalidate(ui_context_t *ctx)
+{
+    if (ctx) {
+        ++ctx->repaint_epoch;
+    }
+}
+
+uint32_t ui_context_repaint_epoch(const ui_context_t *ctx)
+{
+    return ctx ? ctx->repaint_epoch : 0;
+}
+
 const bareui_font_t *ui_context_font(const ui_context_t *ctx)
 {
     return ctx ? ctx->font : NULL;
@@ -657,6 +1240,21 @@ void ui_context_set_font(ui_context_t *ctx, const bareui_font_t *font)
     }
 }
 
+void ui_context_set_text_background(ui_context_t *ctx, ui_color_t color)
+{
+    if (ctx) {
+        ctx->text_background = color;
+        ctx->text_background_set = true;
+    }
+}
+
+void ui_context_clear_text_background(ui_context_t *ctx)
+{
+    if (ctx) {
+        ctx->text_background_set = false;
+    }
+}
+
 void *ui_context_user_data(ui_context_t *ctx)
 {
     return ctx ? ctx->user_data : NULL;
@@ -0,0 +1,366 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ui_profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef BAREUI_PROFILE
+
+/* distinct widget types; past that they share an "other" entry */
+#define UI_PROFILE_MAX_TYPES 32
+
+typedef enum {
+    UI_PROFILE_CAT_RENDER,
+    UI_PROFILE_CAT_LAYOUT,
+    UI_PROFILE_CAT_PHASE,
+    UI_PROFILE_CAT_FRAME
+} ui_profile_cat_t;
+
+typedef struct {
+    const char *name;
+    uint8_t cat;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t self_ns;
+    uint32_t pixels;
+    uint32_t primitives;
+} ui_profile_event_t;
+
+typedef struct {
+    const ui_widget_ops_t *ops;
+    ui_profile_type_stats_t stats;
+} ui_profile_type_t;
+
+uint64_t ui_profile_pixels_written;
+uint64_t ui_profile_primitives_drawn;
+
+static bool ui_profile_on;
+static uint64_t ui_profile_origin_ns;
+static ui_profile_event_t ui_profile_events[BAREUI_PROFILE_EVENTS];
+static size_t ui_profile_event_count;
+static ui_profile_type_t ui_profile_types[UI_PROFILE_MAX_TYPES];
+static size_t ui_profile_type_count;
+static ui_profile_frame_stats_t ui_profile_frames;
+
+static const char *const ui_profile_phase_names[UI_PROFILE_PHASE_COUNT] = {
+    "events", "tick", "layout", "paint", "commit"
+};
+
+static const char *const ui_profile_cat_names[] = {"render", "layout", "phase", "frame"};
+
+static uint64_t ui_profile_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static const char *ui_profile_widget_name(const ui_widget_t *widget)
+{
+    return widget->ops && widget->ops->name ? widget->ops->name : "widget";
+}
+
+static ui_profile_type_stats_t *ui_profile_type(const ui_widget_t *widget)
+{
+    for (size_t i = 0; i < ui_profile_type_count; ++i) {
+        if (ui_profile_types[i].ops == widget->ops) {
+            return &ui_profile_types[i].stats;
+        }
+    }
+    if (ui_profile_type_count == UI_PROFILE_MAX_TYPES - 1) {
+        ui_profile_type_t *other = &ui_profile_types[UI_PROFILE_MAX_TYPES - 1];
+        other->stats.name = "other";
+        return &other->stats;
+    }
+    ui_profile_type_t *type = &ui_profile_types[ui_profile_type_count++];
+    type->ops = widget->ops;
+    type->stats.name = ui_profile_widget_name(widget);
+    return &type->stats;
+}
+
+static void ui_profile_record(const char *name, ui_profile_cat_t cat, uint64_t start_ns,
+                              uint64_t end_ns, const ui_profile_span_t *span)
+{
+    if (ui_profile_event_count == BAREUI_PROFILE_EVENTS) {
+        ++ui_profile_frames.events_dropped;
+        return;
+    }
+    ui_profile_event_t *event = &ui_profile_events[ui_profile_event_count++];
+    event->name = name;
+    event->cat = (uint8_t)cat;
+    event->start_ns = start_ns;
+    event->duration_ns = end_ns - start_ns;
+    event->self_ns = span ? span->self_ns : 0;
+    event->pixels = span ? (uint32_t)span->pixels : 0;
+    event->primitives = span ? (uint32_t)span->primitives : 0;
+}
+
+void ui_profile_span_begin(ui_profile_span_t *span)
+{
+    span->active = ui_profile_on;
+    if (!span->active) {
+        return;
+    }
+    span->origin_ns = ui_profile_now();
+    span->start_ns = span->origin_ns;
+    span->self_ns = 0;
+    span->pixels = ui_profile_pixels_written;
+    span->primitives = ui_profile_primitives_drawn;
+}
+
+void ui_profile_render_self(ui_profile_span_t *span, const ui_widget_t *widget)
+{
+    if (!span->active || !ui_profile_on) {
+        return;
+    }
+    span->self_ns = ui_profile_now() - span->start_ns;
+    span->pixels = ui_profile_pixels_written - span->pixels;
+    span->primitives = ui_profile_primitives_drawn - span->primitives;
+    ui_profile_type_stats_t *stats = ui_profile_type(widget);
+    ++stats->renders;
+    stats->render_ns += span->self_ns;
+    stats->pixels += span->pixels;
+    stats->primitives += span->primitives;
+}
+
+void ui_profile_render_end(ui_profile_span_t *span, const ui_widget_t *widget)
+{
+    if (!span->active || !ui_profile_on) {
+        return;
+    }
+    ui_profile_record(ui_profile_widget_name(widget), UI_PROFILE_CAT_RENDER, span->start_ns,
+                      ui_profile_now(), span);
+}
+
+void ui_profile_layout_end(ui_profile_span_t *span, const ui_widget_t *widget)
+{
+    if (!span->active || !ui_profile_on) {
+        return;
+    }
+    uint64_t end_ns = ui_profile_now();
+    ui_profile_type_stats_t *stats = ui_profile_type(widget);
+    ++stats->layouts;
+    stats->layout_ns += end_ns - span->start_ns;
+    ui_profile_record(ui_profile_widget_name(widget), UI_PROFILE_CAT_LAYOUT, span->start_ns,
+                      end_ns, NULL);
+}
+
+void ui_profile_phase_end(ui_profile_span_t *span, ui_profile_phase_t phase)
+{
+    if (!span->active || !ui_profile_on) {
+        return;
+    }
+    uint64_t end_ns = ui_profile_now();
+    ui_profile_frames.phase_ns[phase] += end_ns - span->start_ns;
+    ui_profile_record(ui_profile_phase_names[phase], UI_PROFILE_CAT_PHASE, span->start_ns,
+                      end_ns, NULL);
+    span->start_ns = end_ns;
+}
+
+void ui_profile_frame_end(ui_profile_span_t *span)
+{
+    if (!span->active || !ui_profile_on) {
+        return;
+    }
+    ++ui_profile_frames.frames;
+    ui_profile_record("frame", UI_PROFILE_CAT_FRAME, span->origin_ns, ui_profile_now(), NULL);
+}
+
+bool ui_profile_set_enabled(bool enabled)
+{
+    if (enabled && !ui_profile_on && ui_profile_origin_ns == 0) {
+        ui_profile_origin_ns = ui_profile_now();
+    }
+    ui_profile_on = enabled;
+    return true;
+}
+
+bool ui_profile_enabled(void)
+{
+    return ui_profile_on;
+}
+
+void ui_profile_reset(void)
+{
+    ui_profile_event_count = 0;
+    ui_profile_type_count = 0;
+    memset(ui_profile_types, 0, sizeof(ui_profile_types));
+    memset(&ui_profile_frames, 0, sizeof(ui_profile_frames));
+    ui_profile_origin_ns = ui_profile_now();
+}
+
+static int ui_profile_compare_render(const void *a, const void *b)
+{
+    const ui_profile_type_stats_t *left = a;
+    const ui_profile_type_stats_t *right = b;
+    if (left->render_ns != right->render_ns) {
+        return left->render_ns < right->render_ns ? 1 : -1;
+    }
+    return strcmp(left->name, right->name);
+}
+
+size_t ui_profile_type_stats(ui_profile_type_stats_t *stats, size_t capacity)
+{
+    ui_profile_type_stats_t sorted[UI_PROFILE_MAX_TYPES];
+    size_t count = ui_profile_type_count;
+    for (size_t i = 0; i < count; ++i) {
+        sorted[i] = ui_profile_types[i].stats;
+    }
+    if (ui_profile_types[UI_PROFILE_MAX_TYPES - 1].stats.name) {
+        sorted[count++] = ui_profile_types[UI_PROFILE_MAX_TYPES - 1].stats;
+    }
+    qsort(sorted, count, sizeof(sorted[0]), ui_profile_compare_render);
+    for (size_t i = 0; stats && i < capacity && i < count; ++i) {
+        stats[i] = sorted[i];
+    }
+    return count;
+}
+
+void ui_profile_frame_stats(ui_profile_frame_stats_t *stats)
+{
+    if (stats) {
+        *stats = ui_profile_frames;
+    }
+}
+
+void ui_profile_print_summary(FILE *file)
+{
+    if (!file) {
+        return;
+    }
+    ui_profile_type_stats_t types[UI_PROFILE_MAX_TYPES];
+    size_t count = ui_profile_type_stats(types, UI_PROFILE_MAX_TYPES);
+    uint32_t frames = ui_profile_frames.frames ? ui_profile_frames.frames : 1;
+    fprintf(file, "profile: %u frames\n", (unsigned)ui_profile_frames.frames);
+    for (int phase = 0; phase < UI_PROFILE_PHASE_COUNT; ++phase) {
+        fprintf(file, "  %-8s %9.1f us/frame\n", ui_profile_phase_names[phase],
+                ui_profile_frames.phase_ns[phase] / 1e3 / frames);
+    }
+    fprintf(file, "  %-14s %8s %11s %8s %11s %11s %9s\n", "type", "renders", "render us",
+            "layouts", "layout us", "pixels", "prims");
+    for (size_t i = 0; i < count; ++i) {
+        fprintf(file, "  %-14s %8u %11.1f %8u %11.1f %11llu %9llu\n", types[i].name,
+                (unsigned)types[i].renders, types[i].render_ns / 1e3,
+                (unsigned)types[i].layouts, types[i].layout_ns / 1e3,
+                (unsigned long long)types[i].pixels, (unsigned long long)types[i].primitives);
+    }
+    if (ui_profile_frames.events_dropped) {
+        fprintf(file, "  %u trace events dropped\n", (unsigned)ui_profile_frames.events_dropped);
+    }
+}
+
+static double ui_profile_us(uint64_t ns)
+{
+    return ns / 1e3;
+}
+
+bool ui_profile_write_trace(const char *path)
+{
+    FILE *file = path ? fopen(path, "w") : NULL;
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+                  "\"args\": {\"name\": \"ui\"}}");
+    for (size_t i = 0; i < ui_profile_event_count; ++i) {
+        const ui_profile_event_t *event = &ui_profile_events[i];
+        uint64_t start_ns = event->start_ns > ui_profile_origin_ns
+                                ? event->start_ns - ui_profile_origin_ns
+                                : 0;
+        fprintf(file,
+                ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                "\"ts\": %.3f, \"dur\": %.3f",
+                event->name, ui_profile_cat_names[event->cat], ui_profile_us(start_ns),
+                ui_profile_us(event->duration_ns));
+        if (event->cat == UI_PROFILE_CAT_RENDER) {
+            fprintf(file, ", \"args\": {\"self_us\": %.3f, \"pixels\": %u, \"primitives\": %u}",
+                    ui_profile_us(event->self_ns), (unsigned)event->pixels,
+                    (unsigned)event->primitives);
+        }
+        fputc('}', file);
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+static char *ui_profile_exit_path;
+
+static void ui_profile_exit(void)
+{
+    ui_profile_print_summary(stderr);
+    if (!ui_profile_write_trace(ui_profile_exit_path)) {
+        fprintf(stderr, "profile: cannot write %s\n", ui_profile_exit_path);
+    }
+    free(ui_profile_exit_path);
+    ui_profile_exit_path = NULL;
+}
+
+bool ui_profile_trace_at_exit(const char *path)
+{
+    if (!path || ui_profile_exit_path) {
+        return false;
+    }
+    size_t length = strlen(path) + 1;
+    ui_profile_exit_path = malloc(length);
+    if (!ui_profile_exit_path) {
+        return false;
+    }
+    memcpy(ui_profile_exit_path, path, length);
+    atexit(ui_profile_exit);
+    return ui_profile_set_enabled(true);
+}
+
+#else
+
+bool ui_profile_set_enabled(bool enabled)
+{
+    (void)enabled;
+    return false;
+}
+
+bool ui_profile_enabled(void)
+{
+    return false;
+}
+
+void ui_profile_reset(void)
+{
+}
+
+size_t ui_profile_type_stats(ui_profile_type_stats_t *stats, size_t capacity)
+{
+    (void)stats;
+    (void)capacity;
+    return 0;
+}
+
+void ui_profile_frame_stats(ui_profile_frame_stats_t *stats)
+{
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void ui_profile_print_summary(FILE *file)
+{
+    if (file) {
+        fprintf(file, "profile: not compiled in (build with -DBAREUI_PROFILE)\n");
+    }
+}
+
+bool ui_profile_write_trace(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+bool ui_profile_trace_at_exit(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+#endif
@@ -1,13 +1,11 @@
-#define _POSIX_C_SOURCE 200809L
-
 #include "ui_progressbar.h"
 
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
+#include "ui_animation.h"
 #include "ui_primitives.h"
 #include "ui_shadow.h"
 
@@ -32,29 +30,16 @@ struct ui_progressbar {
     char *semantics_value;
     char *tooltip;
     double animation_phase;
-    struct timespec last_tick;
+    ui_animation_id_t animation;
 };
 
-static char *ui_progressbar_duplicate_text(const char *text)
-{
-    if (!text) {
-        return NULL;
-    }
-    size_t len = strlen(text) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, text, len);
-    }
-    return copy;
-}
-
-static void ui_progressbar_assign_text(char **slot, const char *text)
+static void ui_progressbar_assign_text(ui_arena_t *arena, char **slot, const char *text)
 {
     if (!slot) {
         return;
     }
-    char *duplicate = ui_progressbar_duplicate_text(text);
-    free(*slot);
+    char *duplicate = ui_arena_strdup(arena, text);
+    ui_arena_free(arena, *slot);
     *slot = duplicate;
 }
 
@@ -156,26 +141,21 @@ static void ui_progressbar_draw_border(ui_context_t *ctx, const ui_rect_t *rect,
     }
 }
 
+/* One sweep per tween, restarted from render: a bar that is not drawn stops
+ * animating. Phase 0 and 1 both leave the indicator off the track. */
 static void ui_progressbar_update_animation(ui_progressbar_t *progress)
 {
-    if (!progress) {
+    if (!progress || progress->determinate ||
+        ui_animation_running(&progress->base, progress->animation)) {
         return;
     }
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    double delta = (double)(now.tv_sec - progress->last_tick.tv_sec) +
-                   (double)(now.tv_nsec - progress->last_tick.tv_nsec) / 1e9;
-    if (delta < 0.0) {
-        delta = 0.0;
-    }
-    progress->last_tick = now;
-    if (progress->determinate) {
-        return;
-    }
-    progress->animation_phase += delta * UI_PROGRESSBAR_ANIMATION_SPEED;
-    if (progress->animation_phase >= 1.0) {
-        progress->animation_phase = fmod(progress->animation_phase, 1.0);
-    }
+    progress->animation_phase = 0.0;
+    ui_animation_params_t params = {
+        .target = &progress->base,
+        .duration_ms = (int)(1000.0 / UI_PROGRESSBAR_ANIMATION_SPEED),
+        .easing = UI_EASE_LINEAR
+    };
+    progress->animation = ui_animate_double(&progress->animation_phase, 1.0, &params);
 }
 
 static void ui_progressbar_apply_style(ui_widget_t *widget, const ui_style_t *style)
@@ -280,6 +260,7 @@ static bool ui_progressbar_render(ui_context_t *ctx, ui_widget_t *widget, const
 }
 
 static const ui_widget_ops_t ui_progressbar_ops = {
+    .name = "progressbar",
     .render = ui_progressbar_render,
     .handle_event = NULL,
     .destroy = NULL,
@@ -292,7 +273,8 @@ static void ui_progressbar_reset_animation(ui_progressbar_t *progress)
         return;
     }
     progress->animation_phase = 0.0;
-    clock_gettime(CLOCK_MONOTONIC, &progress->last_tick);
+    ui_animation_cancel(&progress->base, progress->animation);
+    progress->animation = 0;
 }
 
 void ui_progressbar_init(ui_progressbar_t *progressbar)
@@ -334,11 +316,17 @@ void ui_progressbar_init(ui_progressbar_t *progressbar)
 
 ui_progressbar_t *ui_progressbar_create(void)
 {
-    ui_progressbar_t *progressbar = calloc(1, sizeof(*progressbar));
+    return ui_progressbar_create_in(NULL);
+}
+
+ui_progressbar_t *ui_progressbar_create_in(ui_arena_t *arena)
+{
+    ui_progressbar_t *progressbar = ui_arena_alloc(arena, sizeof(*progressbar));
     if (!progressbar) {
         return NULL;
     }
     ui_progressbar_init(progressbar);
+    ui_widget_set_arena(&progressbar->base, arena);
     return progressbar;
 }
 
@@ -347,10 +335,12 @@ void ui_progressbar_destroy(ui_progressbar_t *progressbar)
     if (!progressbar) {
         return;
     }
-    free(progressbar->semantics_label);
-    free(progressbar->semantics_value);
-    free(progressbar->tooltip);
-    free(progressbar);
+    ui_arena_t *arena = progressbar->base.arena;
+    ui_arena_free(arena, progressbar->semantics_label);
+    ui_arena_free(arena, progressbar->semantics_value);
+    ui_arena_free(arena, progressbar->tooltip);
+    ui_widget_deinit(&progressbar->base);
+    ui_arena_free(arena, progressbar);
 }
 
 void ui_progressbar_set_value(ui_progressbar_t *progressbar, double value)
@@ -366,6 +356,8 @@ void ui_progressbar_set_value(ui_progressbar_t *progressbar, double value)
     }
     progressbar->value = value;
     progressbar->determinate = true;
+    ui_progressbar_reset_animation(progressbar);
+    ui_widget_invalidate(&progressbar->base);
 }
 
 double ui_progressbar_value(const ui_progressbar_t *progressbar)
@@ -384,6 +376,7 @@ void ui_progressbar_clear_value(ui_progressbar_t *progressbar)
     progressbar->determinate = false;
     progressbar->value = 0.0;
     ui_progressbar_reset_animation(progressbar);
+    ui_widget_invalidate(&progressbar->base);
 }
 
 bool ui_progressbar_is_determinate(const ui_progressbar_t *progressbar)
@@ -397,6 +390,7 @@ void ui_progressbar_set_bar_height(ui_progressbar_t *progressbar, int height)
         return;
     }
     progressbar->bar_height = height > 0 ? height : 1;
+    ui_widget_invalidate(&progressbar->base);
 }
 
 int ui_progressbar_bar_height(const ui_progressbar_t *progressbar)
@@ -411,6 +405,7 @@ void ui_progressbar_set_border_radius(ui_progressbar_t *progressbar,
         return;
     }
     progressbar->border_radius = radius;
+    ui_widget_invalidate(&progressbar->base);
 }
 
 ui_border_radius_t ui_progressbar_border_radius(const ui_progressbar_t *progressbar)
@@ -423,7 +418,7 @@ void ui_progressbar_set_semantics_label(ui_progressbar_t *progressbar, const cha
     if (!progressbar) {
         return;
     }
-    ui_progressbar_assign_text(&progressbar->semantics_label, label);
+    ui_progressbar_assign_text(progressbar->base.arena, &progressbar->semantics_label, label);
 }
 
 const char *ui_progressbar_semantics_label(const ui_progressbar_t *progressbar)
@@ -436,7 +431,7 @@ void ui_progressbar_set_semantics_value(ui_progressbar_t *progressbar, const cha
     if (!progressbar) {
         return;
     }
-    ui_progressbar_assign_text(&progressbar->semantics_value, value);
+    ui_progressbar_assign_text(progressbar->base.arena, &progressbar->semantics_value, value);
 }
 
 const char *ui_progressbar_semantics_value(const ui_progressbar_t *progressbar)
@@ -449,7 +444,7 @@ void ui_progressbar_set_tooltip(ui_progressbar_t *progressbar, const char *toolt
     if (!progressbar) {
         return;
     }
-    ui_progressbar_assign_text(&progressbar->tooltip, tooltip);
+    ui_progressbar_assign_text(progressbar->base.arena, &progressbar->tooltip, tooltip);
 }
 
 const char *ui_progressbar_tooltip(const ui_progressbar_t *progressbar)
@@ -1,5 +1,3 @@
-#define _POSIX_C_SOURCE 200809L
-
 #include "ui_progressring.h"
 
 #include <math.h>
@@ -7,12 +5,13 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
+#include "ui_animation.h"
 #include "ui_primitives.h"
 
 #define UI_PROGRESSRING_PI 3.14159265358979323846
 #define UI_PROGRESSRING_TWO_PI (2.0 * UI_PROGRESSRING_PI)
+#define UI_PROGRESSRING_SPIN_MS 1200
 
 struct ui_progressring {
     ui_widget_t base;
@@ -26,24 +25,12 @@ struct ui_progressring {
     char *semantics_label;
     char *semantics_value;
     char *tooltip;
+    double spin_phase;
+    ui_animation_id_t spin;
 };
 
 static const ui_widget_ops_t ui_progressring_ops;
 
-static char *ui_progressring_strdup(const char *value)
-{
-    if (!value) {
-        return NULL;
-    }
-    size_t len = strlen(value) + 1;
-    char *copy = malloc(len);
-    if (!copy) {
-        return NULL;
-    }
-    memcpy(copy, value, len);
-    return copy;
-}
-
 static double ui_progressring_clamp(double value, double min, double max)
 {
     if (value < min) {
@@ -65,6 +52,28 @@ static double ui_progressring_normalize_angle(double angle)
     return normalized;
 }
 
+/* One turn per tween, restarted from render so an undrawn ring stops spinning. */
+static void ui_progressring_keep_spinning(ui_progressring_t *ring)
+{
+    if (ui_animation_running(&ring->base, ring->spin)) {
+        return;
+    }
+    ring->spin_phase = 0.0;
+    ui_animation_params_t params = {
+        .target = &ring->base,
+        .duration_ms = UI_PROGRESSRING_SPIN_MS,
+        .easing = UI_EASE_LINEAR
+    };
+    ring->spin = ui_animate_double(&ring->spin_phase, 1.0, &params);
+}
+
+static void ui_progressring_stop_spinning(ui_progressring_t *ring)
+{
+    ui_animation_cancel(&ring->base, ring->spin);
+    ring->spin = 0;
+    ring->spin_phase = 0.0;
+}
+
 static bool ui_progressring_angle_in_range(double angle, double start, double sweep)
 {
     if (sweep <= 0.0) {
@@ -166,11 +175,8 @@ static bool ui_progressring_render(ui_context_t *ctx, ui_widget_t *widget, const
         value = ui_progressring_clamp(value, 0.0, 1.0);
         sweep = value * UI_PROGRESSRING_TWO_PI;
     } else {
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        double seconds = now.tv_sec + now.tv_nsec / 1e9;
-        double phase = fmod(seconds / 1.2, 1.0);
-        start_angle += phase * UI_PROGRESSRING_TWO_PI;
+        ui_progressring_keep_spinning(ring);
+        start_angle += ring->spin_phase * UI_PROGRESSRING_TWO_PI;
         sweep = UI_PROGRESSRING_PI * 1.35;
     }
 
@@ -232,6 +238,7 @@ static bool ui_progressring_handle_event(ui_widget_t *widget, const ui_event_t *
 }
 
 static const ui_widget_ops_t ui_progressring_ops = {
+    .name = "progressring",
     .render = ui_progressring_render,
     .handle_event = ui_progressring_handle_event,
     .destroy = NULL,
@@ -256,11 +263,17 @@ void ui_progressring_init(ui_progressring_t *ring)
 
 ui_progressring_t *ui_progressring_create(void)
 {
-    ui_progressring_t *ring = calloc(1, sizeof(*ring));
+    return ui_progressring_create_in(NULL);
+}
+
+ui_progressring_t *ui_progressring_create_in(ui_arena_t *arena)
+{
+    ui_progressring_t *ring = ui_arena_alloc(arena, sizeof(*ring));
     if (!ring) {
         return NULL;
     }
     ui_progressring_init(ring);
+    ui_widget_set_arena(&ring->base, arena);
     return ring;
 }
 
@@ -269,10 +282,12 @@ void ui_progressring_destroy(ui_progressring_t *ring)
     if (!ring) {
         return;
     }
-    free(ring->semantics_label);
-    free(ring->semantics_value);
-    free(ring->tooltip);
-    free(ring);
+    ui_arena_t *arena = ring->base.arena;
+    ui_arena_free(arena, ring->semantics_label);
+    ui_arena_free(arena, ring->semantics_value);
+    ui_arena_free(arena, ring->tooltip);
+    ui_widget_deinit(&ring->base);
+    ui_arena_free(arena, ring);
 }
 
 const ui_widget_t *ui_progressring_widget(const ui_progressring_t *ring)
@@ -292,6 +307,8 @@ void ui_progressring_set_value(ui_progressring_t *ring, double value)
     }
     ring->value = value;
     ring->has_value = true;
+    ui_progressring_stop_spinning(ring);
+    ui_widget_invalidate(&ring->base);
 }
 
 double ui_progressring_value(const ui_progressring_t *ring)
@@ -306,12 +323,14 @@ void ui_progressring_clear_value(ui_progressring_t *ring)
     }
     ring->has_value = false;
     ring->value = 0.0;
+    ui_widget_invalidate(&ring->base);
 }
 
 void ui_progressring_set_track_color(ui_progressring_t *ring, ui_color_t color)
 {
     if (ring) {
         ring->track_color = color;
+        ui_widget_invalidate(&ring->base);
     }
 }
 
@@ -324,6 +343,7 @@ void ui_progressring_set_progress_color(ui_progressring_t *ring, ui_color_t colo
 {
     if (ring) {
         ring->progress_color = color;
+        ui_widget_invalidate(&ring->base);
     }
 }
 
@@ -336,6 +356,7 @@ void ui_progressring_set_stroke_width(ui_progressring_t *ring, double width)
 {
     if (ring && width > 0.0) {
         ring->stroke_width = width;
+        ui_widget_invalidate(&ring->base);
     }
 }
 
@@ -348,6 +369,7 @@ void ui_progressring_set_stroke_align(ui_progressring_t *ring, double align)
 {
     if (ring) {
         ring->stroke_align = align;
+        ui_widget_invalidate(&ring->base);
     }
 }
 
@@ -360,6 +382,7 @@ void ui_progressring_set_stroke_cap(ui_progressring_t *ring, ui_stroke_cap_t cap
 {
     if (ring) {
         ring->stroke_cap = cap;
+        ui_widget_invalidate(&ring->base);
     }
 }
 
@@ -373,8 +396,8 @@ void ui_progressring_set_semantics_label(ui_progressring_t *ring, const char *la
     if (!ring) {
         return;
     }
-    free(ring->semantics_label);
-    ring->semantics_label = ui_progressring_strdup(label);
+    ui_arena_free(ring->base.arena, ring->semantics_label);
+    ring->semantics_label = ui_arena_strdup(ring->base.arena, label);
 }
 
 const char *ui_progressring_semantics_label(const ui_progressring_t *ring)
@@ -387,8 +410,8 @@ void ui_progressring_set_semantics_value(ui_progressring_t *ring, const char *va
     if (!ring) {
         return;
     }
-    free(ring->semantics_value);
-    ring->semantics_value = ui_progressring_strdup(value);
+    ui_arena_free(ring->base.arena, ring->semantics_value);
+    ring->semantics_value = ui_arena_strdup(ring->base.arena, value);
 }
 
 const char *ui_progressring_semantics_value(const ui_progressring_t *ring)
@@ -401,8 +424,8 @@ void ui_progressring_set_tooltip(ui_progressring_t *ring, const char *tooltip)
     if (!ring) {
         return;
     }
-    free(ring->tooltip);
-    ring->tooltip = ui_progressring_strdup(tooltip);
+    ui_arena_free(ring->base.arena, ring->tooltip);
+    ring->tooltip = ui_arena_strdup(ring->base.arena, tooltip);
 }
 
 const char *ui_progressring_tooltip(const ui_progressring_t *ring)
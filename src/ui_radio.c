@@ -1,6 +1,7 @@
 #include "ui_radio.h"
 
 #include "ui_primitives.h"
+#include "ui_shaped_text.h"
 
 #include <limits.h>
 #include <math.h>
@@ -22,6 +23,7 @@
 struct ui_radio {
     ui_widget_t base;
     char *label;
+    ui_shaped_text_t shaped_label;
     const bareui_font_t *label_font;
     ui_radio_group_t *group;
     int32_t value;
@@ -30,7 +32,6 @@ struct ui_radio {
     bool pressed;
     bool focused;
     bool enabled;
-    bool autofocus;
     bool adaptive;
     bool toggleable;
     ui_radio_label_position_t label_position;
@@ -83,73 +84,12 @@ static bool ui_radio_contains(const ui_radio_t *radio, int x, int y)
            y < bounds->y + bounds->height;
 }
 
-static bool ui_radio_next_codepoint(const unsigned char **ptr, uint32_t *out)
+static int ui_radio_measure_label(ui_radio_t *radio)
 {
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t codepoint = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-    } else if ((first & 0xE0) == 0xC0) {
-        codepoint &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        codepoint &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        codepoint &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        codepoint = (codepoint << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = codepoint;
-    }
-    return true;
-}
-
-static int ui_radio_measure_label(const ui_radio_t *radio, const char *text)
-{
-    if (!radio || !text) {
+    if (!radio || !radio->label) {
         return 0;
     }
-    const bareui_font_t *font = radio->label_font ? radio->label_font : bareui_font_default();
-    const unsigned char *ptr = (const unsigned char *)text;
-    int width = 0;
-    while (*ptr) {
-        uint32_t codepoint;
-        if (!ui_radio_next_codepoint(&ptr, &codepoint)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, codepoint, &glyph)) {
-            width += glyph.spacing;
-        }
-    }
-    return width;
-}
-
-static char *ui_radio_copy_label(const char *label)
-{
-    if (!label) {
-        return NULL;
-    }
-    size_t len = strlen(label) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, label, len);
-    }
-    return copy;
+    return ui_shaped_text_ensure(&radio->shaped_label, radio->label_font, radio->label);
 }
 
 static void ui_radio_fill_circle(ui_context_t *ctx, int cx, int cy, int radius, ui_color_t color)
@@ -185,6 +125,7 @@ static void ui_radio_notify_focus(ui_radio_t *radio, bool focus_state)
         return;
     }
     radio->focused = focus_state;
+    ui_widget_invalidate(&radio->base);
     if (focus_state && radio->on_focus) {
         radio->on_focus(radio, radio->on_focus_data);
     } else if (!focus_state && radio->on_blur) {
@@ -198,6 +139,7 @@ static void ui_radio_set_selected_internal(ui_radio_t *radio, bool selected, boo
         return;
     }
     radio->selected = selected;
+    ui_widget_invalidate(&radio->base);
     if (notify && radio->on_change) {
         radio->on_change(radio, selected ? radio->value : UI_RADIO_VALUE_NONE,
                          radio->on_change_data);
@@ -268,11 +210,18 @@ static void ui_radio_group_apply_value(ui_radio_group_t *group)
 
 ui_radio_t *ui_radio_create(void)
 {
-    ui_radio_t *radio = calloc(1, sizeof(*radio));
+    return ui_radio_create_in(NULL);
+}
+
+ui_radio_t *ui_radio_create_in(ui_arena_t *arena)
+{
+    ui_radio_t *radio = ui_arena_alloc(arena, sizeof(*radio));
     if (!radio) {
         return NULL;
     }
     ui_radio_init(radio);
+    ui_widget_set_arena(&radio->base, arena);
+    radio->shaped_label.arena = arena;
     return radio;
 }
 
@@ -285,7 +234,8 @@ void ui_radio_destroy(ui_radio_t *radio)
     radio->on_change = NULL;
     radio->on_focus = NULL;
     radio->on_blur = NULL;
-    free(radio);
+    ui_widget_deinit(&radio->base);
+    ui_arena_free(radio->base.arena, radio);
 }
 
 void ui_radio_init(ui_radio_t *radio)
@@ -295,6 +245,7 @@ void ui_radio_init(ui_radio_t *radio)
     }
     ui_widget_init(&radio->base, &ui_radio_ops);
     radio->label = NULL;
+    ui_shaped_text_init(&radio->shaped_label);
     radio->label_font = bareui_font_default();
     radio->group = NULL;
     radio->value = UI_RADIO_VALUE_NONE;
@@ -303,7 +254,7 @@ void ui_radio_init(ui_radio_t *radio)
     radio->pressed = false;
     radio->focused = false;
     radio->enabled = true;
-    radio->autofocus = false;
+    ui_widget_set_focusable(&radio->base, true);
     radio->adaptive = false;
     radio->toggleable = false;
     radio->label_position = UI_RADIO_LABEL_POSITION_RIGHT;
@@ -390,6 +341,8 @@ void ui_radio_set_enabled(ui_radio_t *radio, bool enabled)
 {
     if (radio) {
         radio->enabled = enabled;
+        ui_widget_set_focusable(&radio->base, enabled);
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -415,7 +368,7 @@ void ui_radio_set_autofocus(ui_radio_t *radio, bool autofocus)
     if (!radio) {
         return;
     }
-    radio->autofocus = autofocus;
+    ui_widget_set_autofocus(&radio->base, autofocus);
     if (autofocus) {
         ui_radio_notify_focus(radio, true);
     }
@@ -423,13 +376,14 @@ void ui_radio_set_autofocus(ui_radio_t *radio, bool autofocus)
 
 bool ui_radio_autofocus(const ui_radio_t *radio)
 {
-    return radio ? radio->autofocus : false;
+    return radio ? radio->base.autofocus : false;
 }
 
 void ui_radio_set_adaptive(ui_radio_t *radio, bool adaptive)
 {
     if (radio) {
         radio->adaptive = adaptive;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -442,6 +396,7 @@ void ui_radio_set_active_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->active_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -454,6 +409,7 @@ void ui_radio_set_fill_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->fill_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -466,6 +422,7 @@ void ui_radio_set_border_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->border_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -478,6 +435,7 @@ void ui_radio_set_hover_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->hover_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -490,6 +448,7 @@ void ui_radio_set_focus_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->focus_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -502,6 +461,7 @@ void ui_radio_set_overlay_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->overlay_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -514,6 +474,7 @@ void ui_radio_set_splash_radius(ui_radio_t *radio, int radius)
 {
     if (radio && radius > 0) {
         radio->splash_radius = radius;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -527,12 +488,14 @@ void ui_radio_set_label(ui_radio_t *radio, const char *label)
     if (!radio) {
         return;
     }
-    char *copy = ui_radio_copy_label(label);
+    char *copy = ui_arena_strdup(radio->base.arena, label);
     if (!copy && label) {
         return;
     }
-    free(radio->label);
+    ui_arena_free(radio->base.arena, radio->label);
     radio->label = copy;
+    ui_shaped_text_shape(&radio->shaped_label, radio->label_font, radio->label);
+    ui_widget_invalidate(&radio->base);
 }
 
 const char *ui_radio_label(const ui_radio_t *radio)
@@ -544,6 +507,8 @@ void ui_radio_set_label_font(ui_radio_t *radio, const bareui_font_t *font)
 {
     if (radio) {
         radio->label_font = font ? font : bareui_font_default();
+        ui_shaped_text_invalidate(&radio->shaped_label);
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -556,6 +521,7 @@ void ui_radio_set_label_color(ui_radio_t *radio, ui_color_t color)
 {
     if (radio) {
         radio->label_color = color;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -568,6 +534,7 @@ void ui_radio_set_label_position(ui_radio_t *radio, ui_radio_label_position_t po
 {
     if (radio) {
         radio->label_position = position;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -580,6 +547,7 @@ void ui_radio_set_visual_density(ui_radio_t *radio, ui_radio_visual_density_t de
 {
     if (radio) {
         radio->visual_density = density;
+        ui_widget_invalidate(&radio->base);
     }
 }
 
@@ -706,11 +674,7 @@ static void ui_radio_draw_label(ui_context_t *ctx, const ui_radio_t *radio, int
     if (!ctx || !radio || !radio->label) {
         return;
     }
-    const bareui_font_t *font = radio->label_font ? radio->label_font : bareui_font_default();
-    const bareui_font_t *prev = ui_context_font(ctx);
-    ui_context_set_font(ctx, font);
-    ui_context_draw_text(ctx, x, y, radio->label, radio->label_color);
-    ui_context_set_font(ctx, prev);
+    ui_context_draw_shaped_text(ctx, x, y, &radio->shaped_label, radio->label_color);
 }
 
 static int ui_radio_effective_circle_radius(const ui_radio_t *radio)
@@ -764,7 +728,7 @@ static bool ui_radio_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rec
     int spacing = radio->visual_density == UI_RADIO_VISUAL_DENSITY_COMPACT ? 4 : 8;
     int center_y = bounds->y + bounds->height / 2;
     int circle_x = bounds->x + content_margin + radius;
-    int label_width = radio->label ? ui_radio_measure_label(radio, radio->label) : 0;
+    int label_width = ui_radio_measure_label(radio);
     int label_x = 0;
 
     if (radio->label_position == UI_RADIO_LABEL_POSITION_LEFT && label_width > 0) {
@@ -810,6 +774,25 @@ static bool ui_radio_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rec
     return true;
 }
 
+/* A tap or Enter/Space: selects, or clears a selected toggleable radio. */
+static void ui_radio_activate(ui_radio_t *radio)
+{
+    bool currently_selected = radio->selected;
+    if (radio->group) {
+        if (currently_selected && radio->toggleable) {
+            ui_radio_group_set_value(radio->group, UI_RADIO_VALUE_NONE);
+        } else if (!currently_selected) {
+            ui_radio_group_set_value(radio->group, radio->value);
+        }
+    } else {
+        if (currently_selected && radio->toggleable) {
+            ui_radio_set_selected_internal(radio, false, true);
+        } else if (!currently_selected) {
+            ui_radio_set_selected_internal(radio, true, true);
+        }
+    }
+}
+
 static bool ui_radio_handle_event(ui_widget_t *widget, const ui_event_t *event)
 {
     ui_radio_t *radio = (ui_radio_t *)widget;
@@ -845,23 +828,21 @@ static bool ui_radio_handle_event(ui_widget_t *widget, const ui_event_t *event)
             ui_radio_notify_focus(radio, false);
             return true;
         }
-        bool currently_selected = radio->selected;
-        if (radio->group) {
-            if (currently_selected && radio->toggleable) {
-                ui_radio_group_set_value(radio->group, UI_RADIO_VALUE_NONE);
-            } else if (!currently_selected) {
-                ui_radio_group_set_value(radio->group, radio->value);
-            }
-        } else {
-            if (currently_selected && radio->toggleable) {
-                ui_radio_set_selected_internal(radio, false, true);
-            } else if (!currently_selected) {
-                ui_radio_set_selected_internal(radio, true, true);
-            }
-        }
+        ui_radio_activate(radio);
         ui_radio_notify_focus(radio, false);
         return true;
     }
+    case UI_EVENT_KEY_DOWN: {
+        if (!radio->focused) {
+            return false;
+        }
+        uint32_t keycode = event->data.key.keycode;
+        if (keycode == UI_KEY_SPACE || keycode == '\n' || keycode == UI_KEY_ENTER) {
+            ui_radio_activate(radio);
+            return true;
+        }
+        return false;
+    }
     default:
         return false;
     }
@@ -876,13 +857,22 @@ static void ui_radio_destroy_impl(ui_widget_t *widget)
     if (radio->group) {
         ui_radio_group_unregister_radio(radio->group, radio);
     }
-    free(radio->label);
+    ui_arena_free(radio->base.arena, radio->label);
     radio->label = NULL;
+    ui_shaped_text_release(&radio->shaped_label);
+}
+
+static void ui_radio_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_radio_notify_focus((ui_radio_t *)widget, focused);
 }
 
 static const ui_widget_ops_t ui_radio_ops = {
+    .name = "radio",
     .render = ui_radio_render,
     .handle_event = ui_radio_handle_event,
     .destroy = ui_radio_destroy_impl,
-    .style_changed = ui_radio_apply_style
+    .style_changed = ui_radio_apply_style,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_radio_focus_changed
 };
@@ -1,15 +1,11 @@
 #include "ui_row.h"
 
+#include "ui_scroller.h"
+
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct {
-    ui_widget_t *widget;
-    bool expand;
-    const char *key;
-} ui_row_child_t;
-
 struct ui_row {
     ui_widget_t base;
     ui_main_axis_alignment_t alignment;
@@ -25,51 +21,11 @@ struct ui_row {
     int on_scroll_interval;
     int scroll_offset;
     int max_scroll_offset;
-    ui_row_child_t *children;
-    size_t child_count;
-    size_t child_capacity;
+    ui_scroller_t scroller;
 };
 
 static const int SCROLL_INTERVAL_DEFAULT = 10;
 
-static bool ui_row_ensure_capacity(ui_row_t *row, size_t target)
-{
-    if (row->child_capacity >= target) {
-        return true;
-    }
-    size_t next = row->child_capacity ? row->child_capacity * 2 : 4;
-    if (next < target) {
-        next = target;
-    }
-    ui_row_child_t *realloced = realloc(row->children, next * sizeof(*row->children));
-    if (!realloced) {
-        return false;
-    }
-    row->children = realloced;
-    row->child_capacity = next;
-    return true;
-}
-
-static bool ui_widget_add_child_last(ui_widget_t *parent, ui_widget_t *child)
-{
-    if (!parent || !child || parent == child) {
-        return false;
-    }
-    ui_widget_remove_child(child);
-    child->parent = parent;
-    child->next_sibling = NULL;
-    if (!parent->first_child) {
-        parent->first_child = child;
-        return true;
-    }
-    ui_widget_t *tail = parent->first_child;
-    while (tail->next_sibling) {
-        tail = tail->next_sibling;
-    }
-    tail->next_sibling = child;
-    return true;
-}
-
 static const ui_style_t *ui_widget_style_safe(const ui_widget_t *widget)
 {
     static const ui_style_t default_style = {0};
@@ -91,6 +47,16 @@ static int ui_row_clamp_scroll(ui_row_t *row, int value)
     return value;
 }
 
+/* Moves the content by the clamped change and blits what is already on screen. */
+static void ui_row_apply_scroll(ui_row_t *row, int offset)
+{
+    int previous = row->scroll_offset;
+    row->scroll_offset = ui_row_clamp_scroll(row, offset);
+    if (!ui_widget_scroll_content(&row->base, previous - row->scroll_offset, 0)) {
+        ui_widget_mark_needs_layout(&row->base);
+    }
+}
+
 static void ui_row_update_scroll_limits(ui_row_t *row, int content_width, int available)
 {
     if (!row) {
@@ -109,6 +75,35 @@ static void ui_row_update_scroll_limits(ui_row_t *row, int content_width, int av
     }
 }
 
+/* Children are measured against the space left after their preceding siblings,
+ * so a wrapping child does not claim the whole row. */
+static int ui_row_child_limit(ui_widget_t *child, int content_width, int used)
+{
+    if (content_width <= 0) {
+        return 0;
+    }
+    const ui_style_t *child_style = ui_widget_style_safe(child);
+    int limit = content_width - used - child_style->margin_left - child_style->margin_right;
+    return limit > 0 ? limit : 1;
+}
+
+static int ui_row_child_width(ui_widget_t *child, int content_width, int used)
+{
+    int width = 0;
+    ui_widget_measure(child, ui_row_child_limit(child, content_width, used), 0, &width, NULL);
+    return width > 0 ? width : 0;
+}
+
+static int ui_row_child_height(const ui_row_t *row, ui_widget_t *child, int content_height)
+{
+    const ui_style_t *child_style = ui_widget_style_safe(child);
+    int height = child->preferred_height;
+    if (height <= 0 || row->vertical_alignment == UI_CROSS_AXIS_STRETCH) {
+        height = content_height - child_style->margin_top - child_style->margin_bottom;
+    }
+    return height > 0 ? height : 0;
+}
+
 static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
 {
     if (!row || !bounds) {
@@ -128,24 +123,23 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
 
     int total_child_width = 0;
     size_t expand_count = 0;
-    for (size_t i = 0; i < row->child_count; ++i) {
-        ui_widget_t *child = row->children[i].widget;
+    int used = 0;
+    size_t child_count = row->base.child_count;
+    for (ui_widget_t *child = row->base.first_child; child; child = child->next_sibling) {
         const ui_style_t *child_style = ui_widget_style_safe(child);
-        int child_width = child->bounds.width;
-        if (child_width <= 0) {
-            child_width = 0;
-        }
-        if (row->children[i].expand) {
+        int child_width = ui_row_child_width(child, content_width, used);
+        if (child->expand) {
             expand_count++;
         }
         total_child_width += child_width + child_style->margin_left + child_style->margin_right;
+        used += child_width + child_style->margin_left + child_style->margin_right + row->spacing;
     }
 
     int spacing_total = 0;
     if (row->alignment == UI_MAIN_AXIS_START || row->alignment == UI_MAIN_AXIS_END ||
         row->alignment == UI_MAIN_AXIS_CENTER) {
-        if (row->child_count > 1) {
-            spacing_total = row->spacing * ((int)row->child_count - 1);
+        if (child_count > 1) {
+            spacing_total = row->spacing * ((int)child_count - 1);
         }
     }
 
@@ -163,7 +157,7 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
 
     int start_x = content_x;
     int gap = 0;
-    if (row->child_count > 0) {
+    if (child_count > 0) {
         switch (row->alignment) {
         case UI_MAIN_AXIS_START:
             gap = row->spacing;
@@ -177,7 +171,7 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
             gap = row->spacing;
             break;
         case UI_MAIN_AXIS_SPACE_BETWEEN: {
-            int gaps = row->child_count > 1 ? (int)row->child_count - 1 : 0;
+            int gaps = child_count > 1 ? (int)child_count - 1 : 0;
             if (gaps > 0) {
                 int available = content_width - total_child_width - expand_extra * (int)expand_count;
                 gap = available > 0 ? available / gaps : 0;
@@ -186,13 +180,13 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
         }
         case UI_MAIN_AXIS_SPACE_AROUND: {
             int available = content_width - total_child_width - expand_extra * (int)expand_count;
-            gap = row->child_count > 0 ? (available > 0 ? available / (int)row->child_count : 0) : 0;
+            gap = child_count > 0 ? (available > 0 ? available / (int)child_count : 0) : 0;
             start_x += gap / 2;
             break;
         }
         case UI_MAIN_AXIS_SPACE_EVENLY: {
             int available = content_width - total_child_width - expand_extra * (int)expand_count;
-            gap = row->child_count > 0 ? (available > 0 ? available / ((int)row->child_count + 1) : 0) : 0;
+            gap = child_count > 0 ? (available > 0 ? available / ((int)child_count + 1) : 0) : 0;
             start_x += gap;
             break;
         }
@@ -202,22 +196,16 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
     start_x -= row->scroll_offset;
 
     int cursor_x = start_x;
-    for (size_t i = 0; i < row->child_count; ++i) {
-        ui_widget_t *child = row->children[i].widget;
+    used = 0;
+    for (ui_widget_t *child = row->base.first_child; child; child = child->next_sibling) {
         const ui_style_t *child_style = ui_widget_style_safe(child);
-        child->bounds.width = child->bounds.width > 0 ? child->bounds.width : 0;
-        if (row->children[i].expand) {
-            child->bounds.width += expand_extra;
+        int child_width = ui_row_child_width(child, content_width, used);
+        used += child_width + child_style->margin_left + child_style->margin_right + row->spacing;
+        if (child->expand) {
+            child_width += expand_extra;
         }
 
-        int child_height = child->bounds.height;
-        if (child_height <= 0 || row->vertical_alignment == UI_CROSS_AXIS_STRETCH) {
-            child_height = content_height - child_style->margin_top - child_style->margin_bottom;
-            if (child_height < 0) {
-                child_height = 0;
-            }
-        }
-        child->bounds.height = child_height;
+        int child_height = ui_row_child_height(row, child, content_height);
 
         int y = content_y + child_style->margin_top;
         if (row->vertical_alignment == UI_CROSS_AXIS_CENTER) {
@@ -227,13 +215,12 @@ static void ui_row_layout(ui_row_t *row, const ui_rect_t *bounds)
         }
         if (row->rtl) {
             // When RTL, reverse x placement.
-            cursor_x = content_x + content_width - (cursor_x - content_x) - child->bounds.width;
+            cursor_x = content_x + content_width - (cursor_x - content_x) - child_width;
         }
 
         cursor_x += child_style->margin_left;
-        child->bounds.x = cursor_x;
-        child->bounds.y = y;
-        cursor_x += child->bounds.width + child_style->margin_right;
+        ui_widget_place(child, cursor_x, y, child_width, child_height);
+        cursor_x += child_width + child_style->margin_right;
         if (row->alignment == UI_MAIN_AXIS_SPACE_AROUND || row->alignment == UI_MAIN_AXIS_SPACE_EVENLY) {
             cursor_x += gap;
         } else if (row->alignment == UI_MAIN_AXIS_START ||
@@ -255,23 +242,84 @@ static bool ui_row_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_
     const ui_style_t *style = ui_widget_style_safe(widget);
     ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
                          style->background_color);
-    ui_row_layout(row, bounds);
     return true;
 }
 
+static void ui_row_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    ui_row_layout((ui_row_t *)widget, bounds);
+}
+
+static void ui_row_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                           int *height)
+{
+    (void)max_height;
+    ui_row_t *row = (ui_row_t *)widget;
+    const ui_style_t *style = ui_widget_style_safe(widget);
+    int content_width = 0;
+    if (max_width > 0) {
+        content_width = max_width - style->padding_left - style->padding_right;
+        if (content_width <= 0) {
+            content_width = 1;
+        }
+    }
+    int total = 0;
+    int tallest = 0;
+    int index = 0;
+    for (ui_widget_t *child = row->base.first_child; child; child = child->next_sibling, ++index) {
+        const ui_style_t *child_style = ui_widget_style_safe(child);
+        int child_width = 0;
+        int child_height = 0;
+        int used = total + row->spacing * index;
+        ui_widget_measure(child, ui_row_child_limit(child, content_width, used), 0, &child_width,
+                          &child_height);
+        total += child_width + child_style->margin_left + child_style->margin_right;
+        child_height += child_style->margin_top + child_style->margin_bottom;
+        if (child_height > tallest) {
+            tallest = child_height;
+        }
+    }
+    if (row->base.child_count > 1) {
+        total += row->spacing * ((int)row->base.child_count - 1);
+    }
+    *width = total + style->padding_left + style->padding_right;
+    *height = tallest + style->padding_top + style->padding_bottom;
+}
+
+static bool ui_row_tick(ui_widget_t *widget, double delta_seconds)
+{
+    ui_row_t *row = (ui_row_t *)widget;
+    int offset = row->scroll_offset;
+    bool moving = ui_scroller_step(&row->scroller, delta_seconds, row->max_scroll_offset, &offset);
+    if (offset != row->scroll_offset) {
+        ui_row_apply_scroll(row, offset);
+    }
+    return moving;
+}
+
 static const ui_widget_ops_t ui_row_ops = {
+    .name = "row",
     .render = ui_row_render,
     .handle_event = NULL,
-    .destroy = NULL
+    .destroy = NULL,
+    .measure = ui_row_measure,
+    .arrange = ui_row_arrange,
+    .tick = ui_row_tick
 };
 
 ui_row_t *ui_row_create(void)
 {
-    ui_row_t *row = calloc(1, sizeof(*row));
+    return ui_row_create_in(NULL);
+}
+
+ui_row_t *ui_row_create_in(ui_arena_t *arena)
+{
+    ui_row_t *row = ui_arena_alloc(arena, sizeof(*row));
     if (!row) {
         return NULL;
     }
     ui_row_init(row);
+    ui_widget_set_arena(&row->base, arena);
     return row;
 }
 
@@ -280,10 +328,8 @@ void ui_row_destroy(ui_row_t *row)
     if (!row) {
         return;
     }
-    if (row->children) {
-        free(row->children);
-    }
-    free(row);
+    ui_widget_deinit(&row->base);
+    ui_arena_free(row->base.arena, row);
 }
 
 void ui_row_init(ui_row_t *row)
@@ -307,18 +353,15 @@ bool ui_row_add_control(ui_row_t *row, ui_widget_t *control, bool expand, const
     if (!row || !control) {
         return false;
     }
-    if (!ui_row_ensure_capacity(row, row->child_count + 1)) {
+    if (!ui_widget_append_child(&row->base, control)) {
         return false;
     }
-    row->children[row->child_count++] = (ui_row_child_t){
-        .widget = control,
-        .expand = expand,
-        .key = key
-    };
-    ui_widget_add_child_last(&row->base, control);
+    control->expand = expand;
+    control->key = key;
     if (row->auto_scroll) {
         row->scroll_offset = row->max_scroll_offset;
     }
+    ui_widget_invalidate_measure(control);
     return true;
 }
 
@@ -327,27 +370,23 @@ bool ui_row_remove_control(ui_row_t *row, ui_widget_t *control)
     if (!row || !control) {
         return false;
     }
-    for (size_t i = 0; i < row->child_count; ++i) {
-        if (row->children[i].widget == control) {
-            ui_widget_remove_child(control);
-            memmove(&row->children[i], &row->children[i + 1],
-                    (row->child_count - i - 1) * sizeof(ui_row_child_t));
-            --row->child_count;
-            return true;
-        }
+    if (control->parent != &row->base) {
+        return false;
     }
-    return false;
+    ui_widget_remove_child(control);
+    return true;
 }
 
 size_t ui_row_control_count(const ui_row_t *row)
 {
-    return row ? row->child_count : 0;
+    return row ? row->base.child_count : 0;
 }
 
 void ui_row_set_alignment(ui_row_t *row, ui_main_axis_alignment_t alignment)
 {
     if (row) {
         row->alignment = alignment;
+        ui_widget_mark_needs_layout(&row->base);
     }
 }
 
@@ -360,6 +399,7 @@ void ui_row_set_vertical_alignment(ui_row_t *row, ui_cross_axis_alignment_t alig
 {
     if (row) {
         row->vertical_alignment = alignment;
+        ui_widget_mark_needs_layout(&row->base);
     }
 }
 
@@ -372,6 +412,7 @@ void ui_row_set_spacing(ui_row_t *row, int spacing)
 {
     if (row && spacing >= 0) {
         row->spacing = spacing;
+        ui_widget_invalidate_measure(&row->base);
     }
 }
 
@@ -387,6 +428,7 @@ void ui_row_set_auto_scroll(ui_row_t *row, bool auto_scroll)
         if (auto_scroll) {
             row->scroll_offset = row->max_scroll_offset;
         }
+        ui_widget_mark_needs_layout(&row->base);
     }
 }
 
@@ -401,9 +443,11 @@ void ui_row_set_scroll_mode(ui_row_t *row, ui_row_scroll_mode_t mode)
         row->scroll_mode = mode;
         if (mode == UI_SCROLL_DIRECTION_NONE) {
             row->scroll_offset = 0;
+            ui_scroller_stop(&row->scroller);
         } else {
             row->scroll_offset = ui_row_clamp_scroll(row, row->scroll_offset);
         }
+        ui_widget_mark_needs_layout(&row->base);
     }
 }
 
@@ -415,7 +459,8 @@ ui_row_scroll_mode_t ui_row_scroll_mode(const ui_row_t *row)
 void ui_row_set_scroll_offset(ui_row_t *row, int offset)
 {
     if (row) {
-        row->scroll_offset = ui_row_clamp_scroll(row, offset);
+        ui_scroller_stop(&row->scroller);
+        ui_row_apply_scroll(row, offset);
     }
 }
 
@@ -476,6 +521,7 @@ void ui_row_set_rtl(ui_row_t *row, bool rtl)
 {
     if (row) {
         row->rtl = rtl;
+        ui_widget_mark_needs_layout(&row->base);
     }
 }
 
@@ -496,32 +542,30 @@ int ui_row_on_scroll_interval(const ui_row_t *row)
     return row ? row->on_scroll_interval : SCROLL_INTERVAL_DEFAULT;
 }
 
-static int ui_row_find_child_with_key(const ui_row_t *row, const char *key)
+static ui_widget_t *ui_row_find_child_with_key(const ui_row_t *row, const char *key)
 {
     if (!row || !key) {
-        return -1;
+        return NULL;
     }
-    for (size_t i = 0; i < row->child_count; ++i) {
-        if (row->children[i].key && strcmp(row->children[i].key, key) == 0) {
-            return (int)i;
+    for (ui_widget_t *child = row->base.first_child; child; child = child->next_sibling) {
+        if (child->key && strcmp(child->key, key) == 0) {
+            return child;
         }
     }
-    return -1;
+    return NULL;
 }
 
 void ui_row_scroll_to(ui_row_t *row, int offset, int delta, const char *key,
                       int duration_ms, double curve)
 {
-    (void)duration_ms;
-    (void)curve;
     if (!row) {
         return;
     }
     int target = row->scroll_offset;
     if (key) {
-        int idx = ui_row_find_child_with_key(row, key);
-        if (idx >= 0) {
-            target = row->children[idx].widget->bounds.x - row->base.bounds.x;
+        ui_widget_t *child = ui_row_find_child_with_key(row, key);
+        if (child) {
+            target = child->bounds.x - row->base.bounds.x + row->scroll_offset;
         }
     }
     if (offset != INT_MIN) {
@@ -531,8 +575,15 @@ void ui_row_scroll_to(ui_row_t *row, int offset, int delta, const char *key,
             target = offset;
         }
     }
-    target += delta;
-    row->scroll_offset = ui_row_clamp_scroll(row, target);
+    target = ui_row_clamp_scroll(row, target + delta);
+    if (ui_scroller_animate(&row->scroller, row->scroll_offset, target, duration_ms,
+                            curve) &&
+        ui_widget_schedule_tick(&row->base)) {
+        return;
+    }
+    /* no duration, or no scene to tick the animation yet */
+    ui_scroller_stop(&row->scroller);
+    ui_row_apply_scroll(row, target);
 }
 
 const ui_widget_t *ui_row_widget(const ui_row_t *row)
@@ -2,15 +2,41 @@
 
 #include "ui_scene.h"
 
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "ui_animation.h"
+#include "ui_focus.h"
+#include "ui_profile.h"
 #include <time.h>
 
+#define UI_SCENE_DEFAULT_FRAME_RATE 60
+/* how often HALs with a poll_input op are sampled, drawing or not */
+#define UI_SCENE_INPUT_INTERVAL 0.005
+/* moves folded into one dispatch that stay visible as pointer history */
+#define UI_SCENE_MOVE_HISTORY 16
+
 struct ui_scene {
     ui_context_t *ctx;
     ui_widget_t *root;
     ui_scene_tick_fn tick;
     void *user_data;
-    bool running;
+    atomic_bool running; /* request_exit may clear it from another thread */
+    int frame_rate;
+    ui_widget_t *pointer_capture; /* took TOUCH_DOWN; gets MOVE/UP until release */
+    ui_widget_t *pointer_owner;   /* last widget that handled a pointer event */
+    ui_widget_t *pointer_previous; /* former owner; follows the gesture up to TOUCH_UP */
+    uint32_t pointer_epoch;
+    ui_event_t pending_move; /* latest TOUCH_MOVE of the run being drained */
+    bool has_pending_move;
+    ui_event_t move_history[UI_SCENE_MOVE_HISTORY];
+    size_t move_history_count;
+    uint32_t coalesced_moves;
+    ui_task_mpsc_t tasks; /* ui_scene_post, drained at frame start */
+    ui_focus_manager_t focus;
+    ui_widget_host_t host; /* the root's damage, ticks and tweens */
+    ui_arena_t *arena;
 };
 
 static double ui_scene_time_seconds(void)
@@ -20,6 +46,47 @@ static double ui_scene_time_seconds(void)
     return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
+static bool ui_scene_hal_polls(const ui_scene_t *scene)
+{
+    const ui_hal_ops_t *hal = ui_context_hal(scene->ctx);
+    return hal && hal->poll_input;
+}
+
+/* Sleeps until deadline, sampling polled HAL input on the way; the events it
+ * posts wait for the next frame. */
+static void ui_scene_sleep_until(ui_scene_t *scene, double deadline)
+{
+    bool polls = ui_scene_hal_polls(scene);
+    for (;;) {
+        double remaining = deadline - ui_scene_time_seconds();
+        if (remaining <= 0.0) {
+            return;
+        }
+        if (polls && remaining > UI_SCENE_INPUT_INTERVAL) {
+            remaining = UI_SCENE_INPUT_INTERVAL;
+        }
+        struct timespec wait;
+        wait.tv_sec = (time_t)remaining;
+        wait.tv_nsec = (long)((remaining - (double)wait.tv_sec) * 1e9);
+        nanosleep(&wait, NULL);
+        if (polls) {
+            ui_context_poll_input(scene->ctx);
+        }
+    }
+}
+
+/* Blocks until input is queued or the scene is woken. */
+static void ui_scene_wait_input(ui_scene_t *scene)
+{
+    if (!ui_scene_hal_polls(scene)) {
+        ui_context_wait_event(scene->ctx, -1.0);
+        return;
+    }
+    do {
+        ui_context_poll_input(scene->ctx);
+    } while (!ui_context_wait_event(scene->ctx, UI_SCENE_INPUT_INTERVAL));
+}
+
 ui_scene_t *ui_scene_create(const ui_hal_ops_t *hal)
 {
     if (!hal) {
@@ -38,7 +105,11 @@ ui_scene_t *ui_scene_create(const ui_hal_ops_t *hal)
     scene->root = NULL;
     scene->tick = NULL;
     scene->user_data = hal->user_data;
-    scene->running = false;
+    atomic_init(&scene->running, false);
+    ui_task_mpsc_init(&scene->tasks);
+    scene->frame_rate = UI_SCENE_DEFAULT_FRAME_RATE;
+    ui_focus_manager_init(&scene->focus);
+    ui_widget_host_init(&scene->host);
     return scene;
 }
 
@@ -53,6 +124,9 @@ void ui_scene_destroy(ui_scene_t *scene)
     if (scene->ctx) {
         ui_context_destroy(scene->ctx);
     }
+    ui_focus_manager_release(&scene->focus);
+    ui_arena_destroy(scene->arena);
+    ui_widget_host_release(&scene->host);
     free(scene);
 }
 
@@ -61,7 +135,20 @@ bool ui_scene_set_root(ui_scene_t *scene, ui_widget_t *root)
     if (!scene) {
         return false;
     }
+    if (scene->root) {
+        ui_widget_set_host(scene->root, NULL);
+    }
     scene->root = root;
+    scene->pointer_capture = NULL;
+    scene->pointer_owner = NULL;
+    scene->pointer_previous = NULL;
+    scene->has_pending_move = false;
+    scene->move_history_count = 0;
+    /* focus belongs to the old tree; drop it without notifying */
+    ui_focus_manager_release(&scene->focus);
+    if (root) {
+        ui_widget_set_host(root, &scene->host);
+    }
     return true;
 }
 
@@ -70,6 +157,17 @@ ui_widget_t *ui_scene_root(const ui_scene_t *scene)
     return scene ? scene->root : NULL;
 }
 
+ui_arena_t *ui_scene_arena(ui_scene_t *scene)
+{
+    if (!scene) {
+        return NULL;
+    }
+    if (!scene->arena) {
+        scene->arena = ui_arena_create(0);
+    }
+    return scene->arena;
+}
+
 void ui_scene_set_tick(ui_scene_t *scene, ui_scene_tick_fn tick)
 {
     if (scene) {
@@ -82,6 +180,48 @@ ui_scene_tick_fn ui_scene_tick(const ui_scene_t *scene)
     return scene ? scene->tick : NULL;
 }
 
+void ui_scene_set_frame_rate(ui_scene_t *scene, int frames_per_second)
+{
+    if (scene) {
+        scene->frame_rate =
+            frames_per_second > 0 ? frames_per_second : UI_SCENE_DEFAULT_FRAME_RATE;
+    }
+}
+
+int ui_scene_frame_rate(const ui_scene_t *scene)
+{
+    return scene ? scene->frame_rate : UI_SCENE_DEFAULT_FRAME_RATE;
+}
+
+bool ui_scene_is_animating(const ui_scene_t *scene)
+{
+    if (!scene) {
+        return false;
+    }
+    return ui_animation_count(&scene->host) > 0 || ui_widget_tick_pending(&scene->host);
+}
+
+bool ui_scene_set_debug_overlay(ui_scene_t *scene, uint32_t overlays)
+{
+    return scene ? ui_context_set_debug_overlay(scene->ctx, overlays) : false;
+}
+
+uint32_t ui_scene_debug_overlay(const ui_scene_t *scene)
+{
+    return scene ? ui_context_debug_overlay(scene->ctx) : UI_DEBUG_OVERLAY_NONE;
+}
+
+void ui_scene_event_stats(const ui_scene_t *scene, ui_event_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    ui_context_event_stats(scene ? scene->ctx : NULL, stats);
+    if (scene) {
+        stats->coalesced = scene->coalesced_moves;
+    }
+}
+
 void ui_scene_set_user_data(ui_scene_t *scene, void *user_data)
 {
     if (scene) {
@@ -98,6 +238,28 @@ void ui_scene_request_exit(ui_scene_t *scene)
 {
     if (scene) {
         scene->running = false;
+        ui_context_wake(scene->ctx);
+    }
+}
+
+bool ui_scene_post(ui_scene_t *scene, ui_task_fn fn, void *arg)
+{
+    if (!scene || !fn || !ui_task_mpsc_push(&scene->tasks, fn, arg)) {
+        return false;
+    }
+    ui_context_wake(scene->ctx);
+    return true;
+}
+
+/* Runs what was posted before the frame started; tasks posted by these wait
+ * for the next frame, so a task that reposts itself cannot stall the loop. */
+static void ui_scene_run_tasks(ui_scene_t *scene)
+{
+    ui_task_fn fn;
+    void *arg;
+    for (size_t i = 0; i < UI_TASK_QUEUE_SIZE && ui_task_mpsc_pop(&scene->tasks, &fn, &arg);
+         ++i) {
+        fn(arg);
     }
 }
 
@@ -106,18 +268,159 @@ bool ui_scene_is_running(const ui_scene_t *scene)
     return scene ? scene->running : false;
 }
 
+bool ui_scene_focus(ui_scene_t *scene, ui_widget_t *widget)
+{
+    return scene ? ui_focus_manager_set(&scene->focus, scene->root, widget) : false;
+}
+
+ui_widget_t *ui_scene_focused(ui_scene_t *scene)
+{
+    if (!scene) {
+        return NULL;
+    }
+    ui_focus_manager_sync(&scene->focus, scene->root);
+    return ui_focus_manager_focused(&scene->focus);
+}
+
+bool ui_scene_focus_next(ui_scene_t *scene)
+{
+    return scene ? ui_focus_manager_move(&scene->focus, scene->root, 1) : false;
+}
+
+bool ui_scene_focus_previous(ui_scene_t *scene)
+{
+    return scene ? ui_focus_manager_move(&scene->focus, scene->root, -1) : false;
+}
+
+static bool ui_scene_is_pointer_event(const ui_event_t *event)
+{
+    return event->type == UI_EVENT_TOUCH_DOWN || event->type == UI_EVENT_TOUCH_MOVE ||
+           event->type == UI_EVENT_TOUCH_UP;
+}
+
+static void ui_scene_revalidate_pointer(ui_scene_t *scene)
+{
+    uint32_t epoch = ui_widget_tree_epoch();
+    if (scene->pointer_epoch == epoch) {
+        return;
+    }
+    scene->pointer_epoch = epoch;
+    if (!ui_widget_tree_contains(scene->root, scene->pointer_capture)) {
+        scene->pointer_capture = NULL;
+    }
+    if (!ui_widget_tree_contains(scene->root, scene->pointer_owner)) {
+        scene->pointer_owner = NULL;
+    }
+    if (!ui_widget_tree_contains(scene->root, scene->pointer_previous)) {
+        scene->pointer_previous = NULL;
+    }
+}
+
+static void ui_scene_dispatch_pointer(ui_scene_t *scene, const ui_event_t *event)
+{
+    ui_scene_revalidate_pointer(scene);
+    ui_widget_t *handler = NULL;
+    if (scene->pointer_capture && event->type != UI_EVENT_TOUCH_DOWN) {
+        handler = scene->pointer_capture;
+        ui_widget_send_event(handler, event);
+    } else {
+        handler = ui_widget_dispatch_at(scene->root, event, event->data.touch.x,
+                                        event->data.touch.y);
+        if (handler && handler != scene->pointer_owner) {
+            scene->pointer_previous = scene->pointer_owner;
+            scene->pointer_owner = handler;
+        }
+        scene->pointer_capture = event->type == UI_EVENT_TOUCH_DOWN ? handler : NULL;
+        if (event->type == UI_EVENT_TOUCH_DOWN) {
+            ui_focus_manager_set(&scene->focus, scene->root,
+                                 handler && handler->focusable ? handler : NULL);
+        }
+    }
+    /* the former owner keeps seeing the pointer until the gesture ends, so it
+     * can drop hover, press and focus as it did when every widget saw every event */
+    ui_widget_t *previous = scene->pointer_previous;
+    if (!previous && !handler) {
+        previous = scene->pointer_owner;
+    }
+    if (previous && previous != handler) {
+        ui_widget_send_event(previous, event);
+    }
+    if (event->type == UI_EVENT_TOUCH_UP) {
+        scene->pointer_capture = NULL;
+        scene->pointer_previous = NULL;
+    }
+}
+
+/* Holds a TOUCH_MOVE back until the drain sees something else; the move it
+ * replaces joins the history, oldest dropped first. */
+static void ui_scene_queue_move(ui_scene_t *scene, const ui_event_t *event)
+{
+    if (scene->has_pending_move) {
+        if (scene->move_history_count == UI_SCENE_MOVE_HISTORY) {
+            memmove(scene->move_history, scene->move_history + 1,
+                    (UI_SCENE_MOVE_HISTORY - 1) * sizeof(ui_event_t));
+            scene->move_history_count--;
+        }
+        scene->move_history[scene->move_history_count++] = scene->pending_move;
+        scene->coalesced_moves++;
+    }
+    scene->pending_move = *event;
+    scene->has_pending_move = true;
+}
+
+static void ui_scene_flush_move(ui_scene_t *scene)
+{
+    if (!scene->has_pending_move) {
+        return;
+    }
+    scene->has_pending_move = false;
+    ui_widget_set_pointer_history(&scene->host, scene->move_history, scene->move_history_count);
+    ui_scene_dispatch_pointer(scene, &scene->pending_move);
+    ui_widget_set_pointer_history(&scene->host, NULL, 0);
+    scene->move_history_count = 0;
+}
+
+static void ui_scene_dispatch(ui_scene_t *scene, const ui_event_t *event)
+{
+    if (event->type == UI_EVENT_TOUCH_MOVE) {
+        ui_scene_queue_move(scene, event);
+        return;
+    }
+    /* anything else ends the run of moves, which keep their place in order */
+    ui_scene_flush_move(scene);
+    if (ui_scene_is_pointer_event(event)) {
+        ui_scene_dispatch_pointer(scene, event);
+    } else if (event->type == UI_EVENT_KEY_DOWN || event->type == UI_EVENT_KEY_UP) {
+        ui_focus_manager_route_key(&scene->focus, scene->root, event);
+    } else {
+        ui_widget_dispatch_event(scene->root, event);
+    }
+}
+
 void ui_scene_run(ui_scene_t *scene)
 {
     if (!scene || !scene->ctx) {
         return;
     }
     scene->running = true;
+    ui_damage_add_all(&scene->host.damage);
+    const ui_hal_ops_t *hal = ui_context_hal(scene->ctx);
+    double step = hal ? hal->frame_step_seconds : 0.0;
     double previous = ui_scene_time_seconds();
     while (scene->running) {
         double now = ui_scene_time_seconds();
-        double delta = now - previous;
+        double delta = step > 0.0 ? step : now - previous;
         previous = now;
+        UI_PROFILE_SPAN(frame);
+        UI_PROFILE_BEGIN(frame);
 
+        /* before layout, so a batch of updates costs one layout and one repaint */
+        ui_scene_run_tasks(scene);
+        if (scene->root) {
+            /* hit-testing needs current bounds, including on the first frame */
+            ui_widget_layout_tree(scene->root);
+        }
+        ui_context_poll_input(scene->ctx);
         bool saw_quit = false;
         ui_event_t event;
         while (ui_context_poll_event(scene->ctx, &event)) {
@@ -125,23 +428,49 @@ void ui_scene_run(ui_scene_t *scene)
                 saw_quit = true;
             }
             if (scene->root) {
-                ui_widget_dispatch_event(scene->root, &event);
+                ui_scene_dispatch(scene, &event);
             }
         }
+        if (scene->root) {
+            ui_scene_flush_move(scene);
+        }
         if (saw_quit) {
             scene->running = false;
         }
+        UI_PROFILE_PHASE(frame, UI_PROFILE_PHASE_EVENTS);
         if (scene->tick && scene->running) {
             if (!scene->tick(scene, delta)) {
                 scene->running = false;
             }
         }
+        ui_animation_tick(&scene->host, delta);
+        ui_widget_tick_all(&scene->host, delta);
+        UI_PROFILE_PHASE(frame, UI_PROFILE_PHASE_TICK);
         if (scene->root) {
-            ui_widget_render_tree(scene->root, scene->ctx);
+            /* render_damage would lay out too; done here to time it apart */
+            ui_widget_layout_tree(scene->root);
+            UI_PROFILE_PHASE(frame, UI_PROFILE_PHASE_LAYOUT);
+            ui_widget_render_damage(scene->root, scene->ctx);
         }
+        UI_PROFILE_PHASE(frame, UI_PROFILE_PHASE_PAINT);
         ui_context_render(scene->ctx);
+        UI_PROFILE_PHASE(frame, UI_PROFILE_PHASE_COMMIT);
+        UI_PROFILE_FRAME_END(frame);
 
-        struct timespec wait = {0, 16666667};
-        nanosleep(&wait, NULL);
+        if (step > 0.0) {
+            /* frames replay identically whatever the host's speed */
+            continue;
+        }
+        if (scene->running && !scene->tick && !ui_scene_is_animating(scene) &&
+            ui_damage_is_empty(&scene->host.damage) &&
+            !ui_context_debug_overlay_pending(scene->ctx)) {
+            /* nothing changes until input arrives; the idle time is not
+             * handed to tweens that input starts */
+            ui_scene_wait_input(scene);
+            previous = ui_scene_time_seconds();
+        }
+        /* frames start at most frame_rate times per second; input that
+         * arrives sooner is batched into the next frame */
+        ui_scene_sleep_until(scene, now + 1.0 / scene->frame_rate);
     }
 }
@@ -0,0 +1,166 @@
+#include "ui_scroller.h"
+
+#include <math.h>
+#include <string.h>
+
+/* friction: velocity falls by e every 1/UI_SCROLLER_FRICTION seconds */
+static const double UI_SCROLLER_FRICTION = 3.0;
+static const double UI_SCROLLER_MIN_VELOCITY = 40.0;
+static const double UI_SCROLLER_MAX_VELOCITY = 6000.0;
+static const double UI_SCROLLER_STOP_VELOCITY = 15.0;
+/* only moves this recent count towards the release velocity */
+static const double UI_SCROLLER_VELOCITY_WINDOW = 0.1;
+/* a pointer that rested this long before release does not fling */
+static const double UI_SCROLLER_REST_TIME = 0.05;
+static const double UI_SCROLLER_DEFAULT_CURVE = 3.0;
+
+void ui_scroller_reset(ui_scroller_t *scroller)
+{
+    if (scroller) {
+        memset(scroller, 0, sizeof(*scroller));
+    }
+}
+
+void ui_scroller_stop(ui_scroller_t *scroller)
+{
+    if (!scroller) {
+        return;
+    }
+    scroller->mode = UI_SCROLLER_IDLE;
+    scroller->velocity = 0.0;
+    scroller->sample_count = 0;
+    scroller->sample_next = 0;
+}
+
+bool ui_scroller_active(const ui_scroller_t *scroller)
+{
+    return scroller ? scroller->mode != UI_SCROLLER_IDLE : false;
+}
+
+void ui_scroller_track(ui_scroller_t *scroller, int offset, double time)
+{
+    if (!scroller) {
+        return;
+    }
+    scroller->mode = UI_SCROLLER_IDLE;
+    ui_scroller_sample_t *sample = &scroller->samples[scroller->sample_next];
+    sample->time = time;
+    sample->offset = offset;
+    scroller->sample_next = (scroller->sample_next + 1) % UI_SCROLLER_SAMPLES;
+    if (scroller->sample_count < UI_SCROLLER_SAMPLES) {
+        scroller->sample_count++;
+    }
+}
+
+/* Slope between the newest sample and the oldest one inside the window. */
+static double ui_scroller_velocity(const ui_scroller_t *scroller, double now)
+{
+    if (scroller->sample_count < 2) {
+        return 0.0;
+    }
+    size_t newest = (scroller->sample_next + UI_SCROLLER_SAMPLES - 1) % UI_SCROLLER_SAMPLES;
+    const ui_scroller_sample_t *last = &scroller->samples[newest];
+    if (now - last->time > UI_SCROLLER_REST_TIME) {
+        return 0.0;
+    }
+    const ui_scroller_sample_t *first = last;
+    for (size_t i = 1; i < scroller->sample_count; ++i) {
+        size_t index = (newest + UI_SCROLLER_SAMPLES - i) % UI_SCROLLER_SAMPLES;
+        const ui_scroller_sample_t *sample = &scroller->samples[index];
+        if (last->time - sample->time > UI_SCROLLER_VELOCITY_WINDOW) {
+            break;
+        }
+        first = sample;
+    }
+    double span = last->time - first->time;
+    if (span <= 0.0) {
+        return 0.0;
+    }
+    double velocity = (last->offset - first->offset) / span;
+    if (velocity > UI_SCROLLER_MAX_VELOCITY) {
+        velocity = UI_SCROLLER_MAX_VELOCITY;
+    } else if (velocity < -UI_SCROLLER_MAX_VELOCITY) {
+        velocity = -UI_SCROLLER_MAX_VELOCITY;
+    }
+    return velocity;
+}
+
+bool ui_scroller_fling(ui_scroller_t *scroller, int offset, double time)
+{
+    if (!scroller) {
+        return false;
+    }
+    double velocity = ui_scroller_velocity(scroller, time);
+    ui_scroller_stop(scroller);
+    if (fabs(velocity) < UI_SCROLLER_MIN_VELOCITY) {
+        return false;
+    }
+    scroller->mode = UI_SCROLLER_FLING;
+    scroller->position = offset;
+    scroller->velocity = velocity;
+    return true;
+}
+
+bool ui_scroller_animate(ui_scroller_t *scroller, int from, int to, int duration_ms,
+                         double curve)
+{
+    if (!scroller) {
+        return false;
+    }
+    ui_scroller_stop(scroller);
+    if (duration_ms <= 0 || from == to) {
+        return false;
+    }
+    scroller->mode = UI_SCROLLER_ANIMATE;
+    scroller->position = from;
+    scroller->from = from;
+    scroller->to = to;
+    scroller->elapsed = 0.0;
+    scroller->duration = duration_ms / 1000.0;
+    scroller->curve = curve > 0.0 ? curve : UI_SCROLLER_DEFAULT_CURVE;
+    return true;
+}
+
+bool ui_scroller_step(ui_scroller_t *scroller, double delta_seconds, int max_offset,
+                      int *offset)
+{
+    if (!scroller || !offset || scroller->mode == UI_SCROLLER_IDLE) {
+        return false;
+    }
+    if (delta_seconds < 0.0) {
+        delta_seconds = 0.0;
+    }
+    if (max_offset < 0) {
+        max_offset = 0;
+    }
+    if (scroller->mode == UI_SCROLLER_FLING) {
+        /* exact integral of v * e^(-kt) over the step, so frame rate does not
+         * change the distance travelled */
+        double decay = exp(-UI_SCROLLER_FRICTION * delta_seconds);
+        scroller->position += scroller->velocity * (1.0 - decay) / UI_SCROLLER_FRICTION;
+        scroller->velocity *= decay;
+        if (fabs(scroller->velocity) < UI_SCROLLER_STOP_VELOCITY) {
+            scroller->mode = UI_SCROLLER_IDLE;
+        }
+    } else {
+        scroller->elapsed += delta_seconds;
+        double t = scroller->elapsed / scroller->duration;
+        if (t >= 1.0) {
+            t = 1.0;
+            scroller->mode = UI_SCROLLER_IDLE;
+        }
+        double eased = 1.0 - pow(1.0 - t, scroller->curve);
+        scroller->position = scroller->from + (scroller->to - scroller->from) * eased;
+    }
+    if (scroller->position <= 0.0 || scroller->position >= max_offset) {
+        scroller->position = scroller->position <= 0.0 ? 0.0 : max_offset;
+        if (scroller->mode == UI_SCROLLER_FLING) {
+            scroller->mode = UI_SCROLLER_IDLE;
+        }
+    }
+    *offset = (int)lround(scroller->position);
+    if (scroller->mode == UI_SCROLLER_IDLE) {
+        scroller->velocity = 0.0;
+    }
+    return scroller->mode != UI_SCROLLER_IDLE;
+}
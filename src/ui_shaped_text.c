@@ -0,0 +1,109 @@
+#include "ui_shaped_text.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_text_engine.h"
+
+void ui_shaped_text_init(ui_shaped_text_t *shaped)
+{
+    if (!shaped) {
+        return;
+    }
+    memset(shaped, 0, sizeof(*shaped));
+    shaped->dirty = true;
+}
+
+void ui_shaped_text_release(ui_shaped_text_t *shaped)
+{
+    if (!shaped || shaped->is_static) {
+        return;
+    }
+    ui_arena_t *arena = shaped->arena;
+    ui_arena_free(arena, (void *)shaped->glyphs);
+    ui_shaped_text_init(shaped);
+    shaped->arena = arena;
+}
+
+bool ui_shaped_text_shape(ui_shaped_text_t *shaped, const bareui_font_t *font, const char *text)
+{
+    if (!shaped || shaped->is_static) {
+        return false;
+    }
+    font = font ? font : bareui_font_default();
+    uint32_t epoch = ui_text_engine_font_epoch();
+    size_t count = 0;
+    for (const char *ptr = text; ptr && *ptr;) {
+        uint32_t codepoint;
+        if (!ui_utf8_next(&ptr, &codepoint)) {
+            break;
+        }
+        ++count;
+    }
+
+    bareui_font_glyph_t *glyphs = NULL;
+    if (count > 0) {
+        /* in an arena this stays in place while the label fits its size class */
+        glyphs = ui_arena_realloc(shaped->arena, (void *)shaped->glyphs, count * sizeof(*glyphs));
+        if (!glyphs) {
+            return false;
+        }
+    } else {
+        ui_arena_free(shaped->arena, (void *)shaped->glyphs);
+    }
+    int width = 0;
+    const char *ptr = text;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t codepoint = 0;
+        ui_utf8_next(&ptr, &codepoint);
+        bareui_font_glyph_t *glyph = &glyphs[i];
+        if (codepoint == '\n' || !ui_text_engine_glyph(font, codepoint, glyph)) {
+            memset(glyph, 0, sizeof(*glyph));
+            glyph->codepoint = codepoint;
+            continue;
+        }
+        width += glyph->spacing;
+    }
+
+    shaped->font = font;
+    shaped->glyphs = glyphs;
+    shaped->count = count;
+    shaped->width = width;
+    shaped->height = font->height;
+    shaped->epoch = epoch;
+    shaped->dirty = false;
+    return true;
+}
+
+void ui_shaped_text_invalidate(ui_shaped_text_t *shaped)
+{
+    if (shaped && !shaped->is_static) {
+        shaped->dirty = true;
+    }
+}
+
+int ui_shaped_text_ensure(ui_shaped_text_t *shaped, const bareui_font_t *font, const char *text)
+{
+    if (!shaped) {
+        return 0;
+    }
+    if (shaped->is_static) {
+        return shaped->width;
+    }
+    font = font ? font : bareui_font_default();
+    if (shaped->dirty || shaped->font != font ||
+        shaped->epoch != ui_text_engine_font_epoch()) {
+        ui_shaped_text_shape(shaped, font, text);
+    }
+    return shaped->width;
+}
+
+int ui_shaped_text_width(const ui_shaped_text_t *shaped)
+{
+    return shaped ? shaped->width : 0;
+}
+
+bool ui_shaped_text_is_empty(const ui_shaped_text_t *shaped)
+{
+    return !shaped || shaped->count == 0;
+}
@@ -2,6 +2,7 @@
 
 #include "ui_font.h"
 #include "ui_primitives.h"
+#include "ui_text_engine.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -16,6 +17,8 @@
 #define UI_SLIDER_THUMB_RADIUS 6
 #define UI_SLIDER_LABEL_PADDING 4
 #define UI_SLIDER_LABEL_BUFFER 128
+/* Key steps across the range when divisions is 0. */
+#define UI_SLIDER_KEY_STEPS 20
 
 struct ui_slider {
     ui_widget_t base;
@@ -32,9 +35,9 @@ struct ui_slider {
     ui_color_t secondary_active_color;
     ui_slider_interaction_t interaction;
     ui_mouse_cursor_t mouse_cursor;
-    bool autofocus;
     bool adaptive;
     bool dragging;
+    bool adjusting;
     bool focused;
     bool change_in_progress;
     bool has_secondary_value;
@@ -63,72 +66,12 @@ typedef struct {
 
 static const ui_widget_ops_t ui_slider_ops;
 
-static bool ui_slider_next_codepoint(const unsigned char **ptr, uint32_t *out)
-{
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t cp = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-    } else if ((first & 0xE0) == 0xC0) {
-        cp &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        cp &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        cp &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        cp = (cp << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = cp;
-    }
-    return true;
-}
-
 static int ui_slider_measure_text(const bareui_font_t *font, const char *text)
 {
     if (!text || !font) {
         return 0;
     }
-    int width = 0;
-    const unsigned char *ptr = (const unsigned char *)text;
-    while (*ptr) {
-        uint32_t cp = 0;
-        if (!ui_slider_next_codepoint(&ptr, &cp)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
-        }
-    }
-    return width;
-}
-
-static char *ui_slider_strdup(const char *src)
-{
-    if (!src) {
-        return NULL;
-    }
-    size_t len = strlen(src) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, src, len);
-    }
-    return copy;
+    return ui_text_engine_measure_cached(font, text);
 }
 
 static const ui_style_t *ui_widget_style_safe(const ui_widget_t *widget)
@@ -507,6 +450,29 @@ static bool ui_slider_render(ui_context_t *ctx, ui_widget_t *widget, const ui_re
     return true;
 }
 
+static double ui_slider_key_step(const ui_slider_t *slider)
+{
+    double span = slider->max - slider->min;
+    if (slider->divisions > 0) {
+        return span / (double)slider->divisions;
+    }
+    return span / (double)UI_SLIDER_KEY_STEPS;
+}
+
+static void ui_slider_set_adjusting(ui_slider_t *slider, bool adjusting)
+{
+    if (slider->adjusting == adjusting) {
+        return;
+    }
+    slider->adjusting = adjusting;
+    if (adjusting) {
+        ui_slider_begin_interaction(slider);
+    } else {
+        ui_slider_end_interaction(slider);
+    }
+    ui_widget_invalidate(&slider->base);
+}
+
 static bool ui_slider_handle_event(ui_widget_t *widget, const ui_event_t *event)
 {
     ui_slider_t *slider = (ui_slider_t *)widget;
@@ -547,6 +513,30 @@ static bool ui_slider_handle_event(ui_widget_t *widget, const ui_event_t *event)
         ui_slider_end_interaction(slider);
         ui_slider_notify_focus(slider, false);
         return true;
+    case UI_EVENT_KEY_DOWN: {
+        if (!slider->focused) {
+            return false;
+        }
+        uint32_t keycode = event->data.key.keycode;
+        if (keycode == UI_KEY_SPACE || keycode == '\n' || keycode == UI_KEY_ENTER) {
+            ui_slider_set_adjusting(slider, !slider->adjusting);
+            return true;
+        }
+        if (!slider->adjusting) {
+            /* Outside adjust mode the arrows keep moving focus. */
+            return false;
+        }
+        double step = ui_slider_key_step(slider);
+        if (keycode == UI_KEY_RIGHT || keycode == UI_KEY_UP || keycode == UI_KEY_NEXT) {
+            ui_slider_notify_change(slider, slider->value + step);
+        } else if (keycode == UI_KEY_LEFT || keycode == UI_KEY_DOWN || keycode == UI_KEY_PREV) {
+            ui_slider_notify_change(slider, slider->value - step);
+        } else {
+            return false;
+        }
+        ui_widget_invalidate(&slider->base);
+        return true;
+    }
     default:
         return false;
     }
@@ -559,7 +549,7 @@ static void ui_slider_destroy_internal(ui_widget_t *widget)
         return;
     }
     if (slider->label_format) {
-        free(slider->label_format);
+        ui_arena_free(slider->base.arena, slider->label_format);
         slider->label_format = NULL;
     }
 }
@@ -581,20 +571,38 @@ static void ui_slider_apply_style(ui_widget_t *widget, const ui_style_t *style)
     }
 }
 
+static void ui_slider_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_slider_t *slider = (ui_slider_t *)widget;
+    if (!focused && slider) {
+        ui_slider_set_adjusting(slider, false);
+    }
+    ui_slider_notify_focus(slider, focused);
+}
+
 static const ui_widget_ops_t ui_slider_ops = {
+    .name = "slider",
     .render = ui_slider_render,
     .handle_event = ui_slider_handle_event,
     .destroy = ui_slider_destroy_internal,
-    .style_changed = ui_slider_apply_style
+    .style_changed = ui_slider_apply_style,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_slider_focus_changed
 };
 
 ui_slider_t *ui_slider_create(void)
 {
-    ui_slider_t *slider = calloc(1, sizeof(*slider));
+    return ui_slider_create_in(NULL);
+}
+
+ui_slider_t *ui_slider_create_in(ui_arena_t *arena)
+{
+    ui_slider_t *slider = ui_arena_alloc(arena, sizeof(*slider));
     if (!slider) {
         return NULL;
     }
     ui_slider_init(slider);
+    ui_widget_set_arena(&slider->base, arena);
     return slider;
 }
 
@@ -604,7 +612,8 @@ void ui_slider_destroy(ui_slider_t *slider)
         return;
     }
     ui_slider_destroy_internal(&slider->base);
-    free(slider);
+    ui_widget_deinit(&slider->base);
+    ui_arena_free(slider->base.arena, slider);
 }
 
 void ui_slider_init(ui_slider_t *slider)
@@ -625,14 +634,15 @@ void ui_slider_init(ui_slider_t *slider)
     slider->mouse_cursor = UI_MOUSE_CURSOR_DEFAULT;
     slider->value_round = 0;
     slider->divisions = 0;
-    slider->autofocus = false;
     slider->adaptive = false;
     slider->dragging = false;
+    slider->adjusting = false;
     slider->focused = false;
     slider->change_in_progress = false;
     slider->has_secondary_value = false;
     slider->label_format = NULL;
     ui_widget_init(&slider->base, &ui_slider_ops);
+    ui_widget_set_focusable(&slider->base, true);
 }
 
 void ui_slider_set_value(ui_slider_t *slider, double value)
@@ -641,6 +651,7 @@ void ui_slider_set_value(ui_slider_t *slider, double value)
         return;
     }
     slider->value = ui_slider_quantize_value(slider, value);
+    ui_widget_invalidate(&slider->base);
 }
 
 double ui_slider_value(const ui_slider_t *slider)
@@ -663,6 +674,7 @@ void ui_slider_set_min(ui_slider_t *slider, double min)
     if (slider->has_secondary_value && slider->secondary_value < slider->min) {
         slider->secondary_value = slider->min;
     }
+    ui_widget_invalidate(&slider->base);
 }
 
 double ui_slider_min(const ui_slider_t *slider)
@@ -685,6 +697,7 @@ void ui_slider_set_max(ui_slider_t *slider, double max)
     if (slider->has_secondary_value && slider->secondary_value > slider->max) {
         slider->secondary_value = slider->max;
     }
+    ui_widget_invalidate(&slider->base);
 }
 
 double ui_slider_max(const ui_slider_t *slider)
@@ -702,6 +715,7 @@ void ui_slider_set_divisions(ui_slider_t *slider, int divisions)
     }
     slider->divisions = divisions;
     slider->value = ui_slider_quantize_value(slider, slider->value);
+    ui_widget_invalidate(&slider->base);
 }
 
 int ui_slider_divisions(const ui_slider_t *slider)
@@ -713,6 +727,7 @@ void ui_slider_set_active_color(ui_slider_t *slider, ui_color_t color)
 {
     if (slider) {
         slider->active_color = color;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -725,6 +740,7 @@ void ui_slider_set_inactive_color(ui_slider_t *slider, ui_color_t color)
 {
     if (slider) {
         slider->inactive_color = color;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -737,6 +753,7 @@ void ui_slider_set_thumb_color(ui_slider_t *slider, ui_color_t color)
 {
     if (slider) {
         slider->thumb_color = color;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -749,6 +766,7 @@ void ui_slider_set_overlay_color(ui_slider_t *slider, ui_color_t color)
 {
     if (slider) {
         slider->overlay_color = color;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -761,6 +779,7 @@ void ui_slider_set_secondary_active_color(ui_slider_t *slider, ui_color_t color)
 {
     if (slider) {
         slider->secondary_active_color = color;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -782,6 +801,7 @@ void ui_slider_set_secondary_track_value(ui_slider_t *slider, double value)
     }
     slider->secondary_value = value;
     slider->has_secondary_value = true;
+    ui_widget_invalidate(&slider->base);
 }
 
 double ui_slider_secondary_track_value(const ui_slider_t *slider)
@@ -801,6 +821,7 @@ void ui_slider_clear_secondary_track_value(ui_slider_t *slider)
 {
     if (slider) {
         slider->has_secondary_value = false;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -810,12 +831,13 @@ void ui_slider_set_label(ui_slider_t *slider, const char *label)
         return;
     }
     if (slider->label_format) {
-        free(slider->label_format);
+        ui_arena_free(slider->base.arena, slider->label_format);
         slider->label_format = NULL;
     }
     if (label) {
-        slider->label_format = ui_slider_strdup(label);
+        slider->label_format = ui_arena_strdup(slider->base.arena, label);
     }
+    ui_widget_invalidate(&slider->base);
 }
 
 const char *ui_slider_label(const ui_slider_t *slider)
@@ -827,6 +849,7 @@ void ui_slider_set_round(ui_slider_t *slider, int decimals)
 {
     if (slider) {
         slider->value_round = decimals;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
@@ -850,19 +873,20 @@ ui_slider_interaction_t ui_slider_interaction(const ui_slider_t *slider)
 void ui_slider_set_autofocus(ui_slider_t *slider, bool autofocus)
 {
     if (slider) {
-        slider->autofocus = autofocus;
+        ui_widget_set_autofocus(&slider->base, autofocus);
     }
 }
 
 bool ui_slider_autofocus(const ui_slider_t *slider)
 {
-    return slider ? slider->autofocus : false;
+    return slider ? slider->base.autofocus : false;
 }
 
 void ui_slider_set_adaptive(ui_slider_t *slider, bool adaptive)
 {
     if (slider) {
         slider->adaptive = adaptive;
+        ui_widget_invalidate(&slider->base);
     }
 }
 
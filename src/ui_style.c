@@ -0,0 +1,324 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ui_style.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ui_style_entry {
+    ui_style_t style; /* first, so a shared style pointer is its entry */
+    struct ui_style_entry *next;
+    uint32_t hash;
+    uint32_t refs;
+} ui_style_entry_t;
+
+static ui_style_entry_t ui_style_default_entry = {
+    .style = {.border_sides = UI_BORDER_LEFT | UI_BORDER_TOP},
+};
+
+static ui_style_entry_t **ui_style_buckets;
+static size_t ui_style_bucket_count;
+static size_t ui_style_count;
+
+static char **ui_atom_names;
+static size_t ui_atom_count;
+static size_t ui_atom_capacity;
+static ui_atom_t *ui_atom_slots; /* open addressing, power-of-two size */
+static size_t ui_atom_slot_count;
+
+static uint32_t ui_style_hash_bytes(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t ui_atom_probe(const char *name, uint32_t hash)
+{
+    size_t mask = ui_atom_slot_count - 1;
+    size_t slot = hash & mask;
+    while (ui_atom_slots[slot] && strcmp(ui_atom_names[ui_atom_slots[slot] - 1], name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static bool ui_atom_grow(void)
+{
+    if (ui_atom_count == ui_atom_capacity) {
+        size_t next = ui_atom_capacity ? ui_atom_capacity * 2 : 32;
+        char **names = realloc(ui_atom_names, next * sizeof(*names));
+        if (!names) {
+            return false;
+        }
+        ui_atom_names = names;
+        ui_atom_capacity = next;
+    }
+    if ((ui_atom_count + 1) * 2 <= ui_atom_slot_count) {
+        return true;
+    }
+    size_t slot_count = ui_atom_slot_count ? ui_atom_slot_count * 2 : 64;
+    ui_atom_t *slots = calloc(slot_count, sizeof(*slots));
+    if (!slots) {
+        return false;
+    }
+    free(ui_atom_slots);
+    ui_atom_slots = slots;
+    ui_atom_slot_count = slot_count;
+    for (size_t i = 0; i < ui_atom_count; ++i) {
+        const char *name = ui_atom_names[i];
+        ui_atom_slots[ui_atom_probe(name, ui_style_hash_bytes(name, strlen(name)))] =
+            (ui_atom_t)(i + 1);
+    }
+    return true;
+}
+
+ui_atom_t ui_atom_find(const char *name)
+{
+    if (!name || ui_atom_slot_count == 0) {
+        return 0;
+    }
+    return ui_atom_slots[ui_atom_probe(name, ui_style_hash_bytes(name, strlen(name)))];
+}
+
+ui_atom_t ui_atom_intern(const char *name)
+{
+    ui_atom_t atom = ui_atom_find(name);
+    if (atom || !name || !ui_atom_grow()) {
+        return atom;
+    }
+    char *copy = strdup(name);
+    if (!copy) {
+        return 0;
+    }
+    ui_atom_names[ui_atom_count++] = copy;
+    atom = (ui_atom_t)ui_atom_count;
+    ui_atom_slots[ui_atom_probe(name, ui_style_hash_bytes(name, strlen(name)))] = atom;
+    return atom;
+}
+
+const char *ui_atom_name(ui_atom_t atom)
+{
+    if (atom == 0 || atom > ui_atom_count) {
+        return NULL;
+    }
+    return ui_atom_names[atom - 1];
+}
+
+void ui_style_init(ui_style_t *style)
+{
+    if (!style) {
+        return;
+    }
+    memset(style, 0, sizeof(*style));
+    style->border_width = 0;
+    style->border_sides = UI_BORDER_LEFT | UI_BORDER_TOP;
+    style->border_color = 0;
+    style->box_shadow.enabled = false;
+    style->custom_count = 0;
+    style->flags = 0;
+}
+
+void ui_style_copy(ui_style_t *dst, const ui_style_t *src)
+{
+    if (!dst || !src) {
+        return;
+    }
+    memcpy(dst, src, sizeof(*dst));
+}
+
+static bool ui_style_find_prop_idx(const ui_style_t *style, ui_atom_t key, size_t *out)
+{
+    for (size_t i = 0; i < style->custom_count; ++i) {
+        if (style->custom_props[i].key == key) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ui_style_set_prop(ui_style_t *style, ui_atom_t key, uint32_t value)
+{
+    if (!style || key == 0) {
+        return false;
+    }
+    size_t idx;
+    if (ui_style_find_prop_idx(style, key, &idx)) {
+        style->custom_props[idx].value = value;
+        return true;
+    }
+    if (style->custom_count >= UI_STYLE_MAX_CUSTOM_PROPS) {
+        return false;
+    }
+    style->custom_props[style->custom_count].key = key;
+    style->custom_props[style->custom_count].value = value;
+    style->custom_count++;
+    return true;
+}
+
+bool ui_style_get_prop(const ui_style_t *style, ui_atom_t key, uint32_t *out)
+{
+    if (!style || key == 0 || !out) {
+        return false;
+    }
+    size_t idx;
+    if (!ui_style_find_prop_idx(style, key, &idx)) {
+        return false;
+    }
+    *out = style->custom_props[idx].value;
+    return true;
+}
+
+bool ui_style_set_custom_prop(ui_style_t *style, const char *key, uint32_t value)
+{
+    return ui_style_set_prop(style, ui_atom_intern(key), value);
+}
+
+bool ui_style_get_custom_prop(const ui_style_t *style, const char *key, uint32_t *out)
+{
+    return ui_style_get_prop(style, ui_atom_find(key), out);
+}
+
+/* Field-by-field copy into zeroed memory, props sorted by key, so equal
+ * styles are equal bytes whatever their padding or property order was. */
+static void ui_style_canonical(ui_style_t *dst, const ui_style_t *src)
+{
+    memset(dst, 0, sizeof(*dst));
+    dst->background_color = src->background_color;
+    dst->foreground_color = src->foreground_color;
+    dst->accent_color = src->accent_color;
+    dst->padding_left = src->padding_left;
+    dst->padding_right = src->padding_right;
+    dst->padding_top = src->padding_top;
+    dst->padding_bottom = src->padding_bottom;
+    dst->margin_left = src->margin_left;
+    dst->margin_right = src->margin_right;
+    dst->margin_top = src->margin_top;
+    dst->margin_bottom = src->margin_bottom;
+    dst->border_sides = src->border_sides;
+    dst->border_width = src->border_width;
+    dst->border_color = src->border_color;
+    dst->box_shadow.enabled = src->box_shadow.enabled;
+    dst->box_shadow.offset_x = src->box_shadow.offset_x;
+    dst->box_shadow.offset_y = src->box_shadow.offset_y;
+    dst->box_shadow.blur_radius = src->box_shadow.blur_radius;
+    dst->box_shadow.spread_radius = src->box_shadow.spread_radius;
+    dst->box_shadow.blur_style = src->box_shadow.blur_style;
+    dst->box_shadow.color = src->box_shadow.color;
+    size_t count = src->custom_count < UI_STYLE_MAX_CUSTOM_PROPS ? src->custom_count
+                                                                  : UI_STYLE_MAX_CUSTOM_PROPS;
+    for (size_t i = 0; i < count; ++i) {
+        ui_style_prop_t prop = {src->custom_props[i].key, src->custom_props[i].value};
+        size_t j = i;
+        for (; j > 0 && dst->custom_props[j - 1].key > prop.key; --j) {
+            dst->custom_props[j] = dst->custom_props[j - 1];
+        }
+        dst->custom_props[j] = prop;
+    }
+    dst->custom_count = count;
+    dst->flags = src->flags;
+}
+
+static bool ui_style_grow_buckets(void)
+{
+    if (ui_style_count < ui_style_bucket_count) {
+        return true;
+    }
+    size_t bucket_count = ui_style_bucket_count ? ui_style_bucket_count * 2 : 32;
+    ui_style_entry_t **buckets = calloc(bucket_count, sizeof(*buckets));
+    if (!buckets) {
+        return ui_style_bucket_count > 0; /* keep chaining in the old table */
+    }
+    for (size_t i = 0; i < ui_style_bucket_count; ++i) {
+        ui_style_entry_t *entry = ui_style_buckets[i];
+        while (entry) {
+            ui_style_entry_t *next = entry->next;
+            ui_style_entry_t **head = &buckets[entry->hash & (bucket_count - 1)];
+            entry->next = *head;
+            *head = entry;
+            entry = next;
+        }
+    }
+    free(ui_style_buckets);
+    ui_style_buckets = buckets;
+    ui_style_bucket_count = bucket_count;
+    return true;
+}
+
+const ui_style_t *ui_style_intern(const ui_style_t *style)
+{
+    if (!style) {
+        return &ui_style_default_entry.style;
+    }
+    ui_style_t canonical;
+    ui_style_canonical(&canonical, style);
+    if (memcmp(&canonical, &ui_style_default_entry.style, sizeof(canonical)) == 0) {
+        return &ui_style_default_entry.style;
+    }
+    uint32_t hash = ui_style_hash_bytes(&canonical, sizeof(canonical));
+    if (ui_style_bucket_count > 0) {
+        ui_style_entry_t *entry = ui_style_buckets[hash & (ui_style_bucket_count - 1)];
+        for (; entry; entry = entry->next) {
+            if (entry->hash == hash &&
+                memcmp(&entry->style, &canonical, sizeof(canonical)) == 0) {
+                entry->refs++;
+                return &entry->style;
+            }
+        }
+    }
+    if (!ui_style_grow_buckets()) {
+        return NULL;
+    }
+    ui_style_entry_t *entry = malloc(sizeof(*entry));
+    if (!entry) {
+        return NULL;
+    }
+    memcpy(&entry->style, &canonical, sizeof(canonical));
+    entry->hash = hash;
+    entry->refs = 1;
+    ui_style_entry_t **head = &ui_style_buckets[hash & (ui_style_bucket_count - 1)];
+    entry->next = *head;
+    *head = entry;
+    ui_style_count++;
+    return &entry->style;
+}
+
+const ui_style_t *ui_style_retain(const ui_style_t *shared)
+{
+    if (shared && shared != &ui_style_default_entry.style) {
+        ((ui_style_entry_t *)shared)->refs++;
+    }
+    return shared;
+}
+
+void ui_style_release(const ui_style_t *shared)
+{
+    if (!shared || shared == &ui_style_default_entry.style) {
+        return;
+    }
+    ui_style_entry_t *entry = (ui_style_entry_t *)shared;
+    if (--entry->refs > 0) {
+        return;
+    }
+    ui_style_entry_t **link = &ui_style_buckets[entry->hash & (ui_style_bucket_count - 1)];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    ui_style_count--;
+    free(entry);
+}
+
+const ui_style_t *ui_style_default(void)
+{
+    return &ui_style_default_entry.style;
+}
+
+size_t ui_style_interned_count(void)
+{
+    return ui_style_count + 1;
+}
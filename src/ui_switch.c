@@ -1,6 +1,7 @@
 #include "ui_switch.h"
 
 #include "ui_primitives.h"
+#include "ui_shaped_text.h"
 
 #include <math.h>
 #include <stddef.h>
@@ -11,13 +12,13 @@
 struct ui_switch {
     ui_widget_t base;
     char *label;
+    ui_shaped_text_t shaped_label;
     const bareui_font_t *font;
     bool value;
     bool hovered;
     bool pressed;
     bool focused;
     bool enabled;
-    bool autofocus;
     bool adaptive;
     ui_color_t active_color;
     ui_color_t active_track_color;
@@ -50,74 +51,12 @@ static bool ui_switch_contains(const ui_switch_t *sw, int x, int y)
            x < bounds->x + bounds->width && y < bounds->y + bounds->height;
 }
 
-static bool ui_switch_next_codepoint(const unsigned char **ptr, uint32_t *out)
-{
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t codepoint = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-        // ASCII
-    } else if ((first & 0xE0) == 0xC0) {
-        codepoint &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        codepoint &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        codepoint &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        codepoint = (codepoint << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = codepoint;
-    }
-    return true;
-}
-
-static int ui_switch_measure_label(const ui_switch_t *sw)
+static int ui_switch_measure_label(ui_switch_t *sw)
 {
     if (!sw || !sw->label || !*sw->label) {
         return 0;
     }
-    const bareui_font_t *font = sw->font ? sw->font : bareui_font_default();
-    const unsigned char *ptr = (const unsigned char *)sw->label;
-    int width = 0;
-    while (*ptr) {
-        uint32_t cp;
-        if (!ui_switch_next_codepoint(&ptr, &cp)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
-        }
-    }
-    return width;
-}
-
-static char *ui_switch_copy_label(const char *label)
-{
-    if (!label) {
-        return NULL;
-    }
-    size_t len = strlen(label) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, label, len);
-    }
-    return copy;
+    return ui_shaped_text_ensure(&sw->shaped_label, sw->font, sw->label);
 }
 
 static ui_color_t ui_switch_track_fill_color(const ui_switch_t *sw)
@@ -206,11 +145,7 @@ static void ui_switch_draw_label(ui_context_t *ctx, const ui_switch_t *sw, int x
     if (!ctx || !sw || !sw->label || !*sw->label) {
         return;
     }
-    const bareui_font_t *font = sw->font ? sw->font : bareui_font_default();
-    const bareui_font_t *prev = ui_context_font(ctx);
-    ui_context_set_font(ctx, font);
-    ui_context_draw_text(ctx, x, y, sw->label, color);
-    ui_context_set_font(ctx, prev);
+    ui_context_draw_shaped_text(ctx, x, y, &sw->shaped_label, color);
 }
 
 static void ui_switch_apply_style(ui_widget_t *widget, const ui_style_t *style)
@@ -368,20 +303,35 @@ static bool ui_switch_handle_event(ui_widget_t *widget, const ui_event_t *event)
     return false;
 }
 
+static void ui_switch_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_switch_notify_focus((ui_switch_t *)widget, focused);
+}
+
 static const ui_widget_ops_t ui_switch_ops = {
+    .name = "switch",
     .render = ui_switch_render,
     .handle_event = ui_switch_handle_event,
     .destroy = NULL,
-    .style_changed = ui_switch_apply_style
+    .style_changed = ui_switch_apply_style,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_switch_focus_changed
 };
 
 ui_switch_t *ui_switch_create(void)
 {
-    ui_switch_t *sw = calloc(1, sizeof(*sw));
+    return ui_switch_create_in(NULL);
+}
+
+ui_switch_t *ui_switch_create_in(ui_arena_t *arena)
+{
+    ui_switch_t *sw = ui_arena_alloc(arena, sizeof(*sw));
     if (!sw) {
         return NULL;
     }
     ui_switch_init((ui_switch_t *)sw);
+    ui_widget_set_arena(&sw->base, arena);
+    sw->shaped_label.arena = arena;
     return (ui_switch_t *)sw;
 }
 
@@ -391,8 +341,10 @@ void ui_switch_destroy(ui_switch_t *sw)
         return;
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
-    free(impl->label);
-    free(impl);
+    ui_arena_free(impl->base.arena, impl->label);
+    ui_shaped_text_release(&impl->shaped_label);
+    ui_widget_deinit(&impl->base);
+    ui_arena_free(impl->base.arena, impl);
 }
 
 void ui_switch_init(ui_switch_t *sw)
@@ -403,13 +355,14 @@ void ui_switch_init(ui_switch_t *sw)
     ui_switch_t *impl = (ui_switch_t *)sw;
     memset(impl, 0, sizeof(*impl));
     ui_widget_init(&impl->base, &ui_switch_ops);
+    ui_shaped_text_init(&impl->shaped_label);
     impl->font = bareui_font_default();
     impl->value = false;
     impl->hovered = false;
     impl->pressed = false;
     impl->focused = false;
     impl->enabled = true;
-    impl->autofocus = false;
+    ui_widget_set_focusable(&impl->base, true);
     impl->adaptive = false;
     impl->active_color = ui_color_from_hex(0xFFFFFF);
     impl->active_track_color = ui_color_from_hex(0x25C06B);
@@ -447,6 +400,7 @@ void ui_switch_set_value(ui_switch_t *sw, bool value)
         return;
     }
     impl->value = value;
+    ui_widget_invalidate(&impl->base);
     if (impl->on_change) {
         impl->on_change(sw, value, impl->on_change_data);
     }
@@ -464,11 +418,13 @@ void ui_switch_set_enabled(ui_switch_t *sw, bool enabled)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->enabled = enabled;
+    ui_widget_set_focusable(&impl->base, enabled);
     if (!enabled) {
         impl->pressed = false;
         ui_switch_notify_hover(impl, false);
         ui_switch_notify_focus(impl, false);
     }
+    ui_widget_invalidate(&impl->base);
 }
 
 bool ui_switch_enabled(const ui_switch_t *sw)
@@ -483,12 +439,10 @@ void ui_switch_set_active_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->active_color = color;
-    ui_style_t *style = &impl->base.style;
-    style->accent_color = color;
-    style->flags |= UI_STYLE_FLAG_ACCENT_COLOR;
-    if (impl->base.ops && impl->base.ops->style_changed) {
-        impl->base.ops->style_changed(&impl->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&impl->base);
+    style.accent_color = color;
+    style.flags |= UI_STYLE_FLAG_ACCENT_COLOR;
+    ui_widget_set_style(&impl->base, &style);
 }
 
 ui_color_t ui_switch_active_color(const ui_switch_t *sw)
@@ -503,6 +457,7 @@ void ui_switch_set_active_track_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->active_track_color = color;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_color_t ui_switch_active_track_color(const ui_switch_t *sw)
@@ -517,6 +472,7 @@ void ui_switch_set_inactive_track_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->inactive_track_color = color;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_color_t ui_switch_inactive_track_color(const ui_switch_t *sw)
@@ -531,6 +487,7 @@ void ui_switch_set_inactive_thumb_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->inactive_thumb_color = color;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_color_t ui_switch_inactive_thumb_color(const ui_switch_t *sw)
@@ -545,6 +502,7 @@ void ui_switch_set_hover_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->hover_color = color;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_color_t ui_switch_hover_color(const ui_switch_t *sw)
@@ -559,6 +517,7 @@ void ui_switch_set_focus_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->focus_color = color;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_color_t ui_switch_focus_color(const ui_switch_t *sw)
@@ -573,12 +532,10 @@ void ui_switch_set_track_outline_color(ui_switch_t *sw, ui_color_t color)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->track_outline_color = color;
-    ui_style_t *style = &impl->base.style;
-    style->border_color = color;
-    style->flags |= UI_STYLE_FLAG_BORDER_COLOR;
-    if (impl->base.ops && impl->base.ops->style_changed) {
-        impl->base.ops->style_changed(&impl->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&impl->base);
+    style.border_color = color;
+    style.flags |= UI_STYLE_FLAG_BORDER_COLOR;
+    ui_widget_set_style(&impl->base, &style);
 }
 
 ui_color_t ui_switch_track_outline_color(const ui_switch_t *sw)
@@ -593,12 +550,10 @@ void ui_switch_set_track_outline_width(ui_switch_t *sw, int width)
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->track_outline_width = width >= 0 ? width : 0;
-    ui_style_t *style = &impl->base.style;
-    style->border_width = impl->track_outline_width;
-    style->flags |= UI_STYLE_FLAG_BORDER_WIDTH;
-    if (impl->base.ops && impl->base.ops->style_changed) {
-        impl->base.ops->style_changed(&impl->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&impl->base);
+    style.border_width = impl->track_outline_width;
+    style.flags |= UI_STYLE_FLAG_BORDER_WIDTH;
+    ui_widget_set_style(&impl->base, &style);
 }
 
 int ui_switch_track_outline_width(const ui_switch_t *sw)
@@ -612,8 +567,10 @@ void ui_switch_set_label(ui_switch_t *sw, const char *label)
         return;
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
-    free(impl->label);
-    impl->label = ui_switch_copy_label(label);
+    ui_arena_free(impl->base.arena, impl->label);
+    impl->label = ui_arena_strdup(impl->base.arena, label);
+    ui_shaped_text_shape(&impl->shaped_label, impl->font, impl->label);
+    ui_widget_invalidate(&impl->base);
 }
 
 const char *ui_switch_label(const ui_switch_t *sw)
@@ -628,6 +585,7 @@ void ui_switch_set_label_position(ui_switch_t *sw, ui_switch_label_position_t po
     }
     ui_switch_t *impl = (ui_switch_t *)sw;
     impl->label_position = position;
+    ui_widget_invalidate(&impl->base);
 }
 
 ui_switch_label_position_t ui_switch_label_position(const ui_switch_t *sw)
@@ -639,6 +597,8 @@ void ui_switch_set_font(ui_switch_t *sw, const bareui_font_t *font)
 {
     if (sw) {
         ((ui_switch_t *)sw)->font = font ? font : bareui_font_default();
+        ui_shaped_text_invalidate(&((ui_switch_t *)sw)->shaped_label);
+        ui_widget_invalidate(&sw->base);
     }
 }
 
@@ -2,6 +2,7 @@
 
 #include "ui_font.h"
 #include "ui_primitives.h"
+#include "ui_shaped_text.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -11,10 +12,12 @@
 
 struct ui_tab {
     char *text;
+    ui_shaped_text_t shaped_text;
     ui_widget_t *icon;
     ui_widget_t *tab_content;
     ui_widget_t *content;
     ui_tabs_t *owner;
+    ui_arena_t *arena;
 };
 
 struct ui_tabs {
@@ -42,6 +45,9 @@ struct ui_tabs {
     size_t selected_index;
     size_t pressed_index;
     size_t hovered_index;
+    size_t focus_index;
+    bool focused;
+    bool focus_visible;
     size_t tab_count;
     size_t tab_capacity;
     ui_tab_t **tabs;
@@ -76,74 +82,12 @@ static void ui_tabs_compute_layout(ui_tabs_t *tabs, const ui_rect_t *bounds);
 
 static const ui_widget_ops_t ui_tabs_ops;
 
-static bool ui_tab_next_codepoint(const unsigned char **ptr, uint32_t *out)
+static int ui_tab_measure_text(ui_tab_t *tab)
 {
-    if (!ptr || !*ptr || **ptr == '\0') {
-        return false;
-    }
-    unsigned char first = **ptr;
-    uint32_t codepoint = first;
-    size_t advance = 1;
-    if (first < 0x80) {
-        // ASCII
-    } else if ((first & 0xE0) == 0xC0) {
-        codepoint &= 0x1F;
-        advance = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        codepoint &= 0x0F;
-        advance = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        codepoint &= 0x07;
-        advance = 4;
-    } else {
-        return false;
-    }
-    for (size_t i = 1; i < advance; ++i) {
-        unsigned char c = (*ptr)[i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
-        }
-        codepoint = (codepoint << 6) | (c & 0x3F);
-    }
-    *ptr += advance;
-    if (out) {
-        *out = codepoint;
-    }
-    return true;
-}
-
-static char *ui_tab_strdup(const char *value)
-{
-    if (!value) {
-        return NULL;
-    }
-    size_t len = strlen(value) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, value, len);
-    }
-    return copy;
-}
-
-static int ui_tab_measure_text(const char *text)
-{
-    if (!text) {
+    if (!tab || !tab->text) {
         return 0;
     }
-    const bareui_font_t *font = bareui_font_default();
-    const unsigned char *ptr = (const unsigned char *)text;
-    int width = 0;
-    while (*ptr) {
-        uint32_t cp;
-        if (!ui_tab_next_codepoint(&ptr, &cp)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
-        }
-    }
-    return width;
+    return ui_shaped_text_ensure(&tab->shaped_text, bareui_font_default(), tab->text);
 }
 
 static bool ui_tabs_ensure_tab_capacity(ui_tabs_t *tabs, size_t required)
@@ -158,7 +102,7 @@ static bool ui_tabs_ensure_tab_capacity(ui_tabs_t *tabs, size_t required)
     if (next < required) {
         next = required;
     }
-    ui_tab_t **new_tabs = realloc(tabs->tabs, next * sizeof(*new_tabs));
+    ui_tab_t **new_tabs = ui_arena_realloc(tabs->base.arena, tabs->tabs, next * sizeof(*new_tabs));
     if (!new_tabs) {
         return false;
     }
@@ -179,19 +123,20 @@ static bool ui_tabs_ensure_layout_capacity(ui_tabs_t *tabs, size_t required)
     if (next < required) {
         next = required;
     }
-    int *offsets = realloc(tabs->layout_offsets, next * sizeof(*offsets));
+    ui_arena_t *arena = tabs->base.arena;
+    int *offsets = ui_arena_realloc(arena, tabs->layout_offsets, next * sizeof(*offsets));
     if (!offsets) {
         return false;
     }
-    int *widths = realloc(tabs->layout_widths, next * sizeof(*widths));
+    int *widths = ui_arena_realloc(arena, tabs->layout_widths, next * sizeof(*widths));
     if (!widths) {
-        free(offsets);
+        ui_arena_free(arena, offsets);
         return false;
     }
-    int *text_widths = realloc(tabs->layout_text_widths, next * sizeof(*text_widths));
+    int *text_widths = ui_arena_realloc(arena, tabs->layout_text_widths, next * sizeof(*text_widths));
     if (!text_widths) {
-        free(offsets);
-        free(widths);
+        ui_arena_free(arena, offsets);
+        ui_arena_free(arena, widths);
         return false;
     }
     tabs->layout_offsets = offsets;
@@ -208,6 +153,8 @@ static void ui_tabs_mark_layout_dirty(ui_tabs_t *tabs)
     }
     tabs->layout_dirty = true;
     tabs->layout_bounds = (ui_rect_t){0};
+    ui_widget_invalidate(&tabs->base);
+    ui_widget_mark_needs_layout(&tabs->base);
 }
 
 static void ui_tabs_update_content_visibility(ui_tabs_t *tabs)
@@ -247,7 +194,7 @@ static void ui_tabs_layout_contents(ui_tabs_t *tabs, const ui_rect_t *bounds)
         if (!tab || !tab->content) {
             continue;
         }
-        ui_widget_set_bounds(tab->content, content_left, content_top, content_width, content_height);
+        ui_widget_place(tab->content, content_left, content_top, content_width, content_height);
         ui_widget_set_visible(tab->content, i == tabs->selected_index);
     }
 }
@@ -298,7 +245,7 @@ static void ui_tabs_compute_layout(ui_tabs_t *tabs, const ui_rect_t *bounds)
     int max_label_width = 0;
     for (size_t i = 0; i < tabs->tab_count; ++i) {
         ui_tab_t *tab = tabs->tabs[i];
-        int measured = tab ? ui_tab_measure_text(tab->text) : 0;
+        int measured = ui_tab_measure_text(tab);
         tabs->layout_text_widths[i] = measured;
         int width = measured + tabs->label_padding.left + tabs->label_padding.right;
         if (width > max_label_width) {
@@ -402,6 +349,13 @@ static size_t ui_tabs_index_at(ui_tabs_t *tabs, const ui_rect_t *bounds, int x,
     return SIZE_MAX;
 }
 
+static void ui_tabs_arrange(ui_widget_t *widget, const ui_rect_t *bounds)
+{
+    ui_tabs_t *tabs = (ui_tabs_t *)widget;
+    ui_tabs_prepare_layout(tabs, bounds);
+    ui_tabs_layout_contents(tabs, bounds);
+}
+
 static bool ui_tabs_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_t *bounds)
 {
     if (!ctx || !widget || !bounds) {
@@ -413,14 +367,9 @@ static bool ui_tabs_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect
         ui_context_fill_rect(ctx, bounds->x, bounds->y, bounds->width, bounds->height,
                              style->background_color);
     }
-    ui_tabs_prepare_layout(tabs, bounds);
-    ui_tabs_layout_contents(tabs, bounds);
     if (tabs->tab_count == 0) {
         return true;
     }
-    const bareui_font_t *font = bareui_font_default();
-    const bareui_font_t *prev = ui_context_font(ctx);
-    ui_context_set_font(ctx, font);
     int text_y = tabs->layout_header_top + tabs->padding.top + tabs->label_padding.top;
     for (size_t i = 0; i < tabs->tab_count; ++i) {
         ui_tab_t *tab = tabs->tabs[i];
@@ -432,9 +381,20 @@ static bool ui_tabs_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect
         int text_width = tabs->layout_text_widths ? tabs->layout_text_widths[i] : 0;
         int text_x = offset + (width - text_width) / 2;
         ui_color_t color = i == tabs->selected_index ? tabs->label_color : tabs->unselected_label_color;
-        ui_context_draw_text(ctx, text_x, text_y, tab->text, color);
+        ui_context_draw_shaped_text(ctx, text_x, text_y, &tab->shaped_text, color);
     }
     int indicator_y = tabs->layout_header_top + tabs->padding.top + ui_tabs_label_area_height(tabs);
+    if (tabs->focused && tabs->focus_visible && tabs->focus_index < tabs->tab_count) {
+        /* Key cursor: outline the tab that Enter would select. */
+        int offset = tabs->layout_offsets ? tabs->layout_offsets[tabs->focus_index] : 0;
+        int width = tabs->layout_widths ? tabs->layout_widths[tabs->focus_index] : 0;
+        int top = tabs->layout_header_top + tabs->padding.top;
+        int height = indicator_y - top;
+        ui_context_fill_rect(ctx, offset, top, width, 1, tabs->indicator_color);
+        ui_context_fill_rect(ctx, offset, top + height - 1, width, 1, tabs->indicator_color);
+        ui_context_fill_rect(ctx, offset, top, 1, height, tabs->indicator_color);
+        ui_context_fill_rect(ctx, offset + width - 1, top, 1, height, tabs->indicator_color);
+    }
     if (tabs->selected_index < tabs->tab_count) {
         int offset = tabs->layout_offsets ? tabs->layout_offsets[tabs->selected_index] : 0;
         int width = tabs->layout_widths ? tabs->layout_widths[tabs->selected_index] : 0;
@@ -454,10 +414,19 @@ static bool ui_tabs_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect
         ui_context_fill_rect(ctx, tabs->layout_header_left, divider_y,
                              tabs->layout_header_width, tabs->divider_height, tabs->divider_color);
     }
-    ui_context_set_font(ctx, prev);
     return true;
 }
 
+static void ui_tabs_activate(ui_tabs_t *tabs, size_t index)
+{
+    tabs->focus_index = index;
+    ui_tabs_set_selected_index(tabs, index);
+    if (tabs->on_click) {
+        tabs->on_click(tabs, index, tabs->on_click_data);
+    }
+    ui_widget_invalidate(&tabs->base);
+}
+
 static bool ui_tabs_handle_event(ui_widget_t *widget, const ui_event_t *event)
 {
     if (!widget || !event) {
@@ -471,6 +440,10 @@ static bool ui_tabs_handle_event(ui_widget_t *widget, const ui_event_t *event)
         if (idx < tabs->tab_count) {
             tabs->pressed_index = idx;
             tabs->hovered_index = idx;
+            if (tabs->focus_visible) {
+                tabs->focus_visible = false;
+                ui_widget_invalidate(widget);
+            }
             return true;
         }
         break;
@@ -490,10 +463,7 @@ static bool ui_tabs_handle_event(ui_widget_t *widget, const ui_event_t *event)
     case UI_EVENT_TOUCH_UP: {
         size_t idx = ui_tabs_index_at(tabs, bounds, event->data.touch.x, event->data.touch.y);
         if (idx < tabs->tab_count && tabs->pressed_index == idx) {
-            ui_tabs_set_selected_index(tabs, idx);
-            if (tabs->on_click) {
-                tabs->on_click(tabs, idx, tabs->on_click_data);
-            }
+            ui_tabs_activate(tabs, idx);
             tabs->pressed_index = SIZE_MAX;
             tabs->hovered_index = idx;
             return true;
@@ -501,6 +471,36 @@ static bool ui_tabs_handle_event(ui_widget_t *widget, const ui_event_t *event)
         tabs->pressed_index = SIZE_MAX;
         break;
     }
+    case UI_EVENT_KEY_DOWN: {
+        if (!tabs->focused || tabs->tab_count == 0) {
+            break;
+        }
+        uint32_t keycode = event->data.key.keycode;
+        if (tabs->focus_index >= tabs->tab_count) {
+            tabs->focus_index = tabs->selected_index;
+        }
+        if (!tabs->focus_visible) {
+            tabs->focus_visible = true;
+            ui_widget_invalidate(widget);
+        }
+        if (keycode == UI_KEY_SPACE || keycode == '\n' || keycode == UI_KEY_ENTER) {
+            ui_tabs_activate(tabs, tabs->focus_index);
+            return true;
+        }
+        /* Past the first or last tab the key falls through to focus navigation. */
+        if ((keycode == UI_KEY_RIGHT || keycode == UI_KEY_NEXT) &&
+            tabs->focus_index + 1 < tabs->tab_count) {
+            tabs->focus_index++;
+            ui_widget_invalidate(widget);
+            return true;
+        }
+        if ((keycode == UI_KEY_LEFT || keycode == UI_KEY_PREV) && tabs->focus_index > 0) {
+            tabs->focus_index--;
+            ui_widget_invalidate(widget);
+            return true;
+        }
+        break;
+    }
     default:
         break;
     }
@@ -514,13 +514,13 @@ static void ui_tabs_destroy_internal(ui_widget_t *widget)
     }
     ui_tabs_t *tabs = (ui_tabs_t *)widget;
     ui_tabs_clear(tabs);
-    free(tabs->tabs);
+    ui_arena_free(tabs->base.arena, tabs->tabs);
     tabs->tabs = NULL;
-    free(tabs->layout_offsets);
+    ui_arena_free(tabs->base.arena, tabs->layout_offsets);
     tabs->layout_offsets = NULL;
-    free(tabs->layout_widths);
+    ui_arena_free(tabs->base.arena, tabs->layout_widths);
     tabs->layout_widths = NULL;
-    free(tabs->layout_text_widths);
+    ui_arena_free(tabs->base.arena, tabs->layout_text_widths);
     tabs->layout_text_widths = NULL;
     tabs->layout_capacity = 0;
 }
@@ -531,20 +531,45 @@ static void ui_tabs_style_changed(ui_widget_t *widget, const ui_style_t *style)
     ui_tabs_mark_layout_dirty((ui_tabs_t *)widget);
 }
 
+static void ui_tabs_focus_changed(ui_widget_t *widget, bool focused)
+{
+    ui_tabs_t *tabs = (ui_tabs_t *)widget;
+    if (!tabs || tabs->focused == focused) {
+        return;
+    }
+    tabs->focused = focused;
+    tabs->focus_index = tabs->selected_index;
+    /* the key cursor stays hidden when a touch brought the focus */
+    tabs->focus_visible = focused && tabs->pressed_index == SIZE_MAX;
+    ui_widget_invalidate(widget);
+}
+
 static const ui_widget_ops_t ui_tabs_ops = {
+    .name = "tabs",
     .render = ui_tabs_render,
     .handle_event = ui_tabs_handle_event,
     .destroy = ui_tabs_destroy_internal,
-    .style_changed = ui_tabs_style_changed
+    .style_changed = ui_tabs_style_changed,
+    .arrange = ui_tabs_arrange,
+    .event_mask = UI_EVENT_MASK_POINTER | UI_EVENT_MASK_KEY,
+    .focus_changed = ui_tabs_focus_changed
 };
 
 ui_tab_t *ui_tab_create(void)
 {
-    ui_tab_t *tab = calloc(1, sizeof(*tab));
+    return ui_tab_create_in(NULL);
+}
+
+ui_tab_t *ui_tab_create_in(ui_arena_t *arena)
+{
+    ui_tab_t *tab = ui_arena_alloc(arena, sizeof(*tab));
     if (!tab) {
         return NULL;
     }
     tab->owner = NULL;
+    tab->arena = arena;
+    ui_shaped_text_init(&tab->shaped_text);
+    tab->shaped_text.arena = arena;
     return tab;
 }
 
@@ -553,12 +578,11 @@ void ui_tab_destroy(ui_tab_t *tab)
     if (!tab) {
         return;
     }
-    if (tab->text) {
-        free(tab->text);
-    }
+    ui_arena_free(tab->arena, tab->text);
     tab->text = NULL;
+    ui_shaped_text_release(&tab->shaped_text);
     tab->owner = NULL;
-    free(tab);
+    ui_arena_free(tab->arena, tab);
 }
 
 void ui_tab_set_text(ui_tab_t *tab, const char *text)
@@ -566,11 +590,10 @@ void ui_tab_set_text(ui_tab_t *tab, const char *text)
     if (!tab) {
         return;
     }
-    char *copy = ui_tab_strdup(text);
-    if (tab->text) {
-        free(tab->text);
-    }
+    char *copy = ui_arena_strdup(tab->arena, text);
+    ui_arena_free(tab->arena, tab->text);
     tab->text = copy;
+    ui_shaped_text_shape(&tab->shaped_text, bareui_font_default(), tab->text);
     if (tab->owner) {
         ui_tabs_mark_layout_dirty(tab->owner);
     }
@@ -585,6 +608,9 @@ void ui_tab_set_icon(ui_tab_t *tab, ui_widget_t *icon)
 {
     if (tab) {
         tab->icon = icon;
+        if (tab->owner) {
+            ui_widget_invalidate(&tab->owner->base);
+        }
     }
 }
 
@@ -597,6 +623,9 @@ void ui_tab_set_tab_content(ui_tab_t *tab, ui_widget_t *tab_content)
 {
     if (tab) {
         tab->tab_content = tab_content;
+        if (tab->owner) {
+            ui_widget_invalidate(&tab->owner->base);
+        }
     }
 }
 
@@ -628,11 +657,17 @@ ui_widget_t *ui_tab_content(const ui_tab_t *tab)
 
 ui_tabs_t *ui_tabs_create(void)
 {
-    ui_tabs_t *tabs = calloc(1, sizeof(*tabs));
+    return ui_tabs_create_in(NULL);
+}
+
+ui_tabs_t *ui_tabs_create_in(ui_arena_t *arena)
+{
+    ui_tabs_t *tabs = ui_arena_alloc(arena, sizeof(*tabs));
     if (!tabs) {
         return NULL;
     }
     ui_tabs_init(tabs);
+    ui_widget_set_arena(&tabs->base, arena);
     return tabs;
 }
 
@@ -642,7 +677,8 @@ void ui_tabs_destroy(ui_tabs_t *tabs)
         return;
     }
     ui_tabs_destroy_internal(&tabs->base);
-    free(tabs);
+    ui_widget_deinit(&tabs->base);
+    ui_arena_free(tabs->base.arena, tabs);
 }
 
 void ui_tabs_init(ui_tabs_t *tabs)
@@ -675,8 +711,12 @@ void ui_tabs_init(ui_tabs_t *tabs)
     tabs->selected_index = 0;
     tabs->pressed_index = SIZE_MAX;
     tabs->hovered_index = SIZE_MAX;
+    tabs->focus_index = 0;
+    tabs->focused = false;
+    tabs->focus_visible = false;
     tabs->layout_bounds = (ui_rect_t){0};
     tabs->layout_dirty = true;
+    ui_widget_set_focusable(&tabs->base, true);
 }
 
 const ui_widget_t *ui_tabs_widget(const ui_tabs_t *tabs)
@@ -795,6 +835,7 @@ void ui_tabs_set_selected_index(ui_tabs_t *tabs, size_t index)
     }
     tabs->selected_index = clamped;
     ui_tabs_update_content_visibility(tabs);
+    ui_widget_invalidate(&tabs->base);
     if (tabs->on_change) {
         tabs->on_change(tabs, clamped, tabs->on_change_data);
     }
@@ -809,6 +850,7 @@ void ui_tabs_set_clip_behavior(ui_tabs_t *tabs, ui_tab_clip_behavior_t behavior)
 {
     if (tabs) {
         tabs->clip_behavior = behavior;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -873,6 +915,7 @@ void ui_tabs_set_indicator_color(ui_tabs_t *tabs, ui_color_t color)
 {
     if (tabs) {
         tabs->indicator_color = color;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -898,6 +941,7 @@ void ui_tabs_set_indicator_padding(ui_tabs_t *tabs, int padding)
 {
     if (tabs) {
         tabs->indicator_padding = padding;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -910,6 +954,7 @@ void ui_tabs_set_indicator_tab_size(ui_tabs_t *tabs, bool full_tab)
 {
     if (tabs) {
         tabs->indicator_tab_size = full_tab;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -922,6 +967,7 @@ void ui_tabs_set_indicator_border_radius(ui_tabs_t *tabs, ui_border_radius_t rad
 {
     if (tabs) {
         tabs->indicator_border_radius = radius;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -934,6 +980,7 @@ void ui_tabs_set_indicator_border_side(ui_tabs_t *tabs, ui_border_side_t sides)
 {
     if (tabs) {
         tabs->indicator_border_side = sides;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -946,6 +993,7 @@ void ui_tabs_set_divider_color(ui_tabs_t *tabs, ui_color_t color)
 {
     if (tabs) {
         tabs->divider_color = color;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -971,6 +1019,7 @@ void ui_tabs_set_label_color(ui_tabs_t *tabs, ui_color_t color)
 {
     if (tabs) {
         tabs->label_color = color;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -983,6 +1032,7 @@ void ui_tabs_set_unselected_label_color(ui_tabs_t *tabs, ui_color_t color)
 {
     if (tabs) {
         tabs->unselected_label_color = color;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -995,6 +1045,7 @@ void ui_tabs_set_overlay_color(ui_tabs_t *tabs, ui_color_t color)
 {
     if (tabs) {
         tabs->overlay_color = color;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
@@ -1019,6 +1070,7 @@ void ui_tabs_set_splash_border_radius(ui_tabs_t *tabs, ui_border_radius_t radius
 {
     if (tabs) {
         tabs->splash_border_radius = radius;
+        ui_widget_invalidate(&tabs->base);
     }
 }
 
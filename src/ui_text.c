@@ -7,6 +7,15 @@
 #include <string.h>
 
 #include "ui_font.h"
+#include "ui_text_engine.h"
+
+typedef struct {
+    size_t start;
+    size_t length;
+    int width;
+    size_t keep; /* bytes drawn ahead of the ellipsis; length when none */
+    int keep_width;
+} ui_text_line_t;
 
 struct ui_text {
     ui_widget_t base;
@@ -21,11 +30,13 @@ struct ui_text {
     bool italic;
     int max_lines;
     int line_spacing;
-};
-
-struct ui_text_utf8_reader {
-    const char *ptr;
-    size_t remaining;
+    /* value broken at lines_wrap; the setters that change breaks drop it */
+    ui_text_line_t *lines;
+    size_t line_count;
+    size_t line_capacity;
+    int lines_wrap;
+    uint32_t lines_epoch;
+    bool lines_valid;
 };
 
 
@@ -43,175 +54,98 @@ static void ui_text_apply_style(ui_widget_t *widget, const ui_style_t *style)
     }
 }
 
-static bool ui_text_read_codepoint(const char *str, size_t len, size_t offset, uint32_t *out,
-                                   size_t *advance)
+static size_t ui_text_next_line(const ui_text_t *text, const char *start, size_t total_len,
+                                size_t cursor, int max_width, size_t *next)
 {
-    if (!str || offset >= len || !advance) {
-        return false;
-    }
-    const unsigned char first = (unsigned char)str[offset];
-    uint32_t cp = first;
-    size_t adv = 1;
-    if (first < 0x80) {
-    } else if ((first & 0xE0) == 0xC0) {
-        cp = first & 0x1F;
-        adv = 2;
-    } else if ((first & 0xF0) == 0xE0) {
-        cp = first & 0x0F;
-        adv = 3;
-    } else if ((first & 0xF8) == 0xF0) {
-        cp = first & 0x07;
-        adv = 4;
-    } else {
-        return false;
-    }
-    if (offset + adv > len) {
-        return false;
-    }
-    for (size_t i = 1; i < adv; ++i) {
-        unsigned char c = (unsigned char)str[offset + i];
-        if ((c & 0xC0) != 0x80) {
-            return false;
+    if (text->no_wrap) {
+        size_t end = cursor;
+        while (end < total_len && start[end] != '\n') {
+            ++end;
         }
-        cp = (cp << 6) | (c & 0x3F);
+        *next = end < total_len ? end + 1 : total_len;
+        return end;
     }
-    *advance = adv;
-    if (out) {
-        *out = cp;
-    }
-    return true;
+    size_t rest = 0;
+    size_t end = ui_text_engine_line_break(text->font, start + cursor, total_len - cursor,
+                                           max_width > 0 ? max_width : 1, &rest);
+    *next = cursor + rest;
+    return cursor + end;
 }
 
-static char *ui_text_strdup(const char *src)
+static void ui_text_forget_lines(ui_text_t *text)
 {
-    if (!src) {
-        return NULL;
-    }
-    size_t len = strlen(src) + 1;
-    char *copy = malloc(len);
-    if (copy) {
-        memcpy(copy, src, len);
-    }
-    return copy;
+    text->lines_valid = false;
 }
 
-static size_t ui_text_line_break(const ui_text_t *text, const char *line, size_t total_len,
-                                 size_t cursor, int max_width, size_t *out_newline)
+static bool ui_text_push_line(ui_text_t *text, const ui_text_line_t *line)
 {
-    if (!text || cursor >= total_len) {
-        return total_len;
-    }
-    const bareui_font_t *font = text->font ? text->font : bareui_font_default();
-    size_t pos = cursor;
-    size_t last_space = cursor;
-    int width = 0;
-    *out_newline = cursor;
-
-    while (pos < total_len) {
-        if (line[pos] == '\n') {
-            *out_newline = pos;
-            return pos;
-        }
-        uint32_t cp;
-        size_t adv;
-        if (!ui_text_read_codepoint(line, total_len, pos, &cp, &adv)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
-        }
-        if (max_width > 0 && width > max_width) {
-            if (last_space > cursor) {
-                *out_newline = last_space;
-                return last_space;
-            }
-            *out_newline = pos;
-            return pos;
-        }
-        if (cp == ' ') {
-            last_space = pos;
-        }
-        pos += adv;
-    }
-    return pos;
-}
-
-static int ui_text_measure_line(const ui_text_t *text, const char *line, size_t len)
-{
-    const bareui_font_t *font = text->font ? text->font : bareui_font_default();
-    size_t offset = 0;
-    int width = 0;
-    while (offset < len) {
-        uint32_t cp;
-        size_t adv;
-        if (!ui_text_read_codepoint(line, len, offset, &cp, &adv)) {
-            break;
-        }
-        bareui_font_glyph_t glyph;
-        if (bareui_font_lookup(font, cp, &glyph)) {
-            width += glyph.spacing;
+    if (text->line_count == text->line_capacity) {
+        size_t capacity = text->line_capacity ? text->line_capacity * 2 : 4;
+        ui_text_line_t *lines =
+            ui_arena_realloc(text->base.arena, text->lines, capacity * sizeof(*lines));
+        if (!lines) {
+            return false;
         }
-        offset += adv;
+        text->lines = lines;
+        text->line_capacity = capacity;
     }
-    return width;
+    text->lines[text->line_count++] = *line;
+    return true;
 }
 
-static int ui_text_count_lines(const ui_text_t *text, const char *start, size_t total_len,
-                               int max_lines, int width)
+/* Breaks and measures value once per wrap width; renders of an unchanged
+ * label reuse the lines. Returns false on allocation failure. */
+static bool ui_text_layout_lines(ui_text_t *text, int wrap_width)
 {
-    if (!text || !start) {
-        return 0;
-    }
-    if (width <= 0) {
-        width = 1;
+    uint32_t epoch = ui_text_engine_font_epoch();
+    if (text->lines_valid && text->lines_wrap == wrap_width && text->lines_epoch == epoch) {
+        return true;
     }
+    text->line_count = 0;
+    text->lines_valid = false;
+    const char *start = text->value ? text->value : "";
+    size_t total_len = strlen(start);
+    size_t max_lines = text->max_lines > 0 ? (size_t)text->max_lines : SIZE_MAX;
     size_t cursor = 0;
-    int lines = 0;
-    while (cursor < total_len && lines < max_lines) {
-        size_t newline_pos = cursor;
-        size_t end = newline_pos;
-        if (!text->no_wrap) {
-            end = ui_text_line_break(text, start, total_len, cursor, width, &newline_pos);
-        } else {
-            while (end < total_len && start[end] != '\n') {
-                ++end;
-            }
-        }
-        size_t line_len = end - cursor;
-        if (line_len == 0 && start[cursor] == '\n') {
-            ++lines;
-            cursor = end + 1;
-            continue;
+    while (cursor < total_len && text->line_count < max_lines) {
+        size_t next = total_len;
+        size_t end = ui_text_next_line(text, start, total_len, cursor, wrap_width, &next);
+        ui_text_line_t line = {.start = cursor, .length = end - cursor};
+        line.width = ui_text_engine_measure(text->font, start + cursor, line.length);
+        line.keep = line.length;
+        line.keep_width = line.width;
+        if (line.width > wrap_width && text->overflow == UI_TEXT_OVERFLOW_ELLIPSIS) {
+            line.keep = ui_text_engine_ellipsis_keep(text->font, start + cursor, line.length,
+                                                     wrap_width);
+            line.keep_width = ui_text_engine_measure(text->font, start + cursor, line.keep);
+            line.width = line.keep_width +
+                         ui_text_engine_measure(text->font, UI_TEXT_ENGINE_ELLIPSIS,
+                                                sizeof(UI_TEXT_ENGINE_ELLIPSIS) - 1);
         }
-        ++lines;
-        if (!text->no_wrap && end < total_len && start[end] == '\n') {
-            cursor = end + 1;
-        } else {
-            cursor = end;
+        if (!ui_text_push_line(text, &line)) {
+            text->line_count = 0;
+            return false;
         }
+        cursor = next;
         if (text->no_wrap) {
             break;
         }
     }
-    return lines;
+    text->lines_wrap = wrap_width;
+    text->lines_epoch = epoch;
+    text->lines_valid = true;
+    return true;
 }
 
-static void ui_text_draw_line(ui_context_t *ctx, const ui_text_t *text, const char *line,
-                              size_t len, int x, int y)
+static void ui_text_draw_line(ui_context_t *ctx, const ui_text_t *text,
+                              const ui_text_line_t *line, int x, int y)
 {
-    char *buffer = malloc(len + 1);
-    if (!buffer) {
-        return;
+    const char *start = text->value + line->start;
+    ui_context_draw_text_len(ctx, x, y, start, line->keep, text->color);
+    if (line->keep < line->length) {
+        ui_context_draw_text(ctx, x + line->keep_width, y, UI_TEXT_ENGINE_ELLIPSIS,
+                             text->color);
     }
-    memcpy(buffer, line, len);
-    buffer[len] = '\0';
-    const bareui_font_t *font = text->font ? text->font : bareui_font_default();
-    const bareui_font_t *prev = ui_context_font(ctx);
-    ui_context_set_font(ctx, font);
-    ui_context_draw_text(ctx, x, y, buffer, text->color);
-    ui_context_set_font(ctx, prev);
-    free(buffer);
 }
 
 static bool ui_text_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect_t *bounds)
@@ -225,82 +159,99 @@ static bool ui_text_render(ui_context_t *ctx, ui_widget_t *widget, const ui_rect
     if (!text->value || *text->value == '\0') {
         return true;
     }
-    const char *start = text->value;
-    size_t total_len = strlen(start);
-    size_t cursor = 0;
-    int drawn = 0;
+    if (!ui_text_layout_lines(text, bounds->width > 0 ? bounds->width : 1)) {
+        return true;
+    }
     int line_height = (text->font ? text->font->height : BAREUI_FONT_HEIGHT) + text->line_spacing;
-    int max_lines = text->max_lines > 0 ? text->max_lines : INT_MAX;
-    int line_count = ui_text_count_lines(text, start, total_len, max_lines, bounds->width);
-    int content_height = line_count * line_height;
+    int content_height = (int)text->line_count * line_height;
     int vertical_offset = 0;
     if (content_height < bounds->height) {
         vertical_offset = (bounds->height - content_height) / 2;
     }
-    while (cursor < total_len && drawn < max_lines) {
-        size_t newline_pos = cursor;
-        size_t end = newline_pos;
-        if (!text->no_wrap) {
-            end = ui_text_line_break(text, start, total_len, cursor, bounds->width, &newline_pos);
-        } else {
-            while (end < total_len && start[end] != '\n') {
-                ++end;
-            }
-        }
-        size_t line_len = end - cursor;
-        if (line_len == 0 && start[cursor] == '\n') {
-            cursor = end + 1;
-            ++drawn;
+    const bareui_font_t *font = text->font ? text->font : bareui_font_default();
+    const bareui_font_t *prev = ui_context_font(ctx);
+    ui_context_set_font(ctx, font);
+    ui_context_set_text_background(ctx, text->background_color);
+    for (size_t i = 0; i < text->line_count; ++i) {
+        const ui_text_line_t *line = &text->lines[i];
+        if (line->length == 0) {
             continue;
         }
-        int line_width = ui_text_measure_line(text, start + cursor, line_len);
         int x_point = bounds->x;
         if (text->align == UI_TEXT_ALIGN_CENTER) {
-            x_point = bounds->x + (bounds->width - line_width) / 2;
+            x_point = bounds->x + (bounds->width - line->width) / 2;
         } else if (text->align == UI_TEXT_ALIGN_RIGHT) {
-            x_point = bounds->x + bounds->width - line_width;
+            x_point = bounds->x + bounds->width - line->width;
         }
         if (text->rtl) {
-            x_point = bounds->x + bounds->width - (x_point - bounds->x) - line_width;
-        }
-        int y_point = bounds->y + vertical_offset + drawn * line_height;
-        if (line_width > bounds->width && text->overflow == UI_TEXT_OVERFLOW_FADE) {
-            /* fade effect not implemented yet; fallback to clip */
-        }
-        ui_text_draw_line(ctx, text, start + cursor, line_len, x_point, y_point);
-        ++drawn;
-        if (!text->no_wrap && end < total_len && start[end] == '\n') {
-            cursor = end + 1;
-        } else {
-            cursor = end;
-        }
-        if (text->no_wrap) {
-            break;
+            x_point = bounds->x + bounds->width - (x_point - bounds->x) - line->width;
         }
+        /* UI_TEXT_OVERFLOW_FADE is not implemented yet and clips */
+        int y_point = bounds->y + vertical_offset + (int)i * line_height;
+        ui_text_draw_line(ctx, text, line, x_point, y_point);
     }
+    ui_context_clear_text_background(ctx);
+    ui_context_set_font(ctx, prev);
     return true;
 }
 
+static void ui_text_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                            int *height)
+{
+    (void)max_height;
+    ui_text_t *text = (ui_text_t *)widget;
+    int line_height = (text->font ? text->font->height : BAREUI_FONT_HEIGHT) + text->line_spacing;
+    if (!text->value || *text->value == '\0' ||
+        !ui_text_layout_lines(text, max_width > 0 ? max_width : INT_MAX)) {
+        *width = 0;
+        *height = line_height;
+        return;
+    }
+    int widest = 0;
+    for (size_t i = 0; i < text->line_count; ++i) {
+        /* an ellipsized line was wider than max_width, the clamp below */
+        int line_width =
+            text->lines[i].keep < text->lines[i].length ? max_width : text->lines[i].width;
+        if (line_width > widest) {
+            widest = line_width;
+        }
+    }
+    if (max_width > 0 && widest > max_width) {
+        widest = max_width;
+    }
+    *width = widest;
+    *height = (int)text->line_count * line_height;
+}
+
 static const ui_widget_ops_t ui_text_ops = {
+    .name = "text",
     .render = ui_text_render,
     .handle_event = NULL,
     .destroy = NULL,
-    .style_changed = ui_text_apply_style
+    .style_changed = ui_text_apply_style,
+    .measure = ui_text_measure
 };
 
 static void ui_text_set_value_internal(ui_text_t *text, const char *value)
 {
-    free(text->value);
-    text->value = ui_text_strdup(value);
+    ui_arena_free(text->base.arena, text->value);
+    text->value = ui_arena_strdup(text->base.arena, value);
+    ui_text_forget_lines(text);
 }
 
 ui_text_t *ui_text_create(void)
 {
-    ui_text_t *text = calloc(1, sizeof(*text));
+    return ui_text_create_in(NULL);
+}
+
+ui_text_t *ui_text_create_in(ui_arena_t *arena)
+{
+    ui_text_t *text = ui_arena_alloc(arena, sizeof(*text));
     if (!text) {
         return NULL;
     }
     ui_text_init(text);
+    ui_widget_set_arena(&text->base, arena);
     return text;
 }
 
@@ -309,8 +260,10 @@ void ui_text_destroy(ui_text_t *text)
     if (!text) {
         return;
     }
-    free(text->value);
-    free(text);
+    ui_arena_free(text->base.arena, text->value);
+    ui_arena_free(text->base.arena, text->lines);
+    ui_widget_deinit(&text->base);
+    ui_arena_free(text->base.arena, text);
 }
 
 void ui_text_init(ui_text_t *text)
@@ -330,6 +283,12 @@ void ui_text_init(ui_text_t *text)
     text->italic = false;
     text->max_lines = 0;
     text->line_spacing = 0;
+    text->lines = NULL;
+    text->line_count = 0;
+    text->line_capacity = 0;
+    text->lines_wrap = 0;
+    text->lines_epoch = 0;
+    text->lines_valid = false;
     ui_style_t default_style;
     ui_style_init(&default_style);
     default_style.foreground_color = text->color;
@@ -345,6 +304,7 @@ void ui_text_set_value(ui_text_t *text, const char *value)
         return;
     }
     ui_text_set_value_internal(text, value);
+    ui_widget_invalidate_measure(&text->base);
 }
 
 const char *ui_text_value(const ui_text_t *text)
@@ -357,12 +317,10 @@ void ui_text_set_color(ui_text_t *text, ui_color_t color)
     if (!text) {
         return;
     }
-    ui_style_t *style = &text->base.style;
-    style->foreground_color = color;
-    style->flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
-    if (text->base.ops && text->base.ops->style_changed) {
-        text->base.ops->style_changed(&text->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&text->base);
+    style.foreground_color = color;
+    style.flags |= UI_STYLE_FLAG_FOREGROUND_COLOR;
+    ui_widget_set_style(&text->base, &style);
 }
 
 void ui_text_set_background_color(ui_text_t *text, ui_color_t color)
@@ -370,18 +328,18 @@ void ui_text_set_background_color(ui_text_t *text, ui_color_t color)
     if (!text) {
         return;
     }
-    ui_style_t *style = &text->base.style;
-    style->background_color = color;
-    style->flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
-    if (text->base.ops && text->base.ops->style_changed) {
-        text->base.ops->style_changed(&text->base, style);
-    }
+    ui_style_t style = *ui_widget_style(&text->base);
+    style.background_color = color;
+    style.flags |= UI_STYLE_FLAG_BACKGROUND_COLOR;
+    ui_widget_set_style(&text->base, &style);
 }
 
 void ui_text_set_font(ui_text_t *text, const bareui_font_t *font)
 {
     if (text) {
         text->font = font ? font : bareui_font_default();
+        ui_text_forget_lines(text);
+        ui_widget_invalidate_measure(&text->base);
     }
 }
 
@@ -394,6 +352,7 @@ void ui_text_set_align(ui_text_t *text, ui_text_align_t align)
 {
     if (text) {
         text->align = align;
+        ui_widget_invalidate(&text->base);
     }
 }
 
@@ -406,6 +365,8 @@ void ui_text_set_overflow(ui_text_t *text, ui_text_overflow_t overflow)
 {
     if (text) {
         text->overflow = overflow;
+        ui_text_forget_lines(text);
+        ui_widget_invalidate(&text->base);
     }
 }
 
@@ -418,6 +379,8 @@ void ui_text_set_no_wrap(ui_text_t *text, bool no_wrap)
 {
     if (text) {
         text->no_wrap = no_wrap;
+        ui_text_forget_lines(text);
+        ui_widget_invalidate_measure(&text->base);
     }
 }
 
@@ -430,6 +393,8 @@ void ui_text_set_max_lines(ui_text_t *text, int max_lines)
 {
     if (text) {
         text->max_lines = max_lines;
+        ui_text_forget_lines(text);
+        ui_widget_invalidate_measure(&text->base);
     }
 }
 
@@ -442,6 +407,7 @@ void ui_text_set_line_spacing(ui_text_t *text, int spacing)
 {
     if (text && spacing >= 0) {
         text->line_spacing = spacing;
+        ui_widget_invalidate_measure(&text->base);
     }
 }
 
@@ -454,6 +420,7 @@ void ui_text_set_rtl(ui_text_t *text, bool rtl)
 {
     if (text) {
         text->rtl = rtl;
+        ui_widget_invalidate(&text->base);
     }
 }
 
@@ -466,6 +433,7 @@ void ui_text_set_italic(ui_text_t *text, bool italic)
 {
     if (text) {
         text->italic = italic;
+        ui_widget_invalidate(&text->base);
     }
 }
 
@@ -0,0 +1,381 @@
+#include "ui_text_engine.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define UI_TEXT_ENGINE_FONT_SLOTS 4
+#define UI_TEXT_ENGINE_MEMO_SIZE 64
+#define UI_TEXT_ENGINE_ASCII 128
+#define UI_TEXT_ENGINE_UNKNOWN (-1)
+
+typedef struct {
+    const bareui_font_t *font;
+    uint32_t stamp;
+    int16_t ascii[UI_TEXT_ENGINE_ASCII];
+} ui_text_engine_font_slot_t;
+
+typedef struct {
+    const bareui_font_t *font;
+    uint64_t hash;
+    size_t len;
+    int width;
+} ui_text_engine_memo_t;
+
+static pthread_mutex_t ui_text_engine_lock = PTHREAD_MUTEX_INITIALIZER;
+static ui_text_engine_font_slot_t ui_text_engine_fonts[UI_TEXT_ENGINE_FONT_SLOTS];
+static ui_text_engine_memo_t ui_text_engine_memo[UI_TEXT_ENGINE_MEMO_SIZE];
+static uint32_t ui_text_engine_clock;
+static uint32_t ui_text_engine_epoch;
+
+size_t ui_utf8_decode(const char *text, size_t len, uint32_t *out)
+{
+    if (!text || len == 0) {
+        return 0;
+    }
+    const unsigned char *ptr = (const unsigned char *)text;
+    uint32_t cp = ptr[0];
+    size_t adv = 1;
+    if (cp < 0x80) {
+        if (out) {
+            *out = cp;
+        }
+        return 1;
+    }
+    if ((cp & 0xE0) == 0xC0) {
+        cp &= 0x1F;
+        adv = 2;
+    } else if ((cp & 0xF0) == 0xE0) {
+        cp &= 0x0F;
+        adv = 3;
+    } else if ((cp & 0xF8) == 0xF0) {
+        cp &= 0x07;
+        adv = 4;
+    } else {
+        return 0;
+    }
+    if (adv > len) {
+        return 0;
+    }
+    for (size_t i = 1; i < adv; ++i) {
+        if ((ptr[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (ptr[i] & 0x3F);
+    }
+    if (out) {
+        *out = cp;
+    }
+    return adv;
+}
+
+bool ui_utf8_next(const char **text, uint32_t *out)
+{
+    if (!text || !*text || **text == '\0') {
+        return false;
+    }
+    /* a NUL inside a sequence fails the continuation check, so 4 is safe */
+    size_t adv = ui_utf8_decode(*text, 4, out);
+    if (adv == 0) {
+        return false;
+    }
+    *text += adv;
+    return true;
+}
+
+static const bareui_font_t *ui_text_engine_font(const bareui_font_t *font)
+{
+    return font ? font : bareui_font_default();
+}
+
+bool ui_text_engine_glyph(const bareui_font_t *font, uint32_t codepoint,
+                          bareui_font_glyph_t *glyph_out)
+{
+    font = ui_text_engine_font(font);
+    if (bareui_font_lookup(font, codepoint, glyph_out)) {
+        return true;
+    }
+    if (codepoint != '?') {
+        return bareui_font_lookup(font, '?', glyph_out);
+    }
+    return false;
+}
+
+static int ui_text_engine_lookup_advance(const bareui_font_t *font, uint32_t codepoint)
+{
+    if (codepoint == '\n') {
+        return 0;
+    }
+    bareui_font_glyph_t glyph;
+    return ui_text_engine_glyph(font, codepoint, &glyph) ? glyph.spacing : 0;
+}
+
+static ui_text_engine_font_slot_t *ui_text_engine_slot_locked(const bareui_font_t *font)
+{
+    ui_text_engine_font_slot_t *victim = &ui_text_engine_fonts[0];
+    for (size_t i = 0; i < UI_TEXT_ENGINE_FONT_SLOTS; ++i) {
+        ui_text_engine_font_slot_t *slot = &ui_text_engine_fonts[i];
+        if (slot->font == font) {
+            slot->stamp = ++ui_text_engine_clock;
+            return slot;
+        }
+        if (slot->stamp < victim->stamp) {
+            victim = slot;
+        }
+    }
+    victim->font = font;
+    victim->stamp = ++ui_text_engine_clock;
+    for (size_t i = 0; i < UI_TEXT_ENGINE_ASCII; ++i) {
+        victim->ascii[i] = UI_TEXT_ENGINE_UNKNOWN;
+    }
+    return victim;
+}
+
+static inline int ui_text_engine_ascii_advance(ui_text_engine_font_slot_t *slot, unsigned char c)
+{
+    if (slot->ascii[c] == UI_TEXT_ENGINE_UNKNOWN) {
+        slot->ascii[c] = (int16_t)ui_text_engine_lookup_advance(slot->font, c);
+    }
+    return slot->ascii[c];
+}
+
+static int ui_text_engine_advance_locked(ui_text_engine_font_slot_t *slot, uint32_t codepoint)
+{
+    if (codepoint < UI_TEXT_ENGINE_ASCII) {
+        return ui_text_engine_ascii_advance(slot, (unsigned char)codepoint);
+    }
+    return ui_text_engine_lookup_advance(slot->font, codepoint);
+}
+
+int ui_text_engine_advance(const bareui_font_t *font, uint32_t codepoint)
+{
+    font = ui_text_engine_font(font);
+    pthread_mutex_lock(&ui_text_engine_lock);
+    int advance = ui_text_engine_advance_locked(ui_text_engine_slot_locked(font), codepoint);
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    return advance;
+}
+
+static int ui_text_engine_measure_locked(ui_text_engine_font_slot_t *slot, const char *text,
+                                         size_t len)
+{
+    const unsigned char *ptr = (const unsigned char *)text;
+    int width = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        /* ASCII runs skip the decoder entirely */
+        while (pos < len && ptr[pos] < 0x80 && ptr[pos] != '\0') {
+            width += ui_text_engine_ascii_advance(slot, ptr[pos]);
+            ++pos;
+        }
+        if (pos >= len || ptr[pos] == '\0') {
+            break;
+        }
+        uint32_t cp;
+        size_t adv = ui_utf8_decode(text + pos, len - pos, &cp);
+        if (adv == 0) {
+            break;
+        }
+        width += ui_text_engine_lookup_advance(slot->font, cp);
+        pos += adv;
+    }
+    return width;
+}
+
+int ui_text_engine_measure(const bareui_font_t *font, const char *text, size_t len)
+{
+    if (!text || len == 0) {
+        return 0;
+    }
+    font = ui_text_engine_font(font);
+    pthread_mutex_lock(&ui_text_engine_lock);
+    int width = ui_text_engine_measure_locked(ui_text_engine_slot_locked(font), text, len);
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    return width;
+}
+
+int ui_text_engine_measure_cached(const bareui_font_t *font, const char *text)
+{
+    if (!text || *text == '\0') {
+        return 0;
+    }
+    font = ui_text_engine_font(font);
+    /* FNV-1a over the content: in-place edits of a buffer change the key */
+    uint64_t hash = 0xcbf29ce484222325ull;
+    size_t len = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p; ++p, ++len) {
+        hash = (hash ^ *p) * 0x100000001b3ull;
+    }
+    hash ^= (uint64_t)(uintptr_t)font;
+
+    pthread_mutex_lock(&ui_text_engine_lock);
+    ui_text_engine_memo_t *memo = &ui_text_engine_memo[hash % UI_TEXT_ENGINE_MEMO_SIZE];
+    if (memo->font == font && memo->hash == hash && memo->len == len) {
+        int width = memo->width;
+        pthread_mutex_unlock(&ui_text_engine_lock);
+        return width;
+    }
+    int width = ui_text_engine_measure_locked(ui_text_engine_slot_locked(font), text, len);
+    memo->font = font;
+    memo->hash = hash;
+    memo->len = len;
+    memo->width = width;
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    return width;
+}
+
+size_t ui_text_engine_line_break(const bareui_font_t *font, const char *text, size_t len,
+                                 int max_width, size_t *next)
+{
+    if (next) {
+        *next = len;
+    }
+    if (!text || len == 0) {
+        return 0;
+    }
+    font = ui_text_engine_font(font);
+    pthread_mutex_lock(&ui_text_engine_lock);
+    ui_text_engine_font_slot_t *slot = ui_text_engine_slot_locked(font);
+    size_t pos = 0;
+    size_t last_space = 0;
+    bool has_space = false;
+    int width = 0;
+    size_t end = len;
+    size_t resume = len;
+    while (pos < len) {
+        if (text[pos] == '\n') {
+            end = pos;
+            resume = pos + 1;
+            break;
+        }
+        uint32_t cp;
+        size_t adv = ui_utf8_decode(text + pos, len - pos, &cp);
+        if (adv == 0) {
+            end = pos;
+            resume = len;
+            break;
+        }
+        width += ui_text_engine_advance_locked(slot, cp);
+        if (max_width > 0 && width > max_width) {
+            if (cp == ' ' && pos > 0) {
+                /* the overflowing space itself is the separator */
+                end = pos;
+                resume = pos + adv;
+            } else if (has_space) {
+                end = last_space;
+                resume = last_space + 1;
+            } else {
+                /* always make progress, even if one glyph overflows */
+                end = pos > 0 ? pos : adv;
+                resume = end;
+            }
+            break;
+        }
+        if (cp == ' ') {
+            last_space = pos;
+            has_space = true;
+        }
+        pos += adv;
+    }
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    if (next) {
+        *next = resume;
+    }
+    return end;
+}
+
+size_t ui_text_engine_ellipsis_keep(const bareui_font_t *font, const char *text, size_t len,
+                                    int max_width)
+{
+    if (!text || len == 0) {
+        return 0;
+    }
+    font = ui_text_engine_font(font);
+    pthread_mutex_lock(&ui_text_engine_lock);
+    ui_text_engine_font_slot_t *slot = ui_text_engine_slot_locked(font);
+    size_t keep = len;
+    if (max_width > 0 && ui_text_engine_measure_locked(slot, text, len) > max_width) {
+        int budget = max_width - ui_text_engine_measure_locked(slot, UI_TEXT_ENGINE_ELLIPSIS,
+                                                               sizeof(UI_TEXT_ENGINE_ELLIPSIS) - 1);
+        int width = 0;
+        size_t pos = 0;
+        while (pos < len) {
+            uint32_t cp;
+            size_t adv = ui_utf8_decode(text + pos, len - pos, &cp);
+            if (adv == 0) {
+                break;
+            }
+            width += ui_text_engine_advance_locked(slot, cp);
+            if (width > budget) {
+                break;
+            }
+            pos += adv;
+        }
+        keep = pos;
+    }
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    return keep;
+}
+
+size_t ui_text_engine_ellipsize(const bareui_font_t *font, const char *text, size_t len,
+                                int max_width, char *out, size_t out_size)
+{
+    if (!out || out_size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    if (!text || len == 0) {
+        return 0;
+    }
+    size_t keep = ui_text_engine_ellipsis_keep(font, text, len, max_width);
+    size_t written = keep < out_size - 1 ? keep : out_size - 1;
+    memcpy(out, text, written);
+    if (keep < len) {
+        size_t suffix = sizeof(UI_TEXT_ENGINE_ELLIPSIS) - 1;
+        if (written + suffix > out_size - 1) {
+            suffix = out_size - 1 - written;
+        }
+        memcpy(out + written, UI_TEXT_ENGINE_ELLIPSIS, suffix);
+        written += suffix;
+    }
+    out[written] = '\0';
+    return written;
+}
+
+void ui_text_engine_forget_font(const bareui_font_t *font)
+{
+    if (!font) {
+        return;
+    }
+    pthread_mutex_lock(&ui_text_engine_lock);
+    for (size_t i = 0; i < UI_TEXT_ENGINE_FONT_SLOTS; ++i) {
+        if (ui_text_engine_fonts[i].font == font) {
+            ui_text_engine_fonts[i].font = NULL;
+            ui_text_engine_fonts[i].stamp = 0;
+        }
+    }
+    for (size_t i = 0; i < UI_TEXT_ENGINE_MEMO_SIZE; ++i) {
+        if (ui_text_engine_memo[i].font == font) {
+            ui_text_engine_memo[i].font = NULL;
+        }
+    }
+    ++ui_text_engine_epoch;
+    pthread_mutex_unlock(&ui_text_engine_lock);
+}
+
+void ui_text_engine_reset(void)
+{
+    pthread_mutex_lock(&ui_text_engine_lock);
+    memset(ui_text_engine_fonts, 0, sizeof(ui_text_engine_fonts));
+    memset(ui_text_engine_memo, 0, sizeof(ui_text_engine_memo));
+    ui_text_engine_clock = 0;
+    ++ui_text_engine_epoch;
+    pthread_mutex_unlock(&ui_text_engine_lock);
+}
+
+uint32_t ui_text_engine_font_epoch(void)
+{
+    pthread_mutex_lock(&ui_text_engine_lock);
+    uint32_t epoch = ui_text_engine_epoch;
+    pthread_mutex_unlock(&ui_text_engine_lock);
+    return epoch;
+}
@@ -2,75 +2,52 @@
 
 #include <string.h>
 
-static bool ui_style_find_prop_idx(const ui_style_t *style, const char *key, size_t *out)
-{
-    if (!style || !key) {
-        return false;
-    }
-    for (size_t i = 0; i < style->custom_count; ++i) {
-        if (style->custom_props[i].name &&
-            strcmp(style->custom_props[i].name, key) == 0) {
-            if (out) {
-                *out = i;
-            }
-            return true;
-        }
-    }
-    return false;
-}
+#include "ui_animation.h"
+#include "ui_profile.h"
+#include "ui_text_engine.h"
+
+static uint32_t ui_widget_tree_changes;
 
-void ui_style_init(ui_style_t *style)
+static bool ui_widget_sized(const ui_widget_t *widget)
 {
-    if (!style) {
-        return;
-    }
-    memset(style, 0, sizeof(*style));
-    style->border_width = 0;
-    style->border_sides = UI_BORDER_LEFT | UI_BORDER_TOP;
-    style->border_color = 0;
-    style->box_shadow.enabled = false;
-    style->custom_count = 0;
-    style->flags = 0;
+    return widget->bounds.width > 0 && widget->bounds.height > 0;
 }
 
-void ui_style_copy(ui_style_t *dst, const ui_style_t *src)
+ui_widget_host_t *ui_widget_host(const ui_widget_t *widget)
 {
-    if (!dst || !src) {
-        return;
+    if (!widget) {
+        return NULL;
+    }
+    while (widget->parent) {
+        widget = widget->parent;
     }
-    memcpy(dst, src, sizeof(*dst));
+    return widget->host;
 }
 
-bool ui_style_set_custom_prop(ui_style_t *style, const char *key, uint32_t value)
+static void ui_widget_damage_rect(const ui_widget_t *widget, const ui_rect_t *rect)
 {
-    if (!style || !key) {
-        return false;
-    }
-    size_t idx;
-    if (ui_style_find_prop_idx(style, key, &idx)) {
-        style->custom_props[idx].value = value;
-        return true;
-    }
-    if (style->custom_count >= UI_STYLE_MAX_CUSTOM_PROPS) {
-        return false;
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (host) {
+        ui_damage_add(&host->damage, rect);
     }
-    style->custom_props[style->custom_count].name = key;
-    style->custom_props[style->custom_count].value = value;
-    style->custom_count++;
-    return true;
 }
 
-bool ui_style_get_custom_prop(const ui_style_t *style, const char *key, uint32_t *out)
+/* Unsized groups repaint through their nearest sized ancestor. */
+static void ui_widget_damage_area(const ui_widget_t *widget)
 {
-    if (!style || !key || !out) {
-        return false;
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (!host) {
+        return;
     }
-    size_t idx;
-    if (!ui_style_find_prop_idx(style, key, &idx)) {
-        return false;
+    const ui_widget_t *target = widget;
+    while (target && !ui_widget_sized(target)) {
+        target = target->parent;
+    }
+    if (target) {
+        ui_damage_add(&host->damage, &target->bounds);
+    } else if (widget->parent) {
+        ui_damage_add_all(&host->damage);
     }
-    *out = style->custom_props[idx].value;
-    return true;
 }
 
 void ui_widget_init(ui_widget_t *widget, const ui_widget_ops_t *ops)
@@ -80,15 +57,65 @@ void ui_widget_init(ui_widget_t *widget, const ui_widget_ops_t *ops)
     }
     widget->parent = NULL;
     widget->first_child = NULL;
+    widget->last_child = NULL;
     widget->next_sibling = NULL;
+    widget->prev_sibling = NULL;
+    widget->child_count = 0;
     widget->ops = ops;
     widget->bounds.x = 0;
     widget->bounds.y = 0;
     widget->bounds.width = 0;
     widget->bounds.height = 0;
     widget->user_data = NULL;
+    widget->arena = NULL;
+    widget->arena_link = (ui_arena_finalizer_t){0};
     widget->visible = true;
-    ui_style_init(&widget->style);
+    widget->needs_layout = true;
+    widget->focusable = false;
+    widget->autofocus = false;
+    widget->expand = false;
+    widget->key = NULL;
+    widget->preferred_width = 0;
+    widget->preferred_height = 0;
+    widget->measure_generation = 1;
+    widget->measure_next = 0;
+    memset(widget->measure_cache, 0, sizeof(widget->measure_cache));
+    widget->style = ui_style_default();
+    widget->tick_next = NULL;
+    widget->tick_scheduled = false;
+    widget->host = NULL;
+}
+
+void ui_widget_deinit(ui_widget_t *widget)
+{
+    if (!widget) {
+        return;
+    }
+    ui_arena_remove_finalizer(widget->arena, &widget->arena_link);
+    ui_widget_cancel_tick(widget);
+    ui_animation_cancel_target(widget);
+    ui_style_release(widget->style);
+    widget->style = ui_style_default();
+}
+
+static void ui_widget_finalize(ui_arena_finalizer_t *node)
+{
+    ui_widget_t *widget =
+        (ui_widget_t *)((unsigned char *)node - offsetof(ui_widget_t, arena_link));
+    if (widget->ops && widget->ops->destroy) {
+        widget->ops->destroy(widget);
+    }
+    ui_widget_deinit(widget);
+}
+
+void ui_widget_set_arena(ui_widget_t *widget, ui_arena_t *arena)
+{
+    if (!widget) {
+        return;
+    }
+    ui_arena_remove_finalizer(widget->arena, &widget->arena_link);
+    widget->arena = arena;
+    ui_arena_add_finalizer(arena, &widget->arena_link, ui_widget_finalize);
 }
 
 void ui_widget_set_bounds(ui_widget_t *widget, int x, int y, int width, int height)
@@ -96,16 +123,35 @@ void ui_widget_set_bounds(ui_widget_t *widget, int x, int y, int width, int heig
     if (!widget) {
         return;
     }
+    width = width > 0 ? width : 0;
+    height = height > 0 ? height : 0;
+    if (widget->preferred_width != width || widget->preferred_height != height) {
+        widget->preferred_width = width;
+        widget->preferred_height = height;
+        ui_widget_invalidate_measure(widget);
+    }
+    if (widget->bounds.x == x && widget->bounds.y == y && widget->bounds.width == width &&
+        widget->bounds.height == height) {
+        return;
+    }
+    if (widget->visible) {
+        ui_widget_damage_rect(widget, &widget->bounds);
+    }
     widget->bounds.x = x;
     widget->bounds.y = y;
-    widget->bounds.width = width > 0 ? width : 0;
-    widget->bounds.height = height > 0 ? height : 0;
+    widget->bounds.width = width;
+    widget->bounds.height = height;
+    ui_widget_invalidate(widget);
+    ui_widget_mark_needs_layout(widget);
 }
 
 void ui_widget_set_visible(ui_widget_t *widget, bool visible)
 {
-    if (widget) {
+    if (widget && widget->visible != visible) {
+        ui_widget_damage_area(widget);
         widget->visible = visible;
+        ++ui_widget_tree_changes;
+        ui_widget_invalidate_measure(widget);
     }
 }
 
@@ -121,34 +167,352 @@ void *ui_widget_user_data(const ui_widget_t *widget)
     return widget ? widget->user_data : NULL;
 }
 
+static void ui_widget_link(ui_widget_t *parent, ui_widget_t *child, ui_widget_t *prev,
+                           ui_widget_t *next)
+{
+    if (child->host) {
+        ui_widget_set_host(child, NULL);
+    }
+    child->parent = parent;
+    child->prev_sibling = prev;
+    child->next_sibling = next;
+    if (prev) {
+        prev->next_sibling = child;
+    } else {
+        parent->first_child = child;
+    }
+    if (next) {
+        next->prev_sibling = child;
+    } else {
+        parent->last_child = child;
+    }
+    ++parent->child_count;
+    child->needs_layout = true;
+    ++ui_widget_tree_changes;
+    ui_widget_invalidate(child);
+    ui_widget_invalidate_measure(parent);
+}
+
 bool ui_widget_add_child(ui_widget_t *parent, ui_widget_t *child)
 {
     if (!parent || !child || parent == child) {
         return false;
     }
     ui_widget_remove_child(child);
-    child->next_sibling = parent->first_child;
-    parent->first_child = child;
-    child->parent = parent;
+    ui_widget_link(parent, child, NULL, parent->first_child);
     return true;
 }
 
+bool ui_widget_append_child(ui_widget_t *parent, ui_widget_t *child)
+{
+    if (!parent || !child || parent == child) {
+        return false;
+    }
+    ui_widget_remove_child(child);
+    ui_widget_link(parent, child, parent->last_child, NULL);
+    return true;
+}
+
+/* Drops the ticks and tweens a subtree keeps in its host before it leaves. */
+static void ui_widget_leave_host(ui_widget_t *widget)
+{
+    ui_widget_cancel_tick(widget);
+    ui_animation_cancel_target(widget);
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_widget_leave_host(child);
+    }
+}
+
+static void ui_widget_detach_from_host(ui_widget_t *widget)
+{
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (host && (host->tick_list || host->tick_running || host->tween_count > 0)) {
+        ui_widget_leave_host(widget);
+    }
+}
+
 void ui_widget_remove_child(ui_widget_t *child)
 {
     if (!child || !child->parent) {
         return;
     }
-
-    ui_widget_t **slot = &child->parent->first_child;
-    while (*slot) {
-        if (*slot == child) {
-            *slot = child->next_sibling;
-            break;
-        }
-        slot = &(*slot)->next_sibling;
+    ui_widget_detach_from_host(child);
+    if (child->visible) {
+        ui_widget_damage_area(child);
+    }
+    ui_widget_t *parent = child->parent;
+    if (child->prev_sibling) {
+        child->prev_sibling->next_sibling = child->next_sibling;
+    } else {
+        parent->first_child = child->next_sibling;
+    }
+    if (child->next_sibling) {
+        child->next_sibling->prev_sibling = child->prev_sibling;
+    } else {
+        parent->last_child = child->prev_sibling;
     }
+    --parent->child_count;
+    ui_widget_invalidate_measure(parent);
+    ++ui_widget_tree_changes;
     child->parent = NULL;
     child->next_sibling = NULL;
+    child->prev_sibling = NULL;
+}
+
+void ui_widget_set_focusable(ui_widget_t *widget, bool focusable)
+{
+    if (widget && widget->focusable != focusable) {
+        widget->focusable = focusable;
+        ++ui_widget_tree_changes;
+    }
+}
+
+void ui_widget_set_autofocus(ui_widget_t *widget, bool autofocus)
+{
+    if (widget && widget->autofocus != autofocus) {
+        widget->autofocus = autofocus;
+        ++ui_widget_tree_changes;
+    }
+}
+
+bool ui_widget_accepts_event(const ui_widget_t *widget, ui_event_type_t type)
+{
+    if (!widget || !widget->ops || !widget->ops->handle_event) {
+        return false;
+    }
+    return widget->ops->event_mask == 0 || (widget->ops->event_mask & UI_EVENT_MASK(type));
+}
+
+void ui_widget_mark_needs_layout(ui_widget_t *widget)
+{
+    for (; widget; widget = widget->parent) {
+        widget->needs_layout = true;
+    }
+}
+
+bool ui_widget_needs_layout(const ui_widget_t *widget)
+{
+    return widget ? widget->needs_layout : false;
+}
+
+void ui_widget_invalidate(ui_widget_t *widget)
+{
+    if (widget && widget->visible) {
+        ui_widget_damage_area(widget);
+    }
+}
+
+void ui_widget_invalidate_all(ui_widget_t *widget)
+{
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (host) {
+        ui_damage_add_all(&host->damage);
+    }
+}
+
+const ui_damage_t *ui_widget_damage(const ui_widget_t *widget)
+{
+    ui_widget_host_t *host = ui_widget_host(widget);
+    return host ? &host->damage : NULL;
+}
+
+void ui_widget_host_init(ui_widget_host_t *host)
+{
+    if (!host) {
+        return;
+    }
+    memset(host, 0, sizeof(*host));
+    /* nothing is on screen before the first frame */
+    ui_damage_add_all(&host->damage);
+}
+
+void ui_widget_host_release(ui_widget_host_t *host)
+{
+    ui_animation_cancel_all(host);
+}
+
+void ui_widget_set_host(ui_widget_t *root, ui_widget_host_t *host)
+{
+    if (!root) {
+        return;
+    }
+    if (root->host != host) {
+        ui_widget_detach_from_host(root);
+    }
+    root->host = host;
+    ui_widget_invalidate_all(root);
+}
+
+static void ui_widget_translate(ui_widget_t *widget, int dx, int dy)
+{
+    widget->bounds.x += dx;
+    widget->bounds.y += dy;
+    /* arrange ops may cache absolute positions */
+    widget->needs_layout = true;
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_widget_translate(child, dx, dy);
+    }
+}
+
+bool ui_widget_scroll_content(ui_widget_t *widget, int dx, int dy)
+{
+    if (!widget || (dx == 0 && dy == 0)) {
+        return false;
+    }
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_widget_translate(child, dx, dy);
+    }
+    ui_widget_mark_needs_layout(widget);
+
+    /* only the part of the viewport that ancestors let through is on screen */
+    ui_rect_t viewport = widget->bounds;
+    bool shown = widget->visible && ui_widget_sized(widget);
+    for (const ui_widget_t *ancestor = widget->parent; ancestor && shown;
+         ancestor = ancestor->parent) {
+        if (!ancestor->visible) {
+            return false;
+        }
+        if (ui_widget_sized(ancestor)) {
+            shown = ui_rect_intersect(&viewport, &ancestor->bounds, &viewport);
+        }
+    }
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (!shown || !host) {
+        ui_widget_invalidate(widget);
+        return false;
+    }
+    return ui_damage_scroll(&host->damage, &viewport, dx, dy);
+}
+
+void ui_widget_invalidate_measure(ui_widget_t *widget)
+{
+    ui_widget_invalidate(widget);
+    for (; widget; widget = widget->parent) {
+        if (++widget->measure_generation == 0) {
+            widget->measure_generation = 1;
+        }
+        widget->needs_layout = true;
+    }
+}
+
+/* A size measured under cached_limit still holds for any tighter limit it fits in. */
+static bool ui_widget_measure_reusable(int limit, int cached_limit, int cached_size)
+{
+    if (limit == cached_limit) {
+        return true;
+    }
+    if (limit <= 0) {
+        return false;
+    }
+    return limit >= cached_size && (cached_limit <= 0 || limit <= cached_limit);
+}
+
+static void ui_widget_measure_intrinsic(ui_widget_t *widget, int max_width, int max_height,
+                                        int *width, int *height)
+{
+    max_width = max_width > 0 ? max_width : 0;
+    max_height = max_height > 0 ? max_height : 0;
+    uint32_t font_epoch = ui_text_engine_font_epoch();
+    for (size_t i = 0; i < UI_WIDGET_MEASURE_CACHE_SIZE; ++i) {
+        const ui_measure_entry_t *entry = &widget->measure_cache[i];
+        if (entry->generation == widget->measure_generation &&
+            entry->font_epoch == font_epoch &&
+            ui_widget_measure_reusable(max_width, entry->max_width, entry->width) &&
+            ui_widget_measure_reusable(max_height, entry->max_height, entry->height)) {
+            *width = entry->width;
+            *height = entry->height;
+            return;
+        }
+    }
+    *width = 0;
+    *height = 0;
+    widget->ops->measure(widget, max_width, max_height, width, height);
+    /* round robin keeps the last two constraints, typically a parent's own
+     * measure and its arrange */
+    ui_measure_entry_t *slot = &widget->measure_cache[widget->measure_next];
+    widget->measure_next = (uint8_t)((widget->measure_next + 1) % UI_WIDGET_MEASURE_CACHE_SIZE);
+    slot->max_width = max_width;
+    slot->max_height = max_height;
+    slot->generation = widget->measure_generation;
+    slot->font_epoch = font_epoch;
+    slot->width = *width;
+    slot->height = *height;
+}
+
+void ui_widget_measure(ui_widget_t *widget, int max_width, int max_height, int *width,
+                       int *height)
+{
+    int measured_width = 0;
+    int measured_height = 0;
+    if (widget) {
+        measured_width = widget->preferred_width;
+        measured_height = widget->preferred_height;
+        if ((measured_width <= 0 || measured_height <= 0) && widget->ops &&
+            widget->ops->measure) {
+            int intrinsic_width = 0;
+            int intrinsic_height = 0;
+            ui_widget_measure_intrinsic(widget,
+                                        measured_width > 0 ? measured_width : max_width,
+                                        measured_height > 0 ? measured_height : max_height,
+                                        &intrinsic_width, &intrinsic_height);
+            if (measured_width <= 0) {
+                measured_width = intrinsic_width;
+            }
+            if (measured_height <= 0) {
+                measured_height = intrinsic_height;
+            }
+        }
+    }
+    if (width) {
+        *width = measured_width;
+    }
+    if (height) {
+        *height = measured_height;
+    }
+}
+
+void ui_widget_place(ui_widget_t *child, int x, int y, int width, int height)
+{
+    if (!child) {
+        return;
+    }
+    width = width > 0 ? width : 0;
+    height = height > 0 ? height : 0;
+    if (child->bounds.x == x && child->bounds.y == y && child->bounds.width == width &&
+        child->bounds.height == height) {
+        return;
+    }
+    if (child->visible) {
+        ui_widget_damage_rect(child, &child->bounds);
+    }
+    child->bounds.x = x;
+    child->bounds.y = y;
+    child->bounds.width = width;
+    child->bounds.height = height;
+    child->needs_layout = true;
+    ui_widget_invalidate(child);
+}
+
+static void ui_widget_layout_internal(ui_widget_t *widget)
+{
+    if (!widget || !widget->needs_layout || !widget->visible) {
+        return;
+    }
+    widget->needs_layout = false;
+    if (widget->ops && widget->ops->arrange) {
+        UI_PROFILE_SPAN(span);
+        UI_PROFILE_BEGIN(span);
+        widget->ops->arrange(widget, &widget->bounds);
+        UI_PROFILE_LAYOUT_END(span, widget);
+    }
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_widget_layout_internal(child);
+    }
+}
+
+void ui_widget_layout_tree(ui_widget_t *root)
+{
+    ui_widget_layout_internal(root);
 }
 
 static void ui_widget_render_tree_internal(ui_widget_t *widget, ui_context_t *ctx)
@@ -156,19 +520,195 @@ static void ui_widget_render_tree_internal(ui_widget_t *widget, ui_context_t *ct
     if (!widget || !ctx || !widget->visible) {
         return;
     }
+    UI_PROFILE_SPAN(span);
+    UI_PROFILE_BEGIN(span);
     ui_context_push_clip(ctx, &widget->bounds);
     if (widget->ops && widget->ops->render) {
         widget->ops->render(ctx, widget, &widget->bounds);
     }
+    UI_PROFILE_RENDER_SELF(span, widget);
     for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
         ui_widget_render_tree_internal(child, ctx);
     }
     ui_context_pop_clip(ctx);
+    UI_PROFILE_RENDER_END(span, widget);
+}
+
+bool ui_widget_schedule_tick(ui_widget_t *widget)
+{
+    if (!widget || !widget->ops || !widget->ops->tick) {
+        return false;
+    }
+    if (widget->tick_scheduled) {
+        return true;
+    }
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (!host) {
+        return false;
+    }
+    widget->tick_scheduled = true;
+    widget->tick_next = host->tick_list;
+    host->tick_list = widget;
+    return true;
+}
+
+static bool ui_widget_tick_unlink(ui_widget_t **list, ui_widget_t *widget)
+{
+    for (; *list; list = &(*list)->tick_next) {
+        if (*list == widget) {
+            *list = widget->tick_next;
+            widget->tick_next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ui_widget_cancel_tick(ui_widget_t *widget)
+{
+    if (!widget || !widget->tick_scheduled) {
+        return;
+    }
+    /* scheduled widgets are always in a hosted tree: leaving it cancels */
+    ui_widget_host_t *host = ui_widget_host(widget);
+    if (host && !ui_widget_tick_unlink(&host->tick_list, widget)) {
+        ui_widget_tick_unlink(&host->tick_running, widget);
+    }
+    widget->tick_scheduled = false;
+}
+
+bool ui_widget_tick_all(ui_widget_host_t *host, double delta_seconds)
+{
+    if (!host) {
+        return false;
+    }
+    /* a tick may cancel (or destroy) widgets still waiting, so they are
+     * popped from a list cancel_tick can reach */
+    host->tick_running = host->tick_list;
+    host->tick_list = NULL;
+    while (host->tick_running) {
+        ui_widget_t *widget = host->tick_running;
+        host->tick_running = widget->tick_next;
+        widget->tick_next = NULL;
+        widget->tick_scheduled = false;
+        if (widget->ops->tick(widget, delta_seconds)) {
+            ui_widget_schedule_tick(widget);
+        }
+    }
+    return host->tick_list != NULL;
+}
+
+bool ui_widget_tick_pending(const ui_widget_host_t *host)
+{
+    return host && host->tick_list != NULL;
+}
+
+const ui_event_t *ui_widget_pointer_history(const ui_widget_t *widget, size_t *count)
+{
+    ui_widget_host_t *host = ui_widget_host(widget);
+    const ui_event_t *history = host ? host->history : NULL;
+    if (count) {
+        *count = history ? host->history_count : 0;
+    }
+    return history;
+}
+
+void ui_widget_set_pointer_history(ui_widget_host_t *host, const ui_event_t *events,
+                                   size_t count)
+{
+    if (!host) {
+        return;
+    }
+    host->history = count > 0 ? events : NULL;
+    host->history_count = host->history ? count : 0;
+}
+
+/* Repaints the part of the tree under the current clip; sized widgets that
+ * miss region cannot draw into it, since children clip to their parents. */
+static void ui_widget_render_region(ui_widget_t *widget, ui_context_t *ctx,
+                                    const ui_rect_t *region)
+{
+    ui_rect_t overlap;
+    if (!widget->visible ||
+        (ui_widget_sized(widget) && !ui_rect_intersect(&widget->bounds, region, &overlap))) {
+        return;
+    }
+    UI_PROFILE_SPAN(span);
+    UI_PROFILE_BEGIN(span);
+    ui_context_push_clip(ctx, &widget->bounds);
+    if (widget->ops && widget->ops->render) {
+        widget->ops->render(ctx, widget, &widget->bounds);
+    }
+    UI_PROFILE_RENDER_SELF(span, widget);
+    for (ui_widget_t *child = widget->first_child; child; child = child->next_sibling) {
+        ui_widget_render_region(child, ctx, region);
+    }
+    ui_context_pop_clip(ctx);
+    UI_PROFILE_RENDER_END(span, widget);
 }
 
+static const ui_rect_t ui_widget_screen = {0, 0, UI_FRAMEBUFFER_WIDTH, UI_FRAMEBUFFER_HEIGHT};
+
 void ui_widget_render_tree(ui_widget_t *root, ui_context_t *ctx)
 {
+    ui_widget_layout_tree(root);
+    ui_context_debug_damage(ctx, &ui_widget_screen, false);
     ui_widget_render_tree_internal(root, ctx);
+    ui_widget_host_t *host = ui_widget_host(root);
+    if (host) {
+        ui_damage_reset(&host->damage);
+        host->font_epoch = ui_text_engine_font_epoch();
+        host->repaint_epoch = ui_context_repaint_epoch(ctx);
+    }
+}
+
+void ui_widget_render_damage(ui_widget_t *root, ui_context_t *ctx)
+{
+    if (!root || !ctx) {
+        return;
+    }
+    ui_widget_host_t *host = ui_widget_host(root);
+    if (!host) {
+        ui_widget_render_tree(root, ctx);
+        return;
+    }
+    ui_widget_layout_tree(root);
+    uint32_t font_epoch = ui_text_engine_font_epoch();
+    uint32_t repaint_epoch = ui_context_repaint_epoch(ctx);
+    if (font_epoch != host->font_epoch || repaint_epoch != host->repaint_epoch) {
+        host->font_epoch = font_epoch;
+        host->repaint_epoch = repaint_epoch;
+        ui_damage_add_all(&host->damage);
+    }
+    /* invalidations from render ops (animations) belong to the next frame */
+    ui_damage_t damage = host->damage;
+    ui_damage_reset(&host->damage);
+    if (damage.full) {
+        ui_context_debug_damage(ctx, &ui_widget_screen, false);
+        ui_widget_render_tree_internal(root, ctx);
+        return;
+    }
+    for (size_t i = 0; i < damage.scroll_count; ++i) {
+        const ui_damage_scroll_t *scroll = &damage.scrolls[i];
+        ui_context_scroll_rect(ctx, &scroll->rect, scroll->dx, scroll->dy);
+        ui_context_debug_damage(ctx, &scroll->rect, true);
+    }
+    for (size_t i = 0; i < damage.count; ++i) {
+        ui_context_debug_damage(ctx, &damage.rects[i], false);
+        ui_context_push_clip(ctx, &damage.rects[i]);
+        ui_widget_render_region(root, ctx, &damage.rects[i]);
+        ui_context_pop_clip(ctx);
+    }
+}
+
+/* Runs the handler; widgets repaint after input unless they report damage themselves. */
+static bool ui_widget_call_handler(ui_widget_t *widget, const ui_event_t *event)
+{
+    bool handled = widget->ops->handle_event(widget, event);
+    if (!widget->ops->manages_damage) {
+        ui_widget_invalidate(widget);
+    }
+    return handled;
 }
 
 bool ui_widget_dispatch_event(ui_widget_t *root, const ui_event_t *event)
@@ -181,12 +721,82 @@ bool ui_widget_dispatch_event(ui_widget_t *root, const ui_event_t *event)
             return true;
         }
     }
-    if (root->ops && root->ops->handle_event) {
-        return root->ops->handle_event(root, event);
+    if (ui_widget_accepts_event(root, event->type)) {
+        return ui_widget_call_handler(root, event);
     }
     return false;
 }
 
+/* Empty bounds do not prune: unsized groups still pass events to their children. */
+static bool ui_widget_may_contain(const ui_widget_t *widget, int x, int y)
+{
+    const ui_rect_t *rect = &widget->bounds;
+    if (rect->width <= 0 || rect->height <= 0) {
+        return true;
+    }
+    return x >= rect->x && x < rect->x + rect->width && y >= rect->y && y < rect->y + rect->height;
+}
+
+ui_widget_t *ui_widget_hit_test(ui_widget_t *root, int x, int y)
+{
+    if (!root || !root->visible || !ui_widget_may_contain(root, x, y)) {
+        return NULL;
+    }
+    for (ui_widget_t *child = root->first_child; child; child = child->next_sibling) {
+        ui_widget_t *hit = ui_widget_hit_test(child, x, y);
+        if (hit) {
+            return hit;
+        }
+    }
+    return root->bounds.width > 0 && root->bounds.height > 0 ? root : NULL;
+}
+
+ui_widget_t *ui_widget_dispatch_at(ui_widget_t *root, const ui_event_t *event, int x, int y)
+{
+    if (!root || !event || !root->visible || !ui_widget_may_contain(root, x, y)) {
+        return NULL;
+    }
+    for (ui_widget_t *child = root->first_child; child; child = child->next_sibling) {
+        ui_widget_t *handled = ui_widget_dispatch_at(child, event, x, y);
+        if (handled) {
+            return handled;
+        }
+    }
+    if (ui_widget_accepts_event(root, event->type) && ui_widget_call_handler(root, event)) {
+        return root;
+    }
+    return NULL;
+}
+
+bool ui_widget_send_event(ui_widget_t *widget, const ui_event_t *event)
+{
+    if (!widget || !event || !widget->visible || !ui_widget_accepts_event(widget, event->type)) {
+        return false;
+    }
+    return ui_widget_call_handler(widget, event);
+}
+
+bool ui_widget_tree_contains(const ui_widget_t *root, const ui_widget_t *widget)
+{
+    if (!root || !widget) {
+        return false;
+    }
+    if (root == widget) {
+        return true;
+    }
+    for (const ui_widget_t *child = root->first_child; child; child = child->next_sibling) {
+        if (ui_widget_tree_contains(child, widget)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ui_widget_tree_epoch(void)
+{
+    return ui_widget_tree_changes;
+}
+
 void ui_widget_destroy_tree(ui_widget_t *root)
 {
     if (!root) {
@@ -201,25 +811,55 @@ void ui_widget_destroy_tree(ui_widget_t *root)
     if (root->ops && root->ops->destroy) {
         root->ops->destroy(root);
     }
+    ui_widget_deinit(root);
     ui_widget_remove_child(root);
 }
 
-void ui_widget_set_style(ui_widget_t *widget, const ui_style_t *style)
+/* Paddings, margins and borders change sizes; colors only repaint. */
+static bool ui_style_same_geometry(const ui_style_t *a, const ui_style_t *b)
+{
+    return a->padding_left == b->padding_left && a->padding_right == b->padding_right &&
+           a->padding_top == b->padding_top && a->padding_bottom == b->padding_bottom &&
+           a->margin_left == b->margin_left && a->margin_right == b->margin_right &&
+           a->margin_top == b->margin_top && a->margin_bottom == b->margin_bottom &&
+           a->border_width == b->border_width && a->border_sides == b->border_sides &&
+           a->custom_count == b->custom_count &&
+           memcmp(a->custom_props, b->custom_props, a->custom_count * sizeof(a->custom_props[0])) == 0;
+}
+
+void ui_widget_set_shared_style(ui_widget_t *widget, const ui_style_t *shared)
 {
     if (!widget) {
         return;
     }
-    if (style) {
-        ui_style_copy(&widget->style, style);
-    } else {
-        ui_style_init(&widget->style);
+    const ui_style_t *previous = widget->style;
+    widget->style = shared ? ui_style_retain(shared) : ui_style_default();
+    if (widget->style != previous) {
+        ui_widget_invalidate(widget);
     }
     if (widget->ops && widget->ops->style_changed) {
-        widget->ops->style_changed(widget, &widget->style);
+        widget->ops->style_changed(widget, widget->style);
+    }
+    if (!ui_style_same_geometry(previous, widget->style)) {
+        ui_widget_invalidate_measure(widget);
+    }
+    ui_style_release(previous);
+}
+
+void ui_widget_set_style(ui_widget_t *widget, const ui_style_t *style)
+{
+    if (!widget) {
+        return;
+    }
+    const ui_style_t *shared = ui_style_intern(style);
+    if (!shared) {
+        return;
     }
+    ui_widget_set_shared_style(widget, shared);
+    ui_style_release(shared);
 }
 
 const ui_style_t *ui_widget_style(const ui_widget_t *widget)
 {
-    return widget ? &widget->style : NULL;
+    return widget ? widget->style : NULL;
 }
@@ -0,0 +1,65 @@
+#include "ui_hal_headless.h"
+
+#include <stdio.h>
+
+/*
+ * golden_compare <golden.ppm> <actual.ppm> [diff.ppm]
+ * Exits 0 when the two frames match pixel for pixel. Otherwise reports how
+ * many pixels differ and where, and writes diff.ppm: the actual frame dimmed,
+ * with every differing pixel in red.
+ */
+
+static ui_color_t golden_frame[UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT];
+static ui_color_t actual_frame[UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT];
+static ui_color_t diff_frame[UI_FRAMEBUFFER_WIDTH * UI_FRAMEBUFFER_HEIGHT];
+
+static ui_color_t golden_dim(ui_color_t pixel)
+{
+    return (ui_color_t)((pixel >> 1) & 0x7BEF);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s golden.ppm actual.ppm [diff.ppm]\n", argv[0]);
+        return 2;
+    }
+    if (!ui_hal_headless_read_ppm(argv[1], golden_frame)) {
+        fprintf(stderr, "golden: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    if (!ui_hal_headless_read_ppm(argv[2], actual_frame)) {
+        fprintf(stderr, "golden: cannot read %s\n", argv[2]);
+        return 1;
+    }
+    size_t differing = 0;
+    int min_x = UI_FRAMEBUFFER_WIDTH;
+    int min_y = UI_FRAMEBUFFER_HEIGHT;
+    int max_x = -1;
+    int max_y = -1;
+    for (int y = 0; y < UI_FRAMEBUFFER_HEIGHT; ++y) {
+        for (int x = 0; x < UI_FRAMEBUFFER_WIDTH; ++x) {
+            size_t index = (size_t)y * UI_FRAMEBUFFER_WIDTH + x;
+            if (golden_frame[index] == actual_frame[index]) {
+                diff_frame[index] = golden_dim(actual_frame[index]);
+                continue;
+            }
+            diff_frame[index] = ui_color_rgb(255, 0, 0);
+            ++differing;
+            min_x = x < min_x ? x : min_x;
+            min_y = y < min_y ? y : min_y;
+            max_x = x > max_x ? x : max_x;
+            max_y = y > max_y ? y : max_y;
+        }
+    }
+    if (differing == 0) {
+        printf("golden: %s matches\n", argv[1]);
+        return 0;
+    }
+    printf("golden: %s differs in %zu pixels within (%d,%d)-(%d,%d)\n", argv[1], differing,
+           min_x, min_y, max_x, max_y);
+    if (argc > 3 && !ui_hal_headless_write_ppm(argv[3], diff_frame)) {
+        fprintf(stderr, "golden: cannot write %s\n", argv[3]);
+    }
+    return 1;
+}
@@ -1,5 +1,6 @@
 #include "ui_button.h"
 #include "ui_column.h"
+#include "ui_font_packed.h"
 #include "ui_row.h"
 #include "ui_scene.h"
 #include "ui_text.h"
@@ -27,6 +28,10 @@ typedef struct {
     const char *label;
 } calculator_button_ctx_t;
 
+static const uint32_t CALCULATOR_DISPLAY_GLYPHS[] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', '-', '+', 'e', 'E', 'R'
+};
+
 typedef struct {
     uint32_t seashell;
     uint32_t champagne;
@@ -385,7 +390,7 @@ static void calculator_style_keypad_row(ui_row_t *row, ui_color_t background)
 
 int main(void)
 {
-    const ui_hal_ops_t *hal = ui_hal_test_sdl_ops();
+    const ui_hal_ops_t *hal = ui_hal_test_ops();
     if (!hal) {
         return 1;
     }
@@ -395,7 +400,8 @@ int main(void)
         return 1;
     }
 
-    ui_column_t *root = ui_column_create();
+    ui_arena_t *arena = ui_scene_arena(scene);
+    ui_column_t *root = ui_column_create_in(arena);
     if (!root) {
         ui_scene_destroy(scene);
         return 1;
@@ -430,14 +436,14 @@ int main(void)
     const int content_width = UI_FRAMEBUFFER_WIDTH - 32;
     const int button_spacing = 4;
 
-    ui_text_t *headline = ui_text_create();
+    ui_text_t *headline = ui_text_create_in(arena);
     ui_text_set_value(headline, "Classic Noir Calculator");
     ui_text_set_align(headline, UI_TEXT_ALIGN_CENTER);
     ui_text_set_color(headline, palette.redwood);
     ui_text_set_background_color(headline, palette.champagne);
     ui_widget_set_bounds(ui_text_widget_mutable(headline), 0, 0, content_width, headline_height);
 
-    ui_text_t *display = ui_text_create();
+    ui_text_t *display = ui_text_create_in(arena);
     ui_text_set_align(display, UI_TEXT_ALIGN_RIGHT);
     ui_text_set_no_wrap(display, true);
     ui_text_set_max_lines(display, 1);
@@ -445,11 +451,16 @@ int main(void)
     ui_text_set_color(display, palette.dark_text);
     ui_widget_set_bounds(ui_text_widget_mutable(display), 0, 0, content_width, display_height);
 
+    bareui_font_packed_t *display_font = bareui_font_packed_create_scaled(
+        bareui_font_default(), CALCULATOR_DISPLAY_GLYPHS,
+        sizeof(CALCULATOR_DISPLAY_GLYPHS) / sizeof(CALCULATOR_DISPLAY_GLYPHS[0]), 2);
+    if (display && display_font) {
+        ui_text_set_font(display, &display_font->base);
+    }
+
     if (!headline || !display) {
-        ui_text_destroy(display);
-        ui_text_destroy(headline);
-        ui_column_destroy(root);
         ui_scene_destroy(scene);
+        bareui_font_packed_destroy(display_font);
         return 1;
     }
 
@@ -478,8 +489,6 @@ int main(void)
 
     static const char *bottom_row[BOTTOM_BUTTONS] = {"0", ".", "="};
 
-    ui_row_t *rows[KEYPAD_ROWS] = {0};
-    ui_button_t *buttons[TOTAL_BUTTON_COUNT] = {0};
     calculator_button_ctx_t button_contexts[TOTAL_BUTTON_COUNT] = {0};
 
     const int total_controls = 2 + KEYPAD_ROWS;
@@ -497,18 +506,16 @@ int main(void)
     int extra_height = available_keypad_height - row_height * KEYPAD_ROWS;
 
     const int button_width = (content_width - button_spacing * (BUTTON_COLUMNS - 1)) / BUTTON_COLUMNS;
-    size_t row_index = 0;
     size_t button_index = 0;
     bool build_success = true;
 
     for (size_t r = 0; r < STANDARD_ROWS; ++r) {
         int current_row_height = row_height;
-        ui_row_t *row = ui_row_create();
+        ui_row_t *row = ui_row_create_in(arena);
         if (!row) {
             build_success = false;
             break;
         }
-        rows[row_index++] = row;
         ui_row_set_spacing(row, button_spacing);
         ui_row_set_run_spacing(row, button_spacing);
         ui_row_set_alignment(row, UI_MAIN_AXIS_CENTER);
@@ -518,12 +525,11 @@ int main(void)
 
         for (size_t c = 0; c < BUTTON_COLUMNS; ++c) {
             const char *label = button_layout[r][c];
-            ui_button_t *button = ui_button_create();
+            ui_button_t *button = ui_button_create_in(arena);
             if (!button) {
                 build_success = false;
                 break;
             }
-            buttons[button_index] = button;
             button_contexts[button_index].state = &calculator;
             button_contexts[button_index].label = label;
 
@@ -554,11 +560,10 @@ int main(void)
     }
 
     if (build_success) {
-        ui_row_t *final_row = ui_row_create();
+        ui_row_t *final_row = ui_row_create_in(arena);
         if (!final_row) {
             build_success = false;
         } else {
-            rows[row_index++] = final_row;
             ui_row_set_spacing(final_row, button_spacing);
             ui_row_set_run_spacing(final_row, button_spacing);
             ui_row_set_alignment(final_row, UI_MAIN_AXIS_CENTER);
@@ -571,12 +576,11 @@ int main(void)
 
             for (size_t c = 0; c < BOTTOM_BUTTONS; ++c) {
                 const char *label = bottom_row[c];
-                ui_button_t *button = ui_button_create();
+                ui_button_t *button = ui_button_create_in(arena);
                 if (!button) {
                     build_success = false;
                     break;
                 }
-                buttons[button_index] = button;
                 button_contexts[button_index].state = &calculator;
                 button_contexts[button_index].label = label;
 
@@ -607,31 +611,16 @@ int main(void)
     }
 
     if (!build_success) {
-        for (size_t i = 0; i < button_index; ++i) {
-            ui_button_destroy(buttons[i]);
-        }
-        for (size_t i = 0; i < row_index; ++i) {
-            ui_row_destroy(rows[i]);
-        }
-        ui_text_destroy(display);
-        ui_text_destroy(headline);
-        ui_column_destroy(root);
         ui_scene_destroy(scene);
+        bareui_font_packed_destroy(display_font);
         return 1;
     }
 
     ui_scene_set_root(scene, ui_column_widget_mutable(root));
     ui_scene_run(scene);
 
-    for (size_t i = 0; i < button_index; ++i) {
-        ui_button_destroy(buttons[i]);
-    }
-    for (size_t i = 0; i < row_index; ++i) {
-        ui_row_destroy(rows[i]);
-    }
-    ui_text_destroy(display);
-    ui_text_destroy(headline);
-    ui_column_destroy(root);
+    /* the widgets live in the scene arena and go away with it */
     ui_scene_destroy(scene);
+    bareui_font_packed_destroy(display_font);
     return 0;
 }
@@ -0,0 +1,105 @@
+"""Compare BareUI benchmark results against a baseline.
+
+Usage: python tools/bench_compare.py BASELINE RESULTS [--tolerance 40]
+       python tools/bench_compare.py --median RESULTS > BASELINE
+
+Both files hold one JSON object per line as written by bench/bench_json.h:
+{"bench", "metric", "value", "unit"}. A metric that appears several times
+(make bench BENCH_RUNS=n) stands for the median of its values. Units ending
+in "/s" are better when higher, all others when lower. Exits 1 when any
+metric is worse than the baseline by more than the tolerance (percent);
+metrics present on one side only are listed but do not fail the run.
+--median prints the medians in the same format, for recording a baseline.
+"""
+
+import argparse
+import json
+import statistics
+import sys
+from pathlib import Path
+
+
+def load(path):
+    """Maps (bench, metric) to (median value, unit), keeping file order."""
+    samples = {}
+    with path.open('r', encoding='utf-8') as handle:
+        for number, line in enumerate(handle, 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                entry = json.loads(line)
+            except json.JSONDecodeError as error:
+                raise SystemExit(f'{path}:{number}: {error}')
+            key = (entry['bench'], entry['metric'])
+            samples.setdefault(key, ([], entry['unit']))[0].append(float(entry['value']))
+    return {key: (statistics.median(values), unit) for key, (values, unit) in samples.items()}
+
+
+def print_medians(path):
+    for (bench, metric), (value, unit) in load(path).items():
+        print(json.dumps({'bench': bench, 'metric': metric,
+                          'value': float(f'{value:.6g}'), 'unit': unit}))
+
+
+def change_percent(old, new, unit):
+    """Signed change where positive means worse."""
+    if old == 0:
+        return 0.0
+    change = (new - old) / old * 100.0
+    return -change if unit.endswith('/s') else change
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('files', type=Path, nargs='+', metavar='BASELINE RESULTS')
+    parser.add_argument('--tolerance', type=float, default=40.0)
+    parser.add_argument('--median', action='store_true',
+                        help='print the medians of a single results file')
+    args = parser.parse_args()
+
+    for path in args.files:
+        if not path.exists():
+            raise SystemExit(f'{path} not found')
+    if args.median:
+        if len(args.files) != 1:
+            parser.error('--median takes one results file')
+        print_medians(args.files[0])
+        return
+    if len(args.files) != 2:
+        parser.error('expected BASELINE and RESULTS')
+    args.baseline, args.results = args.files
+    baseline = load(args.baseline)
+    results = load(args.results)
+
+    regressions = 0
+    for key, (new, unit) in results.items():
+        name = f'{key[0]}: {key[1]}'
+        if key not in baseline:
+            print(f'  new   {name:<48} {new:>12.6g} {unit}')
+            continue
+        old, old_unit = baseline[key]
+        if old_unit != unit:
+            print(f'  unit  {name:<48} {old_unit} -> {unit}')
+            continue
+        change = change_percent(old, new, unit)
+        if change > args.tolerance:
+            status = 'WORSE'
+            regressions += 1
+        elif change < -args.tolerance:
+            status = 'better'
+        else:
+            status = 'ok'
+        print(f'{status:>6}  {name:<48} {old:>12.6g} -> {new:<12.6g} {unit:<9} '
+              f'{(new - old) / old * 100.0 if old else 0.0:+6.1f}%')
+    for key in baseline.keys() - results.keys():
+        print(f'  gone  {key[0]}: {key[1]}')
+
+    if regressions:
+        print(f'{regressions} metrics regressed by more than {args.tolerance:g}%',
+              file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
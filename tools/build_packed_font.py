@@ -0,0 +1,157 @@
+"""Emit a variable-height row-major packed font (include/ui_font_packed.h) as C source.
+
+Usage: python tools/build_packed_font.py SOURCE NAME [--range 0x20-0x7E] [--baseline N]
+       [--label IDENT=TEXT ...] > font.h
+
+SOURCE is a BDF file or a .hex (unifont/unscii) file. Blank columns are
+trimmed into bearing_x and blank rows into bearing_y, so only ink is stored.
+Each --label is pre-shaped against the emitted tables into a static
+ui_shaped_text_t IDENT (include/ui_shaped_text.h), so fixed strings skip
+UTF-8 decoding and glyph lookup at runtime.
+"""
+
+import argparse
+from pathlib import Path
+
+from build_paged_font import parse_bdf, parse_hex, parse_range
+
+BLANK_ADVANCE = 3
+SPACING = 1
+
+
+def trim(width, rows):
+    """Return (left, top, ink_width, ink_height, ink_rows) for a glyph."""
+    mask = 0
+    for value in rows:
+        mask |= value
+    used_rows = [index for index, value in enumerate(rows) if value]
+    if not mask or not used_rows:
+        return 0, 0, 0, 0, []
+    left = 0
+    while not mask & (1 << (width - 1 - left)):
+        left += 1
+    right = width - 1
+    while not mask & (1 << (width - 1 - right)):
+        right -= 1
+    ink_width = right - left + 1
+    top, bottom = used_rows[0], used_rows[-1]
+    shift = width - 1 - right
+    ink_rows = [(rows[index] >> shift) & ((1 << ink_width) - 1) for index in range(top, bottom + 1)]
+    return left, top, ink_width, bottom - top + 1, ink_rows
+
+
+def pack_rows(width, rows):
+    stride = (width + 7) // 8
+    data = []
+    for value in rows:
+        value <<= stride * 8 - width
+        data.extend((value >> (8 * (stride - 1 - i))) & 0xFF for i in range(stride))
+    return data
+
+
+def parse_label(text):
+    ident, sep, value = text.partition('=')
+    if not sep or not ident.isidentifier():
+        raise argparse.ArgumentTypeError(f'expected IDENT=TEXT, got {text!r}')
+    return ident, value
+
+
+def shape_label(ident, value, entries):
+    by_codepoint = {entry[0]: entry for entry in entries}
+    glyphs = []
+    for char in value:
+        codepoint = ord(char)
+        if codepoint == 0x0A:
+            glyphs.append((codepoint, None))
+            continue
+        # runtime lookup would fall back to the built-in table, so refuse to guess
+        if codepoint not in by_codepoint:
+            raise SystemExit(f'label {ident}: U+{codepoint:04X} is not in the font; widen --range')
+        glyphs.append((codepoint, by_codepoint[codepoint]))
+    return glyphs
+
+
+def emit_label(name, height, baseline, ident, glyphs):
+    print()
+    print(f'static const bareui_font_glyph_t {ident}_glyphs[] = {{')
+    total = 0
+    for codepoint, entry in glyphs:
+        if entry is None:
+            print(f'    {{0x{codepoint:04X}, 0, 0, NULL, 0, NULL, 0, NULL, 0, 0}},')
+            continue
+        resolved, width, glyph_height, bearing_x, bearing_y, advance, offset = entry
+        rows = f'{name}_bitmap + {offset}' if width else 'NULL'
+        print(f'    {{0x{resolved:04X}, {width}, {glyph_height}, NULL, {advance}, NULL, 1, {rows}, '
+              f'{bearing_x}, {baseline - bearing_y}}},')
+        total += advance
+    print('};')
+    print(f'static const ui_shaped_text_t {ident} = UI_SHAPED_TEXT_STATIC({ident}_glyphs, '
+          f'{len(glyphs)}, {total}, {height});')
+
+
+def emit(name, height, baseline, entries, bitmap, source, labels):
+    print(f'// Auto-generated by tools/build_packed_font.py from {source}')
+    print('#include "ui_font_packed.h"')
+    if labels:
+        print('#include "ui_shaped_text.h"')
+    print()
+    print(f'static const uint8_t {name}_bitmap[] = {{')
+    for start in range(0, len(bitmap), 16):
+        chunk = ', '.join(f'0x{value:02X}' for value in bitmap[start:start + 16])
+        print(f'    {chunk},')
+    print('};')
+    print()
+    print(f'static const bareui_font_packed_entry_t {name}_glyphs[] = {{')
+    for codepoint, width, glyph_height, bearing_x, bearing_y, advance, offset in entries:
+        print(f'    {{0x{codepoint:04X}, {width}, {glyph_height}, {bearing_x}, {bearing_y}, '
+              f'{advance}, {offset}}},')
+    print('};')
+    print()
+    print(f'#define {name.upper()}_HEIGHT {height}')
+    print(f'#define {name.upper()}_BASELINE {baseline}')
+    print(f'#define {name.upper()}_GLYPH_COUNT (sizeof({name}_glyphs) / sizeof({name}_glyphs[0]))')
+    for ident, value in labels:
+        emit_label(name, height, baseline, ident, shape_label(ident, value, entries))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('source', type=Path)
+    parser.add_argument('name')
+    parser.add_argument('--range', type=parse_range, default=(0x20, 0x7E))
+    parser.add_argument('--baseline', type=int, default=None)
+    parser.add_argument('--label', type=parse_label, action='append', default=[])
+    args = parser.parse_args()
+
+    if not args.source.exists():
+        raise SystemExit(f'Font source {args.source} not found')
+    if args.source.suffix.lower() == '.bdf':
+        glyphs = parse_bdf(args.source)
+    else:
+        glyphs = parse_hex(args.source)
+
+    low, high = args.range
+    selected = sorted(cp for cp in glyphs if low <= cp <= high)
+    if not selected:
+        raise SystemExit('No glyph entries generated')
+    height = max(len(glyphs[cp][1]) for cp in selected)
+    baseline = args.baseline if args.baseline is not None else height - max(1, height // 8)
+
+    entries = []
+    bitmap = []
+    for codepoint in selected:
+        width, rows = glyphs[codepoint]
+        # proportional like the built-in tables: leading blank columns are dropped
+        _, top, ink_width, ink_height, ink_rows = trim(width, rows)
+        if ink_width == 0:
+            entries.append((codepoint, 0, 0, 0, 0, BLANK_ADVANCE, 0))
+            continue
+        entries.append((codepoint, ink_width, ink_height, 0, baseline - top,
+                        ink_width + SPACING, len(bitmap)))
+        bitmap.extend(pack_rows(ink_width, ink_rows))
+
+    emit(args.name, height, baseline, entries, bitmap or [0], args.source.name, args.label)
+
+
+if __name__ == '__main__':
+    main()
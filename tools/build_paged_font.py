@@ -0,0 +1,235 @@
+"""Convert .hex (unifont/unscii) or BDF bitmap fonts into the BareUI paged font container.
+
+Usage: python tools/build_paged_font.py SOURCE OUTPUT [--downsample 2] [--range 0x20-0x10FFFF]
+
+The container layout is documented in include/ui_font_paged.h. Glyphs are
+stored as column bytes (LSB = top row), so sources taller than 8 rows must be
+downsampled, e.g. `--downsample 2` for 16 px unifont.
+"""
+
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = b'BUPF'
+VERSION = 1
+HEADER_SIZE = 20
+DIR_ENTRY_SIZE = 12
+PAGE_SIZE = 256
+MAX_HEIGHT = 8
+MAX_WIDTH = 8
+BLANK_WIDTH = 3
+
+
+def parse_hex(path):
+    glyphs = {}
+    with path.open('r', encoding='ascii') as handle:
+        for line in handle:
+            line = line.strip()
+            if not line or ':' not in line:
+                continue
+            code, data = line.split(':', 1)
+            codepoint = int(code, 16)
+            # 16 rows: 32 digits = 8 px wide, 64 digits = 16 px wide; 8 rows: 16 digits
+            if len(data) in (32, 64):
+                height = 16
+            elif len(data) == 16:
+                height = 8
+            else:
+                continue
+            width = len(data) * 4 // height
+            row_digits = width // 4
+            rows = [int(data[i * row_digits:(i + 1) * row_digits], 16) for i in range(height)]
+            glyphs[codepoint] = (width, rows)
+    return glyphs
+
+
+def parse_bdf(path):
+    glyphs = {}
+    font_height = None
+    font_descent = 0
+    codepoint = None
+    bbx = None
+    rows = None
+    with path.open('r', encoding='latin-1') as handle:
+        for line in handle:
+            parts = line.split()
+            if not parts:
+                continue
+            key = parts[0]
+            if key == 'FONTBOUNDINGBOX':
+                font_height = int(parts[2])
+                font_descent = -int(parts[4])
+            elif key == 'ENCODING':
+                codepoint = int(parts[1])
+            elif key == 'BBX':
+                bbx = [int(value) for value in parts[1:5]]
+            elif key == 'BITMAP':
+                rows = []
+            elif key == 'ENDCHAR':
+                if codepoint is not None and codepoint >= 0 and bbx and rows is not None:
+                    glyphs[codepoint] = place_bdf_glyph(bbx, rows, font_height, font_descent)
+                codepoint = None
+                bbx = None
+                rows = None
+            elif rows is not None:
+                rows.append(key)
+    return glyphs
+
+
+def place_bdf_glyph(bbx, hex_rows, font_height, font_descent):
+    width, height, x_off, y_off = bbx
+    cell_width = max(width + max(x_off, 0), 1)
+    cell_height = font_height or height
+    top = cell_height - font_descent - (height + y_off)
+    placed = [0] * cell_height
+    for index, text in enumerate(hex_rows):
+        bits = len(text) * 4
+        value = int(text, 16) >> (bits - width) if text else 0
+        row = top + index
+        if 0 <= row < cell_height:
+            placed[row] = value << (cell_width - width - max(x_off, 0))
+    return cell_width, placed
+
+
+def downsample(width, rows, factor):
+    if factor == 1:
+        return width, rows
+    out_width = (width + factor - 1) // factor
+    out_rows = []
+    threshold = (factor * factor + 1) // 2
+    for y in range(0, len(rows), factor):
+        row_value = 0
+        for x in range(out_width):
+            hits = 0
+            for dy in range(factor):
+                if y + dy >= len(rows):
+                    continue
+                for dx in range(factor):
+                    px = x * factor + dx
+                    if px < width and rows[y + dy] & (1 << (width - 1 - px)):
+                        hits += 1
+            if hits >= threshold:
+                row_value |= 1 << (out_width - 1 - x)
+        out_rows.append(row_value)
+    return out_width, out_rows
+
+
+def rows_to_columns(width, rows):
+    columns = []
+    for col in range(width):
+        bits = 0
+        for row_idx, row_value in enumerate(rows):
+            if row_value & (1 << (width - 1 - col)):
+                bits |= 1 << row_idx
+        columns.append(bits)
+    used = [index for index, value in enumerate(columns) if value]
+    if not used:
+        return [0] * BLANK_WIDTH
+    return columns[used[0]:used[-1] + 1][:MAX_WIDTH]
+
+
+def packbits(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 3:
+            out.append(257 - run)
+            out.append(data[i])
+            i += run
+            continue
+        start = i
+        while i < len(data) and i - start < 128:
+            if i + 2 < len(data) and data[i] == data[i + 1] == data[i + 2]:
+                break
+            i += 1
+        out.append(i - start - 1)
+        out.extend(data[start:i])
+    return bytes(out)
+
+
+def build_pages(glyphs):
+    pages = {}
+    for codepoint, columns in glyphs.items():
+        pages.setdefault(codepoint >> 8, {})[codepoint & 0xFF] = columns
+    packed = []
+    for page in sorted(pages):
+        entries = pages[page]
+        bitmap = bytearray(PAGE_SIZE // 8)
+        body = bytearray()
+        for index in range(PAGE_SIZE):
+            if index not in entries:
+                continue
+            bitmap[index >> 3] |= 1 << (index & 7)
+            columns = entries[index]
+            body.append(len(columns))
+            body.extend(columns)
+        data = packbits(bytes(bitmap) + bytes(body))
+        if len(data) > 0xFFFF:
+            raise SystemExit(f'page 0x{page:X} does not fit into 64 KiB')
+        packed.append((page, data, len(entries)))
+    return packed
+
+
+def write_container(path, pages, height, max_width, glyph_count):
+    dir_offset = HEADER_SIZE
+    data_offset = dir_offset + DIR_ENTRY_SIZE * len(pages)
+    header = MAGIC + struct.pack('<HBBIII', VERSION, height, max_width, len(pages), dir_offset,
+                                 glyph_count)
+    directory = bytearray()
+    blobs = bytearray()
+    for page, data, count in pages:
+        directory += struct.pack('<IIHH', page, data_offset + len(blobs), len(data), count)
+        blobs += data
+    path.write_bytes(header + directory + blobs)
+    return len(header) + len(directory), len(blobs)
+
+
+def parse_range(text):
+    low, _, high = text.partition('-')
+    return int(low, 0), int(high or low, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('source', type=Path)
+    parser.add_argument('output', type=Path)
+    parser.add_argument('--downsample', type=int, default=1)
+    parser.add_argument('--range', type=parse_range, default=(0x20, 0x10FFFF))
+    args = parser.parse_args()
+
+    if not args.source.exists():
+        raise SystemExit(f'Font source {args.source} not found')
+    if args.source.suffix.lower() == '.bdf':
+        source = parse_bdf(args.source)
+    else:
+        source = parse_hex(args.source)
+
+    low, high = args.range
+    glyphs = {}
+    height = 0
+    for codepoint, (width, rows) in source.items():
+        if codepoint < low or codepoint > high:
+            continue
+        width, rows = downsample(width, rows, args.downsample)
+        if len(rows) > MAX_HEIGHT:
+            raise SystemExit(f'U+{codepoint:04X} is {len(rows)} rows tall; use --downsample')
+        height = max(height, len(rows))
+        glyphs[codepoint] = rows_to_columns(width, rows)
+
+    if not glyphs:
+        raise SystemExit('No glyph entries generated')
+
+    max_width = max(len(columns) for columns in glyphs.values())
+    pages = build_pages(glyphs)
+    resident, packed = write_container(args.output, pages, height, max_width, len(glyphs))
+    print(f'{len(glyphs)} glyphs in {len(pages)} pages: {resident} bytes directory, '
+          f'{packed} bytes packed', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()